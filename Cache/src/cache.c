@@ -29,141 +29,189 @@
 
 #include <time.h>
 #include <math.h>
+#include <unistd.h>
 
 #include "cache.h"
 #include "config.h"
 #include "error.h"
- 
+#include "hierarchy.h"
+#include "stats.h"
+
 /*==================================================================================================
-    Main
+    Parameter Handling
 ==================================================================================================*/
 
 /**
-* @brief Main entry point for cache simulation program
-* 
-* @param argc Number of command-line arguments (expected 8)
-* @param argv Array of command-line arguments:
-*               - argv[0] Executable name
-*               - argv[1] Cache type (U/I/D)
-*               - argv[2] Line size in words
-*               - argv[3] Number of cache layers (1-3)
-*               - argv[4] L1 size in KB
-*               - argv[5] L2 size in KB
-*               - argv[6] L3 size in KB
-*               - argv[7] Print style (1/2)
-* @return int 0 on success, -1 on error
-*/
-int main(int argc, char* argv[]) {
-
-    // Set up Timing Elements
-    clock_t start_time, end_time;
-    double elapsed_time;
-    start_time = clock();
-
-    // ========== Retreive Command-line Arguments ==========
-    environment_info_s env;
-    retrieveParameters(&env, argc, argv);
-
-    // ========== Setup Cache Layers ==========
-    error_status_s cache_setup_status;
-    for (unsigned int i = 0; i < env.cache_layers; i++) {
-        cache_setup_status = setupCache(
-             &env.cache[i], 
-             (i+1), 
-        env.layer_sizes[i], 
-         env.line_size);
-        ERR_CHECK(cache_setup_status);
+ * @brief Retrieves and validates command-line parameters for the cache simulation
+ * 
+ * @param env Pointer to environment_info_s structure to store the parameters
+ * @param argc Number of command-line arguments
+ * @param argv Array of command-line argument strings
+ * @return error_status_s Error status structure with any parameter errors
+ */
+error_status_s retrieveParameters(environment_info_s* env, int argc, char** argv) {
+    error_status_s param_status = {  // holds error info
+        .domain = ERROR_PARAMETER,
+        .param.executable_name = argv[0]
+    };
+
+    // Check argument count
+    if (argc != 8 && 
+        argc != (8 + ASSOCIATIVITY_FIELD_COUNT) && 
+        argc != (8 + ASSOCIATIVITY_FIELD_COUNT + 1)) {
+        param_status.code = ERR_INVALID_ARG_COUNT;
+        param_status.param.arg_count = argc;
+        return param_status;
     }
 
-    // ========== Process Reques ts Until End of File ==========
-    char current_char;
-    char buffer[TRACE_SIZE+1]; // traces are 11 char's long + null terminator
-    buffer[TRACE_SIZE] = '\0';
-    bool data_found = false;
+    // Get the cache configuration
+    param_status = parseConfiguration(env, argv + 1);
+    if (param_status.code != ERR_SUCCESS)
+        return param_status;
 
-    // Initialize request
-    request_s* request;
-    error_status_s request_status = allocateRequest(&request);
-    ERR_CHECK(request_status);
+    // Get the associativity of each layer (direct-mapped if not provided)
+    param_status = parseAssociativity(env, argv + 8, (argc - 8));
+    if (param_status.code != ERR_SUCCESS)
+        return param_status;
 
-    // Process each trace in the input file
-    while ((current_char = getchar()) != EOF) {
-        // Skip until trace found
-        if (current_char != '@') continue;
+    // Get print style
+    env->print_style = atoi(argv[7]); // 1 concise : 2 verbose
+    if (env->print_style != 1 && env->print_style != 2) {
+        param_status.code = ERR_INVALID_PRINT_STYLE;
+        param_status.param.print_style = env->print_style;
+        return param_status;
+    }
 
-        // Trace found, read in format: <I/D><R/W><hex-address>
-        fgets(buffer, sizeof(buffer), stdin);
+    return param_status;
+}
 
-        // Skip request for irrelevant cache types
-        if (env.cache_type != UNIFIED && 
-           (reference_type_e)buffer[0] != env.cache_type) {
-            continue;
-        }
+/**
+ * @brief Retrieves every cache configuration listed in a sweep configuration file
+ * 
+ * Each non-empty line that does not begin with '#' holds one configuration in the
+ * same order as the single run arguments (without the print style):
+ *      <cache_type> <line_size> <cache_layers> <L1_size> <L2_size> <L3_size>
+ *      [<L1_ways> <L2_ways> <L3_ways> <replacement_policy> [<inclusion_policy>]]
+ * 
+ * @param envs Output pointer to the allocated array of configurations
+ * @param env_count Output for the number of configurations read
+ * @param argc Number of command-line arguments
+ * @param argv Array of command-line argument strings
+ * @return error_status_s Error status structure with any parameter errors
+ */
+error_status_s retrieveSweepParameters(environment_info_s** envs, size_t* env_count,
+                                       size_t* thread_count, int argc, char** argv) {
+    error_status_s param_status = {  // holds error info
+        .domain = ERROR_PARAMETER,
+        .param.executable_name = argv[0]
+    };
 
-        // Try each cache layer in order until data is found
-        for (unsigned int i = 0; i < env.cache_layers; i++) {
-            env.cache[i]->requests++;
+    // Check argument count
+    if (argc != 3 && argc != 4) {
+        param_status.code = ERR_INVALID_ARG_COUNT;
+        param_status.param.arg_count = argc;
+        return param_status;
+    }
 
-            // Format the request information for cache layer
-            request_status = formatRequest(request, env.cache[i], buffer);
-            ERR_CHECK(request_status);
+    // Get worker thread count (defaults to the number of online cores)
+    long online_cores = sysconf(_SC_NPROCESSORS_ONLN);
+    *thread_count = (argc == 4) ? (size_t)atoi(argv[3]) : 
+                    (size_t)((online_cores > 0) ? online_cores : 1);
+    if (*thread_count < 1 || *thread_count > MAX_SWEEP_THREADS) {
+        param_status.code = ERR_INVALID_THREAD_COUNT;
+        param_status.param.thread_count = *thread_count;
+        return param_status;
+    }
 
-            // Process request in given cache layer
-            request_status = processRequest(request, env.cache[i], &data_found);
-            ERR_CHECK(request_status);
+    FILE* sweep_file = fopen(argv[2], "r");
+    if (sweep_file == NULL) {
+        param_status.code = ERR_FAILED_TO_OPEN_SWEEP_FILE;
+        param_status.param.filename = argv[2];
+        return param_status;
+    }
 
-            if (data_found) break; // exit loop on cache hit
+    size_t capacity = 0;
+    unsigned int line_number = 0;
+    char line[MAX_SWEEP_LINE_SIZE];
+    *envs = NULL;
+    *env_count = 0;
+
+    while (fgets(line, sizeof(line), sweep_file) != NULL) {
+        line_number++;
+
+        // Split the line into its configuration fields
+        char* fields[SWEEP_FIELD_COUNT + ASSOCIATIVITY_FIELD_COUNT + 2];
+        unsigned int field_count = 0;
+        for (char* token = strtok(line, " \t\r\n"); 
+             token != NULL && field_count <= (SWEEP_FIELD_COUNT + ASSOCIATIVITY_FIELD_COUNT + 1); 
+             token = strtok(NULL, " \t\r\n")) {
+            fields[field_count++] = token;
         }
 
-        // Reset flag
-        data_found = false;
-    }
+        // Skip blank and comment lines
+        if (field_count == 0 || fields[0][0] == '#') continue;
 
-    // ========== Print Statistics and Cleanup ==========
-    printResults(env);
+        if (field_count != SWEEP_FIELD_COUNT && 
+            field_count != (SWEEP_FIELD_COUNT + ASSOCIATIVITY_FIELD_COUNT) &&
+            field_count != (SWEEP_FIELD_COUNT + ASSOCIATIVITY_FIELD_COUNT + 1)) {
+            param_status.code = ERR_INVALID_SWEEP_CONFIG;
+            param_status.config_line = line_number;
+            param_status.param.arg_count = field_count;
+            break;
+        }
 
-    // Clean up memory
-    free(request);
-    for (unsigned int i = 0; i < env.cache_layers; i++) {
-        destroyCache(env.cache[i]);
+        // Grow the configuration array as needed
+        if (*env_count == capacity) {
+            capacity = (capacity == 0) ? 16 : (capacity * 2);
+            environment_info_s* grown = (environment_info_s*)realloc(
+                *envs, capacity * sizeof(environment_info_s));
+            if (grown == NULL) {
+                param_status.code = ERR_SWEEP_ALLOCATION_FAILED;
+                break;
+            }
+            *envs = grown;
+        }
+
+        // Parse and validate the configuration itself
+        environment_info_s* env = &(*envs)[*env_count];
+        param_status = parseConfiguration(env, fields);
+        if (param_status.code == ERR_SUCCESS) {
+            param_status = parseAssociativity(env, fields + SWEEP_FIELD_COUNT, 
+                                              (field_count - SWEEP_FIELD_COUNT));
+        }
+        if (param_status.code != ERR_SUCCESS) {
+            param_status.config_line = line_number;
+            break;
+        }
+        env->print_style = 1; // unused, sweep results are always printed as a table
+        (*env_count)++;
     }
+    fclose(sweep_file);
 
-    // Calculate and print elapsed time
-    end_time = clock();
-    elapsed_time = (((double)(end_time - start_time)) / CLOCKS_PER_SEC);
-    printf("Total Elapsed Time: %.2f seconds\n", elapsed_time);
+    if (param_status.code == ERR_SUCCESS && *env_count == 0) {
+        param_status.code = ERR_EMPTY_SWEEP_FILE;
+        param_status.param.filename = argv[2];
+    }
 
-    // End of program
-    return EXIT_SUCCESS;
+    return param_status;
 }
 
-/*==================================================================================================
-    Parameter Handling
-==================================================================================================*/
-
 /**
- * @brief Retrieves and validates command-line parameters for the cache simulation
+ * @brief Parses and validates a single cache configuration
  * 
- * @param env Pointer to environment_info_s structure to store the parameters
- * @param argc Number of command-line arguments
- * @param argv Array of command-line argument strings
+ * @param env Pointer to environment_info_s structure to store the configuration
+ * @param fields Configuration fields in the order:
+ *               <cache_type> <line_size> <cache_layers> <L1_size> <L2_size> <L3_size>
  * @return error_status_s Error status structure with any parameter errors
  */
-error_status_s retrieveParameters(environment_info_s* env, int argc, char** argv) {
+error_status_s parseConfiguration(environment_info_s* env, char** fields) {
     error_status_s param_status = {  // holds error info
         .domain = ERROR_PARAMETER,
-        .param.executable_name = argv[0]
+        .code = ERR_SUCCESS
     };
 
-    // Check argument count
-    if (argc != 8) {
-        param_status.code = ERR_INVALID_ARG_COUNT;
-        param_status.param.arg_count = argc;
-        return param_status;
-    }
-
     // Get type of cache reference to be tracked
-    env->cache_type = (reference_type_e) *argv[1]; // cast the character
+    env->cache_type = (reference_type_e) *fields[0]; // cast the character
     if (env->cache_type != UNIFIED && 
         env->cache_type != INSTRUCTION && 
         env->cache_type != DATA) 
@@ -174,7 +222,7 @@ error_status_s retrieveParameters(environment_info_s* env, int argc, char** argv
     }
     
     // Get size of each line in all caches
-    env->line_size = (atoi(argv[2]) * 4); // convert words to bytes
+    env->line_size = (atoi(fields[1]) * 4); // convert words to bytes
     if (env->line_size < 4) { // cant be smaller than 4 bytes
         param_status.code = ERR_INVALID_LINE_SIZE;
         param_status.cache.line_size = env->line_size;
@@ -182,7 +230,7 @@ error_status_s retrieveParameters(environment_info_s* env, int argc, char** argv
     }
 
     // Get total number of cache layers
-    env->cache_layers = atoi(argv[3]);
+    env->cache_layers = atoi(fields[2]);
     if (env->cache_layers < 1 || env->cache_layers > 3) { // we only support (1-3) layers
         param_status.code = ERR_INVALID_CACHE_LAYER_COUNT;
         param_status.cache.num_layers = env->cache_layers;
@@ -191,7 +239,7 @@ error_status_s retrieveParameters(environment_info_s* env, int argc, char** argv
     
     // Get cache sizes (0 indicates nonexistent cache layer)
     for (unsigned int i = 0; i < env->cache_layers; i++)
-        env->layer_sizes[i] = (atoi(argv[i+4]) * 1024);
+        env->layer_sizes[i] = (atoi(fields[i+3]) * 1024);
 
     // Validate integrity of computed cache sizes
     for (unsigned int i = 0; i < env->cache_layers; i++) {
@@ -204,14 +252,74 @@ error_status_s retrieveParameters(environment_info_s* env, int argc, char** argv
         }
     }
 
-    // Get print style
-    env->print_style = atoi(argv[7]); // 1 concise : 2 verbose
-    if (env->print_style != 1 && env->print_style != 2) {
-        param_status.code = ERR_INVALID_PRINT_STYLE;
-        param_status.param.print_style = env->print_style;
+    return param_status;
+}
+
+/**
+ * @brief Parses and validates the associativity, replacement and inclusion policies of a
+ *        configuration
+ * 
+ * @param env Pointer to environment_info_s structure holding a parsed configuration
+ * @param fields Associativity fields in the order:
+ *               <L1_ways> <L2_ways> <L3_ways> <replacement_policy> [<inclusion_policy>]
+ * @param field_count Number of fields (0 for a direct-mapped NINE hierarchy)
+ * @return error_status_s Error status structure with any parameter errors
+ */
+error_status_s parseAssociativity(environment_info_s* env, char** fields, size_t field_count) {
+    error_status_s param_status = {  // holds error info
+        .domain = ERROR_PARAMETER,
+        .code = ERR_SUCCESS
+    };
+
+    // Default to a direct-mapped hierarchy
+    env->policy = LRU;
+    env->inclusion = NINE;
+    for (unsigned int i = 0; i < 3; i++)
+        env->associativity[i] = 1;
+    if (field_count == 0)
+        return param_status;
+
+    // Get the inclusion policy between layers
+    if (field_count > ASSOCIATIVITY_FIELD_COUNT) {
+        env->inclusion = (inclusion_policy_e) *fields[ASSOCIATIVITY_FIELD_COUNT];
+        if (env->inclusion != NINE && 
+            env->inclusion != INCLUSIVE && 
+            env->inclusion != EXCLUSIVE) 
+        {
+            param_status.code = ERR_INVALID_INCLUSION_POLICY;
+            param_status.cache.type = env->inclusion;
+            return param_status;
+        }
+    }
+
+    // Get the replacement policy shared by every layer
+    env->policy = (replacement_policy_e) *fields[3]; // cast the character
+    if (env->policy != LRU && 
+        env->policy != PLRU && 
+        env->policy != FIFO && 
+        env->policy != RANDOM) 
+    {
+        param_status.code = ERR_INVALID_REPLACEMENT_POLICY;
+        param_status.cache.type = env->policy;
         return param_status;
     }
 
+    // Get the number of ways in each layer
+    for (unsigned int i = 0; i < env->cache_layers; i++) {
+        env->associativity[i] = atoi(fields[i]);
+        size_t num_lines = env->layer_sizes[i] / env->line_size;
+
+        // Ways must be a power of two that fits in the set masks and the layer itself
+        if (!isPowerOfTwo(env->associativity[i]) || 
+            env->associativity[i] > MAX_ASSOCIATIVITY ||
+            env->associativity[i] > num_lines) {
+            param_status.code = ERR_INVALID_ASSOCIATIVITY;
+            param_status.cache.associativity = env->associativity[i];
+            param_status.cache.layer = (i+1); // increment b/c we're 0-indexed
+            return param_status;
+        }
+    }
+
     return param_status;
 }
 
@@ -254,7 +362,9 @@ error_status_s allocateCache(cache_s** cache, size_t layer, size_t cache_size, s
 void destroyCache(cache_s* cache) {
     // Check for null pointer
     if (cache != NULL) {
-        free(cache->lines);
+        free(cache->sets);
+        free(cache->index_accesses);
+        free(cache->index_misses);
         free(cache);
     }
 
@@ -270,9 +380,12 @@ void destroyCache(cache_s* cache) {
  * @param layer Cache layer number (1-3)
  * @param cache_size Total size of cache in bytes
  * @param line_size Size of each cache line in bytes
+ * @param associativity Number of lines in each set (1 for direct-mapped)
+ * @param policy Replacement policy used to select victims within a set
  * @return error_status_s Error status structure indicating success or failure
  */
-error_status_s setupCache(cache_s** cache, size_t layer, size_t cache_size, size_t line_size) {
+error_status_s setupCache(cache_s** cache, size_t layer, size_t cache_size, size_t line_size,
+                          size_t associativity, replacement_policy_e policy) {
 
     // Allocate space for cache on the heap
     error_status_s status = allocateCache(cache, layer, cache_size, line_size);
@@ -285,11 +398,24 @@ error_status_s setupCache(cache_s** cache, size_t layer, size_t cache_size, size
     (*cache)->cache_size = cache_size;
     (*cache)->line_size = line_size;
     (*cache)->num_lines = (cache_size / line_size);
+    (*cache)->associativity = associativity;
+    (*cache)->num_sets = ((*cache)->num_lines / associativity);
+    (*cache)->policy = policy;
+    (*cache)->sets = NULL;
+    (*cache)->random_state = RANDOM_POLICY_SEED;
+    (*cache)->match_tags = selectTagMatch(associativity);
     (*cache)->requests = 0;
     (*cache)->hits = 0;
     (*cache)->misses = 0;
     (*cache)->read_to_write = 0;
     (*cache)->write_to_write = 0;
+    (*cache)->writeback_requests = 0;
+    (*cache)->writeback_hits = 0;
+    (*cache)->back_invalidations = 0;
+    (*cache)->fill_bytes = 0;
+    (*cache)->writeback_bytes = 0;
+    (*cache)->index_accesses = NULL;
+    (*cache)->index_misses = NULL;
 
     // Verify number of lines is a power of two
     if (!isPowerOfTwo((*cache)->num_lines)) {
@@ -298,26 +424,49 @@ error_status_s setupCache(cache_s** cache, size_t layer, size_t cache_size, size
         return status;
     }
 
-    // Memory allocation for cache lines
-    (*cache)->lines = (line_s*)malloc((*cache)->num_lines * sizeof(line_s));
-    if ((*cache)->lines == NULL) {
+    // Each set block holds its header words followed by its tags (and LRU ages). The stride is
+    // rounded up to a power of two so a block never straddles more host cache lines than needed
+    bool keeps_ages = (policy == LRU && associativity > 1);
+    (*cache)->set_stride = SET_HEADER_WORDS + associativity;
+    if (keeps_ages)
+        (*cache)->set_stride += SET_AGE_WORDS(associativity);
+    while (!isPowerOfTwo((*cache)->set_stride))
+        (*cache)->set_stride++;
+
+    // Memory allocation for cache sets (zeroed, so every line starts invalid and clean)
+    size_t set_bytes = (*cache)->num_sets * (*cache)->set_stride * sizeof(uint32_t);
+    if (set_bytes % HOST_CACHE_LINE_SIZE != 0)
+        set_bytes += HOST_CACHE_LINE_SIZE - (set_bytes % HOST_CACHE_LINE_SIZE);
+    (*cache)->sets = (uint32_t*)aligned_alloc(HOST_CACHE_LINE_SIZE, set_bytes);
+    if ((*cache)->sets == NULL) {
         status.code = ERR_CACHE_LINE_ALLOCATION_FAILED;
         return status;
     }
-
-    // Default each line's attributes
-    for (size_t i = 0; i < (*cache)->num_lines; i++) {
-        (*cache)->lines[i].dirty = false; // marks line as initially clean (not modified)
-        (*cache)->lines[i].tag[0] = '\0';  // initial tag set to '\0' to represent uninitialized
+    memset((*cache)->sets, 0, set_bytes);
+
+    // LRU ages start as a permutation (way w has age w) so every touch keeps them distinct
+    if (keeps_ages) {
+        for (size_t s = 0; s < (*cache)->num_sets; s++) {
+            uint8_t* ages = (uint8_t*)&(*cache)->sets[(s * (*cache)->set_stride) +
+                                                      SET_HEADER_WORDS + associativity];
+            for (size_t w = 0; w < associativity; w++)
+                ages[w] = (uint8_t)w;
+        }
     }
 
     // Calculate Address Field Sizes
     (*cache)->offset_size = (size_t)(log2(line_size));
-    (*cache)->index_size = (size_t)(log2((int)(cache_size / line_size)));
+    (*cache)->index_size = (size_t)(log2((int)(*cache)->num_sets));
     (*cache)->tag_size = (size_t)(INSTRUCTION_SIZE - 
                                  (*cache)->index_size - 
                                  (*cache)->offset_size);
 
+    // Precompute shifts and masks so fields can be extracted without strings
+    (*cache)->index_shift = (*cache)->offset_size;
+    (*cache)->tag_shift = (*cache)->offset_size + (*cache)->index_size;
+    (*cache)->offset_mask = (1u << (*cache)->offset_size) - 1;
+    (*cache)->index_mask = (1u << (*cache)->index_size) - 1;
+
     if (DEBUG) {
         printf( "\n"
                 "Cache Created:\n"
@@ -326,10 +475,15 @@ error_status_s setupCache(cache_s** cache, size_t layer, size_t cache_size, size
                 "Size (bytes): %zu\n"
                 "Line Size (bytes): %zu\n"
                 "Number of Lines: %zu\n"
+                "Associativity: %zu\n"
+                "Number of Sets: %zu\n"
+                "Replacement Policy: %c\n"
+                "Tag Match Kernel: %s\n"
                 "Tag Size: %d\n"
                 "Index Size: %d\n"
                 "Offset Size: %d\n",
                 layer, cache_size, line_size, (*cache)->num_lines, 
+                associativity, (*cache)->num_sets, policy, tagMatchName((*cache)->match_tags),
                 (*cache)->tag_size, (*cache)->index_size, (*cache)->offset_size);
     }
 
@@ -362,69 +516,101 @@ error_status_s allocateRequest(request_s** request) {
 }
 
 /**
- * @brief Formats a request structure based on a trace buffer and cache parameters
+ * @brief Simulates a trace against each configuration on the calling thread
  * 
- * @param request Pointer to request structure to format
+ * @param envs Array of configurations to simulate
+ * @param env_count Number of configurations in the array
+ * @param reader Pointer to an open trace reader
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s simulateTrace(environment_info_s* envs, size_t env_count, trace_reader_s* reader) {
+    // Initialize request
+    request_s* request;
+    error_status_s status = allocateRequest(&request);
+    if (status.code != ERR_SUCCESS)
+        return status;
+
+    trace_ref_s batch[TRACE_BATCH_SIZE];
+    size_t batch_count;
+
+    // Process each trace in the input file
+    while ((status = readTraceBatch(reader, batch, TRACE_BATCH_SIZE, &batch_count)).code 
+                == ERR_SUCCESS && batch_count > 0) {
+        for (size_t r = 0; r < batch_count; r++) {
+            loadRequest(request, &batch[r]);
+
+            for (size_t e = 0; e < env_count; e++) {
+                status = simulateRequest(&envs[e], request);
+                if (status.code != ERR_SUCCESS) {
+                    free(request);
+                    return status;
+                }
+
+                // Hand the counters to the stats writer at the end of each interval
+                stats_writer_s* stats = envs[e].stats;
+                if (stats != NULL && --stats->countdown == 0)
+                    publishIntervalSample(stats);
+            }
+        }
+    }
+
+    free(request);
+    return status;
+}
+
+/**
+ * @brief Loads a decoded trace reference into a request structure
+ * 
+ * @param request Pointer to request structure to populate
+ * @param ref Pointer to the decoded trace reference
+ */
+void loadRequest(request_s* request, const trace_ref_s* ref) {
+    request->ref_type = (reference_type_e)ref->ref_type;
+    request->access_type = (access_type_e)ref->access_type;
+    request->address.hex = ref->hex;
+}
+
+/**
+ * @brief Extracts the tag, index, and offset of a request for a given cache layer
+ * 
+ * @param request Pointer to request structure to populate with address fields
  * @param cache Pointer to the cache structure for address field sizing
- * @param buffer Input trace buffer string containing request information
  * @return error_status_s Error status structure indicating success or failure
  */
-error_status_s formatRequest(request_s* request, cache_s* cache, const char* buffer) {
+error_status_s formatRequestAddressFields(request_s* request, cache_s* cache) {
     error_status_s status = {
         .domain = ERROR_REQUEST,
         .code = ERR_SUCCESS
     };
 
-    if (request == NULL) {
-        status.code = ERR_REQUEST_IS_NULL;
-        return status;
-    }
-
     if (cache == NULL) {
         status.code = ERR_CACHE_IS_NULL;
         return status;
     }
 
-    // Assign address field sizes based on cache
-    request->address.tag_size = cache->tag_size;
-    request->address.index_size = cache->index_size;
-    request->address.offset_size = cache->offset_size;
+    // Extract fields using the cache's precomputed shifts and masks
+    unsigned int hex = request->address.hex;
+    request->address.tag = hex >> cache->tag_shift;
+    request->address.index = (hex >> cache->index_shift) & cache->index_mask;
+    request->address.offset = hex & cache->offset_mask;
 
-    // Note: Buffer format: <I/D><R/W><hex-address>
-    // Assign reference type based on trace
-    switch (buffer[0]) {
-        case 'I':
-            request->ref_type = INSTRUCTION;
-            break;
-        case 'D':
-            request->ref_type = DATA;
-            break;
-        default:
-            status.code = ERR_INVALID_REFERENCE_TYPE;
-            status.request.ref_type = buffer[0];
-            return status;
-    }
+    if (DEBUG) {
+        // Retrieve and copy tag, index, and offset as binary strings
+        int tag_size = cache->tag_size;
+        int index_size = cache->index_size;
+        int offset_size = cache->offset_size;
+        hexToBinaryString(request->address.binary, hex);
 
-    // Assign access type based on trace
-    switch (buffer[1]) {
-        case 'R':
-            request->access_type = READ;
-            break;
-        case 'W':
-            request->access_type = WRITE;
-            break;
-        default:
-            status.code = ERR_INVALID_ACCESS_TYPE;
-            status.request.access_type = buffer[1];
-            return status;
-    }
+        strncpy(request->address.tag_bits, request->address.binary, tag_size);
+        request->address.tag_bits[tag_size] = '\0'; // end with null term
 
-    // Format the address fields of the request
-    status = formatRequestAddressFields(request, buffer);
-    if (status.code != ERR_SUCCESS) 
-        return status;
+        strncpy(request->address.index_bits, request->address.binary + tag_size, index_size);
+        request->address.index_bits[index_size] = '\0'; // end with null term
+
+        strncpy(request->address.offset_bits, request->address.binary + tag_size + index_size,
+                offset_size);
+        request->address.offset_bits[offset_size] = '\0'; // end with null term
 
-    if (DEBUG) {
         printf( "\nRequest Formatted:\n"
                   "-------------------\n"
                   "Reference Type: %c\n"
@@ -439,68 +625,39 @@ error_status_s formatRequest(request_s* request, cache_s* cache, const char* buf
                   "Offset Bits: %s\n"
                   "Offset Dec: %u\n",
                   request->ref_type, request->access_type,
-                  cache->layer, request->address.hex, request->address.binary,
-                  request->address.tag, binaryStringToInt(request->address.tag),
-                  request->address.index, binaryStringToInt(request->address.index),
-                  request->address.offset, binaryStringToInt(request->address.offset));
+                  cache->layer, hex, request->address.binary,
+                  request->address.tag_bits, request->address.tag,
+                  request->address.index_bits, request->address.index,
+                  request->address.offset_bits, request->address.offset);
     }
 
     return status;
 }
 
 /**
- * @brief Formats the address fields of a request from a trace buffer
+ * @brief Simulates a decoded request against every layer of a cache hierarchy
  * 
- * @param buffer Input trace buffer string containing address information
- * @param request Pointer to request structure to populate with address fields
+ * @param env Pointer to the environment holding the cache hierarchy
+ * @param request Pointer to decoded request to simulate
  * @return error_status_s Error status structure indicating success or failure
  */
-error_status_s formatRequestAddressFields(request_s* request, const char* buffer) {
+error_status_s simulateRequest(environment_info_s* env, request_s* request) {
     error_status_s status = {
         .domain = ERROR_REQUEST,
         .code = ERR_SUCCESS
     };
 
-    // Format hex address and ensure it's proper
-    if (sscanf(buffer + 2, "%x", &request->address.hex) != 1) {
-        status.code = ERR_FAILED_TO_FORMAT_ADDRESS_HEX;
-        memcpy(&status.request.str_trace, buffer, TRACE_SIZE);
+    // Skip request for irrelevant cache types
+    if (env->cache_type != UNIFIED && request->ref_type != env->cache_type) {
         return status;
     }
 
-    // Convert address to binary representation
-    hexToBinaryString(request->address.binary, request->address.hex);
-    
-    // Retrieve and copy tag, index, and offset
-    int tag_size = request->address.tag_size;
-    int index_size = request->address.index_size;
-    int offset_size = request->address.offset_size;
-    strncpy(
-       request->address.tag, 
-        request->address.binary, // start at index 0
-          tag_size
-    );
-    request->address.tag[tag_size] = '\0'; // end with null term
-
-    strncpy(
-       request->address.index, 
-        request->address.binary + tag_size, // skip tag
-          index_size
-    );
-    request->address.index[index_size] = '\0'; // end with null term
-
-    strncpy(
-      request->address.offset, 
-       request->address.binary + tag_size + index_size, // skip tag + index
-         offset_size
-    );
-    request->address.offset[offset_size] = '\0'; // end with null term
-
-    return status;
+    // Probe, fill and write back through every layer
+    return accessHierarchy(env, request);
 }
 
 /**
- * @brief Processes a cache request, updating cache state and statistics
+ * @brief Processes a cache request in a single layer, updating cache state and statistics
  * 
  * @param request Pointer to formatted request to process
  * @param cache Pointer to cache structure to access
@@ -513,226 +670,237 @@ error_status_s processRequest(request_s* request, cache_s* cache, bool* hit_occu
         .code = ERR_SUCCESS
     };
 
-    // Convert index to integer
-    size_t index = binaryStringToInt(request->address.index);
+    size_t index = request->address.index;
+    bool is_write = (request->access_type == WRITE);
 
     // Check if index is within bounds
-    if (index >= cache->num_lines) {
+    if (index >= cache->num_sets) {
         status.code = ERR_REQUEST_INDEX_OUT_OF_BOUNDS;
+        status.request.index = index;
+        status.request.max_cache_index = cache->num_sets;
         return status;
     }
 
-    // Create reference to line for clarity
-    line_s* line = &cache->lines[index];
-    access_type_e acc_type = request->access_type; // store access_type for clarity
-
     // If line found in cache
-    if (strcmp(line->tag, request->address.tag) == 0) {
+    int way = findWay(cache, index, request->address.tag);
+    if (way >= 0) {
         cache->hits++;
         *hit_occured = true;
-        if (acc_type == 'W') 
-            line->dirty = true;  // data is now modified
-
-    } else {
-        cache->misses++;
-        *hit_occured = false;
-        if (line->dirty == true) {
-            if (acc_type == 'R') cache->read_to_write++;
-            if (acc_type == 'W') cache->write_to_write++;
-        }
+        updateWay(cache, index, way, is_write);
+        return status;
+    }
 
-        // Load the new tag, mark as clean
-        strcpy(line->tag, request->address.tag);
-        if (acc_type == 'R') line->dirty = false;
-        if (acc_type == 'W') line->dirty = true;
+    cache->misses++;
+    *hit_occured = false;
+
+    // Load the new tag, and record a write-back if the replaced line was modified
+    evicted_line_s evicted;
+    installLine(cache, index, request->address.tag, is_write, &evicted);
+    if (evicted.dirty) {
+        if (is_write) cache->write_to_write++;
+        else          cache->read_to_write++;
     }
 
     return status;
 }
 
 /*==================================================================================================
-    Error Handling
+    Line Functions
 ==================================================================================================*/
 
 /**
- * @brief Top-level error handler that delegates to domain-specific handlers
+ * @brief Searches a set for a tag
  * 
- * @param error Error status structure containing error information
- * @return int ERR_FAILURE after displaying error message
+ * @param cache Pointer to cache structure to search
+ * @param index Index of the set
+ * @param tag Tag to search for
+ * @return int Way holding the tag, or -1 if it is not cached
  */
-int handle_error(error_status_s error) {
-    fprintf(stderr, "Error: ");
-
-    switch(error.domain) {
+int findWay(cache_s* cache, size_t index, uint32_t tag) {
+    uint32_t* set = &cache->sets[index * cache->set_stride];
+    uint32_t* tags = &set[SET_HEADER_WORDS];
 
-        default:
-            fprintf(stderr, "Invalid error domain: %d\n", error.domain);
-            break;
-
-        case ERROR_NONE:
-            fprintf(stderr, "Error must have domain\n");
-            break;
-        
-        case ERROR_PARAMETER:
-            return handle_param_error(error);
+    // Compare the tag against every way at once (direct-mapped sets skip the kernel call)
+    uint32_t hit_mask = (cache->associativity == 1) ?
+                        (uint32_t)(tags[0] == tag) :
+                        cache->match_tags(tags, cache->associativity, tag);
+    hit_mask &= set[SET_VALID_WORD];
 
-        case ERROR_CACHE:
-            return handle_cache_error(error);
+    return (hit_mask != 0) ? (int)__builtin_ctz(hit_mask) : -1;
+}
 
-        case ERROR_REQUEST:
-            return handle_request_error(error);
-    }
-    return ERR_FAILURE;
+/**
+ * @brief Records an access to a cached line
+ * 
+ * @param cache Pointer to cache structure holding the line
+ * @param index Index of the set
+ * @param way Way holding the line
+ * @param is_write True if the access modifies the line
+ */
+void updateWay(cache_s* cache, size_t index, unsigned int way, bool is_write) {
+    uint32_t* set = &cache->sets[index * cache->set_stride];
+    set[SET_DIRTY_WORD] |= ((uint32_t)is_write << way); // data is now modified
+    touchWay(cache, set, way);
 }
 
 /**
- * @brief Handles parameter-related errors with appropriate error messages
+ * @brief Loads a line into a set, replacing the way chosen by the replacement policy
  * 
- * @param error Error status structure containing parameter error information
- * @return int ERR_FAILURE after displaying error message
+ * @param cache Pointer to cache structure to fill
+ * @param index Index of the set
+ * @param tag Tag of the line
+ * @param dirty True if the line is modified (writes and write-backs)
+ * @param evicted Output for the line that was replaced
+ * @return unsigned int Way the line was loaded into
  */
-int handle_param_error(error_status_s error) {
-    
-    switch(error.code) {
+unsigned int installLine(cache_s* cache, size_t index, uint32_t tag, bool dirty,
+                         evicted_line_s* evicted) {
+    uint32_t* set = &cache->sets[index * cache->set_stride];
+    uint32_t* tags = &set[SET_HEADER_WORDS];
+
+    // Pick the line to replace
+    unsigned int way = selectVictim(cache, set);
+    uint32_t way_bit = (1u << way);
+    evicted->valid = (set[SET_VALID_WORD] & way_bit) != 0;
+    evicted->dirty = evicted->valid && (set[SET_DIRTY_WORD] & way_bit) != 0;
+    evicted->line = (tags[way] << cache->index_size) | (uint32_t)index;
+
+    // Load the new tag, mark as clean or modified
+    tags[way] = tag;
+    set[SET_VALID_WORD] |= way_bit;
+    set[SET_DIRTY_WORD] = (set[SET_DIRTY_WORD] & ~way_bit) | ((uint32_t)dirty << way);
+    fillWay(cache, set, way);
+
+    return way;
+}
 
-        /** GENERAL CASES **/
-        default:
-            fprintf(stderr, "Invalid error code: %d\n", error.code);
-            break;
+/**
+ * @brief Removes a line from a cache if present
+ * 
+ * @param cache Pointer to cache structure to search
+ * @param line Line address (address >> offset_size)
+ * @param was_dirty Output set to true if the removed line was modified
+ * @return bool True if the line was present, false otherwise
+ */
+bool invalidateLine(cache_s* cache, uint32_t line, bool* was_dirty) {
+    size_t index = line & cache->index_mask;
+    int way = findWay(cache, index, line >> cache->index_size);
+    *was_dirty = false;
+    if (way < 0)
+        return false;
+
+    uint32_t* set = &cache->sets[index * cache->set_stride];
+    uint32_t way_bit = (1u << way);
+    *was_dirty = (set[SET_DIRTY_WORD] & way_bit) != 0;
+    set[SET_VALID_WORD] &= ~way_bit;
+    set[SET_DIRTY_WORD] &= ~way_bit;
+    return true;
+}
 
-        case ERR_SUCCESS:
-            fprintf(stderr, "ERR_SUCCESS unintentionally passed to handler\n");
-            break;
+/*==================================================================================================
+    Replacement Functions
+==================================================================================================*/
 
-        /** PARAMETER ERRORS **/
-        case ERR_INVALID_ARG_COUNT:
-            fprintf(stderr, "Invalid number of arguments. "
-                    "Expected 8, received %d.\n"
-                    "Usage: %s <cache_type> <line_size> <cache_layers>" 
-                    "<L1_size_B> <L2_size_B> <L3_size_B> <print_style>\n",
-                    error.param.arg_count, error.param.executable_name);
-            break;
-        case ERR_INVALID_CACHE_TYPE:
-            fprintf(stderr, 
-                    "Invalid cache type '%c'.\n", 
-                    error.cache.type);
-            break;
-        case ERR_INVALID_LINE_SIZE:
-            fprintf(stderr, 
-                    "Invalid line size '%zu'.\n", 
-                    error.cache.line_size);
-            break;
-        case ERR_INVALID_CACHE_LAYER_COUNT:
-            fprintf(stderr, 
-                    "Invalid cache layer count '%hu'.\n", 
-                    error.cache.num_layers);
-            break;
-        case ERR_INVALID_CACHE_SIZE:
-            fprintf(stderr, 
-                    "Invalid cache size '%zu' for layer '%u'.\n", 
-                    error.cache.size, error.cache.layer);
-            break;
-        case ERR_INVALID_PRINT_STYLE:
-            fprintf(stderr, 
-                    "Invalid print style '%u'.\n"
-                    "Usage: 1 = standard print | 2 = debug print\n", 
-                    error.param.print_style);
-            break;
+/**
+ * @brief Selects the way of a set to replace on a miss
+ * 
+ * @param cache Pointer to cache structure owning the set
+ * @param set Pointer to the set block
+ * @return unsigned int Way to replace
+ */
+unsigned int selectVictim(cache_s* cache, uint32_t* set) {
+    size_t ways = cache->associativity;
+    uint32_t way_mask = (ways == 32) ? 0xFFFFFFFFu : ((1u << ways) - 1);
+
+    // Fill invalid lines first
+    uint32_t invalid = ~set[SET_VALID_WORD] & way_mask;
+    if (invalid != 0)
+        return __builtin_ctz(invalid);
+
+    switch (cache->policy) {
+        case LRU: {
+            // Oldest age
+            const uint8_t* ages = (const uint8_t*)&set[SET_HEADER_WORDS + ways];
+            for (size_t w = 0; w < ways; w++) {
+                if (ages[w] == ways - 1) return (unsigned int)w;
+            }
+            return 0;
+        }
+        case PLRU: {
+            // Follow the tree bits down to a leaf (node n has children 2n and 2n+1)
+            uint32_t tree = set[SET_POLICY_WORD];
+            size_t node = 1;
+            while (node < ways) {
+                node = (2 * node) + ((tree >> node) & 1);
+            }
+            return (unsigned int)(node - ways);
+        }
+        case FIFO:
+            // Oldest insertion
+            return set[SET_POLICY_WORD];
+        case RANDOM: {
+            // xorshift32
+            uint32_t x = cache->random_state;
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            cache->random_state = x;
+            return x & (ways - 1);
+        }
     }
-    return ERR_FAILURE;
+    return 0;
 }
 
 /**
- * @brief Handles cache-related errors with appropriate error messages
+ * @brief Updates the replacement state of a set after a hit
  * 
- * @param error Error status structure containing cache error information
- * @return int ERR_FAILURE after displaying error message
+ * @param cache Pointer to cache structure owning the set
+ * @param set Pointer to the set block
+ * @param way Way that was accessed
  */
-int handle_cache_error(error_status_s error) {
-
-    switch (error.code) {
-
-        /** GENERAL CASES **/
-        default:
-            fprintf(stderr, "Invalid error code: %d\n", error.code);
-            break;
-
-        case ERR_SUCCESS:
-            fprintf(stderr, "ERR_SUCCESS unintentionally passed to handler\n");
-            break;
-
-        /** CACHE ERRORS **/
-        case ERR_CACHE_ALLOCATION_FAILED:
-            fprintf(stderr, 
-                    "Failed to allocate cache "
-                    "{ layer:%d | size:%lu | line_size:%lu }\n",
-                    error.cache.layer, error.cache.size, error.cache.line_size);
-            break;
-        case ERR_CACHE_LINE_ALLOCATION_FAILED:
-            fprintf(stderr, 
-                    "Failed to allocate cache layer:%d\n", 
-                    error.cache.layer);
-            break;
-        case ERR_CACHE_IS_NULL:
-            fprintf(stderr, "Cache is null\n");
-            break;
-        case ERR_CACHE_SIZE_NOT_POWER_OF_TWO:
-            fprintf(stderr, "Cache size is not power of two, "
-                    "size:%lu\n",
-                    error.cache.size);
-            break;
+void touchWay(cache_s* cache, uint32_t* set, unsigned int way) {
+    size_t ways = cache->associativity;
+    if (ways == 1) return;
+
+    if (cache->policy == LRU) {
+        // Age every way younger than the accessed one, then make it the youngest
+        uint8_t* ages = (uint8_t*)&set[SET_HEADER_WORDS + ways];
+        uint8_t age = ages[way];
+        for (size_t w = 0; w < ways; w++) {
+            ages[w] += (ages[w] < age);
+        }
+        ages[way] = 0;
+
+    } else if (cache->policy == PLRU) {
+        // Point every node on the path away from the accessed way
+        uint32_t tree = set[SET_POLICY_WORD];
+        size_t node = way + ways;
+        while (node > 1) {
+            size_t parent = node / 2;
+            uint32_t went_right = (node & 1);
+            tree = (tree & ~(1u << parent)) | ((went_right ^ 1) << parent);
+            node = parent;
+        }
+        set[SET_POLICY_WORD] = tree;
     }
-    return ERR_FAILURE;
 }
 
 /**
- * @brief Handles request-related errors with appropriate error messages
+ * @brief Updates the replacement state of a set after a line is filled
  * 
- * @param error Error status structure containing request error information
- * @return int ERR_FAILURE after displaying error message
+ * @param cache Pointer to cache structure owning the set
+ * @param set Pointer to the set block
+ * @param way Way that was filled
  */
-int handle_request_error(error_status_s error) {
-
-    switch(error.code) {
-
-        /** GENERAL CASES **/
-        default:
-            fprintf(stderr, "Invalid error code: %d\n", error.code);
-            break;
-
-        case ERR_SUCCESS:
-            fprintf(stderr, "ERR_SUCCESS unintentionally passed to handler\n");
-            break;
+void fillWay(cache_s* cache, uint32_t* set, unsigned int way) {
+    if (cache->associativity == 1) return;
 
-        /** REQUEST ERRORS **/
-        case ERR_REQUEST_ALLOCATION_FAILED:
-            fprintf(stderr, "Failed to allocate request\n");
-            break;
-        case ERR_INVALID_REFERENCE_TYPE:
-            fprintf(stderr, "Reference type of \"%c\" is not valid\n",
-                    error.request.ref_type);
-            break;
-        case ERR_INVALID_ACCESS_TYPE:
-            fprintf(stderr, "Access type of \"%c\" is not valid\n",
-                    error.request.access_type);
-            break;
-        case ERR_REQUEST_IS_NULL:
-            fprintf(stderr, "Request is null\n");
-            break;
-        case ERR_REQUEST_ON_NULL_CACHE:
-            fprintf(stderr, "Requested cache is null\n");
-            break;
-        case ERR_REQUEST_INDEX_OUT_OF_BOUNDS:
-            fprintf(stderr, "Requested index out of bounds. (0-Indexed) Index: "
-                    "%d, Number_of_Lines: %ld\n",
-                    error.request.index, error.request.max_cache_index);
-            break;
-        case ERR_FAILED_TO_FORMAT_ADDRESS_HEX:
-            fprintf(stderr, "Failed to format hex address for trace %s\n",
-                    error.request.str_trace);
-            break;
+    // Advance the insertion pointer (ways fill in order, so it always trails the oldest)
+    if (cache->policy == FIFO) {
+        set[SET_POLICY_WORD] = (way + 1) & (cache->associativity - 1);
     }
-    return ERR_FAILURE;
+
+    touchWay(cache, set, way);
 }
 
 /*==================================================================================================
@@ -758,6 +926,10 @@ error_status_s printResults(environment_info_s env) {
     // Print average memory access times;
     printAMAT(env.cache, env.cache_layers);
 
+    // Hierarchy traffic only adds to a single layer's output in the detailed style
+    if (env.cache_layers > 1 || env.print_style == 2)
+        printTraffic(&env);
+
     return status;
 }
 
@@ -793,6 +965,11 @@ error_status_s printCacheStats(cache_s* cache, unsigned int print_style) {
         printf("    Size: %zu bytes\n", cache->cache_size);
         printf("    Line Size: %zu bytes\n", cache->line_size);
         printf("    Line Count: %zu\n", cache->num_lines);
+        if (cache->associativity > 1) { // direct-mapped output is unchanged
+            printf("    Associativity: %zu ways\n", cache->associativity);
+            printf("    Set Count: %zu\n", cache->num_sets);
+            printf("    Replacement Policy: %c\n", cache->policy);
+        }
         printf("Performance Metrics:\n");
         printf("    Total Requests: %zu\n", cache->requests);
         printf("    Hits: %zu\n", cache->hits);
@@ -801,49 +978,162 @@ error_status_s printCacheStats(cache_s* cache, unsigned int print_style) {
         printf("    Miss Rate: %.2f%%\n", ((float)cache->misses / (float)cache->requests) * 100);
         printf("    Read to Write Ratio: %zu\n", cache->read_to_write);
         printf("    Write to Write Ratio: %zu\n", cache->write_to_write);
+        printf("Hierarchy Traffic:\n");
+        printf("    Write-Backs Received: %zu\n", cache->writeback_requests);
+        printf("    Write-Back Hits: %zu\n", cache->writeback_hits);
+        printf("    Back Invalidations: %zu\n", cache->back_invalidations);
+        printf("    Fill Traffic: %zu bytes\n", cache->fill_bytes);
+        printf("    Write-Back Traffic: %zu bytes\n", cache->writeback_bytes);
     }
 
     return status;
 }
 
+/**
+ * @brief Prints simulation results for every sweep configuration as a single table
+ * 
+ * @param envs Array of environment information structures
+ * @param env_count Number of configurations in the array
+ */
+void printSweepResults(environment_info_s* envs, size_t env_count) {
+    printf("------------------------------------------------------------"
+           "------------------------------------------------------------------"
+           "----------------------------\n");
+    printf("%6s | %4s | %8s | %6s | %7s | %7s | %7s | %8s | %6s | %4s | %10s | %8s | %8s | %8s "
+           "| %7s | %10s | %10s\n",
+           "Config", "Type", "Line (B)", "Layers", "L1 (KB)", "L2 (KB)", "L3 (KB)", "Ways",
+           "Policy", "Incl", "Requests", "L1 Miss", "L2 Miss", "L3 Miss", "AMAT", "Mem R (KB)",
+           "Mem W (KB)");
+    printf("------------------------------------------------------------"
+           "------------------------------------------------------------------"
+           "----------------------------\n");
+
+    for (size_t e = 0; e < env_count; e++) {
+        environment_info_s* env = &envs[e];
+        printf("%6zu | %4c | %8zu | %6zu |", (e+1), env->cache_type, env->line_size, 
+               env->cache_layers);
+
+        // Layer sizes (unused layers are left blank)
+        for (unsigned int i = 0; i < 3; i++) {
+            if (i < env->cache_layers) printf(" %7zu |", env->layer_sizes[i] / 1024);
+            else                       printf(" %7s |", "-");
+        }
+
+        // Ways of each layer (e.g 1/4/8)
+        char ways[32] = "";
+        size_t ways_length = 0;
+        for (unsigned int i = 0; i < env->cache_layers; i++) {
+            ways_length += snprintf(ways + ways_length, sizeof(ways) - ways_length, 
+                                    (i == 0) ? "%zu" : "/%zu", env->associativity[i]);
+        }
+        printf(" %8s | %6c | %4c |", ways, env->policy, env->inclusion);
+
+        printf(" %10zu |", env->cache[0]->requests);
+
+        // Layer miss rates
+        for (unsigned int i = 0; i < 3; i++) {
+            if (i < env->cache_layers) {
+                cache_s* cache = env->cache[i];
+                printf(" %7.2f%% |", ((float)cache->misses / (float)cache->requests) * 100);
+            } else {
+                printf(" %8s |", "-");
+            }
+        }
+
+        printf(" %7.2f | %10zu | %10zu\n", computeAMAT(env->cache, env->cache_layers),
+               env->memory_read_bytes / 1024, env->memory_write_bytes / 1024);
+    }
+    printf("------------------------------------------------------------"
+           "------------------------------------------------------------------"
+           "----------------------------\n");
+}
+
 /**
  * @brief Prints Average Memory Access Time (AMAT) for the cache hierarchy
  * 
  * @param cache Array of pointers to cache structures
  * @param layers Number of cache layers
- * @param print_style Print style (1 for concise, 2 for verbose)
  */
 void printAMAT(cache_s** cache, size_t layers) {
+    printf("------------------------------------------------------------\n");
+    printf("AMAT: %.2f\n", computeAMAT(cache, layers));
+    printf("------------------------------------------------------------\n");
+}
+
+/**
+ * @brief Calculates the Average Memory Access Time (AMAT) for the cache hierarchy
+ * 
+ * @param cache Array of pointers to cache structures
+ * @param layers Number of cache layers
+ * @return float Average memory access time
+ */
+float computeAMAT(cache_s** cache, size_t layers) {
 
     // Calculate miss rates
     float miss_rates[3];
     for (unsigned int i = 0; i < layers; i++) {
-        miss_rates[i] = ((float)cache[i]->misses / (float)cache[i]->requests)   ;
+        miss_rates[i] = ((float)cache[i]->misses / (float)cache[i]->requests);
     }
 
-    // Calculate and display average memory access time for each layer
-    printf("------------------------------------------------------------\n");
+    // Calculate average memory access time for the hierarchy
     if (layers == 1) {
-        printf("AMAT: %.2f\n", 
-               (HIT_TIME_L1 + 
-               (miss_rates[0] * MEM_ACCESS_TIME)));
+        return (HIT_TIME_L1 + 
+               (miss_rates[0] * MEM_ACCESS_TIME));
 
     } else if (layers == 2) {
-        printf("AMAT: %.2f\n", 
-               (HIT_TIME_L1 + 
+        return (HIT_TIME_L1 + 
                (miss_rates[0] * (HIT_TIME_L2 +
-               (miss_rates[1] * MEM_ACCESS_TIME)))));
+               (miss_rates[1] * MEM_ACCESS_TIME))));
 
     } else if (layers == 3) {
-        printf("AMAT: %.2f\n", 
-               (HIT_TIME_L1 +
+        return (HIT_TIME_L1 +
                (miss_rates[0] * (HIT_TIME_L2 +
                (miss_rates[1] * HIT_TIME_L3 +
-               (miss_rates[2] * MEM_ACCESS_TIME))))));
+               (miss_rates[2] * MEM_ACCESS_TIME)))));
     }
+    return 0;
+}
+
+/**
+ * @brief Prints the main memory traffic of a hierarchy and the AMAT including write-backs
+ * 
+ * @param env Pointer to the environment holding the cache hierarchy
+ */
+void printTraffic(environment_info_s* env) {
+    const char* inclusion = (env->inclusion == INCLUSIVE) ? "Inclusive" :
+                            (env->inclusion == EXCLUSIVE) ? "Exclusive" : 
+                                                            "Non-Inclusive Non-Exclusive";
+    printf("Inclusion Policy: %s\n", inclusion);
+    printf("Memory Traffic: %zu bytes read | %zu bytes written\n", 
+           env->memory_read_bytes, env->memory_write_bytes);
+    printf("Write-Back Time: %.2f per request\n", computeWriteBackTime(env));
+    printf("AMAT (with write-backs): %.2f\n", 
+           computeAMAT(env->cache, env->cache_layers) + computeWriteBackTime(env));
     printf("------------------------------------------------------------\n");
 }
 
+/**
+ * @brief Calculates the average time per request spent absorbing write-backs
+ * 
+ * Each write-back costs the hit time of the layer receiving it, or the memory access
+ * time once it leaves the last layer.
+ * 
+ * @param env Pointer to the environment holding the cache hierarchy
+ * @return float Average write-back time per request
+ */
+float computeWriteBackTime(environment_info_s* env) {
+    const float hit_times[3] = {HIT_TIME_L1, HIT_TIME_L2, HIT_TIME_L3};
+    if (env->cache[0]->requests == 0)
+        return 0;
+
+    float total_time = ((float)env->memory_write_bytes / env->line_size) * MEM_ACCESS_TIME;
+    for (unsigned int i = 1; i < env->cache_layers; i++) {
+        total_time += env->cache[i]->writeback_requests * hit_times[i];
+    }
+
+    return (total_time / env->cache[0]->requests);
+}
+
 /*==================================================================================================
     Additional Helpers
 ==================================================================================================*/
@@ -14,10 +14,13 @@
 ***************************************************************************************************/
 
 #include <stdlib.h>
+#include <stdint.h>
 #include <stdbool.h>
 
 #include "config.h"
 #include "error.h"
+#include "tagmatch.h"
+#include "trace.h"
 
 /*==================================================================================================
     Cache/Request Structures/Enums
@@ -35,11 +38,34 @@ typedef enum {
 	WRITE = 'W',
 } access_type_e;
 
+typedef enum {
+	LRU = 'L',    // least recently used
+	PLRU = 'P',   // tree pseudo-LRU
+	FIFO = 'F',   // first in first out
+	RANDOM = 'R'
+} replacement_policy_e;
+
+typedef enum {
+	NINE = 'N',       // non-inclusive non-exclusive
+	INCLUSIVE = 'I',  // every line is also held by the layers below
+	EXCLUSIVE = 'E'   // every line is held by at most one layer
+} inclusion_policy_e;
+
 /***************| Cache |***************/
-typedef struct {
-  bool dirty; // represents the dirty bit
-  char tag[INSTRUCTION_SIZE];
-} line_s;
+
+/*
+ * Cache sets are stored as fixed size blocks of 32 bit words, one bit per way in each mask:
+ *
+ *      <valid mask> <dirty mask> <policy state> <reserved> <tag 0> ... <tag ways-1> [<ages>]
+ *
+ * The policy state holds the PLRU tree bits or the FIFO insertion pointer. LRU sets end with
+ * one age byte per way (0 = most recent, ways-1 = least recent), four to a word.
+ */
+#define SET_VALID_WORD 0
+#define SET_DIRTY_WORD 1
+#define SET_POLICY_WORD 2
+#define SET_HEADER_WORDS 4
+#define SET_AGE_WORDS(ways) (((ways) + 3) / 4)
 
 typedef struct {
   // Cache Details
@@ -47,34 +73,67 @@ typedef struct {
   size_t cache_size;    // (bytes)
   size_t line_size;     // (bytes)
   size_t num_lines;     // (lines/block)
-  line_s *lines;
+  size_t associativity; // (lines/set)
+  size_t num_sets;
+  replacement_policy_e policy;
+
+  // Set Storage
+  uint32_t* sets;           // num_sets blocks of set_stride words
+  size_t set_stride;        // (words) power of two
+  uint32_t random_state;
+  tag_match_fn match_tags;  // chosen for the host CPU and set width
 
   // Feild Sizes
   unsigned int tag_size;
   unsigned int index_size;
   unsigned int offset_size;
 
+  // Feild Extraction (precomputed from field sizes)
+  unsigned int tag_shift;      // (offset_size + index_size)
+  unsigned int index_shift;    // (offset_size)
+  unsigned int index_mask;
+  unsigned int offset_mask;
+
   // Recorded Metrics
   size_t requests;
   size_t hits;
   size_t misses;
   size_t read_to_write;     // reads resulting in write-backs
   size_t write_to_write;    // writes resulting in write-backs
+
+  // Hierarchy Metrics
+  size_t writeback_requests;  // write-backs (or exclusive victims) received from the layer above
+  size_t writeback_hits;
+  size_t back_invalidations;  // upper layer lines removed to keep the hierarchy inclusive
+  size_t fill_bytes;          // (bytes) read from the layer below on misses
+  size_t writeback_bytes;     // (bytes) written to the layer below
+
+  // Per-index demand accesses and misses (NULL unless a histogram was requested)
+  uint64_t* index_accesses;
+  uint64_t* index_misses;
 } cache_s;
 
+// Line pushed out of a set by a fill
+typedef struct {
+  bool valid;
+  bool dirty;
+  uint32_t line;  // line address (address >> offset_size)
+} evicted_line_s;
+
 /***************| Request |***************/
 typedef struct { 
   unsigned int hex;
-  char binary[33]; // temp size
-
-  char tag[INSTRUCTION_SIZE+1]; // +1 for null terminator
-  unsigned int tag_size;
 
-  char index[INSTRUCTION_SIZE+1];
-  unsigned int index_size;
+  // Integer fields used by the simulation
+  unsigned int tag;
+  unsigned int index;
+  unsigned int offset;
 
-  char offset[INSTRUCTION_SIZE+1];
-  unsigned int offset_size;
+  // String fields (only populated when DEBUG is enabled)
+  char binary[INSTRUCTION_SIZE+1]; // +1 for null terminator
+  char tag_bits[INSTRUCTION_SIZE+1];
+  char index_bits[INSTRUCTION_SIZE+1];
+  char offset_bits[INSTRUCTION_SIZE+1];
 
 } address_s;
 
@@ -88,13 +147,25 @@ typedef struct {
     Environment Structures
 ==================================================================================================*/
 
+typedef struct stats_writer_s stats_writer_s; // see stats.h
+
 typedef struct {
     cache_s* cache[3];
     size_t cache_layers;
     size_t layer_sizes[3];
     reference_type_e cache_type;
     size_t line_size;
+    size_t associativity[3];
+    replacement_policy_e policy;
+    inclusion_policy_e inclusion;
     unsigned int print_style;
+
+    // Main memory traffic (bytes)
+    size_t memory_read_bytes;
+    size_t memory_write_bytes;
+
+    // Interval statistics writer (NULL unless requested)
+    stats_writer_s* stats;
 } environment_info_s;
 
 /*==================================================================================================
@@ -105,6 +176,13 @@ typedef struct {
 
 error_status_s retrieveParameters(environment_info_s* env_info, int argc, char** argv);
 
+error_status_s retrieveSweepParameters(environment_info_s** envs, size_t* env_count,
+                                       size_t* thread_count, int argc, char** argv);
+
+error_status_s parseConfiguration(environment_info_s* env, char** fields);
+
+error_status_s parseAssociativity(environment_info_s* env, char** fields, size_t field_count);
+
 
 /***************| Cache |***************/
 /**
@@ -120,7 +198,8 @@ error_status_s allocateCache(cache_s** cache, size_t layer, size_t cache_size, s
 
 void destroyCache(cache_s* cache);
 
-error_status_s setupCache(cache_s** cache, size_t layer, size_t cache_size, size_t line_size);
+error_status_s setupCache(cache_s** cache, size_t layer, size_t cache_size, size_t line_size,
+                          size_t associativity, replacement_policy_e policy);
 
 
 /***************| Request |***************/
@@ -129,21 +208,54 @@ error_status_s allocateRequest(request_s** request);
 
 void destroyRequest(request_s* request);
 
-error_status_s formatRequest(request_s* request, cache_s* cache, const char* buffer);
+error_status_s simulateTrace(environment_info_s* envs, size_t env_count, trace_reader_s* reader);
+
+void loadRequest(request_s* request, const trace_ref_s* ref);
+
+error_status_s formatRequestAddressFields(request_s* request, cache_s* cache);
 
-error_status_s formatRequestAddressFields(request_s* request, const char* buffer);
+error_status_s simulateRequest(environment_info_s* env, request_s* request);
 
 error_status_s processRequest(request_s* request, cache_s* cache, bool* hit_occured);
 
 
+/***************| Lines |***************/
+
+int findWay(cache_s* cache, size_t index, uint32_t tag);
+
+void updateWay(cache_s* cache, size_t index, unsigned int way, bool is_write);
+
+unsigned int installLine(cache_s* cache, size_t index, uint32_t tag, bool dirty,
+                         evicted_line_s* evicted);
+
+bool invalidateLine(cache_s* cache, uint32_t line, bool* was_dirty);
+
+
+/***************| Replacement |***************/
+
+unsigned int selectVictim(cache_s* cache, uint32_t* set);
+
+void touchWay(cache_s* cache, uint32_t* set, unsigned int way);
+
+void fillWay(cache_s* cache, uint32_t* set, unsigned int way);
+
+
 /***************| Printing |***************/
 
 error_status_s printResults(environment_info_s env);
 
 error_status_s printCacheStats(cache_s* cache, unsigned int print_style);
 
+void printSweepResults(environment_info_s* envs, size_t env_count);
+
 void printAMAT(cache_s** cache, size_t layers);
 
+float computeAMAT(cache_s** cache, size_t layers);
+
+void printTraffic(environment_info_s* env);
+
+float computeWriteBackTime(environment_info_s* env);
+
 
 /***************| Additional Helpers |***************/
 
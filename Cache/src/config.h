@@ -32,4 +32,39 @@
 #define MAX_OFFSET_SIZE 5
 #define TRACE_SIZE 11
 
+// Sweep mode - runs every configuration in a file over a single pass of the trace
+#define SWEEP_FLAG "-s"
+#define SWEEP_FIELD_COUNT 6
+#define MAX_SWEEP_LINE_SIZE 256
+#define SWEEP_BATCH_SIZE 65536 // decoded requests handed to the sweep workers at once
+#define MAX_SWEEP_THREADS 256
+
+// Decoded requests read at once by a single threaded run
+#define TRACE_BATCH_SIZE 1024
+
+// Set-associativity - optional <L1_ways> <L2_ways> <L3_ways> <policy> arguments
+#define ASSOCIATIVITY_FIELD_COUNT 4
+#define MAX_ASSOCIATIVITY 32        // ways are tracked with 32 bit masks
+#define HOST_CACHE_LINE_SIZE 64     // (bytes) alignment of the simulated set array
+#define RANDOM_POLICY_SEED 2463534242u
+
+// Stack distance mode - LRU miss-ratio curves for every cache size in one pass
+#define STACK_DISTANCE_FLAG "-d"
+#define MAX_STACK_LINE_SIZES 8
+#define STACK_INITIAL_SLOTS 65536   // access slots (and map entries) before the first resize
+#define STACK_HISTOGRAM_BINS 34     // distance 0 plus one bin per significant bit count
+#define STACK_EMPTY_SLOT 0xFFFFFFFFu
+
+// Streamed trace input - compressed traces are decoded on a background thread
+#define TRACE_BLOCK_SIZE (1 << 20)             // (bytes) trace read or decoded at once
+#define TRACE_RING_BLOCKS 4                    // decoded blocks buffered ahead of the reader
+#define TRACE_COMPRESSED_CHUNK_SIZE (1 << 18)  // (bytes) compressed trace read at once
+
+// Run statistics - optional flags of a single run, each followed by a value
+#define INTERVAL_FLAG "-i"          // write interval statistics every N requests
+#define STATS_FORMAT_FLAG "-f"      // csv or json
+#define INTERVAL_OUTPUT_FLAG "-o"   // interval statistics file (defaults to stdout)
+#define HISTOGRAM_FLAG "-m"         // per-index access/miss histogram file
+#define STATS_RING_SAMPLES 256      // samples queued ahead of the background writer
+
 #endif // CONFIG_H
\ No newline at end of file
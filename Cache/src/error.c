@@ -0,0 +1,324 @@
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file error.c
+* @brief Contains functions to report errors encountered during the simulation.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config.h"
+#include "error.h"
+
+/*==================================================================================================
+    Error Handling
+==================================================================================================*/
+
+/**
+ * @brief Top-level error handler that delegates to domain-specific handlers
+ * 
+ * @param error Error status structure containing error information
+ * @return int ERR_FAILURE after displaying error message
+ */
+int handle_error(error_status_s error) {
+    fprintf(stderr, "Error: ");
+
+    switch(error.domain) {
+
+        default:
+            fprintf(stderr, "Invalid error domain: %d\n", error.domain);
+            break;
+
+        case ERROR_NONE:
+            fprintf(stderr, "Error must have domain\n");
+            break;
+        
+        case ERROR_PARAMETER:
+            return handle_param_error(error);
+
+        case ERROR_CACHE:
+            return handle_cache_error(error);
+
+        case ERROR_REQUEST:
+            return handle_request_error(error);
+    }
+    return ERR_FAILURE;
+}
+
+/**
+ * @brief Handles parameter-related errors with appropriate error messages
+ * 
+ * @param error Error status structure containing parameter error information
+ * @return int ERR_FAILURE after displaying error message
+ */
+int handle_param_error(error_status_s error) {
+    
+    switch(error.code) {
+
+        /** GENERAL CASES **/
+        default:
+            fprintf(stderr, "Invalid error code: %d\n", error.code);
+            break;
+
+        case ERR_SUCCESS:
+            fprintf(stderr, "ERR_SUCCESS unintentionally passed to handler\n");
+            break;
+
+        /** PARAMETER ERRORS **/
+        case ERR_INVALID_ARG_COUNT:
+            fprintf(stderr, "Invalid number of arguments. "
+                    "Expected 8, 12 or 13, received %d.\n"
+                    "Usage: %s <cache_type> <line_size> <cache_layers>" 
+                    "<L1_size_B> <L2_size_B> <L3_size_B> <print_style>\n"
+                    "       [<L1_ways> <L2_ways> <L3_ways> <replacement_policy> [<inclusion_policy>]]\n"
+                    "       [" INTERVAL_FLAG " <requests>] [" STATS_FORMAT_FLAG " csv|json] "
+                    "[" INTERVAL_OUTPUT_FLAG " <file>] [" HISTOGRAM_FLAG " <file>]\n"
+                    "       %s " SWEEP_FLAG " <sweep_file> [thread_count]\n"
+                    "       %s " STACK_DISTANCE_FLAG " <cache_type> <line_size> [<line_size> ...]\n",
+                    error.param.arg_count, error.param.executable_name,
+                    error.param.executable_name, error.param.executable_name);
+            break;
+        case ERR_INVALID_CACHE_TYPE:
+            fprintf(stderr, 
+                    "Invalid cache type '%c'.\n", 
+                    error.cache.type);
+            break;
+        case ERR_INVALID_LINE_SIZE:
+            fprintf(stderr, 
+                    "Invalid line size '%zu'.\n", 
+                    error.cache.line_size);
+            break;
+        case ERR_INVALID_CACHE_LAYER_COUNT:
+            fprintf(stderr, 
+                    "Invalid cache layer count '%hu'.\n", 
+                    error.cache.num_layers);
+            break;
+        case ERR_INVALID_CACHE_SIZE:
+            fprintf(stderr, 
+                    "Invalid cache size '%zu' for layer '%u'.\n", 
+                    error.cache.size, error.cache.layer);
+            break;
+        case ERR_INVALID_PRINT_STYLE:
+            fprintf(stderr, 
+                    "Invalid print style '%u'.\n"
+                    "Usage: 1 = standard print | 2 = debug print\n", 
+                    error.param.print_style);
+            break;
+        case ERR_FAILED_TO_OPEN_SWEEP_FILE:
+            fprintf(stderr, 
+                    "Failed to open sweep file '%s'.\n", 
+                    error.param.filename);
+            break;
+        case ERR_INVALID_SWEEP_CONFIG:
+            fprintf(stderr, 
+                    "Invalid sweep configuration, expected %d fields, received %u.\n"
+                    "Format: <cache_type> <line_size> <cache_layers> "
+                    "<L1_size> <L2_size> <L3_size>\n", 
+                    SWEEP_FIELD_COUNT, error.param.arg_count);
+            break;
+        case ERR_EMPTY_SWEEP_FILE:
+            fprintf(stderr, 
+                    "Sweep file '%s' contains no configurations.\n", 
+                    error.param.filename);
+            break;
+        case ERR_SWEEP_ALLOCATION_FAILED:
+            fprintf(stderr, "Failed to allocate sweep configurations\n");
+            break;
+        case ERR_INVALID_THREAD_COUNT:
+            fprintf(stderr, 
+                    "Invalid thread count '%u', expected 1-%d.\n", 
+                    error.param.thread_count, MAX_SWEEP_THREADS);
+            break;
+        case ERR_SWEEP_THREAD_FAILED:
+            fprintf(stderr, "Failed to start sweep worker thread\n");
+            break;
+        case ERR_INVALID_ASSOCIATIVITY:
+            fprintf(stderr, 
+                    "Invalid associativity '%zu' for layer '%u', expected a power of two "
+                    "up to %d ways and no more than the layer's line count.\n", 
+                    error.cache.associativity, error.cache.layer, MAX_ASSOCIATIVITY);
+            break;
+        case ERR_INVALID_REPLACEMENT_POLICY:
+            fprintf(stderr, 
+                    "Invalid replacement policy '%c'.\n"
+                    "Usage: L = LRU | P = pseudo-LRU | F = FIFO | R = random\n", 
+                    error.cache.type);
+            break;
+        case ERR_INVALID_INCLUSION_POLICY:
+            fprintf(stderr, 
+                    "Invalid inclusion policy '%c'.\n"
+                    "Usage: N = non-inclusive non-exclusive | I = inclusive | E = exclusive\n", 
+                    error.cache.type);
+            break;
+        case ERR_MISSING_FLAG_VALUE:
+            fprintf(stderr, "Missing value for flag '%s'.\n", error.param.flag);
+            break;
+        case ERR_INVALID_STATS_INTERVAL:
+            fprintf(stderr, 
+                    "Invalid statistics interval '%s', expected a positive request count.\n", 
+                    error.param.flag);
+            break;
+        case ERR_INVALID_STATS_FORMAT:
+            fprintf(stderr, 
+                    "Invalid statistics format '%s'.\n"
+                    "Usage: csv | json\n", 
+                    error.param.flag);
+            break;
+        case ERR_STATS_MODE_UNSUPPORTED:
+            fprintf(stderr, "Interval statistics and histograms are only supported in a single run\n");
+            break;
+        case ERR_FAILED_TO_OPEN_STATS_FILE:
+            fprintf(stderr, 
+                    "Failed to open statistics file '%s'.\n", 
+                    error.param.filename);
+            break;
+        case ERR_FAILED_TO_WRITE_STATS:
+            fprintf(stderr, 
+                    "Failed to write statistics to '%s'.\n", 
+                    error.param.filename);
+            break;
+        case ERR_STATS_WRITER_FAILED:
+            fprintf(stderr, "Failed to start statistics writer thread\n");
+            break;
+    }
+
+    // Point to the offending configuration when parsing a sweep file
+    if (error.config_line > 0) {
+        fprintf(stderr, "       (sweep file line %u)\n", error.config_line);
+    }
+    return ERR_FAILURE;
+}
+
+/**
+ * @brief Handles cache-related errors with appropriate error messages
+ * 
+ * @param error Error status structure containing cache error information
+ * @return int ERR_FAILURE after displaying error message
+ */
+int handle_cache_error(error_status_s error) {
+
+    switch (error.code) {
+
+        /** GENERAL CASES **/
+        default:
+            fprintf(stderr, "Invalid error code: %d\n", error.code);
+            break;
+
+        case ERR_SUCCESS:
+            fprintf(stderr, "ERR_SUCCESS unintentionally passed to handler\n");
+            break;
+
+        /** CACHE ERRORS **/
+        case ERR_CACHE_ALLOCATION_FAILED:
+            fprintf(stderr, 
+                    "Failed to allocate cache "
+                    "{ layer:%d | size:%lu | line_size:%lu }\n",
+                    error.cache.layer, error.cache.size, error.cache.line_size);
+            break;
+        case ERR_CACHE_LINE_ALLOCATION_FAILED:
+            fprintf(stderr, 
+                    "Failed to allocate cache layer:%d\n", 
+                    error.cache.layer);
+            break;
+        case ERR_CACHE_IS_NULL:
+            fprintf(stderr, "Cache is null\n");
+            break;
+        case ERR_CACHE_SIZE_NOT_POWER_OF_TWO:
+            fprintf(stderr, "Cache size is not power of two, "
+                    "size:%lu\n",
+                    error.cache.size);
+            break;
+        case ERR_STACK_ALLOCATION_FAILED:
+            fprintf(stderr, 
+                    "Failed to allocate stack distance tracker "
+                    "{ line_size:%lu }\n",
+                    error.cache.line_size);
+            break;
+        case ERR_HISTOGRAM_ALLOCATION_FAILED:
+            fprintf(stderr, 
+                    "Failed to allocate index histogram for cache layer:%d\n",
+                    error.cache.layer);
+            break;
+    }
+    return ERR_FAILURE;
+}
+
+/**
+ * @brief Handles request-related errors with appropriate error messages
+ * 
+ * @param error Error status structure containing request error information
+ * @return int ERR_FAILURE after displaying error message
+ */
+int handle_request_error(error_status_s error) {
+
+    switch(error.code) {
+
+        /** GENERAL CASES **/
+        default:
+            fprintf(stderr, "Invalid error code: %d\n", error.code);
+            break;
+
+        case ERR_SUCCESS:
+            fprintf(stderr, "ERR_SUCCESS unintentionally passed to handler\n");
+            break;
+
+        /** REQUEST ERRORS **/
+        case ERR_REQUEST_ALLOCATION_FAILED:
+            fprintf(stderr, "Failed to allocate request\n");
+            break;
+        case ERR_INVALID_REFERENCE_TYPE:
+            fprintf(stderr, "Reference type of \"%c\" is not valid\n",
+                    error.request.ref_type);
+            break;
+        case ERR_INVALID_ACCESS_TYPE:
+            fprintf(stderr, "Access type of \"%c\" is not valid\n",
+                    error.request.access_type);
+            break;
+        case ERR_REQUEST_IS_NULL:
+            fprintf(stderr, "Request is null\n");
+            break;
+        case ERR_REQUEST_ON_NULL_CACHE:
+            fprintf(stderr, "Requested cache is null\n");
+            break;
+        case ERR_REQUEST_INDEX_OUT_OF_BOUNDS:
+            fprintf(stderr, "Requested index out of bounds. (0-Indexed) Index: "
+                    "%d, Number_of_Lines: %ld\n",
+                    error.request.index, error.request.max_cache_index);
+            break;
+        case ERR_FAILED_TO_FORMAT_ADDRESS_HEX:
+            fprintf(stderr, "Failed to format hex address for trace %s\n",
+                    error.request.str_trace);
+            break;
+        case ERR_FAILED_TO_MAP_TRACE:
+            fprintf(stderr, "Failed to map binary trace into memory\n");
+            break;
+        case ERR_INVALID_BINARY_TRACE:
+            fprintf(stderr, "Binary trace has an invalid header or truncated records\n");
+            break;
+        case ERR_TRACE_ALREADY_BINARY:
+            fprintf(stderr, "Trace is already in the binary format\n");
+            break;
+        case ERR_FAILED_TO_WRITE_TRACE:
+            fprintf(stderr, "Failed to write binary trace\n");
+            break;
+        case ERR_FAILED_TO_READ_TRACE:
+            fprintf(stderr, "Failed to read trace\n");
+            break;
+        case ERR_COMPRESSION_NOT_SUPPORTED:
+            fprintf(stderr, "Trace is %s compressed, but %s support was not built in\n",
+                    error.request.format, error.request.format);
+            break;
+        case ERR_FAILED_TO_DECOMPRESS_TRACE:
+            fprintf(stderr, "Compressed trace is corrupt or truncated\n");
+            break;
+        case ERR_TRACE_DECODER_FAILED:
+            fprintf(stderr, "Failed to start the trace decoder\n");
+            break;
+    }
+    return ERR_FAILURE;
+}
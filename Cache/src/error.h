@@ -36,8 +36,11 @@
 // Parameter-related error data
 typedef struct {
     char* executable_name;
+    char* filename;
     unsigned int arg_count;
+    unsigned int thread_count;
     unsigned int print_style;
+    const char* flag;   // flag (or flag value) in error
 } parameter_error_data_s;
 
 // Cache-related error data
@@ -48,6 +51,7 @@ typedef struct {
     size_t size;
     size_t line_size;
     size_t num_lines;
+    size_t associativity;
 } cache_error_data_s;
 
 // Request-related error data
@@ -57,6 +61,7 @@ typedef struct {
     char access_type;
     int index;
     size_t max_cache_index;
+    const char* format;
 } request_error_data_s;
 
 /*==================================================================================================
@@ -86,12 +91,30 @@ typedef enum {
     ERR_INVALID_CACHE_LAYER_COUNT = -103,
     ERR_INVALID_CACHE_SIZE = -104,
     ERR_INVALID_PRINT_STYLE = -105,
+    ERR_FAILED_TO_OPEN_SWEEP_FILE = -106,
+    ERR_INVALID_SWEEP_CONFIG = -107,
+    ERR_EMPTY_SWEEP_FILE = -108,
+    ERR_SWEEP_ALLOCATION_FAILED = -109,
+    ERR_INVALID_THREAD_COUNT = -110,
+    ERR_SWEEP_THREAD_FAILED = -111,
+    ERR_INVALID_ASSOCIATIVITY = -112,
+    ERR_INVALID_REPLACEMENT_POLICY = -113,
+    ERR_INVALID_INCLUSION_POLICY = -114,
+    ERR_MISSING_FLAG_VALUE = -115,
+    ERR_INVALID_STATS_INTERVAL = -116,
+    ERR_INVALID_STATS_FORMAT = -117,
+    ERR_STATS_MODE_UNSUPPORTED = -118,
+    ERR_FAILED_TO_OPEN_STATS_FILE = -119,
+    ERR_FAILED_TO_WRITE_STATS = -120,
+    ERR_STATS_WRITER_FAILED = -121,
     
     // Cache errors (-200 to -299)
     ERR_CACHE_ALLOCATION_FAILED = -200,
     ERR_CACHE_LINE_ALLOCATION_FAILED = -201,
     ERR_CACHE_IS_NULL = -202,
     ERR_CACHE_SIZE_NOT_POWER_OF_TWO = -203,
+    ERR_STACK_ALLOCATION_FAILED = -204,
+    ERR_HISTOGRAM_ALLOCATION_FAILED = -205,
     
     // Request errors (-300 to -399)
     ERR_REQUEST_ALLOCATION_FAILED = -300,
@@ -101,12 +124,21 @@ typedef enum {
     ERR_REQUEST_ON_NULL_CACHE = -304,
     ERR_REQUEST_INDEX_OUT_OF_BOUNDS = -305,
     ERR_FAILED_TO_FORMAT_ADDRESS_HEX = -306,
+    ERR_FAILED_TO_MAP_TRACE = -307,
+    ERR_INVALID_BINARY_TRACE = -308,
+    ERR_TRACE_ALREADY_BINARY = -309,
+    ERR_FAILED_TO_WRITE_TRACE = -310,
+    ERR_FAILED_TO_READ_TRACE = -311,
+    ERR_COMPRESSION_NOT_SUPPORTED = -312,
+    ERR_FAILED_TO_DECOMPRESS_TRACE = -313,
+    ERR_TRACE_DECODER_FAILED = -314,
 } error_code_s;
 
 // Unified error status structure
 typedef struct {
     error_domain_s domain;
     error_code_s code;
+    unsigned int config_line; // sweep file line of the configuration (0 if none)
     
     // Error-specific data
     union {
@@ -0,0 +1,230 @@
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file hierarchy.c
+* @brief Contains functions to move lines between the layers of a cache hierarchy.
+*
+* A demand request probes the layers in order until a layer (or main memory) holds the
+* line, which is then filled into the layers above according to the inclusion policy:
+*
+*       NINE      - the line is filled into every layer that missed.
+*       INCLUSIVE - as NINE, and a line evicted from a lower layer is also removed from
+*                   every layer above it (back-invalidation).
+*       EXCLUSIVE - the line moves into L1 alone, and each layer's victim moves down
+*                   into the layer below.
+*
+* Dirty lines evicted from a layer are written into the layer below it (or main memory),
+* where they may evict further lines. Every transfer is counted so the traffic reaching
+* each layer and main memory can be reported.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cache.h"
+#include "config.h"
+#include "error.h"
+#include "hierarchy.h"
+
+/*==================================================================================================
+    Hierarchy Functions
+==================================================================================================*/
+
+/**
+ * @brief Simulates a demand request through every layer of a hierarchy
+ *
+ * @param env Pointer to the environment holding the cache hierarchy
+ * @param request Pointer to decoded request to simulate
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s accessHierarchy(environment_info_s* env, request_s* request) {
+    error_status_s status = {
+        .domain = ERROR_REQUEST,
+        .code = ERR_SUCCESS
+    };
+
+    bool is_write = (request->access_type == WRITE);
+    size_t layers = env->cache_layers;
+    size_t hit_layer = layers; // main memory
+    int hit_way = -1;
+
+    // Try each cache layer in order until data is found
+    for (size_t i = 0; i < layers; i++) {
+        cache_s* cache = env->cache[i];
+        cache->requests++;
+
+        // Extract the address fields for cache layer
+        status = formatRequestAddressFields(request, cache);
+        if (status.code != ERR_SUCCESS)
+            return status;
+
+        hit_way = findWay(cache, request->address.index, request->address.tag);
+
+        // Per-index histogram, only allocated when requested
+        if (cache->index_accesses != NULL) {
+            cache->index_accesses[request->address.index]++;
+            if (hit_way < 0) cache->index_misses[request->address.index]++;
+        }
+
+        if (hit_way >= 0) {
+            cache->hits++;
+            hit_layer = i;
+            break; // exit loop on cache hit
+        }
+        cache->misses++;
+    }
+
+    // Hits in L1 are served in place
+    if (hit_layer == 0) {
+        updateWay(env->cache[0], request->address.index, hit_way, is_write);
+        return status;
+    }
+
+    // Every layer shares a line size, so the line address is the same in each
+    uint32_t line = request->address.hex >> env->cache[0]->offset_size;
+    bool dirty = is_write;
+
+    // Fetch the line from where it was found
+    if (hit_layer == layers) {
+        env->memory_read_bytes += env->line_size;
+    } else if (env->inclusion == EXCLUSIVE) {
+        bool was_dirty;
+        invalidateLine(env->cache[hit_layer], line, &was_dirty); // line moves up
+        dirty = dirty || was_dirty;
+    } else {
+        updateWay(env->cache[hit_layer], request->address.index, hit_way, false);
+    }
+
+    // Fill the layers above the hit from the bottom up (exclusive fills L1 alone)
+    size_t fill_from = (env->inclusion == EXCLUSIVE) ? 1 : hit_layer;
+    for (size_t i = fill_from; i-- > 0;) {
+        cache_s* cache = env->cache[i];
+        cache->fill_bytes += env->line_size;
+
+        // Writes only modify the copy in L1
+        evicted_line_s evicted;
+        installLine(cache, line & cache->index_mask, line >> cache->index_size,
+                    (i == 0) && dirty, &evicted);
+        evictLine(env, i, &evicted);
+
+        // Record a write-back if the replaced line was modified
+        if (evicted.dirty) {
+            if (is_write) cache->write_to_write++;
+            else          cache->read_to_write++;
+        }
+    }
+
+    return status;
+}
+
+/**
+ * @brief Sends a line replaced in a layer to the layer below as the inclusion policy requires
+ *
+ * @param env Pointer to the environment holding the cache hierarchy
+ * @param layer Layer the line was replaced in (0-indexed)
+ * @param evicted Pointer to the replaced line (dirty is set if upper copies were modified)
+ */
+void evictLine(environment_info_s* env, size_t layer, evicted_line_s* evicted) {
+    if (!evicted->valid) return;
+
+    // Copies above an inclusive layer must leave with the line
+    if (env->inclusion == INCLUSIVE && layer > 0 && backInvalidate(env, layer, evicted->line))
+        evicted->dirty = true;
+
+    if (env->inclusion == EXCLUSIVE) {
+        demoteLine(env, layer + 1, evicted->line, evicted->dirty);
+    } else if (evicted->dirty) {
+        writeBackLine(env, layer + 1, evicted->line);
+    }
+}
+
+/**
+ * @brief Writes a modified line into a layer from the layer above it
+ *
+ * @param env Pointer to the environment holding the cache hierarchy
+ * @param layer Layer receiving the line (0-indexed, cache_layers for main memory)
+ * @param line Line address
+ */
+void writeBackLine(environment_info_s* env, size_t layer, uint32_t line) {
+    env->cache[layer - 1]->writeback_bytes += env->line_size;
+    if (layer == env->cache_layers) {
+        env->memory_write_bytes += env->line_size;
+        return;
+    }
+
+    cache_s* cache = env->cache[layer];
+    size_t index = line & cache->index_mask;
+    uint32_t tag = line >> cache->index_size;
+    cache->writeback_requests++;
+
+    int way = findWay(cache, index, tag);
+    if (way >= 0) {
+        cache->writeback_hits++;
+        updateWay(cache, index, way, true);
+        return;
+    }
+
+    // Write-allocate, the whole line is written so nothing is fetched from below
+    evicted_line_s evicted;
+    installLine(cache, index, tag, true, &evicted);
+    evictLine(env, layer, &evicted);
+}
+
+/**
+ * @brief Moves a victim of an exclusive layer into the layer below it
+ *
+ * @param env Pointer to the environment holding the cache hierarchy
+ * @param layer Layer receiving the line (0-indexed, cache_layers for main memory)
+ * @param line Line address
+ * @param dirty True if the line is modified
+ */
+void demoteLine(environment_info_s* env, size_t layer, uint32_t line, bool dirty) {
+    // Clean lines leaving the last layer are dropped
+    if (layer == env->cache_layers) {
+        if (dirty) writeBackLine(env, layer, line);
+        return;
+    }
+
+    env->cache[layer - 1]->writeback_bytes += env->line_size;
+    cache_s* cache = env->cache[layer];
+    size_t index = line & cache->index_mask;
+    uint32_t tag = line >> cache->index_size;
+    cache->writeback_requests++;
+
+    int way = findWay(cache, index, tag);
+    if (way >= 0) {
+        cache->writeback_hits++;
+        updateWay(cache, index, way, dirty);
+        return;
+    }
+
+    evicted_line_s evicted;
+    installLine(cache, index, tag, dirty, &evicted);
+    evictLine(env, layer, &evicted);
+}
+
+/**
+ * @brief Removes a line from every layer above a layer
+ *
+ * @param env Pointer to the environment holding the cache hierarchy
+ * @param layer Layer the line is leaving (0-indexed)
+ * @param line Line address
+ * @return bool True if any removed copy was modified, false otherwise
+ */
+bool backInvalidate(environment_info_s* env, size_t layer, uint32_t line) {
+    bool any_dirty = false;
+    for (size_t i = 0; i < layer; i++) {
+        bool was_dirty;
+        if (invalidateLine(env->cache[i], line, &was_dirty)) {
+            env->cache[i]->back_invalidations++;
+            any_dirty = any_dirty || was_dirty;
+        }
+    }
+    return any_dirty;
+}
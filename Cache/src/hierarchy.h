@@ -0,0 +1,44 @@
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file hierarchy.h
+* @brief Contains function declarations related to moving lines between the layers of a
+         cache hierarchy.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cache.h"
+#include "config.h"
+#include "error.h"
+
+/*==================================================================================================
+    Hierarchy Function Declarations
+==================================================================================================*/
+
+/**
+ * @brief Simulates a demand request through every layer of a hierarchy
+ *
+ * @param env Pointer to the environment holding the cache hierarchy
+ * @param request Pointer to decoded request to simulate
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s accessHierarchy(environment_info_s* env, request_s* request);
+
+void evictLine(environment_info_s* env, size_t layer, evicted_line_s* evicted);
+
+void writeBackLine(environment_info_s* env, size_t layer, uint32_t line);
+
+void demoteLine(environment_info_s* env, size_t layer, uint32_t line, bool dirty);
+
+bool backInvalidate(environment_info_s* env, size_t layer, uint32_t line);
+
+#endif // HIERARCHY_H
@@ -0,0 +1,205 @@
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file main.c
+* @brief Contains the entry point of the cache simulation.
+*
+*   The process is as follows:
+*       1. Retrieve the configuration(s) from the command-line or a sweep file.
+*       2. Instantiate every cache layer of each configuration.
+*       3. Simulate the trace on stdin against every configuration.
+*       4. Print the results.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <time.h>
+
+#include "cache.h"
+#include "config.h"
+#include "error.h"
+#include "stackdist.h"
+#include "stats.h"
+#include "sweep.h"
+#include "trace.h"
+
+/*==================================================================================================
+    Main
+==================================================================================================*/
+
+/**
+* @brief Main entry point for cache simulation program
+* 
+* @param argc Number of command-line arguments (expected 8, 12 or 13, 3-4 in sweep mode, or
+*             4+ in stack distance mode)
+* @param argv Array of command-line arguments:
+*               - argv[0] Executable name
+*               - argv[1] Cache type (U/I/D)
+*               - argv[2] Line size in words
+*               - argv[3] Number of cache layers (1-3)
+*               - argv[4] L1 size in KB
+*               - argv[5] L2 size in KB
+*               - argv[6] L3 size in KB
+*               - argv[7] Print style (1/2)
+*               - argv[8-10] L1-L3 ways (optional, defaults to direct-mapped)
+*               - argv[11] Replacement policy (L/P/F/R, optional)
+*               - argv[12] Inclusion policy (N/I/E, optional, defaults to NINE)
+*               - Statistics flags (optional, anywhere after argv[0], see retrieveStatsOptions())
+*             Sweep mode:
+*               - argv[1] Sweep flag (-s)
+*               - argv[2] Path to sweep configuration file
+*               - argv[3] Worker thread count (optional, defaults to online cores)
+*             Stack distance mode:
+*               - argv[1] Stack distance flag (-d)
+*               - argv[2] Cache type (U/I/D)
+*               - argv[3...] Line sizes in words (one miss-ratio curve each)
+* @return int 0 on success, -1 on error
+*/
+int main(int argc, char* argv[]) {
+
+    // Set up Timing Elements
+    clock_t start_time, end_time;
+    double elapsed_time;
+    start_time = clock();
+
+    // ========== Retrieve Statistics Flags ==========
+    stats_options_s stats_options;
+    error_status_s stats_status = retrieveStatsOptions(&stats_options, &argc, argv);
+    ERR_CHECK(stats_status);
+
+    // Statistics are only gathered for a single run
+    bool stack_mode = (argc > 1 && strcmp(argv[1], STACK_DISTANCE_FLAG) == 0);
+    bool sweep_mode = (argc > 1 && strcmp(argv[1], SWEEP_FLAG) == 0);
+    if ((stack_mode || sweep_mode) && statsRequested(&stats_options)) {
+        stats_status.code = ERR_STATS_MODE_UNSUPPORTED;
+        ERR_CHECK(stats_status);
+    }
+
+    // ========== Stack Distance Mode ==========
+    if (stack_mode) {
+        // Every cache size is derived from one pass, so no cache layers are simulated
+        stack_distance_s stack;
+        error_status_s stack_status = retrieveStackParameters(&stack, argc, argv);
+        ERR_CHECK(stack_status);
+        stack_status = setupStackDistance(&stack);
+        ERR_CHECK(stack_status);
+
+        trace_reader_s reader;
+        stack_status = openTraceReader(&reader, stdin);
+        ERR_CHECK(stack_status);
+        stack_status = runStackDistance(&stack, &reader);
+        ERR_CHECK(stack_status);
+
+        printMissRatioCurve(&stack);
+        closeTraceReader(&reader);
+        destroyStackDistance(&stack);
+
+        end_time = clock();
+        elapsed_time = (((double)(end_time - start_time)) / CLOCKS_PER_SEC);
+        printf("Total Elapsed Time: %.2f seconds\n", elapsed_time);
+        return EXIT_SUCCESS;
+    }
+
+    // ========== Retreive Command-line Arguments ==========
+    environment_info_s* envs = NULL;
+    size_t env_count = 0;
+    size_t thread_count = 1;
+
+    error_status_s param_status;
+    if (sweep_mode) {
+        param_status = retrieveSweepParameters(&envs, &env_count, &thread_count, argc, argv);
+    } else {
+        envs = (environment_info_s*)malloc(sizeof(environment_info_s));
+        env_count = 1;
+        param_status = retrieveParameters(&envs[0], argc, argv);
+    }
+    ERR_CHECK(param_status);
+
+    // ========== Setup Cache Layers ==========
+    error_status_s cache_setup_status;
+    for (size_t e = 0; e < env_count; e++) {
+        envs[e].memory_read_bytes = 0;
+        envs[e].memory_write_bytes = 0;
+        envs[e].stats = NULL;
+        for (unsigned int i = 0; i < envs[e].cache_layers; i++) {
+            cache_setup_status = setupCache(
+                 &envs[e].cache[i], 
+                 (i+1), 
+            envs[e].layer_sizes[i], 
+             envs[e].line_size,
+         envs[e].associativity[i],
+                envs[e].policy);
+            ERR_CHECK(cache_setup_status);
+        }
+    }
+
+    // ========== Process Requests Until End of File ==========
+    trace_reader_s reader;
+    error_status_s trace_status = openTraceReader(&reader, stdin);
+    ERR_CHECK(trace_status);
+
+    if (sweep_mode) {
+        // Independent configurations are simulated on a pool of worker threads
+        sweep_pool_s pool;
+        error_status_s sweep_status = setupSweepPool(&pool, envs, env_count, thread_count);
+        ERR_CHECK(sweep_status);
+        sweep_status = runSweep(&pool, &reader);
+        ERR_CHECK(sweep_status);
+
+        printSweepResults(envs, env_count);
+        printSweepThroughput(&pool);
+        destroySweepPool(&pool);
+    } else {
+        // Optional interval statistics and per-index histogram
+        stats_writer_s stats_writer;
+        if (stats_options.histogram_path != NULL) {
+            stats_status = setupIndexHistogram(&envs[0]);
+            ERR_CHECK(stats_status);
+        }
+        if (stats_options.interval > 0) {
+            stats_status = startStatsWriter(&stats_writer, &envs[0], &stats_options);
+            ERR_CHECK(stats_status);
+            envs[0].stats = &stats_writer;
+        }
+
+        trace_status = simulateTrace(envs, env_count, &reader);
+        ERR_CHECK(trace_status);
+
+        // Every interval is written before the results are printed
+        if (envs[0].stats != NULL) {
+            stats_status = stopStatsWriter(&stats_writer);
+            ERR_CHECK(stats_status);
+            envs[0].stats = NULL;
+        }
+        if (stats_options.histogram_path != NULL) {
+            stats_status = writeIndexHistogram(&envs[0], &stats_options);
+            ERR_CHECK(stats_status);
+        }
+
+        printResults(envs[0]);
+    }
+
+    // ========== Cleanup ==========
+    closeTraceReader(&reader);
+    for (size_t e = 0; e < env_count; e++) {
+        for (unsigned int i = 0; i < envs[e].cache_layers; i++) {
+            destroyCache(envs[e].cache[i]);
+        }
+    }
+    free(envs);
+
+    // Calculate and print elapsed time
+    end_time = clock();
+    elapsed_time = (((double)(end_time - start_time)) / CLOCKS_PER_SEC);
+    printf("Total Elapsed Time: %.2f seconds\n", elapsed_time);
+
+    // End of program
+    return EXIT_SUCCESS;
+}
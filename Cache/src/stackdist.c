@@ -0,0 +1,405 @@
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file stackdist.c
+* @brief Contains functions to compute LRU stack distances of a trace in a single pass.
+*
+* The stack distance of a reference is the number of distinct lines referenced since the
+* previous reference to the same line. A fully associative LRU cache of C lines hits
+* exactly when that distance is below C, so one histogram of distances gives the miss
+* ratio of every cache size at once (Mattson et al.).
+*
+*   The process is as follows:
+*       1. Each reference is mapped to its line for every requested line size.
+*       2. The line's previous slot is found in a hash map, and the number of live slots
+*          after it is counted in a Fenwick tree (O(log M) for M distinct lines).
+*       3. The distance is binned into a power of two histogram.
+*       4. The histogram is summed into a miss-ratio curve.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <math.h>
+
+#include "cache.h"
+#include "config.h"
+#include "error.h"
+#include "stackdist.h"
+#include "trace.h"
+
+/*==================================================================================================
+    Static Helpers
+==================================================================================================*/
+
+/**
+ * @brief Hashes a line address into a map position
+ *
+ * @param line Line address
+ * @param map_capacity Capacity of the map (power of two)
+ * @return size_t Starting position of the line in the map
+ */
+static inline size_t hashLine(uint32_t line, size_t map_capacity) {
+    return (size_t)((line * 2654435761u) & (map_capacity - 1));
+}
+
+/**
+ * @brief Finds the map entry of a line, or the empty entry it would be inserted at
+ *
+ * @param tracker Pointer to the tracker owning the map
+ * @param line Line address
+ * @return size_t Position of the entry
+ */
+static inline size_t findLine(stack_tracker_s* tracker, uint32_t line) {
+    size_t position = hashLine(line, tracker->map_capacity);
+    while (tracker->map_slots[position] != STACK_EMPTY_SLOT &&
+           tracker->map_lines[position] != line) {
+        position = (position + 1) & (tracker->map_capacity - 1);
+    }
+    return position;
+}
+
+/**
+ * @brief Adds a value to a slot of the Fenwick tree
+ *
+ * @param tracker Pointer to the tracker owning the tree
+ * @param slot Slot to update (0-indexed)
+ * @param value Value to add
+ */
+static inline void addToSlot(stack_tracker_s* tracker, size_t slot, int32_t value) {
+    for (size_t i = slot + 1; i <= tracker->capacity; i += (i & -i)) {
+        tracker->tree[i] += value;
+    }
+}
+
+/**
+ * @brief Counts the live slots up to and including a slot
+ *
+ * @param tracker Pointer to the tracker owning the tree
+ * @param slot Last slot to include (0-indexed)
+ * @return size_t Number of live slots in [0, slot]
+ */
+static inline size_t countToSlot(stack_tracker_s* tracker, size_t slot) {
+    size_t count = 0;
+    for (size_t i = slot + 1; i > 0; i -= (i & -i)) {
+        count += tracker->tree[i];
+    }
+    return count;
+}
+
+/**
+ * @brief Doubles the capacity of the line map
+ *
+ * @param tracker Pointer to the tracker owning the map
+ * @return bool True on success, false if allocation failed
+ */
+static bool growLineMap(stack_tracker_s* tracker) {
+    uint32_t* old_lines = tracker->map_lines;
+    uint32_t* old_slots = tracker->map_slots;
+    size_t old_capacity = tracker->map_capacity;
+
+    tracker->map_capacity *= 2;
+    tracker->map_lines = (uint32_t*)malloc(tracker->map_capacity * sizeof(uint32_t));
+    tracker->map_slots = (uint32_t*)malloc(tracker->map_capacity * sizeof(uint32_t));
+    if (!tracker->map_lines || !tracker->map_slots) {
+        free(old_lines);
+        free(old_slots);
+        return false;
+    }
+    memset(tracker->map_slots, 0xFF, tracker->map_capacity * sizeof(uint32_t));
+
+    // Reinsert every entry
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_slots[i] == STACK_EMPTY_SLOT) continue;
+        size_t position = findLine(tracker, old_lines[i]);
+        tracker->map_lines[position] = old_lines[i];
+        tracker->map_slots[position] = old_slots[i];
+    }
+
+    free(old_lines);
+    free(old_slots);
+    return true;
+}
+
+/**
+ * @brief Moves every live slot to the front (in order), growing the slots if mostly live
+ *
+ * @param tracker Pointer to the tracker to compact
+ * @return bool True on success, false if allocation failed
+ */
+static bool compactSlots(stack_tracker_s* tracker) {
+    // Keep at least half the slots free so compaction stays amortized O(1) per reference
+    if (tracker->distinct_lines * 2 > tracker->capacity) {
+        size_t capacity = tracker->capacity * 2;
+        uint32_t* tree = (uint32_t*)realloc(tracker->tree, (capacity + 1) * sizeof(uint32_t));
+        if (tree == NULL) return false;
+        tracker->tree = tree;
+        uint32_t* slot_lines = (uint32_t*)realloc(tracker->slot_lines, capacity * sizeof(uint32_t));
+        if (slot_lines == NULL) return false;
+        tracker->slot_lines = slot_lines;
+        tracker->capacity = capacity;
+    }
+
+    // Slide live slots down, pointing their lines at the new slots
+    size_t live = 0;
+    for (size_t slot = 0; slot < tracker->next_slot; slot++) {
+        uint32_t line = tracker->slot_lines[slot];
+        if (line == STACK_EMPTY_SLOT) continue;
+        tracker->slot_lines[live] = line;
+        tracker->map_slots[findLine(tracker, line)] = (uint32_t)live;
+        live++;
+    }
+    memset(tracker->slot_lines + live, 0xFF, (tracker->capacity - live) * sizeof(uint32_t));
+    tracker->next_slot = live;
+
+    // Rebuild the tree directly, node i covers slots (i - lowbit(i), i]
+    for (size_t i = 1; i <= tracker->capacity; i++) {
+        size_t first = i - (i & -i);
+        tracker->tree[i] = (live > first) ? (uint32_t)(((live < i) ? live : i) - first) : 0;
+    }
+
+    return true;
+}
+
+/*==================================================================================================
+    Parameter Handling
+==================================================================================================*/
+
+/**
+ * @brief Retrieves and validates the command-line parameters of stack distance mode
+ *
+ * @param stack Pointer to stack distance structure to store the parameters
+ * @param argc Number of command-line arguments
+ * @param argv Array of command-line argument strings in the order:
+ *             <executable> -d <cache_type> <line_size> [<line_size> ...]
+ * @return error_status_s Error status structure with any parameter errors
+ */
+error_status_s retrieveStackParameters(stack_distance_s* stack, int argc, char** argv) {
+    error_status_s param_status = {  // holds error info
+        .domain = ERROR_PARAMETER,
+        .param.executable_name = argv[0]
+    };
+
+    // Check argument count
+    if (argc < 4 || argc > (3 + MAX_STACK_LINE_SIZES)) {
+        param_status.code = ERR_INVALID_ARG_COUNT;
+        param_status.param.arg_count = argc;
+        return param_status;
+    }
+
+    memset(stack, 0, sizeof(*stack));
+    param_status.code = ERR_SUCCESS;
+
+    // Get type of cache reference to be tracked
+    stack->cache_type = (reference_type_e) *argv[2]; // cast the character
+    if (stack->cache_type != UNIFIED &&
+        stack->cache_type != INSTRUCTION &&
+        stack->cache_type != DATA)
+    {
+        param_status.code = ERR_INVALID_CACHE_TYPE;
+        param_status.cache.type = stack->cache_type;
+        return param_status;
+    }
+
+    // Get every line size to track (words), lines are addressed by shifting
+    stack->tracker_count = (argc - 3);
+    for (size_t t = 0; t < stack->tracker_count; t++) {
+        stack->trackers[t].line_size = (atoi(argv[t+3]) * 4); // convert words to bytes
+        if (stack->trackers[t].line_size < 4 || !isPowerOfTwo(stack->trackers[t].line_size)) {
+            param_status.code = ERR_INVALID_LINE_SIZE;
+            param_status.cache.line_size = stack->trackers[t].line_size;
+            return param_status;
+        }
+    }
+
+    return param_status;
+}
+
+/*==================================================================================================
+    Stack Distance Functions
+==================================================================================================*/
+
+/**
+ * @brief Allocates the slots and line map of every tracker
+ *
+ * @param stack Pointer to stack distance structure with its line sizes set
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s setupStackDistance(stack_distance_s* stack) {
+    error_status_s status = {
+        .domain = ERROR_CACHE,
+        .code = ERR_SUCCESS
+    };
+
+    for (size_t t = 0; t < stack->tracker_count; t++) {
+        stack_tracker_s* tracker = &stack->trackers[t];
+        tracker->offset_size = (unsigned int)log2(tracker->line_size);
+        tracker->capacity = STACK_INITIAL_SLOTS;
+        tracker->map_capacity = STACK_INITIAL_SLOTS;
+        tracker->tree = (uint32_t*)calloc(tracker->capacity + 1, sizeof(uint32_t));
+        tracker->slot_lines = (uint32_t*)malloc(tracker->capacity * sizeof(uint32_t));
+        tracker->map_lines = (uint32_t*)malloc(tracker->map_capacity * sizeof(uint32_t));
+        tracker->map_slots = (uint32_t*)malloc(tracker->map_capacity * sizeof(uint32_t));
+        if (!tracker->tree || !tracker->slot_lines || !tracker->map_lines || !tracker->map_slots) {
+            status.code = ERR_STACK_ALLOCATION_FAILED;
+            status.cache.line_size = tracker->line_size;
+            return status;
+        }
+        memset(tracker->slot_lines, 0xFF, tracker->capacity * sizeof(uint32_t));
+        memset(tracker->map_slots, 0xFF, tracker->map_capacity * sizeof(uint32_t));
+    }
+
+    return status;
+}
+
+/**
+ * @brief Frees memory allocated for every tracker
+ *
+ * @param stack Pointer to the stack distance structure to destroy
+ */
+void destroyStackDistance(stack_distance_s* stack) {
+    for (size_t t = 0; t < stack->tracker_count; t++) {
+        free(stack->trackers[t].tree);
+        free(stack->trackers[t].slot_lines);
+        free(stack->trackers[t].map_lines);
+        free(stack->trackers[t].map_slots);
+    }
+}
+
+/**
+ * @brief Records the stack distance of every reference in a trace
+ *
+ * @param stack Pointer to an initialized stack distance structure
+ * @param reader Pointer to an open trace reader
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s runStackDistance(stack_distance_s* stack, trace_reader_s* reader) {
+    error_status_s status;
+    trace_ref_s batch[TRACE_BATCH_SIZE];
+    size_t batch_count;
+
+    while ((status = readTraceBatch(reader, batch, TRACE_BATCH_SIZE, &batch_count)).code
+                == ERR_SUCCESS && batch_count > 0) {
+        for (size_t r = 0; r < batch_count; r++) {
+            // Skip request for irrelevant cache types
+            if (stack->cache_type != UNIFIED && batch[r].ref_type != stack->cache_type)
+                continue;
+
+            for (size_t t = 0; t < stack->tracker_count; t++) {
+                status = recordStackReference(&stack->trackers[t], batch[r].hex);
+                if (status.code != ERR_SUCCESS)
+                    return status;
+            }
+        }
+    }
+
+    return status;
+}
+
+/**
+ * @brief Records the stack distance of a single reference
+ *
+ * @param tracker Pointer to the tracker of one line size
+ * @param hex Referenced address
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s recordStackReference(stack_tracker_s* tracker, uint32_t hex) {
+    error_status_s status = {
+        .domain = ERROR_CACHE,
+        .code = ERR_SUCCESS
+    };
+
+    uint32_t line = hex >> tracker->offset_size;
+    size_t position = findLine(tracker, line);
+    bool cold_miss = (tracker->map_slots[position] == STACK_EMPTY_SLOT);
+    tracker->requests++;
+
+    if (!cold_miss) {
+        // Every live slot is before next_slot, so the lines referenced since are the
+        // live slots after the previous one
+        size_t slot = tracker->map_slots[position];
+        size_t distance = tracker->distinct_lines - countToSlot(tracker, slot);
+        tracker->histogram[(distance == 0) ? 0 : (64 - __builtin_clzll(distance))]++;
+
+        addToSlot(tracker, slot, -1);
+        tracker->slot_lines[slot] = STACK_EMPTY_SLOT;
+    } else {
+        tracker->distinct_lines++;
+    }
+
+    // Make room for the new slot and map entry (neither touches the line's own entry)
+    if (tracker->next_slot == tracker->capacity && !compactSlots(tracker)) {
+        status.code = ERR_STACK_ALLOCATION_FAILED;
+        status.cache.line_size = tracker->line_size;
+        return status;
+    }
+    if (cold_miss && (tracker->distinct_lines * 2) > tracker->map_capacity) {
+        if (!growLineMap(tracker)) {
+            status.code = ERR_STACK_ALLOCATION_FAILED;
+            status.cache.line_size = tracker->line_size;
+            return status;
+        }
+        position = findLine(tracker, line);
+    }
+
+    // Move the line to a new slot at the top of the stack
+    size_t slot = tracker->next_slot++;
+    tracker->slot_lines[slot] = line;
+    tracker->map_lines[position] = line;
+    tracker->map_slots[position] = (uint32_t)slot;
+    addToSlot(tracker, slot, 1);
+
+    return status;
+}
+
+/*==================================================================================================
+    Print Functions
+==================================================================================================*/
+
+/**
+ * @brief Prints the miss-ratio curve of every tracked line size
+ *
+ * Sizes double from 1KB (or one line) until every distinct line fits, after which only
+ * cold misses remain.
+ *
+ * @param stack Pointer to the stack distance structure containing tracker metrics
+ */
+void printMissRatioCurve(stack_distance_s* stack) {
+    for (size_t t = 0; t < stack->tracker_count; t++) {
+        stack_tracker_s* tracker = &stack->trackers[t];
+
+        printf("------------------------------------------------------------\n");
+        printf("Line Size: %zu bytes | Requests: %zu | Distinct Lines: %zu\n",
+               tracker->line_size, tracker->requests, tracker->distinct_lines);
+        printf("------------------------------------------------------------\n");
+        printf("%10s | %10s | %12s | %9s\n", "Size (KB)", "Lines", "Misses", "Miss Rate");
+        printf("------------------------------------------------------------\n");
+
+        size_t size = (tracker->line_size > 1024) ? tracker->line_size : 1024;
+        while (true) {
+            // A cache of 2^k lines misses on cold references and distances of at least 2^k,
+            // which are exactly the bins above k
+            size_t lines = size / tracker->line_size;
+            size_t bin = (size_t)__builtin_ctzll(lines) + 1;
+            size_t misses = tracker->distinct_lines;
+            for (size_t b = bin; b < STACK_HISTOGRAM_BINS; b++) {
+                misses += tracker->histogram[b];
+            }
+
+            float miss_rate = (tracker->requests > 0) ?
+                              ((float)misses / (float)tracker->requests) * 100 : 0;
+            printf("%10.2f | %10zu | %12zu | %8.2f%%\n", size / 1024.0, lines, misses, miss_rate);
+
+            if (lines >= tracker->distinct_lines) break;
+            size *= 2;
+        }
+    }
+    printf("------------------------------------------------------------\n");
+}
@@ -0,0 +1,88 @@
+#ifndef STACKDIST_H
+#define STACKDIST_H
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file stackdist.h
+* @brief Contains structures and function declarations related to computing LRU stack
+         distances and miss-ratio curves.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "cache.h"
+#include "config.h"
+#include "error.h"
+#include "trace.h"
+
+/*==================================================================================================
+    Stack Distance Structures
+==================================================================================================*/
+
+/***************| Tracker |***************/
+
+/*
+ * Every reference is given a slot in access order. A Fenwick tree holds a 1 in the slot of
+ * each line's latest reference, so the stack distance of a reuse is the number of set slots
+ * after the line's previous slot. Once every slot is used, the live slots are compacted to
+ * the front, keeping the tree proportional to the number of distinct lines.
+ */
+typedef struct {
+    size_t line_size;           // (bytes)
+    unsigned int offset_size;
+
+    // Access slots
+    uint32_t* tree;             // Fenwick tree (1-indexed) of live slots
+    uint32_t* slot_lines;       // line held by each slot (STACK_EMPTY_SLOT once superseded)
+    size_t capacity;
+    size_t next_slot;
+
+    // Line address -> latest slot (open addressing)
+    uint32_t* map_lines;
+    uint32_t* map_slots;        // STACK_EMPTY_SLOT marks an unused entry
+    size_t map_capacity;        // power of two
+
+    // Recorded Metrics
+    size_t requests;
+    size_t distinct_lines;      // also the number of cold misses
+    size_t histogram[STACK_HISTOGRAM_BINS]; // bin b holds distances with b significant bits
+} stack_tracker_s;
+
+/***************| Stack Distance |***************/
+typedef struct {
+    reference_type_e cache_type;
+    stack_tracker_s trackers[MAX_STACK_LINE_SIZES]; // one per line size
+    size_t tracker_count;
+} stack_distance_s;
+
+/*==================================================================================================
+    Stack Distance Function Declarations
+==================================================================================================*/
+
+/**
+ * @brief Retrieves and validates the command-line parameters of stack distance mode
+ *
+ * @param stack Pointer to stack distance structure to store the parameters
+ * @param argc Number of command-line arguments
+ * @param argv Array of command-line argument strings
+ * @return error_status_s Error status structure with any parameter errors
+ */
+error_status_s retrieveStackParameters(stack_distance_s* stack, int argc, char** argv);
+
+error_status_s setupStackDistance(stack_distance_s* stack);
+
+void destroyStackDistance(stack_distance_s* stack);
+
+error_status_s runStackDistance(stack_distance_s* stack, trace_reader_s* reader);
+
+error_status_s recordStackReference(stack_tracker_s* tracker, uint32_t hex);
+
+void printMissRatioCurve(stack_distance_s* stack);
+
+#endif // STACKDIST_H
@@ -0,0 +1,421 @@
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file stats.c
+* @brief Contains functions to report interval statistics and per-index histograms of a run.
+*
+* Interval statistics show how the hits, misses and write-backs of each layer change
+* over the trace, which exposes program phases. The simulation thread only copies the
+* cumulative counters of every layer into a ring every N requests, and a background
+* writer thread turns consecutive samples into per-interval CSV rows or JSON lines.
+*
+* The per-index histogram counts the demand accesses and misses of every set in each
+* layer, which exposes conflict-heavy sets. It is written once the run is complete.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <inttypes.h>
+
+#include <pthread.h>
+
+#include "cache.h"
+#include "config.h"
+#include "error.h"
+#include "stats.h"
+
+/*==================================================================================================
+    Static Helpers
+==================================================================================================*/
+
+/**
+ * @brief Writes the change between two samples as the statistics of one interval
+ *
+ * @param stats Pointer to the writer owning the stream
+ * @param sample Pointer to the sample ending the interval
+ */
+static void writeIntervalSample(stats_writer_s* stats, const interval_sample_s* sample) {
+    const interval_sample_s* previous = &stats->previous;
+    size_t interval = ++stats->intervals_written;
+    size_t layers = stats->env->cache_layers;
+    int result = 0;
+
+    if (stats->options.format == STATS_JSON) {
+        result |= fprintf(stats->stream, "{\"interval\":%zu,\"request\":%zu,\"layers\":[",
+                          interval, sample->request);
+    }
+
+    for (size_t i = 0; i < layers; i++) {
+        size_t requests = sample->requests[i] - previous->requests[i];
+        size_t hits = sample->hits[i] - previous->hits[i];
+        size_t misses = sample->misses[i] - previous->misses[i];
+        size_t write_backs = sample->write_backs[i] - previous->write_backs[i];
+        double miss_rate = (requests > 0) ? ((double)misses / requests) : 0.0;
+
+        if (stats->options.format == STATS_JSON) {
+            result |= fprintf(stats->stream,
+                              "%s{\"layer\":%zu,\"requests\":%zu,\"hits\":%zu,\"misses\":%zu,"
+                              "\"miss_rate\":%.6f,\"write_backs\":%zu}",
+                              (i > 0) ? "," : "", (i + 1), requests, hits, misses,
+                              miss_rate, write_backs);
+        } else {
+            result |= fprintf(stats->stream, "%zu,%zu,L%zu,%zu,%zu,%zu,%.6f,%zu\n",
+                              interval, sample->request, (i + 1), requests, hits, misses,
+                              miss_rate, write_backs);
+        }
+    }
+
+    if (stats->options.format == STATS_JSON)
+        result |= fprintf(stats->stream, "]}\n");
+
+    if (result < 0) stats->write_failed = true;
+    stats->previous = *sample;
+}
+
+/**
+ * @brief Writes queued samples until the simulation stops the writer
+ *
+ * @param arg Pointer to the writer structure
+ * @return void* Always NULL, write failures are stored in the writer
+ */
+static void* statsWriterThread(void* arg) {
+    stats_writer_s* stats = (stats_writer_s*)arg;
+
+    if (stats->options.format == STATS_CSV) {
+        if (fprintf(stats->stream, "interval,request,layer,requests,hits,misses,"
+                                   "miss_rate,write_backs\n") < 0)
+            stats->write_failed = true;
+    }
+
+    pthread_mutex_lock(&stats->lock);
+    while (true) {
+        while (stats->count == 0 && !stats->stopping) {
+            pthread_cond_wait(&stats->not_empty, &stats->lock);
+        }
+        if (stats->count == 0) break; // stopping with nothing left to write
+
+        // Format outside the lock so the simulation never waits on I/O
+        interval_sample_s sample = stats->samples[stats->tail];
+        stats->tail = (stats->tail + 1) % STATS_RING_SAMPLES;
+        stats->count--;
+        pthread_cond_signal(&stats->not_full);
+        pthread_mutex_unlock(&stats->lock);
+
+        writeIntervalSample(stats, &sample);
+
+        pthread_mutex_lock(&stats->lock);
+    }
+    pthread_mutex_unlock(&stats->lock);
+
+    if (fflush(stats->stream) != 0) stats->write_failed = true;
+    return NULL;
+}
+
+/**
+ * @brief Retrieves the value following a statistics flag
+ *
+ * @param status Pointer to the status to fill if the value is missing
+ * @param argc Number of command-line arguments
+ * @param argv Array of command-line arguments
+ * @param a Index of the flag
+ * @return char* Value of the flag, or NULL if it is missing
+ */
+static char* retrieveFlagValue(error_status_s* status, int argc, char** argv, int a) {
+    if (a + 1 >= argc) {
+        status->code = ERR_MISSING_FLAG_VALUE;
+        status->param.flag = argv[a];
+        return NULL;
+    }
+    return argv[a + 1];
+}
+
+/*==================================================================================================
+    Option Functions
+==================================================================================================*/
+
+/**
+ * @brief Retrieves the statistics flags and removes them from the argument list
+ *
+ * Supported flags (each followed by a value, anywhere after the executable name):
+ *      -i <requests>  - write interval statistics every N requests
+ *      -f <csv|json>  - format of the interval statistics and histogram (defaults to csv)
+ *      -o <path>      - file to write interval statistics to (defaults to stdout)
+ *      -m <path>      - file to write the per-index access/miss histogram to
+ *
+ * @param options Pointer to options structure to populate
+ * @param argc Pointer to the number of command-line arguments (updated)
+ * @param argv Array of command-line arguments (statistics flags are removed)
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s retrieveStatsOptions(stats_options_s* options, int* argc, char** argv) {
+    error_status_s status = {
+        .domain = ERROR_PARAMETER,
+        .code = ERR_SUCCESS,
+        .param.executable_name = argv[0]
+    };
+
+    options->interval = 0;
+    options->format = STATS_CSV;
+    options->interval_path = NULL;
+    options->histogram_path = NULL;
+
+    int kept = 1;
+    for (int a = 1; a < *argc; a++) {
+        bool is_interval = (strcmp(argv[a], INTERVAL_FLAG) == 0);
+        bool is_format = (strcmp(argv[a], STATS_FORMAT_FLAG) == 0);
+        bool is_output = (strcmp(argv[a], INTERVAL_OUTPUT_FLAG) == 0);
+        bool is_histogram = (strcmp(argv[a], HISTOGRAM_FLAG) == 0);
+
+        // Keep every argument that is not a statistics flag
+        if (!is_interval && !is_format && !is_output && !is_histogram) {
+            argv[kept++] = argv[a];
+            continue;
+        }
+
+        char* value = retrieveFlagValue(&status, *argc, argv, a);
+        if (value == NULL)
+            return status;
+        a++;
+
+        if (is_interval) {
+            char* end;
+            long long interval = strtoll(value, &end, 10);
+            if (*end != '\0' || interval <= 0) {
+                status.code = ERR_INVALID_STATS_INTERVAL;
+                status.param.flag = value;
+                return status;
+            }
+            options->interval = (size_t)interval;
+        } else if (is_format) {
+            if (strcmp(value, "csv") == 0) {
+                options->format = STATS_CSV;
+            } else if (strcmp(value, "json") == 0) {
+                options->format = STATS_JSON;
+            } else {
+                status.code = ERR_INVALID_STATS_FORMAT;
+                status.param.flag = value;
+                return status;
+            }
+        } else if (is_output) {
+            options->interval_path = value;
+        } else {
+            options->histogram_path = value;
+        }
+    }
+
+    *argc = kept;
+    argv[kept] = NULL;
+    return status;
+}
+
+/**
+ * @brief Checks if any statistics output was requested
+ *
+ * @param options Pointer to the retrieved options
+ * @return bool True if interval statistics or a histogram were requested
+ */
+bool statsRequested(const stats_options_s* options) {
+    return (options->interval > 0 || options->histogram_path != NULL);
+}
+
+/*==================================================================================================
+    Interval Writer Functions
+==================================================================================================*/
+
+/**
+ * @brief Opens the interval statistics stream and starts the writer thread
+ *
+ * @param stats Pointer to writer structure to initialize
+ * @param env Pointer to the environment whose counters are sampled
+ * @param options Pointer to the retrieved options (interval must be non-zero)
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s startStatsWriter(stats_writer_s* stats, environment_info_s* env,
+                                const stats_options_s* options) {
+    error_status_s status = {
+        .domain = ERROR_PARAMETER,
+        .code = ERR_SUCCESS
+    };
+
+    memset(stats, 0, sizeof(*stats));
+    stats->options = *options;
+    stats->env = env;
+    stats->countdown = options->interval;
+
+    stats->stream = stdout;
+    if (options->interval_path != NULL) {
+        stats->stream = fopen(options->interval_path, "w");
+        if (stats->stream == NULL) {
+            status.code = ERR_FAILED_TO_OPEN_STATS_FILE;
+            status.param.filename = (char*)options->interval_path;
+            return status;
+        }
+    }
+
+    pthread_mutex_init(&stats->lock, NULL);
+    pthread_cond_init(&stats->not_empty, NULL);
+    pthread_cond_init(&stats->not_full, NULL);
+    if (pthread_create(&stats->thread, NULL, statsWriterThread, stats) != 0) {
+        status.code = ERR_STATS_WRITER_FAILED;
+        return status;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Ends the current interval by queueing the counters of every layer
+ *
+ * Called by the simulation thread once the countdown reaches zero.
+ *
+ * @param stats Pointer to a running writer
+ */
+void publishIntervalSample(stats_writer_s* stats) {
+    environment_info_s* env = stats->env;
+    stats->requests += (stats->options.interval - stats->countdown);
+    stats->countdown = stats->options.interval;
+
+    pthread_mutex_lock(&stats->lock);
+    while (stats->count == STATS_RING_SAMPLES) {
+        pthread_cond_wait(&stats->not_full, &stats->lock);
+    }
+    interval_sample_s* sample = &stats->samples[stats->head];
+    pthread_mutex_unlock(&stats->lock);
+
+    // The sample at head is owned by the simulation until it is published
+    sample->request = stats->requests;
+    for (size_t i = 0; i < env->cache_layers; i++) {
+        cache_s* cache = env->cache[i];
+        sample->requests[i] = cache->requests;
+        sample->hits[i] = cache->hits;
+        sample->misses[i] = cache->misses;
+        sample->write_backs[i] = cache->read_to_write + cache->write_to_write;
+    }
+
+    pthread_mutex_lock(&stats->lock);
+    stats->head = (stats->head + 1) % STATS_RING_SAMPLES;
+    stats->count++;
+    pthread_cond_signal(&stats->not_empty);
+    pthread_mutex_unlock(&stats->lock);
+}
+
+/**
+ * @brief Queues the final partial interval, then waits for the writer to finish
+ *
+ * @param stats Pointer to a running writer
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s stopStatsWriter(stats_writer_s* stats) {
+    error_status_s status = {
+        .domain = ERROR_PARAMETER,
+        .code = ERR_SUCCESS
+    };
+
+    if (stats->countdown != stats->options.interval)
+        publishIntervalSample(stats);
+
+    pthread_mutex_lock(&stats->lock);
+    stats->stopping = true;
+    pthread_cond_signal(&stats->not_empty);
+    pthread_mutex_unlock(&stats->lock);
+    pthread_join(stats->thread, NULL);
+
+    pthread_mutex_destroy(&stats->lock);
+    pthread_cond_destroy(&stats->not_empty);
+    pthread_cond_destroy(&stats->not_full);
+
+    if (stats->stream != stdout && fclose(stats->stream) != 0)
+        stats->write_failed = true;
+    if (stats->write_failed) {
+        status.code = ERR_FAILED_TO_WRITE_STATS;
+        status.param.filename = (char*)((stats->options.interval_path != NULL) ?
+                                        stats->options.interval_path : "stdout");
+    }
+
+    return status;
+}
+
+/*==================================================================================================
+    Index Histogram Functions
+==================================================================================================*/
+
+/**
+ * @brief Allocates the per-index access and miss counters of every layer
+ *
+ * @param env Pointer to the environment holding the cache hierarchy
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s setupIndexHistogram(environment_info_s* env) {
+    error_status_s status = {
+        .domain = ERROR_CACHE,
+        .code = ERR_SUCCESS
+    };
+
+    for (size_t i = 0; i < env->cache_layers; i++) {
+        cache_s* cache = env->cache[i];
+        cache->index_accesses = (uint64_t*)calloc(cache->num_sets, sizeof(uint64_t));
+        cache->index_misses = (uint64_t*)calloc(cache->num_sets, sizeof(uint64_t));
+        if (cache->index_accesses == NULL || cache->index_misses == NULL) {
+            status.code = ERR_HISTOGRAM_ALLOCATION_FAILED;
+            status.cache.layer = (i + 1);
+            return status;
+        }
+    }
+
+    return status;
+}
+
+/**
+ * @brief Writes the per-index access and miss counters of every layer
+ *
+ * @param env Pointer to the environment holding the cache hierarchy
+ * @param options Pointer to the retrieved options (histogram_path must be set)
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s writeIndexHistogram(environment_info_s* env, const stats_options_s* options) {
+    error_status_s status = {
+        .domain = ERROR_PARAMETER,
+        .code = ERR_SUCCESS,
+        .param.filename = (char*)options->histogram_path
+    };
+
+    FILE* stream = fopen(options->histogram_path, "w");
+    if (stream == NULL) {
+        status.code = ERR_FAILED_TO_OPEN_STATS_FILE;
+        return status;
+    }
+
+    int result = 0;
+    if (options->format == STATS_CSV)
+        result |= fprintf(stream, "layer,index,accesses,misses,miss_rate\n");
+
+    for (size_t i = 0; i < env->cache_layers; i++) {
+        cache_s* cache = env->cache[i];
+        for (size_t index = 0; index < cache->num_sets; index++) {
+            uint64_t accesses = cache->index_accesses[index];
+            uint64_t misses = cache->index_misses[index];
+            double miss_rate = (accesses > 0) ? ((double)misses / accesses) : 0.0;
+
+            if (options->format == STATS_JSON) {
+                result |= fprintf(stream, "{\"layer\":%zu,\"index\":%zu,\"accesses\":%" PRIu64 ","
+                                  "\"misses\":%" PRIu64 ",\"miss_rate\":%.6f}\n",
+                                  (i + 1), index, accesses, misses, miss_rate);
+            } else {
+                result |= fprintf(stream, "L%zu,%zu,%" PRIu64 ",%" PRIu64 ",%.6f\n",
+                                  (i + 1), index, accesses, misses, miss_rate);
+            }
+        }
+    }
+
+    if (fclose(stream) != 0 || result < 0)
+        status.code = ERR_FAILED_TO_WRITE_STATS;
+
+    return status;
+}
@@ -0,0 +1,119 @@
+#ifndef STATS_H
+#define STATS_H
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file stats.h
+* @brief Contains structures and function declarations related to interval statistics and
+         per-index histograms of a single run.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "cache.h"
+#include "config.h"
+#include "error.h"
+
+/*==================================================================================================
+    Stats Structures
+==================================================================================================*/
+
+typedef enum {
+    STATS_CSV,
+    STATS_JSON
+} stats_format_e;
+
+/***************| Options |***************/
+typedef struct {
+    size_t interval;                // requests between samples (0 disables interval stats)
+    stats_format_e format;
+    const char* interval_path;      // NULL for stdout
+    const char* histogram_path;     // NULL disables the per-index histogram
+} stats_options_s;
+
+/***************| Sample |***************/
+// Cumulative counters of every layer at the end of an interval
+typedef struct {
+    size_t request;                 // trace references read so far
+    size_t requests[3];
+    size_t hits[3];
+    size_t misses[3];
+    size_t write_backs[3];
+} interval_sample_s;
+
+/***************| Writer |***************/
+/*
+ * The simulation copies counters into the sample at head, while the writer thread
+ * formats the sample at tail, so no formatting or I/O happens on the simulation thread.
+ */
+struct stats_writer_s {
+    stats_options_s options;
+    environment_info_s* env;
+    FILE* stream;
+    pthread_t thread;
+
+    // Hot path state (simulation thread only)
+    size_t countdown;               // requests left in the current interval
+    size_t requests;                // trace references read so far
+
+    // Ring of samples waiting to be written
+    interval_sample_s samples[STATS_RING_SAMPLES];
+    size_t head;                    // next sample to fill
+    size_t tail;                    // next sample to write
+    size_t count;                   // filled samples
+
+    // Synchronization between the simulation and the writer
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    bool stopping;
+
+    // Writer state (writer thread only)
+    interval_sample_s previous;
+    size_t intervals_written;
+    bool write_failed;
+};
+
+/*==================================================================================================
+    Stats Function Declarations
+==================================================================================================*/
+
+/***************| Options |***************/
+
+/**
+ * @brief Retrieves the statistics flags and removes them from the argument list
+ *
+ * @param options Pointer to options structure to populate
+ * @param argc Pointer to the number of command-line arguments (updated)
+ * @param argv Array of command-line arguments (statistics flags are removed)
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s retrieveStatsOptions(stats_options_s* options, int* argc, char** argv);
+
+bool statsRequested(const stats_options_s* options);
+
+
+/***************| Interval Writer |***************/
+
+error_status_s startStatsWriter(stats_writer_s* stats, environment_info_s* env,
+                                const stats_options_s* options);
+
+void publishIntervalSample(stats_writer_s* stats);
+
+error_status_s stopStatsWriter(stats_writer_s* stats);
+
+
+/***************| Index Histogram |***************/
+
+error_status_s setupIndexHistogram(environment_info_s* env);
+
+error_status_s writeIndexHistogram(environment_info_s* env, const stats_options_s* options);
+
+#endif // STATS_H
@@ -0,0 +1,256 @@
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file sweep.c
+* @brief Contains functions to simulate sweep configurations on a pool of worker threads.
+*
+* Every configuration in a sweep owns its own cache hierarchy, so configurations can be
+* simulated independently. The configurations are split into contiguous shards, one per
+* worker thread.
+*
+*   The process is as follows:
+*       1. The main thread decodes a batch of requests from stdin.
+*       2. The batch is published to every worker as shared read-only data.
+*       3. Each worker simulates the batch against every configuration in its shard,
+*          while the main thread decodes the next batch into the second buffer.
+*       4. Once every worker is done the buffers are swapped and the process repeats
+*          until the end of the trace.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <time.h>
+#include <pthread.h>
+
+#include "cache.h"
+#include "config.h"
+#include "error.h"
+#include "sweep.h"
+#include "trace.h"
+
+/*==================================================================================================
+    Static Helpers
+==================================================================================================*/
+
+/**
+ * @brief Retrieves the current monotonic time in seconds
+ *
+ * @return double Current time in seconds
+ */
+static double currentTime() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec + (now.tv_nsec / 1e9));
+}
+
+/**
+ * @brief Simulates every published batch against the configurations in a worker's shard
+ *
+ * @param arg Pointer to the worker structure
+ * @return void* Always NULL, errors are stored in the worker's status
+ */
+static void* sweepWorker(void* arg) {
+    sweep_worker_s* worker = (sweep_worker_s*)arg;
+    sweep_pool_s* pool = worker->pool;
+    request_s request;
+
+    // Wait until the reader knows how many workers started and has sized the barriers
+    pthread_mutex_lock(&pool->start_lock);
+    pthread_mutex_unlock(&pool->start_lock);
+
+    while (true) {
+        // Wait for the next batch to be published
+        pthread_barrier_wait(&pool->start_barrier);
+        size_t batch_count = pool->batch_count;
+        if (batch_count == 0) break; // end of trace
+
+        double start_time = currentTime();
+
+        // Simulate one configuration at a time so its lines stay hot in the host cache
+        for (size_t e = 0; e < worker->env_count && worker->status.code == ERR_SUCCESS; e++) {
+            environment_info_s* env = &worker->envs[e];
+
+            for (size_t r = 0; r < batch_count; r++) {
+                loadRequest(&request, &pool->batch[r]);
+                worker->status = simulateRequest(env, &request);
+                if (worker->status.code != ERR_SUCCESS) break;
+            }
+        }
+
+        worker->busy_time += (currentTime() - start_time);
+        worker->requests += (batch_count * worker->env_count);
+
+        // Signal batch completion
+        pthread_barrier_wait(&pool->done_barrier);
+    }
+
+    return NULL;
+}
+
+/*==================================================================================================
+    Sweep Functions
+==================================================================================================*/
+
+/**
+ * @brief Allocates a worker pool and splits the configurations between its workers
+ *
+ * @param pool Pointer to pool structure to initialize
+ * @param envs Array of configurations to simulate
+ * @param env_count Number of configurations in the array
+ * @param thread_count Requested number of worker threads
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s setupSweepPool(sweep_pool_s* pool, environment_info_s* envs, size_t env_count,
+                              size_t thread_count) {
+    error_status_s status = {
+        .domain = ERROR_PARAMETER,
+        .code = ERR_SUCCESS
+    };
+
+    // Never start more workers than there are configurations
+    if (thread_count > env_count)
+        thread_count = env_count;
+
+    memset(pool, 0, sizeof(*pool));
+    pthread_mutex_init(&pool->start_lock, NULL);
+    pool->worker_count = thread_count;
+    pool->workers = (sweep_worker_s*)calloc(thread_count, sizeof(sweep_worker_s));
+    pool->batches[0] = (trace_ref_s*)malloc(SWEEP_BATCH_SIZE * sizeof(trace_ref_s));
+    pool->batches[1] = (trace_ref_s*)malloc(SWEEP_BATCH_SIZE * sizeof(trace_ref_s));
+    if (!pool->workers || !pool->batches[0] || !pool->batches[1]) {
+        status.code = ERR_SWEEP_ALLOCATION_FAILED;
+        return status;
+    }
+
+    // Split configurations into contiguous shards, spreading the remainder
+    size_t shard_size = env_count / thread_count;
+    size_t remainder = env_count % thread_count;
+    size_t next_env = 0;
+    for (size_t t = 0; t < thread_count; t++) {
+        sweep_worker_s* worker = &pool->workers[t];
+        worker->pool = pool;
+        worker->id = (t+1);
+        worker->first_env = next_env;
+        worker->env_count = shard_size + ((t < remainder) ? 1 : 0);
+        worker->envs = &envs[next_env];
+        worker->status.code = ERR_SUCCESS;
+        next_env += worker->env_count;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Reads the trace and simulates it on the worker pool
+ *
+ * @param pool Pointer to an initialized worker pool
+ * @param reader Pointer to an open trace reader
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s runSweep(sweep_pool_s* pool, trace_reader_s* reader) {
+    error_status_s status = {
+        .domain = ERROR_PARAMETER,
+        .code = ERR_SUCCESS
+    };
+
+    // Start the workers, which wait on the start lock until the barriers exist
+    pthread_mutex_lock(&pool->start_lock);
+    size_t started = 0;
+    while (started < pool->worker_count &&
+           pthread_create(&pool->workers[started].thread, NULL, sweepWorker,
+                          &pool->workers[started]) == 0) {
+        started++;
+    }
+    if (started < pool->worker_count)
+        status.code = ERR_SWEEP_THREAD_FAILED;
+
+    // Workers that started and the reader meet at both barriers
+    pool->worker_count = started;
+    if (started > 0) {
+        pthread_barrier_init(&pool->start_barrier, NULL, started + 1);
+        pthread_barrier_init(&pool->done_barrier, NULL, started + 1);
+        pool->barriers_ready = true;
+    }
+    pthread_mutex_unlock(&pool->start_lock);
+    if (started == 0)
+        return status;
+
+    // Prime the first batch (none if a worker failed to start, so the others exit)
+    unsigned int current = 0;
+    size_t batch_count = 0;
+    if (status.code == ERR_SUCCESS) {
+        status = readTraceBatch(reader, pool->batches[current], SWEEP_BATCH_SIZE, &batch_count);
+        if (status.code != ERR_SUCCESS)
+            batch_count = 0;
+    }
+
+    while (true) {
+        // Publish the batch to the workers (an empty batch tells them to exit)
+        pool->batch = pool->batches[current];
+        pool->batch_count = batch_count;
+        pthread_barrier_wait(&pool->start_barrier);
+        if (batch_count == 0) break;
+
+        // Decode the next batch while the workers simulate the current one
+        status = readTraceBatch(reader, pool->batches[current ^ 1], SWEEP_BATCH_SIZE, &batch_count);
+        if (status.code != ERR_SUCCESS)
+            batch_count = 0;
+
+        pthread_barrier_wait(&pool->done_barrier);
+        current ^= 1;
+    }
+
+    // Wait for every worker to exit
+    for (size_t t = 0; t < pool->worker_count; t++) {
+        pthread_join(pool->workers[t].thread, NULL);
+    }
+
+    // Report the first error hit by a worker
+    if (status.code == ERR_SUCCESS) {
+        for (size_t t = 0; t < pool->worker_count; t++) {
+            if (pool->workers[t].status.code != ERR_SUCCESS)
+                return pool->workers[t].status;
+        }
+    }
+
+    return status;
+}
+
+/**
+ * @brief Frees memory allocated for a worker pool
+ *
+ * @param pool Pointer to the pool structure to destroy
+ */
+void destroySweepPool(sweep_pool_s* pool) {
+    if (pool->barriers_ready) {
+        pthread_barrier_destroy(&pool->start_barrier);
+        pthread_barrier_destroy(&pool->done_barrier);
+    }
+    pthread_mutex_destroy(&pool->start_lock);
+    free(pool->batches[0]);
+    free(pool->batches[1]);
+    free(pool->workers);
+}
+
+/**
+ * @brief Prints the throughput of each worker in the pool
+ *
+ * @param pool Pointer to the pool structure containing worker metrics
+ */
+void printSweepThroughput(sweep_pool_s* pool) {
+    for (size_t t = 0; t < pool->worker_count; t++) {
+        sweep_worker_s* worker = &pool->workers[t];
+        double throughput = (worker->busy_time > 0) ?
+                            (worker->requests / worker->busy_time) : 0;
+        printf("Thread %zu: Configs %zu-%zu, %zu requests, %.0f requests/s\n",
+               worker->id, (worker->first_env + 1), (worker->first_env + worker->env_count),
+               worker->requests, throughput);
+    }
+}
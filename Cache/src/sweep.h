@@ -0,0 +1,85 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file sweep.h
+* @brief Contains structures and function declarations related to running sweep
+         configurations in parallel.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "cache.h"
+#include "config.h"
+#include "error.h"
+
+/*==================================================================================================
+    Sweep Structures
+==================================================================================================*/
+
+struct sweep_pool_s;
+
+/***************| Worker |***************/
+typedef struct {
+    struct sweep_pool_s* pool;
+    pthread_t thread;
+    size_t id;
+
+    // Shard of configurations owned by this worker
+    environment_info_s* envs;
+    size_t first_env;
+    size_t env_count;
+
+    // Recorded Metrics
+    size_t requests;        // requests simulated across all configurations in shard
+    double busy_time;       // (seconds) time spent simulating
+    error_status_s status;
+} sweep_worker_s;
+
+/***************| Pool |***************/
+typedef struct sweep_pool_s {
+    sweep_worker_s* workers;
+    size_t worker_count;
+
+    // Shared read-only batch of decoded requests (double buffered)
+    trace_ref_s* batches[2];
+    const trace_ref_s* batch;
+    size_t batch_count;
+
+    // Synchronization between the reader and the workers
+    pthread_mutex_t start_lock;     // held by the reader until the barriers are sized
+    pthread_barrier_t start_barrier;
+    pthread_barrier_t done_barrier;
+    bool barriers_ready;
+} sweep_pool_s;
+
+/*==================================================================================================
+    Sweep Function Declarations
+==================================================================================================*/
+
+/**
+ * @brief Allocates a worker pool and splits the configurations between its workers
+ *
+ * @param pool Pointer to pool structure to initialize
+ * @param envs Array of configurations to simulate
+ * @param env_count Number of configurations in the array
+ * @param thread_count Requested number of worker threads
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s setupSweepPool(sweep_pool_s* pool, environment_info_s* envs, size_t env_count,
+                              size_t thread_count);
+
+error_status_s runSweep(sweep_pool_s* pool, trace_reader_s* reader);
+
+void destroySweepPool(sweep_pool_s* pool);
+
+void printSweepThroughput(sweep_pool_s* pool);
+
+#endif // SWEEP_H
@@ -0,0 +1,279 @@
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file tag_bench.c
+* @brief Microbenchmark comparing the vector tag match kernels against the scalar lookup.
+*
+*   The benchmark runs in two parts:
+*       1. Kernel - every supported kernel searches random sets for random probe tags.
+*       2. Lookup - processRequest() runs over a random request stream, once with the
+*          scalar kernel and once with the kernel selected for the host CPU.
+*
+*   Both parts verify that every kernel finds exactly the same ways as the scalar code.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <time.h>
+
+#include "cache.h"
+#include "config.h"
+#include "error.h"
+#include "tagmatch.h"
+
+/*==================================================================================================
+    Macros
+==================================================================================================*/
+
+#define BENCH_SETS 1024             // sets searched by the kernel benchmark
+#define BENCH_PROBES (1 << 16)      // probe tags / requests generated per set width
+#define BENCH_ROUNDS 64             // passes over the probes (default)
+#define BENCH_CACHE_SIZE (64 * 1024)
+#define BENCH_LINE_SIZE 32
+
+/*==================================================================================================
+    Static Helpers
+==================================================================================================*/
+
+typedef struct {
+    const char* name;
+    tag_match_fn match;
+    size_t width;       // ways compared at once
+} bench_kernel_s;
+
+/**
+ * @brief Retrieves the current monotonic time in seconds
+ *
+ * @return double Current time in seconds
+ */
+static double currentTime() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec + (now.tv_nsec / 1e9));
+}
+
+/**
+ * @brief Generates the next pseudo-random number (xorshift32)
+ *
+ * @param state Pointer to generator state
+ * @return uint32_t Next random number
+ */
+static uint32_t nextRandom(uint32_t* state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/**
+ * @brief Collects every kernel the host CPU supports
+ *
+ * @param kernels Output array of at least 4 kernels
+ * @return size_t Number of kernels collected
+ */
+static size_t collectKernels(bench_kernel_s* kernels) {
+    size_t count = 0;
+    kernels[count++] = (bench_kernel_s){"Scalar", matchTagsScalar, 1};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        kernels[count++] = (bench_kernel_s){"SSE2", matchTagsSSE2, 4};
+    if (__builtin_cpu_supports("avx2"))
+        kernels[count++] = (bench_kernel_s){"AVX2", matchTagsAVX2, 8};
+#elif defined(__aarch64__)
+    kernels[count++] = (bench_kernel_s){"NEON", matchTagsNEON, 4};
+#endif
+    return count;
+}
+
+/*==================================================================================================
+    Benchmarks
+==================================================================================================*/
+
+/**
+ * @brief Times every supported kernel searching random sets of one width
+ *
+ * @param kernels Array of supported kernels (the first is the scalar kernel)
+ * @param kernel_count Number of kernels in the array
+ * @param ways Number of ways in each set
+ * @param rounds Number of passes over the probes
+ * @return bool True if every kernel matched the scalar kernel, false otherwise
+ */
+static bool benchKernels(bench_kernel_s* kernels, size_t kernel_count, size_t ways, size_t rounds) {
+    uint32_t* tags = (uint32_t*)malloc(BENCH_SETS * ways * sizeof(uint32_t));
+    uint32_t* probe_sets = (uint32_t*)malloc(BENCH_PROBES * sizeof(uint32_t));
+    uint32_t* probe_tags = (uint32_t*)malloc(BENCH_PROBES * sizeof(uint32_t));
+    if (!tags || !probe_sets || !probe_tags) {
+        fprintf(stderr, "Error: Failed to allocate benchmark sets\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Random sets, probed by a tag from the set half of the time
+    uint32_t state = RANDOM_POLICY_SEED;
+    for (size_t t = 0; t < BENCH_SETS * ways; t++)
+        tags[t] = nextRandom(&state);
+    for (size_t p = 0; p < BENCH_PROBES; p++) {
+        probe_sets[p] = nextRandom(&state) % BENCH_SETS;
+        probe_tags[p] = (nextRandom(&state) & 1) ?
+                        tags[(probe_sets[p] * ways) + (nextRandom(&state) % ways)] :
+                        nextRandom(&state);
+    }
+
+    bool matched = true;
+    uint64_t scalar_checksum = 0;
+    double scalar_time = 0;
+    for (size_t k = 0; k < kernel_count; k++) {
+        if (ways % kernels[k].width != 0) continue;
+
+        // Fold every mask into a checksum so no lookup can be skipped
+        uint64_t checksum = 0;
+        double start_time = currentTime();
+        for (size_t r = 0; r < rounds; r++) {
+            for (size_t p = 0; p < BENCH_PROBES; p++) {
+                uint32_t mask = kernels[k].match(&tags[probe_sets[p] * ways], ways, probe_tags[p]);
+                checksum = (checksum * 31) + mask;
+            }
+        }
+        double elapsed_time = currentTime() - start_time;
+
+        if (k == 0) {
+            scalar_checksum = checksum;
+            scalar_time = elapsed_time;
+        }
+        bool correct = (checksum == scalar_checksum);
+        matched = matched && correct;
+
+        printf("%6zu | %10s | %10.2f | %7.2fx | %s\n", ways, kernels[k].name,
+               (elapsed_time * 1e9) / (rounds * BENCH_PROBES), scalar_time / elapsed_time,
+               correct ? "ok" : "MISMATCH");
+    }
+
+    free(tags);
+    free(probe_sets);
+    free(probe_tags);
+    return matched;
+}
+
+/**
+ * @brief Times processRequest() on a random request stream with a given kernel
+ *
+ * @param requests Array of requests to process
+ * @param ways Number of ways in each set
+ * @param match Tag match kernel to install in the cache
+ * @param rounds Number of passes over the requests
+ * @param hits Output for the number of hits
+ * @return double Elapsed time in seconds
+ */
+static double benchLookup(request_s* requests, size_t ways, tag_match_fn match, size_t rounds,
+                          size_t* hits) {
+    cache_s* cache = NULL;
+    error_status_s status = setupCache(&cache, 1, BENCH_CACHE_SIZE, BENCH_LINE_SIZE, ways, LRU);
+    if (status.code != ERR_SUCCESS) {
+        fprintf(stderr, "Error: Failed to set up benchmark cache\n");
+        exit(EXIT_FAILURE);
+    }
+    cache->match_tags = match;
+
+    bool hit_occured;
+    double start_time = currentTime();
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t p = 0; p < BENCH_PROBES; p++) {
+            processRequest(&requests[p], cache, &hit_occured);
+        }
+    }
+    double elapsed_time = currentTime() - start_time;
+
+    *hits = cache->hits;
+    destroyCache(cache);
+    return elapsed_time;
+}
+
+/*==================================================================================================
+    Main
+==================================================================================================*/
+
+/**
+* @brief Main entry point for the tag match microbenchmark
+*
+* @param argc Number of command-line arguments (expected 1-2)
+* @param argv Array of command-line arguments:
+*               - argv[0] Executable name
+*               - argv[1] Number of passes over the probes (optional)
+* @return int 0 if every kernel matched the scalar lookup, 1 otherwise
+*/
+int main(int argc, char* argv[]) {
+    size_t rounds = (argc > 1) ? (size_t)atoi(argv[1]) : BENCH_ROUNDS;
+    if (rounds < 1) {
+        fprintf(stderr, "Usage: %s [rounds]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bench_kernel_s kernels[4];
+    size_t kernel_count = collectKernels(kernels);
+    size_t widths[] = {4, 8, 16, 32};
+    bool matched = true;
+
+    // ========== Kernels ==========
+    printf("------------------------------------------------------------\n");
+    printf("%6s | %10s | %10s | %8s | %s\n", "Ways", "Kernel", "ns/lookup", "Speedup", "Check");
+    printf("------------------------------------------------------------\n");
+    for (size_t i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+        matched = benchKernels(kernels, kernel_count, widths[i], rounds) && matched;
+    }
+
+    // ========== processRequest() ==========
+    request_s* requests = (request_s*)malloc(BENCH_PROBES * sizeof(request_s));
+    if (requests == NULL) {
+        fprintf(stderr, "Error: Failed to allocate benchmark requests\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("------------------------------------------------------------\n");
+    printf("%6s | %10s | %10s | %8s | %s\n", "Ways", "Kernel", "ns/request", "Speedup", "Check");
+    printf("------------------------------------------------------------\n");
+    for (size_t i = 0; i < sizeof(widths) / sizeof(widths[0]); i++) {
+        size_t ways = widths[i];
+
+        // Random reads over twice the cache size, decoded once up front
+        cache_s* layout = NULL;
+        setupCache(&layout, 1, BENCH_CACHE_SIZE, BENCH_LINE_SIZE, ways, LRU);
+        uint32_t state = RANDOM_POLICY_SEED;
+        for (size_t p = 0; p < BENCH_PROBES; p++) {
+            trace_ref_s ref = {
+                .hex = nextRandom(&state) % (2 * BENCH_CACHE_SIZE),
+                .ref_type = DATA,
+                .access_type = READ
+            };
+            loadRequest(&requests[p], &ref);
+            formatRequestAddressFields(&requests[p], layout);
+        }
+        destroyCache(layout);
+
+        size_t scalar_hits, vector_hits;
+        tag_match_fn selected = selectTagMatch(ways);
+        double scalar_time = benchLookup(requests, ways, matchTagsScalar, rounds, &scalar_hits);
+        double vector_time = benchLookup(requests, ways, selected, rounds, &vector_hits);
+        bool correct = (scalar_hits == vector_hits);
+        matched = matched && correct;
+
+        printf("%6zu | %10s | %10.2f | %7.2fx | %s\n", ways, "Scalar",
+               (scalar_time * 1e9) / (rounds * BENCH_PROBES), 1.0, "ok");
+        printf("%6zu | %10s | %10.2f | %7.2fx | %s\n", ways, tagMatchName(selected),
+               (vector_time * 1e9) / (rounds * BENCH_PROBES), scalar_time / vector_time,
+               correct ? "ok" : "MISMATCH");
+    }
+    printf("------------------------------------------------------------\n");
+    free(requests);
+
+    return matched ? EXIT_SUCCESS : EXIT_FAILURE;
+}
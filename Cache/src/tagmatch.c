@@ -0,0 +1,169 @@
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file tagmatch.c
+* @brief Contains the kernels used to search a cache set for a tag.
+*
+* A set-associative lookup compares the request tag against every way of its set.
+* The vector kernels broadcast the tag and compare a full register of ways at once,
+* then collapse the comparison into a hit mask with a movemask. The kernel is chosen
+* once per cache at setup based on what the host CPU supports, falling back to the
+* scalar loop when no vector kernel applies.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "tagmatch.h"
+
+/*==================================================================================================
+    Kernels
+==================================================================================================*/
+
+/**
+ * @brief Compares a tag against every way of a set one way at a time
+ *
+ * @param tags Pointer to the set's tags
+ * @param ways Number of ways in the set
+ * @param tag Tag to search for
+ * @return uint32_t Mask with a bit set for each way holding the tag
+ */
+uint32_t matchTagsScalar(const uint32_t* tags, size_t ways, uint32_t tag) {
+    uint32_t match_mask = 0;
+    for (size_t w = 0; w < ways; w++) {
+        match_mask |= ((uint32_t)(tags[w] == tag) << w);
+    }
+    return match_mask;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/**
+ * @brief Compares a tag against a set four ways at a time (ways must be a multiple of 4)
+ *
+ * @param tags Pointer to the set's tags
+ * @param ways Number of ways in the set
+ * @param tag Tag to search for
+ * @return uint32_t Mask with a bit set for each way holding the tag
+ */
+__attribute__((target("sse2")))
+uint32_t matchTagsSSE2(const uint32_t* tags, size_t ways, uint32_t tag) {
+    __m128i probe = _mm_set1_epi32((int)tag);
+    uint32_t match_mask = 0;
+
+    for (size_t w = 0; w < ways; w += 4) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(tags + w));
+        __m128i equal = _mm_cmpeq_epi32(chunk, probe);
+        match_mask |= ((uint32_t)_mm_movemask_ps(_mm_castsi128_ps(equal)) << w);
+    }
+    return match_mask;
+}
+
+/**
+ * @brief Compares a tag against a set eight ways at a time (ways must be a multiple of 8)
+ *
+ * @param tags Pointer to the set's tags
+ * @param ways Number of ways in the set
+ * @param tag Tag to search for
+ * @return uint32_t Mask with a bit set for each way holding the tag
+ */
+__attribute__((target("avx2")))
+uint32_t matchTagsAVX2(const uint32_t* tags, size_t ways, uint32_t tag) {
+    __m256i probe = _mm256_set1_epi32((int)tag);
+    uint32_t match_mask = 0;
+
+    for (size_t w = 0; w < ways; w += 8) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(tags + w));
+        __m256i equal = _mm256_cmpeq_epi32(chunk, probe);
+        match_mask |= ((uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(equal)) << w);
+    }
+
+    // Clear the upper halves so the surrounding SSE code avoids transition stalls
+    // (the compiler only inserts this itself when optimizing)
+    _mm256_zeroupper();
+    return match_mask;
+}
+
+#endif
+
+#if defined(__aarch64__)
+
+/**
+ * @brief Compares a tag against a set four ways at a time (ways must be a multiple of 4)
+ *
+ * @param tags Pointer to the set's tags
+ * @param ways Number of ways in the set
+ * @param tag Tag to search for
+ * @return uint32_t Mask with a bit set for each way holding the tag
+ */
+uint32_t matchTagsNEON(const uint32_t* tags, size_t ways, uint32_t tag) {
+    static const uint32_t lane_bits[4] = {1, 2, 4, 8};
+    uint32x4_t probe = vdupq_n_u32(tag);
+    uint32x4_t bits = vld1q_u32(lane_bits);
+    uint32_t match_mask = 0;
+
+    // NEON has no movemask, so keep one bit per matching lane and add the lanes together
+    for (size_t w = 0; w < ways; w += 4) {
+        uint32x4_t equal = vceqq_u32(vld1q_u32(tags + w), probe);
+        match_mask |= (vaddvq_u32(vandq_u32(equal, bits)) << w);
+    }
+    return match_mask;
+}
+
+#endif
+
+/*==================================================================================================
+    Dispatch
+==================================================================================================*/
+
+/**
+ * @brief Selects the fastest kernel the host CPU supports for a set width
+ *
+ * @param ways Number of ways in each set
+ * @return tag_match_fn Tag match kernel (scalar when no vector kernel applies)
+ */
+tag_match_fn selectTagMatch(size_t ways) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (ways % 8 == 0 && __builtin_cpu_supports("avx2"))
+        return matchTagsAVX2;
+    if (ways % 4 == 0 && __builtin_cpu_supports("sse2"))
+        return matchTagsSSE2;
+#elif defined(__aarch64__)
+    // Advanced SIMD is mandatory on AArch64
+    if (ways % 4 == 0)
+        return matchTagsNEON;
+#endif
+    (void)ways;
+    return matchTagsScalar;
+}
+
+/**
+ * @brief Retrieves the printable name of a tag match kernel
+ *
+ * @param match Tag match kernel
+ * @return const char* Name of the kernel
+ */
+const char* tagMatchName(tag_match_fn match) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (match == matchTagsAVX2) return "AVX2";
+    if (match == matchTagsSSE2) return "SSE2";
+#elif defined(__aarch64__)
+    if (match == matchTagsNEON) return "NEON";
+#endif
+    (void)match;
+    return "Scalar";
+}
@@ -0,0 +1,52 @@
+#ifndef TAGMATCH_H
+#define TAGMATCH_H
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file tagmatch.h
+* @brief Contains function declarations related to comparing a tag against every way
+         of a cache set.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+/*==================================================================================================
+    Tag Match Kernels
+==================================================================================================*/
+
+/*
+ * Every kernel returns a mask with bit w set when tags[w] == tag. The vector kernels
+ * consume their full width at a time, so they only handle way counts that are a
+ * multiple of it (see selectTagMatch).
+ */
+typedef uint32_t (*tag_match_fn)(const uint32_t* tags, size_t ways, uint32_t tag);
+
+uint32_t matchTagsScalar(const uint32_t* tags, size_t ways, uint32_t tag);
+
+#if defined(__x86_64__) || defined(__i386__)
+uint32_t matchTagsSSE2(const uint32_t* tags, size_t ways, uint32_t tag);
+
+uint32_t matchTagsAVX2(const uint32_t* tags, size_t ways, uint32_t tag);
+#endif
+
+#if defined(__aarch64__)
+uint32_t matchTagsNEON(const uint32_t* tags, size_t ways, uint32_t tag);
+#endif
+
+/**
+ * @brief Selects the fastest kernel the host CPU supports for a set width
+ *
+ * @param ways Number of ways in each set
+ * @return tag_match_fn Tag match kernel (scalar when no vector kernel applies)
+ */
+tag_match_fn selectTagMatch(size_t ways);
+
+const char* tagMatchName(tag_match_fn match);
+
+#endif // TAGMATCH_H
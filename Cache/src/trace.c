@@ -0,0 +1,480 @@
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file trace.c
+* @brief Contains functions to decode textual, binary and compressed trace files.
+*
+* Textual traces hold references in the format @<I/D><R/W><hex-address>, and are
+* scanned a block at a time out of a single buffer. Binary traces (see trace.h) are
+* mapped into memory when they are regular files, so each record is unpacked in place
+* without any string parsing, and are streamed through the same buffer otherwise.
+* Gzip and zstd traces are decompressed on a background thread (see tracedecoder.c)
+* that fills the buffer with either format.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "cache.h"
+#include "config.h"
+#include "error.h"
+#include "trace.h"
+
+/*==================================================================================================
+    Static Helpers
+==================================================================================================*/
+
+/**
+ * @brief Moves the unread bytes to the front of the stream buffer and appends more input
+ *
+ * Input is read until at least minimum unread bytes are buffered or the trace ends.
+ *
+ * @param reader Pointer to a streaming trace reader
+ * @param minimum Number of unread bytes wanted (at most TRACE_BUFFER_PADDING)
+ * @return error_status_s Error status structure indicating success or failure
+ */
+static error_status_s fillTraceBuffer(trace_reader_s* reader, size_t minimum) {
+    error_status_s status = {
+        .domain = ERROR_REQUEST,
+        .code = ERR_SUCCESS
+    };
+
+    size_t leftover = reader->buffer_end - reader->buffer_start;
+    memmove(reader->buffer, reader->buffer + reader->buffer_start, leftover);
+    reader->buffer_start = 0;
+    reader->buffer_end = leftover;
+
+    while (reader->buffer_end < minimum && !reader->end_of_input) {
+        if (reader->decoder != NULL) {
+            // Copy the next decompressed block out of the ring
+            const uint8_t* block;
+            size_t length;
+            if (!nextDecodedBlock(reader->decoder, &block, &length)) {
+                reader->end_of_input = true;
+                status.code = reader->decoder->error;
+                break;
+            }
+            memcpy(reader->buffer + reader->buffer_end, block, length);
+            reader->buffer_end += length;
+            releaseDecodedBlock(reader->decoder);
+        } else {
+            ssize_t bytes_read;
+            do {
+                bytes_read = read(reader->fd, reader->buffer + reader->buffer_end,
+                                  TRACE_BLOCK_SIZE + TRACE_BUFFER_PADDING - reader->buffer_end);
+            } while (bytes_read == -1 && errno == EINTR);
+
+            if (bytes_read < 0) {
+                status.code = ERR_FAILED_TO_READ_TRACE;
+                break;
+            }
+            if (bytes_read == 0) reader->end_of_input = true;
+            reader->buffer_end += (size_t)bytes_read;
+        }
+    }
+
+    reader->buffer[reader->buffer_end] = '\0';
+    return status;
+}
+
+/**
+ * @brief Maps an uncompressed binary trace file into memory
+ *
+ * @param reader Pointer to reader structure to initialize
+ * @param size Size of the trace file
+ * @return error_status_s Error status structure indicating success or failure
+ */
+static error_status_s mapBinaryTrace(trace_reader_s* reader, size_t size) {
+    error_status_s status = {
+        .domain = ERROR_REQUEST,
+        .code = ERR_SUCCESS
+    };
+
+    reader->size = size;
+    void* data = mmap(NULL, reader->size, PROT_READ, MAP_PRIVATE, reader->fd, 0);
+    if (data == MAP_FAILED) {
+        status.code = ERR_FAILED_TO_MAP_TRACE;
+        return status;
+    }
+    madvise(data, reader->size, MADV_SEQUENTIAL);
+    reader->data = (const uint8_t*)data;
+    reader->format = TRACE_BINARY;
+
+    // Validate the header
+    if (reader->size < BINARY_TRACE_HEADER_SIZE ||
+        reader->data[4] != BINARY_TRACE_VERSION ||
+        reader->data[5] != BINARY_TRACE_RECORD_SIZE ||
+        (reader->size - BINARY_TRACE_HEADER_SIZE) % BINARY_TRACE_RECORD_SIZE != 0) {
+        status.code = ERR_INVALID_BINARY_TRACE;
+        return status;
+    }
+    reader->position = BINARY_TRACE_HEADER_SIZE;
+
+    return status;
+}
+
+/**
+ * @brief Decodes the next batch of references from a textual stream
+ *
+ * @param reader Pointer to a streaming trace reader
+ * @param batch Output array of decoded references
+ * @param capacity Maximum number of references to decode
+ * @param count Output for the number of references decoded
+ * @return error_status_s Error status structure indicating success or failure
+ */
+static error_status_s readTextBatch(trace_reader_s* reader, trace_ref_s* batch, size_t capacity,
+                                    size_t* count) {
+    error_status_s status = {
+        .domain = ERROR_REQUEST,
+        .code = ERR_SUCCESS
+    };
+
+    while (*count < capacity) {
+        // Skip until trace found
+        char* buffer = reader->buffer;
+        char* marker = memchr(buffer + reader->buffer_start, '@',
+                              reader->buffer_end - reader->buffer_start);
+        if (marker == NULL) {
+            reader->buffer_start = reader->buffer_end;
+            if (reader->end_of_input) break;
+            status = fillTraceBuffer(reader, 1);
+            if (status.code != ERR_SUCCESS) return status;
+            continue;
+        }
+        reader->buffer_start = (size_t)(marker - buffer);
+
+        // Make sure the whole trace is buffered: <I/D><R/W><hex-address>
+        size_t available = reader->buffer_end - reader->buffer_start - 1;
+        if (available < TRACE_SIZE - 1 && !reader->end_of_input) {
+            status = fillTraceBuffer(reader, TRACE_SIZE);
+            if (status.code != ERR_SUCCESS) return status;
+            continue;
+        }
+        if (available == 0) break; // '@' ends the trace
+
+        // Trace found, the buffer is NUL terminated so a short trace stops the decode
+        status = decodeTraceText(&batch[*count], marker + 1);
+        if (status.code != ERR_SUCCESS)
+            return status;
+        reader->buffer_start++;
+        (*count)++;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Decodes the next batch of references from a binary stream
+ *
+ * @param reader Pointer to a streaming trace reader
+ * @param batch Output array of decoded references
+ * @param capacity Maximum number of references to decode
+ * @param count Output for the number of references decoded
+ * @return error_status_s Error status structure indicating success or failure
+ */
+static error_status_s readBinaryStreamBatch(trace_reader_s* reader, trace_ref_s* batch,
+                                            size_t capacity, size_t* count) {
+    error_status_s status = {
+        .domain = ERROR_REQUEST,
+        .code = ERR_SUCCESS
+    };
+
+    while (*count < capacity) {
+        size_t available = reader->buffer_end - reader->buffer_start;
+        if (available < BINARY_TRACE_RECORD_SIZE) {
+            if (reader->end_of_input) {
+                if (available > 0) status.code = ERR_INVALID_BINARY_TRACE; // truncated record
+                break;
+            }
+            status = fillTraceBuffer(reader, BINARY_TRACE_RECORD_SIZE);
+            if (status.code != ERR_SUCCESS) return status;
+            continue;
+        }
+
+        // Unpack every whole record that is buffered
+        size_t records = available / BINARY_TRACE_RECORD_SIZE;
+        if (records > capacity - *count) records = capacity - *count;
+        const uint8_t* record = (const uint8_t*)reader->buffer + reader->buffer_start;
+
+        for (size_t r = 0; r < records; r++, record += BINARY_TRACE_RECORD_SIZE) {
+            decodeTraceRecord(&batch[*count + r], record);
+        }
+
+        reader->buffer_start += (records * BINARY_TRACE_RECORD_SIZE);
+        *count += records;
+    }
+
+    return status;
+}
+
+/*==================================================================================================
+    Reader Functions
+==================================================================================================*/
+
+/**
+ * @brief Opens a reader on a trace stream, detecting its format and compression
+ *
+ * @param reader Pointer to reader structure to initialize
+ * @param stream Trace stream (regular file or pipe)
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s openTraceReader(trace_reader_s* reader, FILE* stream) {
+    error_status_s status = {
+        .domain = ERROR_REQUEST,
+        .code = ERR_SUCCESS
+    };
+
+    memset(reader, 0, sizeof(*reader));
+    reader->format = TRACE_TEXT;
+    reader->compression = TRACE_UNCOMPRESSED;
+    reader->fd = fileno(stream);
+
+    // Uncompressed binary files are mapped, peeking the magic without moving the position
+    struct stat trace_stat;
+    char magic[BINARY_TRACE_MAGIC_SIZE];
+    if (fstat(reader->fd, &trace_stat) == 0 && S_ISREG(trace_stat.st_mode) &&
+        pread(reader->fd, magic, sizeof(magic), 0) == sizeof(magic) &&
+        memcmp(magic, BINARY_TRACE_MAGIC, BINARY_TRACE_MAGIC_SIZE) == 0)
+        return mapBinaryTrace(reader, (size_t)trace_stat.st_size);
+
+    // Everything else is streamed
+    reader->buffer = (char*)malloc(TRACE_BLOCK_SIZE + TRACE_BUFFER_PADDING + 1);
+    if (reader->buffer == NULL) {
+        status.code = ERR_REQUEST_ALLOCATION_FAILED;
+        return status;
+    }
+    status = fillTraceBuffer(reader, ZSTD_MAGIC_SIZE);
+    if (status.code != ERR_SUCCESS)
+        return status;
+
+    // Compressed input is handed to the decoder, which starts from the bytes already read
+    reader->compression = detectCompression((const uint8_t*)reader->buffer, reader->buffer_end);
+    if (reader->compression != TRACE_UNCOMPRESSED) {
+        reader->decoder = (trace_decoder_s*)malloc(sizeof(trace_decoder_s));
+        if (reader->decoder == NULL) {
+            status.code = ERR_TRACE_DECODER_FAILED;
+            return status;
+        }
+        status = startTraceDecoder(reader->decoder, reader->fd, reader->compression,
+                                   (const uint8_t*)reader->buffer, reader->buffer_end);
+        if (status.code != ERR_SUCCESS) {
+            free(reader->decoder);
+            reader->decoder = NULL;
+            return status;
+        }
+        reader->buffer_start = reader->buffer_end = 0;
+        reader->end_of_input = false;
+    }
+
+    // Detect binary content within the (decompressed) stream
+    status = fillTraceBuffer(reader, BINARY_TRACE_HEADER_SIZE);
+    if (status.code != ERR_SUCCESS)
+        return status;
+    if (reader->buffer_end < BINARY_TRACE_MAGIC_SIZE ||
+        memcmp(reader->buffer, BINARY_TRACE_MAGIC, BINARY_TRACE_MAGIC_SIZE) != 0)
+        return status;
+
+    reader->format = TRACE_BINARY;
+    if (reader->buffer_end < BINARY_TRACE_HEADER_SIZE ||
+        (uint8_t)reader->buffer[4] != BINARY_TRACE_VERSION ||
+        (uint8_t)reader->buffer[5] != BINARY_TRACE_RECORD_SIZE) {
+        status.code = ERR_INVALID_BINARY_TRACE;
+        return status;
+    }
+    reader->buffer_start = BINARY_TRACE_HEADER_SIZE;
+
+    return status;
+}
+
+/**
+ * @brief Releases the mapping, buffer and decoder held by a trace reader
+ *
+ * @param reader Pointer to the reader structure to close
+ */
+void closeTraceReader(trace_reader_s* reader) {
+    if (reader->data != NULL) {
+        munmap((void*)reader->data, reader->size);
+        reader->data = NULL;
+    }
+    if (reader->decoder != NULL) {
+        stopTraceDecoder(reader->decoder);
+        free(reader->decoder);
+        reader->decoder = NULL;
+    }
+    free(reader->buffer);
+    reader->buffer = NULL;
+}
+
+/**
+ * @brief Decodes the next batch of trace references
+ *
+ * @param reader Pointer to an open trace reader
+ * @param batch Output array of decoded references
+ * @param capacity Maximum number of references to decode
+ * @param count Output for the number of references decoded (0 at end of file)
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s readTraceBatch(trace_reader_s* reader, trace_ref_s* batch, size_t capacity,
+                              size_t* count) {
+    error_status_s status = {
+        .domain = ERROR_REQUEST,
+        .code = ERR_SUCCESS
+    };
+    *count = 0;
+
+    // Binary records are unpacked straight from the mapping
+    if (reader->data != NULL) {
+        size_t remaining = (reader->size - reader->position) / BINARY_TRACE_RECORD_SIZE;
+        size_t records = (remaining < capacity) ? remaining : capacity;
+        const uint8_t* record = reader->data + reader->position;
+
+        for (size_t r = 0; r < records; r++, record += BINARY_TRACE_RECORD_SIZE) {
+            decodeTraceRecord(&batch[r], record);
+        }
+
+        reader->position += (records * BINARY_TRACE_RECORD_SIZE);
+        *count = records;
+        return status;
+    }
+
+    if (reader->format == TRACE_BINARY)
+        return readBinaryStreamBatch(reader, batch, capacity, count);
+    return readTextBatch(reader, batch, capacity, count);
+}
+
+/*==================================================================================================
+    Encoding Functions
+==================================================================================================*/
+
+/**
+ * @brief Decodes a textual trace reference
+ *
+ * @param ref Pointer to reference structure to populate
+ * @param buffer Trace buffer string in the format <I/D><R/W><hex-address>
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s decodeTraceText(trace_ref_s* ref, const char* buffer) {
+    error_status_s status = {
+        .domain = ERROR_REQUEST,
+        .code = ERR_SUCCESS
+    };
+
+    // Assign reference type based on trace
+    switch (buffer[0]) {
+        case 'I':
+            ref->ref_type = INSTRUCTION;
+            break;
+        case 'D':
+            ref->ref_type = DATA;
+            break;
+        default:
+            status.code = ERR_INVALID_REFERENCE_TYPE;
+            status.request.ref_type = buffer[0];
+            return status;
+    }
+
+    // Assign access type based on trace
+    switch (buffer[1]) {
+        case 'R':
+            ref->access_type = READ;
+            break;
+        case 'W':
+            ref->access_type = WRITE;
+            break;
+        default:
+            status.code = ERR_INVALID_ACCESS_TYPE;
+            status.request.access_type = buffer[1];
+            return status;
+    }
+
+    // Format hex address and ensure it's proper
+    unsigned int hex;
+    if (!parseHexAddress(buffer + 2, &hex)) {
+        status.code = ERR_FAILED_TO_FORMAT_ADDRESS_HEX;
+        memcpy(&status.request.str_trace, buffer, TRACE_SIZE);
+        return status;
+    }
+    ref->hex = hex;
+
+    return status;
+}
+
+/**
+ * @brief Packs a trace reference into a binary trace record
+ *
+ * @param ref Pointer to reference to pack
+ * @param record Output buffer of at least BINARY_TRACE_RECORD_SIZE bytes
+ */
+void encodeTraceRecord(const trace_ref_s* ref, uint8_t* record) {
+    record[0] = (uint8_t)(ref->hex);
+    record[1] = (uint8_t)(ref->hex >> 8);
+    record[2] = (uint8_t)(ref->hex >> 16);
+    record[3] = (uint8_t)(ref->hex >> 24);
+    record[4] = ((ref->ref_type == DATA) ? BINARY_TRACE_FLAG_DATA : 0) |
+                ((ref->access_type == WRITE) ? BINARY_TRACE_FLAG_WRITE : 0);
+}
+
+/**
+ * @brief Unpacks a binary trace record into a trace reference
+ *
+ * @param ref Pointer to reference structure to populate
+ * @param record Input record of BINARY_TRACE_RECORD_SIZE bytes
+ */
+void decodeTraceRecord(trace_ref_s* ref, const uint8_t* record) {
+    ref->hex = (uint32_t)record[0] |
+               ((uint32_t)record[1] << 8) |
+               ((uint32_t)record[2] << 16) |
+               ((uint32_t)record[3] << 24);
+    ref->ref_type = (record[4] & BINARY_TRACE_FLAG_DATA) ? DATA : INSTRUCTION;
+    ref->access_type = (record[4] & BINARY_TRACE_FLAG_WRITE) ? WRITE : READ;
+}
+
+/**
+ * @brief Writes the binary trace header
+ *
+ * @param header Output buffer of at least BINARY_TRACE_HEADER_SIZE bytes
+ */
+void encodeTraceHeader(uint8_t* header) {
+    memcpy(header, BINARY_TRACE_MAGIC, BINARY_TRACE_MAGIC_SIZE);
+    header[4] = BINARY_TRACE_VERSION;
+    header[5] = BINARY_TRACE_RECORD_SIZE;
+    header[6] = 0; // reserved
+    header[7] = 0; // reserved
+}
+
+/**
+ * @brief Parses a hexadecimal address string up to the first non-hex character
+ *
+ * @param str Input string beginning with hex digits
+ * @param hex Output for the parsed address
+ * @return bool True if at least one hex digit was parsed, false otherwise
+ */
+bool parseHexAddress(const char* str, unsigned int* hex) {
+    unsigned int result = 0;
+    int digits = 0;
+
+    for (; digits < 8; digits++) {
+        char c = str[digits];
+        unsigned int value;
+        if (c >= '0' && c <= '9') value = c - '0';
+        else if (c >= 'a' && c <= 'f') value = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') value = c - 'A' + 10;
+        else break;
+        result = (result << 4) | value;
+    }
+
+    *hex = result;
+    return (digits > 0);
+}
@@ -0,0 +1,117 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file trace.h
+* @brief Contains structures and function declarations related to reading textual,
+         binary and compressed trace files.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "config.h"
+#include "error.h"
+#include "tracedecoder.h"
+
+/*==================================================================================================
+    Binary Trace Format
+==================================================================================================*/
+
+/*
+ * A binary trace is an 8 byte header followed by packed 5 byte records:
+ *
+ *      Header: <magic "CTRB" (4)> <version (1)> <record size (1)> <reserved (2)>
+ *      Record: <address (4, little-endian)> <flags (1)>
+ */
+#define BINARY_TRACE_MAGIC "CTRB"
+#define BINARY_TRACE_MAGIC_SIZE 4
+#define BINARY_TRACE_VERSION 1
+#define BINARY_TRACE_HEADER_SIZE 8
+#define BINARY_TRACE_RECORD_SIZE 5
+
+// Record flag bits
+#define BINARY_TRACE_FLAG_DATA 0x1  // set for data references, clear for instructions
+#define BINARY_TRACE_FLAG_WRITE 0x2 // set for writes, clear for reads
+
+/*==================================================================================================
+    Trace Structures
+==================================================================================================*/
+
+// Compact decoded trace reference, shared read-only between sweep workers
+typedef struct {
+  uint32_t hex;
+  uint8_t ref_type;     // reference_type_e
+  uint8_t access_type;  // access_type_e
+} trace_ref_s;
+
+typedef enum {
+    TRACE_TEXT,
+    TRACE_BINARY
+} trace_format_e;
+
+// Room kept in the stream buffer for a partial reference carried over between blocks
+#define TRACE_BUFFER_PADDING 64
+
+typedef struct {
+    trace_format_e format;
+    trace_compression_e compression;
+    int fd;
+
+    // Uncompressed binary files are mapped into memory
+    const uint8_t* data;
+    size_t size;
+    size_t position;
+
+    // Everything else is streamed through a buffer, NUL terminated at buffer_end
+    char* buffer;
+    size_t buffer_start;
+    size_t buffer_end;
+    bool end_of_input;
+
+    // Compressed traces are decompressed on a background thread
+    trace_decoder_s* decoder;
+} trace_reader_s;
+
+/*==================================================================================================
+    Trace Function Declarations
+==================================================================================================*/
+
+/***************| Reader |***************/
+
+/**
+ * @brief Opens a reader on a trace stream, detecting its format and compression
+ *
+ * @param reader Pointer to reader structure to initialize
+ * @param stream Trace stream (regular file or pipe)
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s openTraceReader(trace_reader_s* reader, FILE* stream);
+
+void closeTraceReader(trace_reader_s* reader);
+
+error_status_s readTraceBatch(trace_reader_s* reader, trace_ref_s* batch, size_t capacity,
+                              size_t* count);
+
+
+/***************| Encoding |***************/
+
+error_status_s decodeTraceText(trace_ref_s* ref, const char* buffer);
+
+void encodeTraceRecord(const trace_ref_s* ref, uint8_t* record);
+
+void decodeTraceRecord(trace_ref_s* ref, const uint8_t* record);
+
+void encodeTraceHeader(uint8_t* header);
+
+bool parseHexAddress(const char* str, unsigned int* hex);
+
+
+#endif // TRACE_H
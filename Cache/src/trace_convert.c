@@ -0,0 +1,83 @@
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file trace_convert.c
+* @brief Converts a textual trace into the packed binary trace format.
+*
+* Reads a textual trace (@<I/D><R/W><hex-address>) from stdin, and writes the
+* equivalent binary trace (see trace.h) to stdout. The simulator detects and maps
+* binary traces automatically when they are redirected to its stdin.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "error.h"
+#include "trace.h"
+
+/*==================================================================================================
+    Main
+==================================================================================================*/
+
+/**
+* @brief Main entry point for the trace converter
+* 
+* @return int 0 on success, -1 on error
+*/
+int main() {
+    error_status_s status = {
+        .domain = ERROR_REQUEST,
+        .code = ERR_SUCCESS
+    };
+
+    trace_reader_s reader;
+    status = openTraceReader(&reader, stdin);
+    ERR_CHECK(status);
+
+    // Nothing to convert
+    if (reader.format == TRACE_BINARY) {
+        closeTraceReader(&reader);
+        status.code = ERR_TRACE_ALREADY_BINARY;
+        ERR_CHECK(status);
+    }
+
+    // Write the header
+    uint8_t header[BINARY_TRACE_HEADER_SIZE];
+    encodeTraceHeader(header);
+    if (fwrite(header, sizeof(header), 1, stdout) != 1) {
+        status.code = ERR_FAILED_TO_WRITE_TRACE;
+        ERR_CHECK(status);
+    }
+
+    // Convert the trace one batch at a time
+    static trace_ref_s batch[TRACE_BATCH_SIZE];
+    static uint8_t records[TRACE_BATCH_SIZE * BINARY_TRACE_RECORD_SIZE];
+    size_t batch_count;
+
+    while ((status = readTraceBatch(&reader, batch, TRACE_BATCH_SIZE, &batch_count)).code 
+                == ERR_SUCCESS && batch_count > 0) {
+        for (size_t r = 0; r < batch_count; r++) {
+            encodeTraceRecord(&batch[r], &records[r * BINARY_TRACE_RECORD_SIZE]);
+        }
+
+        if (fwrite(records, BINARY_TRACE_RECORD_SIZE, batch_count, stdout) != batch_count) {
+            status.code = ERR_FAILED_TO_WRITE_TRACE;
+            break;
+        }
+    }
+    ERR_CHECK(status);
+
+    if (fflush(stdout) != 0) {
+        status.code = ERR_FAILED_TO_WRITE_TRACE;
+        ERR_CHECK(status);
+    }
+
+    closeTraceReader(&reader);
+    return EXIT_SUCCESS;
+}
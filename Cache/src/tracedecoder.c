@@ -0,0 +1,440 @@
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file tracedecoder.c
+* @brief Contains functions to decompress gzip and zstd traces on a background thread.
+*
+* Compressed traces are decompressed by a dedicated decoder thread, so decompression
+* overlaps the simulation instead of running behind a pipe on the same core.
+*
+*   The process is as follows:
+*       1. The decoder reads a chunk of compressed bytes from the trace.
+*       2. The chunk is decompressed into the free block at the head of the ring.
+*       3. Full blocks are published to the reader, which copies them into its own
+*          buffer and releases them.
+*       4. The decoder waits only when every block in the ring is waiting to be read.
+*
+* Support for each format is compiled in when its library is available (HAVE_ZLIB,
+* HAVE_ZSTD), otherwise the trace is rejected with an error.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "config.h"
+#include "error.h"
+#include "tracedecoder.h"
+
+/*==================================================================================================
+    Static Helpers
+==================================================================================================*/
+
+#if defined(HAVE_ZLIB) || defined(HAVE_ZSTD)
+
+/**
+ * @brief Reads the next chunk of compressed bytes, starting with the detected prefix
+ *
+ * @param decoder Pointer to the decoder reading the trace
+ * @param chunk Output buffer of TRACE_COMPRESSED_CHUNK_SIZE bytes
+ * @return ssize_t Number of bytes read, 0 at end of file, -1 on error
+ */
+static ssize_t readCompressed(trace_decoder_s* decoder, uint8_t* chunk) {
+    if (decoder->prefix_position < decoder->prefix_length) {
+        size_t length = decoder->prefix_length - decoder->prefix_position;
+        if (length > TRACE_COMPRESSED_CHUNK_SIZE) length = TRACE_COMPRESSED_CHUNK_SIZE;
+        memcpy(chunk, decoder->prefix + decoder->prefix_position, length);
+        decoder->prefix_position += length;
+        return (ssize_t)length;
+    }
+
+    ssize_t bytes_read;
+    do {
+        bytes_read = read(decoder->fd, chunk, TRACE_COMPRESSED_CHUNK_SIZE);
+    } while (bytes_read == -1 && errno == EINTR);
+    return bytes_read;
+}
+
+/**
+ * @brief Waits for the block at the head of the ring to be free
+ *
+ * @param decoder Pointer to the decoder filling the ring
+ * @return uint8_t* Block to fill, or NULL if the reader stopped the decoder
+ */
+static uint8_t* acquireBlock(trace_decoder_s* decoder) {
+    pthread_mutex_lock(&decoder->lock);
+    while (decoder->count == TRACE_RING_BLOCKS && !decoder->stopping) {
+        pthread_cond_wait(&decoder->not_full, &decoder->lock);
+    }
+    uint8_t* block = decoder->stopping ? NULL : decoder->blocks[decoder->head];
+    pthread_mutex_unlock(&decoder->lock);
+    return block;
+}
+
+/**
+ * @brief Hands the block at the head of the ring to the reader
+ *
+ * @param decoder Pointer to the decoder filling the ring
+ * @param length Number of bytes decompressed into the block
+ */
+static void publishBlock(trace_decoder_s* decoder, size_t length) {
+    pthread_mutex_lock(&decoder->lock);
+    decoder->lengths[decoder->head] = length;
+    decoder->head = (decoder->head + 1) % TRACE_RING_BLOCKS;
+    decoder->count++;
+    pthread_cond_signal(&decoder->not_empty);
+    pthread_mutex_unlock(&decoder->lock);
+}
+#endif
+
+/**
+ * @brief Marks the end of decoding, recording the first error if any
+ *
+ * @param decoder Pointer to the decoder filling the ring
+ * @param error Error code the decoder finished with
+ */
+static void finishDecoding(trace_decoder_s* decoder, error_code_s error) {
+    pthread_mutex_lock(&decoder->lock);
+    decoder->error = error;
+    decoder->finished = true;
+    pthread_cond_signal(&decoder->not_empty);
+    pthread_mutex_unlock(&decoder->lock);
+}
+
+#ifdef HAVE_ZLIB
+/**
+ * @brief Decompresses a gzip trace (including concatenated members) into the ring
+ *
+ * @param decoder Pointer to the decoder filling the ring
+ * @param chunk Compressed input buffer of TRACE_COMPRESSED_CHUNK_SIZE bytes
+ * @return error_code_s ERR_SUCCESS, or the error that ended decoding
+ */
+static error_code_s decodeGzip(trace_decoder_s* decoder, uint8_t* chunk) {
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) // 15 bit window, gzip header detection
+        return ERR_TRACE_DECODER_FAILED;
+
+    uint8_t* block = acquireBlock(decoder);
+    stream.next_out = block;
+    stream.avail_out = TRACE_BLOCK_SIZE;
+    bool end_of_member = false;
+    error_code_s error = ERR_SUCCESS;
+
+    while (block != NULL) {
+        // Refill the compressed input, ending once every member is complete
+        if (stream.avail_in == 0) {
+            ssize_t bytes_read = readCompressed(decoder, chunk);
+            if (bytes_read < 0) {
+                error = ERR_FAILED_TO_READ_TRACE;
+                break;
+            }
+            if (bytes_read == 0) {
+                if (!end_of_member) error = ERR_FAILED_TO_DECOMPRESS_TRACE; // truncated
+                break;
+            }
+            stream.next_in = chunk;
+            stream.avail_in = (uInt)bytes_read;
+        }
+
+        // Start the next member once the previous one is done
+        if (end_of_member) {
+            inflateReset(&stream);
+            end_of_member = false;
+        }
+
+        int result = inflate(&stream, Z_NO_FLUSH);
+        if (result == Z_STREAM_END) {
+            end_of_member = true;
+        } else if (result != Z_OK && result != Z_BUF_ERROR) {
+            error = ERR_FAILED_TO_DECOMPRESS_TRACE;
+            break;
+        }
+
+        if (stream.avail_out == 0) {
+            publishBlock(decoder, TRACE_BLOCK_SIZE);
+            block = acquireBlock(decoder);
+            stream.next_out = block;
+            stream.avail_out = TRACE_BLOCK_SIZE;
+        }
+    }
+
+    // Publish the final partial block
+    if (block != NULL && stream.avail_out < TRACE_BLOCK_SIZE)
+        publishBlock(decoder, TRACE_BLOCK_SIZE - stream.avail_out);
+
+    inflateEnd(&stream);
+    return error;
+}
+#endif
+
+#ifdef HAVE_ZSTD
+/**
+ * @brief Decompresses a zstd trace (including concatenated frames) into the ring
+ *
+ * @param decoder Pointer to the decoder filling the ring
+ * @param chunk Compressed input buffer of TRACE_COMPRESSED_CHUNK_SIZE bytes
+ * @return error_code_s ERR_SUCCESS, or the error that ended decoding
+ */
+static error_code_s decodeZstd(trace_decoder_s* decoder, uint8_t* chunk) {
+    ZSTD_DCtx* context = ZSTD_createDCtx();
+    if (context == NULL)
+        return ERR_TRACE_DECODER_FAILED;
+
+    uint8_t* block = acquireBlock(decoder);
+    ZSTD_inBuffer input = { chunk, 0, 0 };
+    ZSTD_outBuffer output = { block, TRACE_BLOCK_SIZE, 0 };
+    size_t frame_remaining = 0; // 0 once the current frame is complete
+    error_code_s error = ERR_SUCCESS;
+
+    while (block != NULL) {
+        // Refill the compressed input, ending once every frame is complete
+        if (input.pos == input.size) {
+            ssize_t bytes_read = readCompressed(decoder, chunk);
+            if (bytes_read < 0) {
+                error = ERR_FAILED_TO_READ_TRACE;
+                break;
+            }
+            if (bytes_read == 0) {
+                if (frame_remaining != 0) error = ERR_FAILED_TO_DECOMPRESS_TRACE; // truncated
+                break;
+            }
+            input.size = (size_t)bytes_read;
+            input.pos = 0;
+        }
+
+        frame_remaining = ZSTD_decompressStream(context, &output, &input);
+        if (ZSTD_isError(frame_remaining)) {
+            error = ERR_FAILED_TO_DECOMPRESS_TRACE;
+            break;
+        }
+
+        if (output.pos == output.size) {
+            publishBlock(decoder, TRACE_BLOCK_SIZE);
+            block = acquireBlock(decoder);
+            output.dst = block;
+            output.pos = 0;
+        }
+    }
+
+    // Publish the final partial block
+    if (block != NULL && output.pos > 0)
+        publishBlock(decoder, output.pos);
+
+    ZSTD_freeDCtx(context);
+    return error;
+}
+#endif
+
+/**
+ * @brief Frees the prefix and ring blocks of a decoder
+ *
+ * @param decoder Pointer to the decoder to free
+ */
+static void freeDecoderBuffers(trace_decoder_s* decoder) {
+    for (size_t b = 0; b < TRACE_RING_BLOCKS; b++) {
+        free(decoder->blocks[b]);
+        decoder->blocks[b] = NULL;
+    }
+    free(decoder->prefix);
+    decoder->prefix = NULL;
+}
+
+/**
+ * @brief Decompresses the trace into the ring until the end of the trace
+ *
+ * @param arg Pointer to the decoder structure
+ * @return void* Always NULL, errors are stored in the decoder
+ */
+static void* decoderThread(void* arg) {
+    trace_decoder_s* decoder = (trace_decoder_s*)arg;
+    error_code_s error = ERR_COMPRESSION_NOT_SUPPORTED;
+
+    uint8_t* chunk = (uint8_t*)malloc(TRACE_COMPRESSED_CHUNK_SIZE);
+    if (chunk == NULL) {
+        finishDecoding(decoder, ERR_TRACE_DECODER_FAILED);
+        return NULL;
+    }
+
+#ifdef HAVE_ZLIB
+    if (decoder->compression == TRACE_GZIP)
+        error = decodeGzip(decoder, chunk);
+#endif
+#ifdef HAVE_ZSTD
+    if (decoder->compression == TRACE_ZSTD)
+        error = decodeZstd(decoder, chunk);
+#endif
+
+    free(chunk);
+    finishDecoding(decoder, error);
+    return NULL;
+}
+
+/*==================================================================================================
+    Decoder Functions
+==================================================================================================*/
+
+/**
+ * @brief Detects the compression format from the first bytes of a trace
+ *
+ * @param data First bytes of the trace
+ * @param length Number of bytes available
+ * @return trace_compression_e Compression format of the trace
+ */
+trace_compression_e detectCompression(const uint8_t* data, size_t length) {
+    if (length >= GZIP_MAGIC_SIZE && memcmp(data, GZIP_MAGIC, GZIP_MAGIC_SIZE) == 0)
+        return TRACE_GZIP;
+    if (length >= ZSTD_MAGIC_SIZE && memcmp(data, ZSTD_MAGIC, ZSTD_MAGIC_SIZE) == 0)
+        return TRACE_ZSTD;
+    return TRACE_UNCOMPRESSED;
+}
+
+/**
+ * @brief Starts a decoder thread on a compressed trace
+ *
+ * @param decoder Pointer to decoder structure to initialize
+ * @param fd File descriptor of the compressed trace
+ * @param compression Compression format of the trace
+ * @param prefix Compressed bytes already read from fd
+ * @param prefix_length Number of bytes in prefix
+ * @return error_status_s Error status structure indicating success or failure
+ */
+error_status_s startTraceDecoder(trace_decoder_s* decoder, int fd, trace_compression_e compression,
+                                 const uint8_t* prefix, size_t prefix_length) {
+    error_status_s status = {
+        .domain = ERROR_REQUEST,
+        .code = ERR_SUCCESS
+    };
+
+    memset(decoder, 0, sizeof(*decoder));
+    decoder->fd = fd;
+    decoder->compression = compression;
+
+    // Reject formats that were not compiled in before starting anything
+#ifndef HAVE_ZLIB
+    if (compression == TRACE_GZIP) status.code = ERR_COMPRESSION_NOT_SUPPORTED;
+#endif
+#ifndef HAVE_ZSTD
+    if (compression == TRACE_ZSTD) status.code = ERR_COMPRESSION_NOT_SUPPORTED;
+#endif
+    if (status.code != ERR_SUCCESS) {
+        status.request.format = compressionName(compression);
+        return status;
+    }
+
+    // Memory allocation for the prefix and the ring
+    decoder->prefix = (uint8_t*)malloc(prefix_length);
+    bool allocated = (decoder->prefix != NULL || prefix_length == 0);
+    for (size_t b = 0; b < TRACE_RING_BLOCKS; b++) {
+        decoder->blocks[b] = (uint8_t*)malloc(TRACE_BLOCK_SIZE);
+        allocated = allocated && (decoder->blocks[b] != NULL);
+    }
+    if (!allocated) {
+        freeDecoderBuffers(decoder);
+        status.code = ERR_TRACE_DECODER_FAILED;
+        return status;
+    }
+    memcpy(decoder->prefix, prefix, prefix_length);
+    decoder->prefix_length = prefix_length;
+
+    pthread_mutex_init(&decoder->lock, NULL);
+    pthread_cond_init(&decoder->not_empty, NULL);
+    pthread_cond_init(&decoder->not_full, NULL);
+    if (pthread_create(&decoder->thread, NULL, decoderThread, decoder) != 0) {
+        pthread_mutex_destroy(&decoder->lock);
+        pthread_cond_destroy(&decoder->not_empty);
+        pthread_cond_destroy(&decoder->not_full);
+        freeDecoderBuffers(decoder);
+        status.code = ERR_TRACE_DECODER_FAILED;
+        return status;
+    }
+
+    return status;
+}
+
+/**
+ * @brief Waits for the next decompressed block
+ *
+ * @param decoder Pointer to a running decoder
+ * @param data Output pointer to the block's data
+ * @param length Output for the number of bytes in the block
+ * @return bool True if a block is available, false once the trace is fully decoded
+ */
+bool nextDecodedBlock(trace_decoder_s* decoder, const uint8_t** data, size_t* length) {
+    pthread_mutex_lock(&decoder->lock);
+    while (decoder->count == 0 && !decoder->finished) {
+        pthread_cond_wait(&decoder->not_empty, &decoder->lock);
+    }
+    bool available = (decoder->count > 0);
+    if (available) {
+        *data = decoder->blocks[decoder->tail];
+        *length = decoder->lengths[decoder->tail];
+    }
+    pthread_mutex_unlock(&decoder->lock);
+    return available;
+}
+
+/**
+ * @brief Returns the block obtained by nextDecodedBlock() to the decoder
+ *
+ * @param decoder Pointer to a running decoder
+ */
+void releaseDecodedBlock(trace_decoder_s* decoder) {
+    pthread_mutex_lock(&decoder->lock);
+    decoder->tail = (decoder->tail + 1) % TRACE_RING_BLOCKS;
+    decoder->count--;
+    pthread_cond_signal(&decoder->not_full);
+    pthread_mutex_unlock(&decoder->lock);
+}
+
+/**
+ * @brief Stops the decoder thread and frees its ring
+ *
+ * @param decoder Pointer to a started decoder
+ * @return error_code_s First error hit by the decoder (ERR_SUCCESS if none)
+ */
+error_code_s stopTraceDecoder(trace_decoder_s* decoder) {
+    pthread_mutex_lock(&decoder->lock);
+    decoder->stopping = true;
+    pthread_cond_signal(&decoder->not_full);
+    pthread_mutex_unlock(&decoder->lock);
+    pthread_join(decoder->thread, NULL);
+
+    pthread_mutex_destroy(&decoder->lock);
+    pthread_cond_destroy(&decoder->not_empty);
+    pthread_cond_destroy(&decoder->not_full);
+    freeDecoderBuffers(decoder);
+    return decoder->error;
+}
+
+/**
+ * @brief Retrieves the printable name of a compression format
+ *
+ * @param compression Compression format
+ * @return const char* Name of the format
+ */
+const char* compressionName(trace_compression_e compression) {
+    switch (compression) {
+        case TRACE_GZIP: return "gzip";
+        case TRACE_ZSTD: return "zstd";
+        default:         return "uncompressed";
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef TRACEDECODER_H
+#define TRACEDECODER_H
+
+/***************************************************************************************************
+* @project: Direct-Mapped Write-Back Cache [Trace Driven Simulation]
+****************************************************************************************************
+* @file tracedecoder.h
+* @brief Contains structures and function declarations related to decompressing traces
+         on a background thread.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <pthread.h>
+
+#include "config.h"
+#include "error.h"
+
+/*==================================================================================================
+    Compression Formats
+==================================================================================================*/
+
+#define GZIP_MAGIC "\x1f\x8b"
+#define GZIP_MAGIC_SIZE 2
+#define ZSTD_MAGIC "\x28\xb5\x2f\xfd"
+#define ZSTD_MAGIC_SIZE 4
+
+typedef enum {
+    TRACE_UNCOMPRESSED,
+    TRACE_GZIP,
+    TRACE_ZSTD
+} trace_compression_e;
+
+/*==================================================================================================
+    Decoder Structures
+==================================================================================================*/
+
+/*
+ * The decoder thread fills blocks of decompressed trace data and hands them to the reader
+ * through a ring. The decoder writes the block at head while the reader consumes the
+ * block at tail, so each side only waits when the ring is full or empty.
+ */
+typedef struct {
+    pthread_t thread;
+    int fd;
+    trace_compression_e compression;
+
+    // Compressed bytes already read from fd while detecting the format
+    uint8_t* prefix;
+    size_t prefix_length;
+    size_t prefix_position; // prefix bytes already handed to the decompressor
+
+    // Ring of decompressed blocks
+    uint8_t* blocks[TRACE_RING_BLOCKS];
+    size_t lengths[TRACE_RING_BLOCKS];
+    size_t head;            // next block to fill
+    size_t tail;            // next block to consume
+    size_t count;           // filled blocks
+
+    // Synchronization between the decoder and the reader
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    bool finished;          // set by the decoder once every block is published
+    bool stopping;          // set by the reader to end decoding early
+    error_code_s error;     // first error hit by the decoder
+} trace_decoder_s;
+
+/*==================================================================================================
+    Decoder Function Declarations
+==================================================================================================*/
+
+/**
+ * @brief Detects the compression format from the first bytes of a trace
+ *
+ * @param data First bytes of the trace
+ * @param length Number of bytes available
+ * @return trace_compression_e Compression format of the trace
+ */
+trace_compression_e detectCompression(const uint8_t* data, size_t length);
+
+error_status_s startTraceDecoder(trace_decoder_s* decoder, int fd, trace_compression_e compression,
+                                 const uint8_t* prefix, size_t prefix_length);
+
+bool nextDecodedBlock(trace_decoder_s* decoder, const uint8_t** data, size_t* length);
+
+void releaseDecodedBlock(trace_decoder_s* decoder);
+
+error_code_s stopTraceDecoder(trace_decoder_s* decoder);
+
+const char* compressionName(trace_compression_e compression);
+
+#endif // TRACEDECODER_H
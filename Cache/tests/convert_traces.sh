@@ -0,0 +1,31 @@
+#!/bin/bash
+
+# CONVERT -------------------------------------
+# Converts every textual trace into the packed binary trace format (<trace>.bin)
+
+# Filepaths
+executable_dir='../src/'
+source_dir='../src/'
+tests_dir='../tests/'
+traces_dir='../traces/'
+
+# Compile environment
+echo "Compiling..."
+cd "${source_dir}"
+make all
+cd "${tests_dir}"
+
+# Trace file setup
+trace=('126.gcc' '129.compress' '132.ijpeg' '134.perl' '099.go' '124.m88ksim')
+
+# Concatenate path to converter
+converter_path="${executable_dir}trace_convert"
+
+for trace in "${trace[@]}"; do
+  trace_path="${traces_dir}${trace}" # Concatenate the path to the trace file
+  echo "Converting trace $trace..."
+  ./"${converter_path}" < $trace_path > "${trace_path}.bin"
+  echo "    $(wc -c < $trace_path) bytes -> $(wc -c < ${trace_path}.bin) bytes"
+done
+
+echo -e "\nALL FINISHED!\n"
@@ -0,0 +1,44 @@
+#!/bin/bash
+
+# STACK DISTANCE -----------------------------
+# Prints the LRU miss-ratio curve of every trace in a single pass, covering every
+# L1/L2/L3 size from run2.sh (and every other power of two size) at once
+
+# Filepaths
+executable_dir='../src/'
+source_dir='../src/'
+tests_dir='../tests/'
+traces_dir='../traces/'
+
+# Clean up and compile environment
+echo "Cleaning up environment and compiling..."
+cd "${source_dir}"
+make clean
+make all
+clear
+cd "${tests_dir}"
+
+# Fixed arguments (same as run2.sh)
+cache_type='D'
+line_sizes=('4' '8')
+
+# Trace file setup
+trace=('126.gcc' '129.compress' '132.ijpeg' '134.perl' '099.go' '124.m88ksim')
+
+echo "Starting stack distance runs..."
+
+# Concatenate path to executable
+executable_path="${executable_dir}cache_exec"
+
+# Single pass over each trace for all cache sizes and line sizes
+for trace in "${trace[@]}"; do
+  trace_path="${traces_dir}${trace}" # Concatenate the path to the trace file
+  echo -e "\nXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX\n"
+  echo -e "\t\t\t Testing trace $trace..."
+  echo -e "\nXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX\n"
+  ./"${executable_path}" -d $cache_type "${line_sizes[@]}" < $trace_path
+done
+
+echo "============================================================"
+echo -e "\n\t\t\t ALL FINISHED! \n"
+echo -e "============================================================\n"
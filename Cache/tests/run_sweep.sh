@@ -0,0 +1,80 @@
+#!/bin/bash
+
+# SWEEP -------------------------------------
+# Runs every configuration from run1.sh and run2.sh in a single pass per trace
+
+# Filepaths
+executable_dir='../src/'
+source_dir='../src/'
+tests_dir='../tests/'
+traces_dir='../traces/'
+sweep_file='sweep.cfg'
+
+# Clean up and compile environment
+echo "Cleaning up environment and compiling..."
+cd "${source_dir}"
+make clean
+make all
+clear
+cd "${tests_dir}"
+
+# Trace file setup
+trace=('126.gcc' '129.compress' '132.ijpeg' '134.perl' '099.go' '124.m88ksim')
+
+# Part 1 configurations
+cache_types=('U' 'I' 'D')
+cache_sizes=('8' '16')
+line_sizes=('4' '8')
+
+# Part 2 configurations
+cache_type='D'
+line_size='8'
+L1_sizes=('4' '16')
+L2_sizes=('32' '64')
+L3_sizes=('256' '1024')
+
+# Write every configuration to the sweep file
+# Format: <cache_type> <line_size> <cache_layers> <L1_size> <L2_size> <L3_size>
+echo "# Generated by run_sweep.sh" > "${sweep_file}"
+for type in "${cache_types[@]}"; do
+  for size in "${cache_sizes[@]}"; do
+    for line in "${line_sizes[@]}"; do
+      echo "$type $line 1 $size 0 0" >> "${sweep_file}"
+    done
+  done
+done
+for L1_size in "${L1_sizes[@]}"; do
+  echo "$cache_type $line_size 1 $L1_size 0 0" >> "${sweep_file}"
+done
+for L1_size in "${L1_sizes[@]}"; do
+  for L2_size in "${L2_sizes[@]}"; do
+    echo "$cache_type $line_size 2 $L1_size $L2_size 0" >> "${sweep_file}"
+  done
+done
+for L1_size in "${L1_sizes[@]}"; do
+  for L2_size in "${L2_sizes[@]}"; do
+    for L3_size in "${L3_sizes[@]}"; do
+      echo "$cache_type $line_size 3 $L1_size $L2_size $L3_size" >> "${sweep_file}"
+    done
+  done
+done
+
+echo "Starting cache configuration sweep..."
+
+# Concatenate path to executable
+executable_path="${executable_dir}cache_exec"
+
+# Single pass over each trace for all configurations
+for trace in "${trace[@]}"; do
+  trace_path="${traces_dir}${trace}" # Concatenate the path to the trace file
+  echo -e "\nXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX\n"
+  echo -e "\t\t\t Testing trace $trace..."
+  echo -e "\nXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX\n"
+  ./"${executable_path}" -s "${sweep_file}" < $trace_path
+done
+
+rm -f "${sweep_file}"
+
+echo "============================================================"
+echo -e "\n\t\t\t ALL FINISHED! \n"
+echo -e "============================================================\n"
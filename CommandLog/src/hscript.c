@@ -14,15 +14,24 @@
  *
  * The program ensures proper cleanup of opened file descriptors
  * in error scenarios and executes the given command using a
- * child process.
+ * child process. In batch mode every line of a file is executed
+ * as its own command, with up to MAX_RUNNING running at once.
+ *
+ * The parent sleeps in epoll_wait() until a stream has data or a
+ * child exits (reported through a signalfd), and exits only once
+ * every child is reaped and every stream has reached EOF.
  *
  * Argument format:
  * ./hscript <program name> <arguments> ... <log_directory_name>
+ * ./hscript -b <batch_file> <log_directory_name>
  ******************************************************************/
 
+#define _GNU_SOURCE // tee(), splice() and pipe2()
+
 #include <sys/stat.h>
 #include <sys/types.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #include <stdio.h>
@@ -33,6 +42,7 @@
 #include "hscript.h"
 #include <stdarg.h>
 #include <errno.h>
+#include <signal.h>
 #include <stdbool.h>
 
 int log_fd; // File descriptor for file in which all error output will be logged
@@ -52,123 +62,30 @@ int main(int argc, char** argv) {
 
     // Initialize environment container
     Environmental_Info env_info = {0};
-    Streams* streams = &env_info.streams; // pointer used for visual clarity after forking
 
     // Build the environment, and catch any errors
     int env_status;
     CEC(env_status = buildEnvironment(&env_info, argc, &argv),
                         printError(1, "[main] - Failed to setup environment - Code: %d", env_status), 
-                        destroyFDManager(env_info.fd_mngr));
-
-    // Fork child for command execution
-    pid_t pid = fork();
-
-    // Catch forking error
-    if (pid < 0) {
-        printError(1, "[main] - Error while forking - Info: %s", strerror(errno));
-        destroyFDManager(env_info.fd_mngr);
-        return ERR_FORKING;
-    }
-
-    // Child (executes command)
-    else if (pid == 0) {
-
-        // Change global for error prints
-        proc_t = CHILD;
-
-        // Cleanup uneccesary file decriptors
-        int unnecessary_fds[] = {
-            streams->input.pipe[1],
-            streams->output.pipe[0],
-            streams->error.pipe[0],
-            streams->input.fd,
-            streams->output.fd,
-            streams->error.fd}; 
-        for (unsigned int i = 0; i < sizeof(unnecessary_fds)/sizeof(int); i++) {
-            CEC(closeManagedFD(unnecessary_fds[i], env_info.fd_mngr), 
-                    printError(0, "[main] - Unable to close unecessary pipe ends"),
-                    destroyFDManager(env_info.fd_mngr));
-        }
-
-        // Reroutes childs standard input/output to pipes
-        CEC(redirectStreams(&env_info.streams), 
-                printError(0, "[main] - Unable to redirect streams"),
-                destroyFDManager(env_info.fd_mngr));
-
-        // Exec into designated command
-        execvp(env_info.command, argv);
-        printError(1, "[main] - Execvp failed to execute command - Info: %s", strerror(errno));
+                        destroyEnvironment(&env_info));
+
+    // Start the first commands, the rest start as these finish
+    proc_t = PARENT;
+    while (env_info.started_count < env_info.command_count && 
+           env_info.started_count < MAX_RUNNING) {
+        int index = env_info.started_count++;
+        CEC(startCommand(&env_info, &env_info.commands[index], index),
+                printError(0, "[main] - Unable to start command"),
+                destroyEnvironment(&env_info));
     }
 
-    // Parent (monitors streams)
-    else {
-
-        // Change global for error prints
-        proc_t = PARENT;
-
-        // Cleanup uneccesary pipe ends
-        int unnecessary_fds[] = {
-            streams->input.pipe[0],
-            streams->output.pipe[1],
-            streams->error.pipe[1]};
-        for (unsigned int i = 0; i < sizeof(unnecessary_fds)/sizeof(int); i++) {
-            CEC(closeManagedFD(unnecessary_fds[i], env_info.fd_mngr), 
-                    printError(0, "[main] - Unable to close unecessary pipe ends"),
-                    destroyFDManager(env_info.fd_mngr));
-        }
-
-        // Selection variables
-        int status = 0;
-        fd_set readfds;
-
-        // Continue checking fds until child has finished executing
-        while (waitpid(pid, &status, WNOHANG) == 0) {
-
-            // Clear fd_set for reselection
-            FD_ZERO(&readfds);
-
-            // Monitor stdin, stdout, and stderr
-            FD_SET(STDIN_FILENO, &readfds);
-            FD_SET(streams->output.pipe[0], &readfds);
-            FD_SET(streams->error.pipe[0], &readfds);
-            const int FD_BOUND = (streams->error.pipe[1] + 1);
-
-            // Attempt to monitor stream descriptors
-            CEC(select(FD_BOUND, &readfds, NULL, NULL, NULL) <= 0,
-                    printError(1, "[main] - Failed to monitor file descriptors - Info: %s", strerror(errno)),
-                    destroyFDManager(env_info.fd_mngr));
-
-            // Stdin ready to read
-            if (FD_ISSET(STDIN_FILENO, &readfds)) {
-                transferData(STDIN_FILENO, 
-                             streams->input.fd, 
-                             streams->input.pipe[1],  
-                             streams->input.path, 
-                             streams->input.pipe);
-            }
-
-            // Command output ready to read
-            if (FD_ISSET(streams->output.pipe[0], &readfds)) {
-                transferData(streams->output.pipe[0], 
-                             streams->output.fd, 
-                             STDOUT_FILENO, 
-                             streams->output.path, 
-                             NULL);
-            }
-
-            // Command error ready to read
-            if (FD_ISSET(streams->error.pipe[0], &readfds)) {
-                transferData(streams->error.pipe[0], 
-                             streams->error.fd,
-                             STDERR_FILENO,
-                             streams->error.path, 
-                             NULL);
-            }
-        }
-    }
+    // Log the streams until every command has finished
+    CEC(runEventLoop(&env_info),
+            printError(0, "[main] - Event loop failed"),
+            destroyEnvironment(&env_info));
 
     // Exit program
-    destroyFDManager(env_info.fd_mngr);
+    destroyEnvironment(&env_info);
     return SUCCESS;
 }
 
@@ -177,7 +94,8 @@ int main(int argc, char** argv) {
 //==================================================================
 
 /**
- * @brief Sets up environment including directories, logfiles, and pipe creation
+ * @brief Sets up environment including the log directory, the commands
+ * to run, and the event loop monitoring them
  * 
  * @param env_info Struct containing information about the file environment
  * @param argc Number of arguments passed to program
@@ -192,43 +110,54 @@ int buildEnvironment(Environmental_Info* env_info, int argc, char*** argv) {
     }
     
     // Parse through command line arguments
-    CE(parseArguments(argc, argv, &env_info->command, &env_info->dir_name));
+    CE(parseArguments(argc, argv, env_info));
 
     // Create directory to hold log files
     CE(createDirectory((const char*)env_info->dir_name));
 
-    // Open new files for logging stdin stdout and stderr
-    CE(initLogFiles((const char*)env_info->dir_name, env_info->fd_mngr, &env_info->streams));
-
-    // Create pipes for each stream connected to new log files
-    CE(initPipes(env_info->fd_mngr, &env_info->streams));
+    // Create the epoll instance and the signalfd reporting child exits
+    CE(initEventLoop(env_info));
 
     return SUCCESS;
 }
 
 /**
  * @brief Parses command line arguments for the required command and directory.
- * Modifies the argv array to be compatible for the execvp call.
+ * Modifies the argv array to be compatible for the execvp call. In batch mode
+ * the commands are read from the batch file instead.
  * 
  * @param argc Number of arguments passed to program
  * @param argv Array of arguments in form of character arrays
- * @param command Pointer to command string
- * @param dirName Pointer to directory name string
+ * @param env_info Struct receiving the commands and directory name
  * @return int 0 on success : (-) on error
  */
-int parseArguments(int argc, char*** argv, char** command, char** dirName) {
-    if (argc < 3) {
+int parseArguments(int argc, char*** argv, Environmental_Info* env_info) {
+    // Dereference argv for simplicity
+    char** args = *argv;
+
+    if (argc < 3 || (strcmp(args[1], BATCH_FLAG) == 0 && argc != 4)) {
         printError(0, "Invalid argument count\n" 
-                       "Usage: ./hscript <program name> <optional_arguments> <directory>");
+                       "Usage: ./hscript <program name> <optional_arguments> <directory>\n"
+                       "       ./hscript -b <batch_file> <directory>");
         return ERR_INVALID_USAGE;
     }
 
-    // Dereference argv for simplicity
-    char** args = *argv;
+    // Retrieve directory name
+    env_info->dir_name = args[argc - 1];
 
-    // Retrieve arguments
-    *command = args[1];
-    *dirName = args[argc - 1];
+    // Batch mode reads a command from each line of the file
+    if (strcmp(args[1], BATCH_FLAG) == 0) {
+        env_info->batch = true;
+        return parseBatchFile(args[2], env_info);
+    }
+
+    // Allocate the single command
+    env_info->commands = (Command_Info*)calloc(1, sizeof(Command_Info));
+    if (!env_info->commands) {
+        printError(1, "[parseArguments] - Could not allocate command - Info: %s", strerror(errno));
+        return ERR_COMMAND_ALLOCATION;
+    }
+    env_info->command_count = 1;
 
     // Modify argv for execvp call in child
     for (int i = 0; i < argc - 1; i++) {
@@ -237,10 +166,126 @@ int parseArguments(int argc, char*** argv, char** command, char** dirName) {
 
     args[argc-2] = NULL; // remove directory name
     args[argc-1] = NULL; // set last argument to NULL for execvp
+    env_info->commands[0].argv = args;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Reads one command per line of a batch file. Arguments are
+ * separated by whitespace, and blank lines are skipped.
+ * 
+ * @param path Path to the batch file
+ * @param env_info Struct receiving the commands
+ * @return int 0 on success : (-) on error
+ */
+int parseBatchFile(const char* path, Environmental_Info* env_info) {
+    FILE* batch_file = fopen(path, "r");
+    if (!batch_file) {
+        printError(2, "[parseBatchFile] - Could not open batch file '%s' - Info: %s", path, strerror(errno));
+        return ERR_BATCH_FILE;
+    }
+
+    int capacity = 0;
+    char* line = NULL;
+    size_t line_size = 0;
+    while (getline(&line, &line_size, batch_file) != -1) {
+        // Split the line into arguments, with room for the NULL terminator
+        char** args = NULL;
+        int arg_count = 0;
+        for (char* arg = strtok(line, " \t\r\n"); arg; arg = strtok(NULL, " \t\r\n")) {
+            char** grown = (char**)realloc(args, (arg_count + 2) * sizeof(char*));
+            if (!grown) {
+                printError(1, "[parseBatchFile] - Could not allocate arguments - Info: %s", strerror(errno));
+                return ERR_COMMAND_ALLOCATION;
+            }
+            args = grown;
+            args[arg_count++] = arg;
+        }
+
+        // Skip blank lines, reusing their buffer
+        if (arg_count == 0) {
+            continue;
+        }
+        args[arg_count] = NULL;
+
+        // Grow the command array if necessary
+        if (env_info->command_count == capacity) {
+            capacity = capacity ? capacity * 2 : 8;
+            Command_Info* grown = (Command_Info*)realloc(env_info->commands, 
+                                                         capacity * sizeof(Command_Info));
+            if (!grown) {
+                printError(1, "[parseBatchFile] - Could not allocate commands - Info: %s", strerror(errno));
+                return ERR_COMMAND_ALLOCATION;
+            }
+            env_info->commands = grown;
+        }
+
+        // Store the command, which keeps the line its arguments point into
+        Command_Info* command = &env_info->commands[env_info->command_count++];
+        memset(command, 0, sizeof(Command_Info));
+        command->argv = args;
+        command->line = line;
+        line = NULL;
+        line_size = 0;
+    }
+    free(line);
+    fclose(batch_file);
+
+    if (env_info->command_count == 0) {
+        printError(1, "[parseBatchFile] - Batch file '%s' holds no commands", path);
+        return ERR_BATCH_FILE;
+    }
 
     return SUCCESS;
 }
 
+/**
+ * @brief Creates the epoll instance monitoring the streams, and a
+ * signalfd reporting child exits so the parent never polls waitpid().
+ * SIGCHLD is blocked before any child is forked so no exit is missed.
+ * 
+ * @param env_info Struct receiving the event loop descriptors
+ * @return int 0 on success : (-) on error
+ */
+int initEventLoop(Environmental_Info* env_info) {
+    // Deliver SIGCHLD through the signalfd only
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    if (sigprocmask(SIG_BLOCK, &mask, &env_info->old_mask) == -1) {
+        printError(1, "[initEventLoop] - Could not block SIGCHLD - Info: %s", strerror(errno));
+        return ERR_EVENT_LOOP;
+    }
+
+    // A command that stops reading its input is reported as EPIPE instead
+    signal(SIGPIPE, SIG_IGN);
+
+    env_info->signal_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (env_info->signal_fd == -1) {
+        printError(1, "[initEventLoop] - Could not create signalfd - Info: %s", strerror(errno));
+        return ERR_EVENT_LOOP;
+    }
+    CE(addFDToManager(env_info->signal_fd, env_info->fd_mngr));
+
+    env_info->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (env_info->epoll_fd == -1) {
+        printError(1, "[initEventLoop] - Could not create epoll instance - Info: %s", strerror(errno));
+        return ERR_EVENT_LOOP;
+    }
+    CE(addFDToManager(env_info->epoll_fd, env_info->fd_mngr));
+
+    // The signalfd is the only event without a stream
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = NULL};
+    if (epoll_ctl(env_info->epoll_fd, EPOLL_CTL_ADD, env_info->signal_fd, &event) == -1) {
+        printError(1, "[initEventLoop] - Could not monitor signalfd - Info: %s", strerror(errno));
+        return ERR_EVENT_LOOP;
+    }
+
+    env_info->stdin_polled = true;
+    return SUCCESS;
+}
+
 /**
  * @brief Opens the files in which the command's stdin, stderr, and stdout will be logged
  * 
@@ -313,6 +358,366 @@ int redirectStreams(Streams* streams) {
     return SUCCESS;
 }
 
+/**
+ * @brief Marks the streams whose data can be duplicated with tee(),
+ * which needs both the source and destination to be pipes. The
+ * command's side is always a pipe, so only the terminal side is checked.
+ * 
+ * @param streams Pointer to structs that contain stdin, stderr, and stdout stream info
+ */
+void detectSplicing(Streams* streams) {
+    streams->input.spliceable = isPipe(STDIN_FILENO);
+    streams->output.spliceable = isPipe(STDOUT_FILENO);
+    streams->error.spliceable = isPipe(STDERR_FILENO);
+}
+
+/**
+ * @brief Closes every managed fd and frees the commands
+ * 
+ * @param env_info Struct containing information about the file environment
+ * @return int 0 on success
+ */
+int destroyEnvironment(Environmental_Info* env_info) {
+    destroyFDManager(env_info->fd_mngr);
+    env_info->fd_mngr = NULL;
+
+    // Batch commands own their arguments and lines
+    if (env_info->batch) {
+        for (int i = 0; i < env_info->command_count; i++) {
+            free(env_info->commands[i].argv);
+            free(env_info->commands[i].line);
+        }
+    }
+    free(env_info->commands);
+    env_info->commands = NULL;
+
+    return SUCCESS;
+}
+
+//==================================================================
+//                         Command Control
+//==================================================================
+
+/**
+ * @brief Opens a command's log files and pipes, then forks the child
+ * that executes it. Every fd is opened close-on-exec, so the child only
+ * keeps the pipe ends redirected onto its standard streams.
+ * 
+ * @param env_info Struct containing information about the file environment
+ * @param command Command to be started
+ * @param index Position of the command, naming its log directory in batch mode
+ * @return int 0 on success : (-) on error
+ */
+int startCommand(Environmental_Info* env_info, Command_Info* command, int index) {
+    // Batch commands each log to a directory of their own
+    if (env_info->batch) {
+        snprintf(command->dir_name, PATH_MAX, "%s/%d", env_info->dir_name, index);
+        CE(createDirectory((const char*)command->dir_name));
+    } else {
+        snprintf(command->dir_name, PATH_MAX, "%s", env_info->dir_name);
+    }
+
+    // Open new files for logging stdin stdout and stderr
+    CE(initLogFiles((const char*)command->dir_name, env_info->fd_mngr, &command->streams));
+
+    // Create pipes for each stream connected to new log files
+    CE(initPipes(env_info->fd_mngr, &command->streams));
+
+    // Check which streams can be teed instead of copied
+    detectSplicing(&command->streams);
+
+    // Fork child for command execution
+    pid_t pid = fork();
+
+    // Catch forking error
+    if (pid < 0) {
+        printError(1, "[startCommand] - Error while forking - Info: %s", strerror(errno));
+        return ERR_FORKING;
+    }
+
+    // Child (executes command)
+    else if (pid == 0) {
+
+        // Change global for error prints
+        proc_t = CHILD;
+
+        // Restore the signal handling the parent changed
+        signal(SIGPIPE, SIG_DFL);
+        sigprocmask(SIG_SETMASK, &env_info->old_mask, NULL);
+
+        // Reroutes childs standard input/output to pipes
+        if (redirectStreams(&command->streams) != SUCCESS) {
+            exit(ERR_STREAM_REDIRECT);
+        }
+
+        // Exec into designated command
+        execvp(command->argv[0], command->argv);
+        printError(1, "[startCommand] - Execvp failed to execute command - Info: %s", strerror(errno));
+    }
+
+    // Parent (monitors streams)
+    command->pid = pid;
+    command->running = true;
+    env_info->running_count++;
+
+    // Cleanup uneccesary pipe ends
+    int unnecessary_fds[] = {
+        command->streams.input.pipe[0],
+        command->streams.output.pipe[1],
+        command->streams.error.pipe[1]};
+    for (unsigned int i = 0; i < sizeof(unnecessary_fds)/sizeof(int); i++) {
+        CE(closeManagedFD(unnecessary_fds[i], env_info->fd_mngr));
+    }
+
+    return watchStreams(env_info, command);
+}
+
+/**
+ * @brief Connects a started command's streams to their terminal side
+ * and adds them to the epoll instance. Batch commands share the
+ * terminal, so their input is closed instead of forwarded.
+ * 
+ * @param env_info Struct containing information about the file environment
+ * @param command Command whose streams are watched
+ * @return int 0 on success : (-) on error
+ */
+int watchStreams(Environmental_Info* env_info, Command_Info* command) {
+    Streams* streams = &command->streams;
+    streams->input.src_fd = STDIN_FILENO;
+    streams->input.dest_fd = streams->input.pipe[1];
+    streams->output.src_fd = streams->output.pipe[0];
+    streams->output.dest_fd = STDOUT_FILENO;
+    streams->error.src_fd = streams->error.pipe[0];
+    streams->error.dest_fd = STDERR_FILENO;
+
+    Stream_Info* stream_info[3] = {&streams->input, &streams->output, &streams->error};
+    for (int i = 0; i < 3; i++) {
+        stream_info[i]->command = command;
+        stream_info[i]->open = true;
+        command->open_streams++;
+    }
+
+    // Monitor the command's output and errors
+    for (int i = 1; i < 3; i++) {
+        struct epoll_event event = {.events = EPOLLIN, .data.ptr = stream_info[i]};
+        if (epoll_ctl(env_info->epoll_fd, EPOLL_CTL_ADD, stream_info[i]->src_fd, &event) == -1) {
+            printError(1, "[watchStreams] - Could not monitor stream - Info: %s", strerror(errno));
+            return ERR_EVENT_LOOP;
+        }
+    }
+
+    // Only a single command reads from stdin
+    if (env_info->batch) {
+        return closeStream(env_info, &streams->input);
+    }
+
+    // Never block on the input pipe, or a command busy writing output could stall hscript
+    if (fcntl(streams->input.pipe[1], F_SETFL, O_NONBLOCK) == -1) {
+        printError(1, "[watchStreams] - Could not make input pipe nonblocking - Info: %s", strerror(errno));
+        return ERR_EVENT_LOOP;
+    }
+
+    // Monitor stdin (regular files cannot be monitored, but are always readable)
+    struct epoll_event event = {.events = EPOLLIN, .data.ptr = &streams->input};
+    if (epoll_ctl(env_info->epoll_fd, EPOLL_CTL_ADD, STDIN_FILENO, &event) == -1) {
+        if (errno != EPERM) {
+            printError(1, "[watchStreams] - Could not monitor stdin - Info: %s", strerror(errno));
+            return ERR_EVENT_LOOP;
+        }
+        env_info->stdin_polled = false;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Sleeps until a stream has data or a child exits, and handles
+ * the events until every command has finished
+ * 
+ * @param env_info Struct containing information about the file environment
+ * @return int 0 on success : (-) on error
+ */
+int runEventLoop(Environmental_Info* env_info) {
+    struct epoll_event events[MAX_EVENTS];
+    Stream_Info* input = &env_info->commands[0].streams.input;
+
+    while (env_info->finished_count < env_info->command_count) {
+        // An unmonitored stdin is read on every pass, so don't sleep
+        bool read_stdin = !env_info->stdin_polled && input->open && !input->blocked;
+        int ready = epoll_wait(env_info->epoll_fd, events, MAX_EVENTS, read_stdin ? 0 : -1);
+        if (ready == -1) {
+            if (errno == EINTR) continue;  // Retry on interrupt
+            printError(1, "[runEventLoop] - Failed to wait for events - Info: %s", strerror(errno));
+            return ERR_EVENT_LOOP;
+        }
+
+        for (int i = 0; i < ready; i++) {
+            Stream_Info* stream = (Stream_Info*)events[i].data.ptr;
+            if (stream == NULL) {
+                CE(reapCommands(env_info));
+            } else if (stream->open) { // May have closed earlier in this pass
+                CE(serviceStream(env_info, stream));
+            }
+        }
+
+        if (read_stdin && input->open) {
+            CE(serviceStream(env_info, input));
+        }
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Moves the data waiting in a stream, closing the stream at EOF.
+ * Input that the command's pipe can't take yet waits for the pipe to
+ * drain, instead of blocking the whole loop.
+ * 
+ * @param env_info Struct containing information about the file environment
+ * @param stream Stream whose source (or blocked input pipe) is ready
+ * @return int 0 on success : (-) on error
+ */
+int serviceStream(Environmental_Info* env_info, Stream_Info* stream) {
+    // A blocked input's pipe has drained, so forward what is pending first
+    int status = stream->blocked ? flushInput(stream) : transferData(stream);
+
+    if (status == STREAM_EOF) {
+        return closeStream(env_info, stream);
+    } else if (status == STREAM_BLOCKED && !stream->blocked) {
+        return blockInput(env_info, stream, true);
+    } else if (status == SUCCESS && stream->blocked) {
+        return blockInput(env_info, stream, false);
+    }
+    return (status == STREAM_BLOCKED) ? SUCCESS : status;
+}
+
+/**
+ * @brief Switches the input between waiting for stdin to be readable,
+ * and waiting for the command's input pipe to be writable
+ * 
+ * @param env_info Struct containing information about the file environment
+ * @param stream Input stream of the command
+ * @param blocked Whether the input pipe is full
+ * @return int 0 on success : (-) on error
+ */
+int blockInput(Environmental_Info* env_info, Stream_Info* stream, bool blocked) {
+    struct epoll_event event = {.events = blocked ? EPOLLOUT : EPOLLIN, .data.ptr = stream};
+    int old_fd = blocked ? stream->src_fd : stream->dest_fd;
+    int new_fd = blocked ? stream->dest_fd : stream->src_fd;
+    bool old_monitored = !blocked || env_info->stdin_polled;
+    bool new_monitored = blocked || env_info->stdin_polled;
+
+    if ((old_monitored && epoll_ctl(env_info->epoll_fd, EPOLL_CTL_DEL, old_fd, NULL) == -1) ||
+        (new_monitored && epoll_ctl(env_info->epoll_fd, EPOLL_CTL_ADD, new_fd, &event) == -1)) {
+        printError(1, "[blockInput] - Could not switch monitored input fd - Info: %s", strerror(errno));
+        return ERR_EVENT_LOOP;
+    }
+
+    stream->blocked = blocked;
+    return SUCCESS;
+}
+
+/**
+ * @brief Closes a stream's source so it is no longer monitored. For
+ * input, the pipe to the command is closed so the command sees EOF.
+ * 
+ * @param env_info Struct containing information about the file environment
+ * @param stream Stream to be closed
+ * @return int 0 on success : (-) on error
+ */
+int closeStream(Environmental_Info* env_info, Stream_Info* stream) {
+    Command_Info* command = stream->command;
+    stream->open = false;
+    command->open_streams--;
+
+    // Stop monitoring the source (batch input and unmonitored stdin were never added)
+    int monitored_fd = stream->blocked ? stream->dest_fd : stream->src_fd;
+    bool monitored = !isInput(stream) || stream->blocked || (!env_info->batch && env_info->stdin_polled);
+    if (monitored && epoll_ctl(env_info->epoll_fd, EPOLL_CTL_DEL, monitored_fd, NULL) == -1) {
+        printError(1, "[closeStream] - Could not stop monitoring stream - Info: %s", strerror(errno));
+        return ERR_EVENT_LOOP;
+    }
+
+    // Close the parent's pipe end (stdin itself stays open)
+    CE(closeManagedFD(isInput(stream) ? stream->pipe[1] : stream->pipe[0], env_info->fd_mngr));
+    free(stream->pending);
+    stream->pending = NULL;
+
+    return finishCommand(env_info, command);
+}
+
+/**
+ * @brief Reaps every child that has exited since the signalfd was last
+ * read. A finished command no longer needs its input, so it is closed.
+ * 
+ * @param env_info Struct containing information about the file environment
+ * @return int 0 on success : (-) on error
+ */
+int reapCommands(Environmental_Info* env_info) {
+    // Empty the signalfd (several exits may share one signal)
+    struct signalfd_siginfo info;
+    while (read(env_info->signal_fd, &info, sizeof(info)) > 0) {
+    }
+
+    // Reap every exited child
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        for (int i = 0; i < env_info->started_count; i++) {
+            Command_Info* command = &env_info->commands[i];
+            if (command->running && command->pid == pid) {
+                command->running = false;
+                env_info->running_count--;
+                if (command->streams.input.open) {
+                    CE(closeStream(env_info, &command->streams.input));
+                } else {
+                    CE(finishCommand(env_info, command));
+                }
+                break;
+            }
+        }
+    }
+
+    if (pid == -1 && errno != ECHILD) {
+        printError(1, "[reapCommands] - Failed to reap children - Info: %s", strerror(errno));
+        return ERR_WAIT;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Closes a command's log files once it has been reaped and its
+ * streams have reached EOF, then starts the next batch command
+ * 
+ * @param env_info Struct containing information about the file environment
+ * @param command Command that may have finished
+ * @return int 0 on success : (-) on error
+ */
+int finishCommand(Environmental_Info* env_info, Command_Info* command) {
+    if (command->running || command->open_streams > 0) {
+        return SUCCESS;
+    }
+
+    // Release the command's log files
+    int log_fds[] = {
+        command->streams.input.fd,
+        command->streams.output.fd,
+        command->streams.error.fd};
+    for (unsigned int i = 0; i < sizeof(log_fds)/sizeof(int); i++) {
+        CE(closeManagedFD(log_fds[i], env_info->fd_mngr));
+    }
+    env_info->finished_count++;
+
+    // Take the finished command's place
+    if (env_info->started_count < env_info->command_count) {
+        int index = env_info->started_count++;
+        CE(startCommand(env_info, &env_info->commands[index], index));
+    }
+
+    return SUCCESS;
+}
+
 //==================================================================
 //                       Directory Management
 //==================================================================
@@ -330,7 +735,7 @@ int createFile(const char* path, mode_t mode, FD_Manager* fd_mngr) {
     }
 
     // Open file and assign fd
-    int fd = open(path, O_CREAT | O_WRONLY | O_TRUNC, mode);
+    int fd = open(path, O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, mode);
 
     // Catch error
     if (fd == -1) {
@@ -353,7 +758,7 @@ int createFile(const char* path, mode_t mode, FD_Manager* fd_mngr) {
  */
 int createPipe(int* pipeFD, FD_Manager* fd_mngr) {
     // Attempt to make pipe, and catch errors
-    if (pipe(pipeFD) != 0) {
+    if (pipe2(pipeFD, O_CLOEXEC) != 0) {
         printError(1, "[createPipe] - Could not create pipe - Info: %s", strerror(errno));
         return ERR_PIPE_CREATE;
     }
@@ -398,6 +803,15 @@ FD_Manager* allocateFDManager() {
         return NULL;
     }
 
+    // Allocate the fd array, which grows as fds are added
+    fd_mngr->fd_capacity = FD_MANAGER_CAPACITY;
+    fd_mngr->fd_arr = (int*)malloc(fd_mngr->fd_capacity * sizeof(int));
+    if (!fd_mngr->fd_arr) {
+        printError(1, "[allocateFDManager] - Could not allocate space for FD array - Info: %s", strerror(errno));
+        free(fd_mngr);
+        return NULL;
+    }
+
     // Zero out fd manager array and initialize count
     zeroFDArray(fd_mngr);
     
@@ -413,6 +827,7 @@ FD_Manager* allocateFDManager() {
 int destroyFDManager(FD_Manager* fd_mngr){
     if (fd_mngr) {
         cleanupFDManager(fd_mngr);
+        free(fd_mngr->fd_arr);
         free(fd_mngr);
         return 0;
     }
@@ -425,7 +840,7 @@ int destroyFDManager(FD_Manager* fd_mngr){
  * @param fd_mngr Fd manager struct to be zero'd out
  */
 void zeroFDArray(FD_Manager* fd_mngr) {
-    for (int i = 0; i < MAX_FDS; i++){
+    for (int i = 0; i < fd_mngr->fd_capacity; i++){
         fd_mngr->fd_arr[i] = -1;
     }
     fd_mngr->fd_counter = 0;
@@ -443,9 +858,21 @@ int addFDToManager(int fd, FD_Manager* fd_mngr) {
     if (fd == -1) {
         printError(0, "[addFDToManager] - Cannot add fd of default value '-1'");
         return ERR_BAD_FD;
-    } else if (fd_mngr->fd_counter >= MAX_FDS) {
-        printError(1, "[addFDToManager] Cannot add fd '%d' as FD array is already full", fd);
-        return ERR_FD_ARRAY_FULL;
+    }
+
+    // Double the fd array once it is full
+    if (fd_mngr->fd_counter >= fd_mngr->fd_capacity) {
+        int capacity = fd_mngr->fd_capacity * 2;
+        int* grown = (int*)realloc(fd_mngr->fd_arr, capacity * sizeof(int));
+        if (!grown) {
+            printError(1, "[addFDToManager] Cannot add fd '%d' as FD array could not grow", fd);
+            return ERR_FD_ARRAY_FULL;
+        }
+        for (int i = fd_mngr->fd_capacity; i < capacity; i++) {
+            grown[i] = -1;
+        }
+        fd_mngr->fd_arr = grown;
+        fd_mngr->fd_capacity = capacity;
     }
 
     // Add fd to list
@@ -566,63 +993,252 @@ void printError(int arg_count, char *format, ...) {
 }
 
 /**
- * @brief Writes data to both a log file, and destination fd
+ * @brief Writes data to both a log file, and destination fd. Pipes
+ * are teed in the kernel when possible, otherwise up to BUFFER_SIZE
+ * bytes are copied through a buffer.
  * 
- * @param srcFD File from which data is read
- * @param logFD Log file to be written to
- * @param destFD Additional file to be written to
- * @param logPath Path to the logfile
- * @param pipe Pipe holding the file descriptors to be read/written from
- * @return int 0 on success : (-) on error
+ * @param stream Stream whose source is ready to read (its spliceable
+ * flag is cleared if tee() refuses its fds)
+ * @return int 0 on success : STREAM_EOF if the stream has ended :
+ * STREAM_BLOCKED if the input pipe is full : (-) on error
  */
-int transferData(int srcFD, int logFD, int destFD, const char *logPath, int pipe[]) {
+int transferData(Stream_Info* stream) {
+    // Duplicate the data without copying it when both ends are pipes
+    if (stream->spliceable) {
+        int status = teeData(stream);
+        if (status != ERR_SPLICE_UNSUPPORTED) {
+            return status;
+        }
+        stream->spliceable = false; // Copy through the buffer from now on
+    }
+
     // Read from source file
     char buffer[BUFFER_SIZE];
-    ssize_t bytes_read = read(srcFD, buffer, BUFFER_SIZE);
+    ssize_t bytes_read = read(stream->src_fd, buffer, BUFFER_SIZE);
     
     // Handle read errors
     if (bytes_read == -1) {
+        if (errno == EINTR || errno == EAGAIN) return SUCCESS;  // Retry on next event
         printError(1, "[transferData] - Could not read from source fd '%d': %s", 
-                  srcFD, strerror(errno));
+                  stream->src_fd, strerror(errno));
         return ERR_FILE_READ;
     }
 
-    // Handle EOF for pipe
-    if (bytes_read == 0 && pipe != NULL && destFD == pipe[1]) {
-        return closeFD(pipe[1]);
+    // Handle EOF
+    if (bytes_read == 0) {
+        return STREAM_EOF;
     }
 
     // Write to log file
-    ssize_t total_written_log = 0;
-    while (total_written_log < bytes_read) {
-        ssize_t written = write(logFD, buffer + total_written_log, 
-                                bytes_read - total_written_log);
+    if (writeAll(stream->fd, buffer, bytes_read) == -1) {
+        printError(1, "[transferData] - Could not write to log file %s: %s", 
+                   stream->path, strerror(errno));
+        return ERR_FILE_WRITE;
+    }
+
+    // Hand input to the command's nonblocking pipe
+    if (isInput(stream)) {
+        return queueInput(stream, buffer, bytes_read);
+    }
+
+    // Write to destination
+    if (writeAll(stream->dest_fd, buffer, bytes_read) == -1) {
+        printError(1, "[transferData] - Could not write to destination fd '%d': %s", 
+                  stream->dest_fd, strerror(errno));
+        return ERR_FILE_WRITE;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Duplicates the data waiting in a pipe into the destination
+ * pipe with tee(), then moves the same bytes into the log file with
+ * splice(), so the data never passes through user space.
+ * 
+ * @param stream Stream whose source and destination are pipes
+ * @return int 0 on success : STREAM_EOF if the stream has ended :
+ * STREAM_BLOCKED if the input pipe is full :
+ * ERR_SPLICE_UNSUPPORTED if tee() refuses the fds : (-) on error
+ */
+int teeData(Stream_Info* stream) {
+    // Duplicate the data into the destination, leaving it in the source
+    unsigned int flags = isInput(stream) ? SPLICE_F_NONBLOCK : 0;
+    ssize_t bytes_teed;
+    do {
+        bytes_teed = tee(stream->src_fd, stream->dest_fd, BUFFER_SIZE, flags);
+    } while (bytes_teed == -1 && errno == EINTR);
+
+    // Handle tee errors
+    if (bytes_teed == -1) {
+        if (errno == EINVAL) {
+            return ERR_SPLICE_UNSUPPORTED;
+        }
+        if (errno == EAGAIN) {
+            return isInput(stream) ? STREAM_BLOCKED : SUCCESS;  // Retry on next event
+        }
+        if (errno == EPIPE && isInput(stream)) {
+            return STREAM_EOF;  // The command stopped reading its input
+        }
+        printError(1, "[teeData] - Could not tee source fd '%d': %s", stream->src_fd, strerror(errno));
+        return ERR_FILE_WRITE;
+    }
+
+    // Handle EOF
+    if (bytes_teed == 0) {
+        return STREAM_EOF;
+    }
+
+    // Move the duplicated bytes out of the source and into the log file
+    return spliceToLog(stream->src_fd, stream->fd, stream->path, (size_t)bytes_teed);
+}
+
+/**
+ * @brief Moves a given number of bytes from a pipe into a log file
+ * with splice(), copying them through a buffer if the log file's
+ * filesystem does not support splicing.
+ * 
+ * @param srcFD Pipe from which data is read
+ * @param logFD Log file to be written to
+ * @param logPath Path to the logfile
+ * @param length Number of bytes to move
+ * @return int 0 on success : (-) on error
+ */
+int spliceToLog(int srcFD, int logFD, const char *logPath, size_t length) {
+    size_t total_moved = 0;
+    while (total_moved < length) {
+        ssize_t moved = splice(srcFD, NULL, logFD, NULL, length - total_moved, SPLICE_F_MOVE);
+        if (moved == -1) {
+            if (errno == EINTR) continue;  // Retry on interrupt
+            if (errno != EINVAL) {
+                printError(1, "[spliceToLog] - Could not splice to log file %s: %s", 
+                           logPath, strerror(errno));
+                return ERR_FILE_WRITE;
+            }
+
+            // Copy what is left through a buffer instead
+            char buffer[BUFFER_SIZE];
+            ssize_t bytes_read = read(srcFD, buffer, length - total_moved);
+            if (bytes_read == -1) {
+                if (errno == EINTR) continue;  // Retry on interrupt
+                printError(1, "[spliceToLog] - Could not read from source fd '%d': %s", 
+                           srcFD, strerror(errno));
+                return ERR_FILE_READ;
+            }
+            if (writeAll(logFD, buffer, bytes_read) == -1) {
+                printError(1, "[spliceToLog] - Could not write to log file %s: %s", 
+                           logPath, strerror(errno));
+                return ERR_FILE_WRITE;
+            }
+            moved = bytes_read;
+        }
+        total_moved += moved;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Writes input to the command's nonblocking pipe, keeping
+ * whatever the pipe can't take yet as pending
+ * 
+ * @param stream Input stream of the command
+ * @param buffer Data to be written
+ * @param length Number of bytes to write
+ * @return int 0 on success : STREAM_EOF if the command stopped reading :
+ * STREAM_BLOCKED if data is pending : (-) on error
+ */
+int queueInput(Stream_Info* stream, const char* buffer, size_t length) {
+    size_t total_written = 0;
+    while (total_written < length) {
+        ssize_t written = write(stream->dest_fd, buffer + total_written, length - total_written);
         if (written == -1) {
             if (errno == EINTR) continue;  // Retry on interrupt
-            printError(1, "[transferData] - Could not write to log file %s: %s", 
-                       logPath, strerror(errno));
+            if (errno == EPIPE) return STREAM_EOF;  // The command stopped reading its input
+            if (errno == EAGAIN) break;
+            printError(1, "[queueInput] - Could not write to input pipe '%d': %s", 
+                       stream->dest_fd, strerror(errno));
             return ERR_FILE_WRITE;
         }
-        total_written_log += written;
+        total_written += written;
     }
 
-    // Write to destination
-    ssize_t total_written_dest = 0;
-    while (total_written_dest < bytes_read) {
-        ssize_t written = write(destFD, buffer + total_written_dest, 
-                              bytes_read - total_written_dest);
+    // Everything fit in the pipe
+    if (total_written == length) {
+        return SUCCESS;
+    }
+
+    // Keep the rest until the pipe drains (buffer may be the pending data itself)
+    if (!stream->pending) {
+        stream->pending = (char*)malloc(BUFFER_SIZE);
+        if (!stream->pending) {
+            printError(1, "[queueInput] - Could not allocate pending input - Info: %s", strerror(errno));
+            return ERR_COMMAND_ALLOCATION;
+        }
+    }
+    memmove(stream->pending, buffer + total_written, length - total_written);
+    stream->pending_length = length - total_written;
+
+    return STREAM_BLOCKED;
+}
+
+/**
+ * @brief Writes the pending input once the command's pipe has drained
+ * 
+ * @param stream Input stream of the command
+ * @return int 0 on success : STREAM_EOF if the command stopped reading :
+ * STREAM_BLOCKED if data is still pending : (-) on error
+ */
+int flushInput(Stream_Info* stream) {
+    size_t length = stream->pending_length;
+    stream->pending_length = 0;
+    return queueInput(stream, stream->pending, length);
+}
+
+/**
+ * @brief Writes a whole buffer to a file descriptor, retrying on
+ * partial writes and interrupts
+ * 
+ * @param fd File descriptor to be written to
+ * @param buffer Data to be written
+ * @param length Number of bytes to write
+ * @return int 0 on success : -1 on error with errno set
+ */
+int writeAll(int fd, const char* buffer, size_t length) {
+    size_t total_written = 0;
+    while (total_written < length) {
+        ssize_t written = write(fd, buffer + total_written, length - total_written);
         if (written == -1) {
             if (errno == EINTR) continue;  // Retry on interrupt
-            printError(1, "[transferData] - Could not write to destination fd '%d': %s", 
-                      destFD, strerror(errno));
-            return ERR_FILE_WRITE;
+            return -1;
         }
-        total_written_dest += written;
+        total_written += written;
     }
 
     return SUCCESS;
 }
 
+/**
+ * @brief Checks whether a file descriptor refers to a pipe
+ * 
+ * @param fd File descriptor to be checked
+ * @return bool true if fd is a pipe (or FIFO) : false otherwise
+ */
+bool isPipe(int fd) {
+    struct stat info;
+    return fstat(fd, &info) == 0 && S_ISFIFO(info.st_mode);
+}
+
+/**
+ * @brief Checks whether a stream is its command's input
+ * 
+ * @param stream Stream to be checked
+ * @return bool true if the stream forwards stdin to the command : false otherwise
+ */
+bool isInput(Stream_Info* stream) {
+    return stream == &stream->command->streams.input;
+}
+
 /**
  * @brief Prints contents of fd manager to stderr for debugging
  * 
@@ -630,7 +1246,7 @@ int transferData(int srcFD, int logFD, int destFD, const char *logPath, int pipe
  */
 void printFDManager(FD_Manager* fd_mngr) {
     fprintf(stderr, "{|");
-    for (int i = 0; i < MAX_FDS; i++) {
+    for (int i = 0; i < fd_mngr->fd_capacity; i++) {
         fprintf(stderr, " [%d]:%d |", i, fd_mngr->fd_arr[i]);
     }
     fprintf(stderr, "} fd_counter: %d\n", fd_mngr->fd_counter);
@@ -18,6 +18,7 @@
  *
  * Argument format:
  * ./hscript <program name> <arguments> <log_directory_name>
+ * ./hscript -b <batch_file> <log_directory_name>
  ******************************************************************/
 
 #ifndef HSCRIPT_H
@@ -25,17 +26,20 @@
 
 #include <sys/stat.h>
 #include <sys/types.h>
-#include <sys/select.h>
 #include <sys/wait.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <fcntl.h>
 #include <linux/limits.h>
+#include <signal.h>
 #include <stdbool.h>
 
-#define MAX_FDS 9 // Number of FDS an FD_Manager can track
-#define BUFFER_SIZE 1024 // Buffer size used to write to fds in transferData()
+#define FD_MANAGER_CAPACITY 9 // Number of FDS an FD_Manager tracks before it grows
+#define BATCH_FLAG "-b" // Runs every line of the given file as a command
+#define MAX_RUNNING 32 // Batch commands running at once
+#define MAX_EVENTS 64 // Events handled per epoll_wait() call
+#define BUFFER_SIZE (64 * 1024) // Bytes transferData() moves at a time (a pipe's capacity)
 
 //==================================================================
 //                           Error Handling
@@ -80,6 +84,8 @@
  */
 typedef enum {
     SUCCESS = 0,
+    STREAM_EOF = 1, // Not an error, the stream's source has no more data
+    STREAM_BLOCKED = 2, // Not an error, the command's input pipe is full
 
     // File creation
     ERR_FILE_OPEN = -100,
@@ -102,10 +108,17 @@ typedef enum {
 
     // Argument Validation
     ERR_INVALID_USAGE = -500,
+    ERR_BATCH_FILE = -501,
 
     // Environmental Management
     ERR_STREAM_REDIRECT = -600,
-    ERR_FORKING = -601
+    ERR_FORKING = -601,
+    ERR_EVENT_LOOP = -602,
+    ERR_WAIT = -603,
+    ERR_COMMAND_ALLOCATION = -604,
+
+    // Zero-copy transfer
+    ERR_SPLICE_UNSUPPORTED = -700
 
 } script_error_t;
 
@@ -129,10 +142,13 @@ typedef enum {
  * and abrupt file descriptor cleanup.
  */
 typedef struct {
-    int fd_arr[MAX_FDS];
+    int* fd_arr;
     int fd_counter;
+    int fd_capacity; // Doubled whenever fd_arr fills
 } FD_Manager;
 
+typedef struct Command_Info Command_Info;
+
 /**
  * @brief - Contains file stream info for stream redirection such as
  * file descriptor, path, and a pipe.
@@ -141,6 +157,14 @@ typedef struct {
     int fd;
     char path[PATH_MAX];
     int pipe[2];
+    bool spliceable; // source and destination are pipes, so data is teed between them
+    int src_fd; // Descriptor data is read from
+    int dest_fd; // Descriptor data is written to besides the log file
+    bool open; // Source has not reached EOF
+    bool blocked; // Waiting for the command to drain its input pipe
+    char* pending; // Input read but not yet accepted by the input pipe
+    size_t pending_length;
+    Command_Info* command; // Command the stream belongs to
 } Stream_Info;
 
 /**
@@ -152,15 +176,37 @@ typedef struct {
     Stream_Info error;
 } Streams;
 
+/**
+ * @brief - A command being logged, along with its streams and the
+ * directory holding its log files.
+ */
+struct Command_Info {
+    char** argv; // Arguments passed to execvp, starting with the command
+    char* line; // Batch file line argv points into (NULL outside batch mode)
+    char dir_name[PATH_MAX];
+    pid_t pid;
+    bool running; // Started and not yet reaped
+    int open_streams; // Streams not yet closed
+    Streams streams;
+};
+
 /**
  * @brief - Container for filesystem environmental info used for
  * cleaner argument passing and consolidation.
  */
 typedef struct {
     FD_Manager* fd_mngr;
-    char* command;
     char* dir_name;
-    Streams streams;
+    bool batch;
+    Command_Info* commands;
+    int command_count;
+    int started_count; // Commands started so far, in order
+    int finished_count; // Commands reaped with every stream closed
+    int running_count; // Commands started and not yet reaped
+    int epoll_fd;
+    int signal_fd; // Reports SIGCHLD, which stays blocked in the parent
+    sigset_t old_mask; // Signal mask restored in each child
+    bool stdin_polled; // False if stdin cannot be added to epoll (e.g. a regular file)
 } Environmental_Info;
 
 //==================================================================
@@ -169,10 +215,24 @@ typedef struct {
 
 // ------- Environment Creation -------
 int buildEnvironment(Environmental_Info* env_info, int argc, char*** argv);
-int parseArguments(int argc, char*** argv, char** command, char** dirName);
+int parseArguments(int argc, char*** argv, Environmental_Info* env_info);
+int parseBatchFile(const char* path, Environmental_Info* env_info);
+int initEventLoop(Environmental_Info* env_info);
 int initLogFiles(const char* dir_name, FD_Manager* fd_mngr, Streams* streams);
 int initPipes(FD_Manager* fd_mngr, Streams* streams);
 int redirectStreams(Streams* streams);
+void detectSplicing(Streams* streams);
+int destroyEnvironment(Environmental_Info* env_info);
+
+// ---------- Command Control ---------
+int startCommand(Environmental_Info* env_info, Command_Info* command, int index);
+int watchStreams(Environmental_Info* env_info, Command_Info* command);
+int runEventLoop(Environmental_Info* env_info);
+int serviceStream(Environmental_Info* env_info, Stream_Info* stream);
+int closeStream(Environmental_Info* env_info, Stream_Info* stream);
+int blockInput(Environmental_Info* env_info, Stream_Info* stream, bool blocked);
+int reapCommands(Environmental_Info* env_info);
+int finishCommand(Environmental_Info* env_info, Command_Info* command);
 
 // ------- Directory Management -------
 int createFile(const char* path, mode_t mode, FD_Manager* fd_mngr);
@@ -190,7 +250,14 @@ int closeFD(int fd);
 
 // -------- Additional Helpers --------
 void printError(int arg_count, char *format, ...);
-int transferData(int srcFD, int logFD, int destFD, const char *logPath, int pipe[]);
+int transferData(Stream_Info* stream);
+int teeData(Stream_Info* stream);
+int spliceToLog(int srcFD, int logFD, const char *logPath, size_t length);
+int queueInput(Stream_Info* stream, const char* buffer, size_t length);
+int flushInput(Stream_Info* stream);
+int writeAll(int fd, const char* buffer, size_t length);
+bool isPipe(int fd);
+bool isInput(Stream_Info* stream);
 void printFDManager(FD_Manager* fd_mngr);
 
 #endif // HSCRIPT_H
\ No newline at end of file
@@ -13,57 +13,173 @@
     file. As an unsigned char is limited to the range of value 0-255 we
     assign EOF_SIGNAL the value of 256 so that the signal does not share
     the value of a valid character.
+
+    Input and output are moved in blocks of INPUT_BUFFER_SIZE and
+    OUTPUT_BUFFER_SIZE bytes, so a stream costs one system call per block
+    rather than one per byte. Bits pass through a 64-bit accumulator, which
+    lets multi-bit fields be read or written in a single operation.
 ===========================================================================
 */
 
+#include <errno.h>
+#include <stdint.h>
 #include <unistd.h>
 #include "bit_ops.h"
 
-static char read_buffer = 0;
-static int read_index = -1; // -1 
+// Input block and accumulator (next bit at the MSB)
+static unsigned char read_buffer[INPUT_BUFFER_SIZE];
+static ssize_t read_length = 0;
+static ssize_t read_position = 0;
+static uint64_t read_accumulator = 0;
+static unsigned int read_count = 0; // bits held in the accumulator
+static int read_finished = 0;       // set once STDIN returns end of file
 
-static char write_buffer = 0;
-static int write_index = 7; // n-1 of bytesize
+// Output block and accumulator (last bit at the LSB)
+static unsigned char write_buffer[OUTPUT_BUFFER_SIZE];
+static size_t write_position = 0;
+static uint64_t write_accumulator = 0;
+static unsigned int write_count = 0; // bits held in the accumulator
 
 /* ===================================================================
                           Reading Functions
 =================================================================== */
 
- /**
-  * @brief Read the next bit from STDOUT into a buffer
-  * 
-  * @param byte Pointer to bit buffer to be loaded
-  *             Valid character value: 0-255
-  *             End of file signal: 256
-  * @return int 0 on success : negative on failure
-  */
-int read_bit(unsigned short* bit) {
+/**
+ * @brief Top up the read accumulator from the input block, reading the
+ * next block from STDIN once the current one is consumed.
+ * 
+ * @return int 0 on success : negative on failure
+ */
+static int fill_read_accumulator() {
+    while (read_count <= 56) {
+
+        // Read next block once the current one is consumed
+        if (read_position == read_length) {
+            if (read_finished) {
+                break;
+            }
+
+            ssize_t bytes_read;
+            do {
+                bytes_read = read(STDIN_FILENO, read_buffer, INPUT_BUFFER_SIZE);
+            } while (bytes_read == -1 && errno == EINTR);
 
-    // Check if previous byte is done being read
-    if (read_index < 0) {
+            if (bytes_read == -1) {
+                return ERR_READ_FAILURE;
+            }
 
-        // Read next byte and reset byte index
-        ssize_t bytes_read = read(STDIN_FILENO, &read_buffer, 1);
+            // Check for end of file.
+            if (bytes_read == 0) {
+                read_finished = 1;
+                break;
+            }
 
-        if (bytes_read == -1) {
-            return ERR_READ_FAILURE;
+            read_length = bytes_read;
+            read_position = 0;
         }
 
+        // Append the byte below the bits already held
+        read_accumulator |= ((uint64_t)read_buffer[read_position++] << (56 - read_count));
+        read_count += 8;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Read the next multi-bit field from STDIN (MSB first)
+ * 
+ * @param count Number of bits in the field (1-MAX_FIELD_BITS)
+ * @param value Pointer to field buffer to be loaded (zero at end of file)
+ * @return int 0 on success : EOF_BITS if fewer than count bits are left :
+ *             negative on failure
+ */
+int read_bits(unsigned int count, uint32_t* value) {
+
+    // Refill if the accumulator runs short
+    if (read_count < count) {
+        CHECK_READ(fill_read_accumulator());
+
         // Check for end of file.
-        if (bytes_read == 0) {
-            *bit =  EOF_SIGNAL;
-            return SUCCESS;
+        if (read_count < count) {
+            *value = 0;
+            return EOF_BITS;
         }
+    }
+
+    // Grab the field from the top of the accumulator
+    *value = (uint32_t)(read_accumulator >> (64 - count));
+    read_accumulator <<= count;
+    read_count -= count;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Place bytes already read from STDIN back in front of the input
+ * 
+ * @param data Bytes to be read again
+ * @param length Number of bytes (at most INPUT_BUFFER_SIZE), must be
+ *               called before anything else is read
+ */
+void preload_input(const unsigned char* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        read_buffer[i] = data[i];
+    }
+    read_length = (ssize_t)length;
+    read_position = 0;
+}
+
+/**
+ * @brief Look at the next multi-bit field from STDIN without consuming it
+ * 
+ * @param count Number of bits in the field (1-MAX_FIELD_BITS)
+ * @param value Pointer to field buffer to be loaded, bits past the end
+ *              of file are zero
+ * @param available Pointer loaded with the number of bits left (up to count)
+ * @return int 0 on success : negative on failure
+ */
+int peek_bits(unsigned int count, uint32_t* value, unsigned int* available) {
 
-        read_index = 7; // move index to read bytes MSB
+    // Refill if the accumulator runs short
+    if (read_count < count) {
+        CHECK_READ(fill_read_accumulator());
     }
 
-    // Grab next bit from buffered byte from left -> right (MSB -> LSB)
-    *bit = ((read_buffer >> read_index--) & 1);
+    // Bits below those held are always zero
+    *value = (uint32_t)(read_accumulator >> (64 - count));
+    *available = (read_count < count) ? read_count : count;
 
     return SUCCESS;
 }
 
+/**
+ * @brief Consume bits previously looked at with peek_bits()
+ * 
+ * @param count Number of bits to consume (at most the bits available)
+ */
+void skip_bits(unsigned int count) {
+    read_accumulator <<= count;
+    read_count -= count;
+}
+
+ /**
+  * @brief Read the next bit from STDOUT into a buffer
+  * 
+  * @param byte Pointer to bit buffer to be loaded
+  *             Valid character value: 0-255
+  *             End of file signal: 256
+  * @return int 0 on success : negative on failure
+  */
+int read_bit(unsigned short* bit) {
+    uint32_t value;
+    int status = read_bits(1, &value);
+    CHECK_READ(status);
+
+    *bit = (status == EOF_BITS) ? EOF_SIGNAL : (unsigned short)value;
+    return SUCCESS;
+}
+
  /**
   * @brief Read the next byte from STDOUT into a buffer
   * 
@@ -73,24 +189,11 @@ int read_bit(unsigned short* bit) {
   * @return int 0 on success : negative on failure
   */
 int read_byte(unsigned short* byte) {
-    unsigned short bit = 0;
-
-    // Iterate each bit in byte
-    for (int i = 7; i >= 0; i--) {
-        CHECK_READ(read_bit(&bit));
-
-        // Check for end of file.
-        if (bit == EOF_SIGNAL) {
-            *byte =  EOF_SIGNAL;
-            return SUCCESS;
-        }
-
-        // If bit is 1, XOR shift it, and simply skip 0's
-        if (bit) {
-            *byte |= (1 << i);
-        }
-    }
+    uint32_t value;
+    int status = read_bits(8, &value);
+    CHECK_READ(status);
 
+    *byte = (status == EOF_BITS) ? EOF_SIGNAL : (unsigned short)value;
     return SUCCESS;
 }
 
@@ -100,76 +203,226 @@ int read_byte(unsigned short* byte) {
 =================================================================== */
 
 /**
- * @brief Load a bit into the 8-bit write buffer. And write the buffer
- * if it is full.
+ * @brief Write the filled part of the output block to STDOUT
  * 
- * @param bit Bit to be loaded into buffer
+ * @return int 0 on success : negative on failure
  */
-int write_bit(unsigned char bit) {
-    // Load the bit into the 8-bit write buffer
-    if (bit) {
-        write_buffer |= (1 << write_index);
-    }
+static int write_block() {
+    size_t written = 0;
 
-    // Shift bit pointer in write buffer
-    write_index--;
+    // Loop until the whole block is out, write() may take only part of it
+    while (written < write_position) {
+        ssize_t bytes_wrote = write(STDOUT_FILENO, write_buffer + written,
+                                    write_position - written);
 
-    // If byte buffer is full, write it out.
-    if (write_index < 0) {
-        ssize_t bytes_wrote = write(STDOUT_FILENO, &write_buffer, 1);
-        
         // Pass up write error
         if (bytes_wrote == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
             return ERR_WRITE_FAILURE;
         }
-        
-        write_buffer = 0; // zero out buffer
-        write_index = 7; // reset index to point to MSB
+
+        written += (size_t)bytes_wrote;
+    }
+
+    write_position = 0;
+    return SUCCESS;
+}
+
+/**
+ * @brief Move every whole byte from the write accumulator into the
+ * output block, writing the block if it is full.
+ * 
+ * @return int 0 on success : negative on failure
+ */
+static int drain_write_accumulator() {
+    while (write_count >= 8) {
+        write_count -= 8;
+        write_buffer[write_position++] = (unsigned char)(write_accumulator >> write_count);
+
+        // If block buffer is full, write it out.
+        if (write_position == OUTPUT_BUFFER_SIZE) {
+            CHECK_WRITE(write_block());
+        }
     }
 
     return SUCCESS;
 }
 
+/**
+ * @brief Load a multi-bit field into the write accumulator (MSB first)
+ * 
+ * @param value Field to be loaded, only the low count bits are used
+ * @param count Number of bits in the field (1-MAX_FIELD_BITS)
+ */
+int write_bits(uint32_t value, unsigned int count) {
+    uint64_t field = (uint64_t)value & ((UINT64_C(1) << count) - 1);
+    write_accumulator = (write_accumulator << count) | field;
+    write_count += count;
+
+    // Less than 32 bits are held after a drain, so the next field always fits
+    if (write_count >= 32) {
+        CHECK_WRITE(drain_write_accumulator());
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Load a bit into the write accumulator. And write the block
+ * buffer if it is full.
+ * 
+ * @param bit Bit to be loaded into buffer
+ */
+int write_bit(unsigned char bit) {
+    return write_bits(bit ? 1 : 0, 1);
+}
+
 /**
  * @brief Write an entire byte to STDOUT
  * 
  * @param byte To be written to STDOUT
  */
 int write_byte(unsigned char byte) {
-    unsigned char bit;
-    int status; // holds return status of write op
-
-    // Write each bit to STDOUT from left to right
-    for (int i = 7; i >= 0; i--) {
-        bit = (byte >> i) & 1;
-        status = write_bit(bit);
-        
-        // Check for write error
-        if(status == ERR_WRITE_FAILURE) {
-            return ERR_WRITE_FAILURE;
-        }
+    return write_bits(byte, 8);
+}
+
+/**
+ * @brief Pad the last byte with 1 bits and flush all buffered data to STDOUT
+ * 
+ */
+int flush_write_buffer() {
+    unsigned int empty_bits = (8 - (write_count % 8)) % 8;
+
+    // Fill the remaining bits of the last byte
+    if (empty_bits > 0) {
+        CHECK_WRITE(write_bits((1u << empty_bits) - 1, empty_bits));
     }
 
+    CHECK_WRITE(drain_write_accumulator());
+    CHECK_WRITE(write_block());
+
     return SUCCESS;
 }
 
+
+/* ===================================================================
+                          Span Bit Streams
+=================================================================== */
+
 /**
- * @brief Flush any remaining bits to STDOUT
+ * @brief Start writing bits into a span of memory
  * 
+ * @param writer Pointer to the writer to be initialized
+ * @param data Memory to be written
+ * @param capacity Size of the memory in bytes
  */
-int flush_write_buffer() {
-    unsigned int empty_bits = (7 - write_index);
-    int status; // holds return status of write op
-
-    // Flush the remaining bits from the buffer
-    for (int i = 0; i < empty_bits; i++) {
-        status = write_bit(1);
-        
-        // Check for write error
-        if(status == ERR_WRITE_FAILURE) {
-            return ERR_WRITE_FAILURE;
+void span_writer_init(span_writer* writer, unsigned char* data, size_t capacity) {
+    writer->data = data;
+    writer->capacity = capacity;
+    writer->position = 0;
+    writer->accumulator = 0;
+    writer->count = 0;
+}
+
+/**
+ * @brief Write a multi-bit field into a span (MSB first)
+ * 
+ * @param writer Pointer to an initialized writer
+ * @param value Field to be written, only the low count bits are used
+ * @param count Number of bits in the field (1-MAX_FIELD_BITS)
+ * @return int 0 on success : ERR_OUTPUT_OVERFLOW if the span is full
+ */
+int span_write_bits(span_writer* writer, uint32_t value, unsigned int count) {
+    uint64_t field = (uint64_t)value & ((UINT64_C(1) << count) - 1);
+    writer->accumulator = (writer->accumulator << count) | field;
+    writer->count += count;
+
+    // Less than 8 bits are held after a drain, so the next field always fits
+    if (writer->count >= 32) {
+        if (writer->capacity - writer->position < writer->count / 8) {
+            return ERR_OUTPUT_OVERFLOW;
+        }
+        while (writer->count >= 8) {
+            writer->count -= 8;
+            writer->data[writer->position++] = (unsigned char)(writer->accumulator >> writer->count);
         }
     }
 
     return SUCCESS;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Pad the last byte with 1 bits and move every bit into the span
+ * 
+ * @param writer Pointer to an initialized writer
+ * @param length Pointer loaded with the number of bytes written
+ * @return int 0 on success : ERR_OUTPUT_OVERFLOW if the span is full
+ */
+int span_writer_finish(span_writer* writer, size_t* length) {
+    unsigned int empty_bits = (8 - (writer->count % 8)) % 8;
+    writer->accumulator = (writer->accumulator << empty_bits) | ((1u << empty_bits) - 1);
+    writer->count += empty_bits;
+
+    if (writer->capacity - writer->position < writer->count / 8) {
+        return ERR_OUTPUT_OVERFLOW;
+    }
+    while (writer->count >= 8) {
+        writer->count -= 8;
+        writer->data[writer->position++] = (unsigned char)(writer->accumulator >> writer->count);
+    }
+
+    *length = writer->position;
+    return SUCCESS;
+}
+
+/**
+ * @brief Start reading bits from a span of memory
+ * 
+ * @param reader Pointer to the reader to be initialized
+ * @param data Memory to be read
+ * @param length Size of the memory in bytes
+ */
+void span_reader_init(span_reader* reader, const unsigned char* data, size_t length) {
+    reader->data = data;
+    reader->length = length;
+    reader->position = 0;
+    reader->accumulator = 0;
+    reader->count = 0;
+}
+
+/**
+ * @brief Look at the next multi-bit field of a span without consuming it
+ * 
+ * @param reader Pointer to an initialized reader
+ * @param count Number of bits in the field (1-MAX_FIELD_BITS)
+ * @param value Pointer to field buffer to be loaded, bits past the end
+ *              of the span are zero
+ * @return unsigned int Number of bits left (up to count)
+ */
+unsigned int span_peek_bits(span_reader* reader, unsigned int count, uint32_t* value) {
+
+    // Refill if the accumulator runs short
+    if (reader->count < count) {
+        while (reader->count <= 56 && reader->position < reader->length) {
+            reader->accumulator |= ((uint64_t)reader->data[reader->position++] << (56 - reader->count));
+            reader->count += 8;
+        }
+    }
+
+    // Bits below those held are always zero
+    *value = (uint32_t)(reader->accumulator >> (64 - count));
+    return (reader->count < count) ? reader->count : count;
+}
+
+/**
+ * @brief Consume bits previously looked at with span_peek_bits()
+ * 
+ * @param reader Pointer to an initialized reader
+ * @param count Number of bits to consume (at most the bits available)
+ */
+void span_skip_bits(span_reader* reader, unsigned int count) {
+    reader->accumulator <<= count;
+    reader->count -= count;
+}
@@ -9,19 +9,32 @@
  DESCRIPTION:
     This file contains function definitions for bit manipulation, as well
     as additional macros.
+
+    Bits are read from STDIN and written to STDOUT in blocks, through a
+    64-bit accumulator holding the bits between the block buffer and the
+    caller. Fields are stored MSB first.
+
+    Span bit streams do the same over caller owned memory. They keep all
+    of their state in a structure, so any number can be used at once
+    (e.g. one per compression thread).
 ===========================================================================
 */
 
 #ifndef BIT_OPS_H
 #define BIT_OPS_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 /* ===================================================================
                                 Macros
 =================================================================== */
 
 #define EOF_SIGNAL 256
-#define INPUT_BUFFER_SIZE 1024
-#define OUTPUT_BUFFER_SIZE 1024
+#define EOF_BITS 1                   // read_bits() status at end of file
+#define INPUT_BUFFER_SIZE 65536      // bytes read from STDIN at once
+#define OUTPUT_BUFFER_SIZE 65536     // bytes written to STDOUT at once
+#define MAX_FIELD_BITS 32            // widest field read or written in one call
 
 #define CHECK_WRITE(write_call)             \
         do {                                \
@@ -45,9 +58,36 @@ typedef enum {
     SUCCESS = 0,
     ERR_WRITE_FAILURE = -1,
     ERR_READ_FAILURE = -2,
-    ERR_INDEX_OUT_OF_BOUNDS = -3
+    ERR_INDEX_OUT_OF_BOUNDS = -3,
+    ERR_ALLOCATION_FAILURE = -4,
+    ERR_THREAD_FAILURE = -5,
+    ERR_INVALID_ARGUMENT = -6,
+    ERR_INVALID_CONTAINER = -7,
+    ERR_OUTPUT_OVERFLOW = -8
 } error;
 
+/* ===================================================================
+                          Span Bit Streams
+=================================================================== */
+
+// Writes bits into caller owned memory
+typedef struct {
+    unsigned char* data;
+    size_t capacity;
+    size_t position;        // bytes written
+    uint64_t accumulator;   // last bit at the LSB
+    unsigned int count;     // bits held in the accumulator
+} span_writer;
+
+// Reads bits from caller owned memory
+typedef struct {
+    const unsigned char* data;
+    size_t length;
+    size_t position;        // bytes loaded into the accumulator
+    uint64_t accumulator;   // next bit at the MSB
+    unsigned int count;     // bits held in the accumulator
+} span_reader;
+
 /* ===================================================================
                          Function Declarations
 =================================================================== */
@@ -73,13 +113,49 @@ int read_bit(unsigned short* bit);
 int read_byte(unsigned short* byte);
 
 /**
- * @brief Load a bit into the 8-bit write buffer. And write the buffer
- * if it is full.
+ * @brief Read the next multi-bit field from STDIN (MSB first)
+ * 
+ * @param count Number of bits in the field (1-MAX_FIELD_BITS)
+ * @param value Pointer to field buffer to be loaded (zero at end of file)
+ * @return int 0 on success : EOF_BITS if fewer than count bits are left :
+ *             negative on failure
+ */
+int read_bits(unsigned int count, uint32_t* value);
+
+/**
+ * @brief Look at the next multi-bit field from STDIN without consuming it
+ * 
+ * @param count Number of bits in the field (1-MAX_FIELD_BITS)
+ * @param value Pointer to field buffer to be loaded, bits past the end
+ *              of file are zero
+ * @param available Pointer loaded with the number of bits left (up to count)
+ * @return int 0 on success : negative on failure
+ */
+int peek_bits(unsigned int count, uint32_t* value, unsigned int* available);
+
+/**
+ * @brief Consume bits previously looked at with peek_bits()
+ * 
+ * @param count Number of bits to consume (at most the bits available)
+ */
+void skip_bits(unsigned int count);
+
+/**
+ * @brief Load a bit into the write accumulator. And write the block
+ * buffer if it is full.
  * 
  * @param bit Bit to be loaded into buffer
  */
 int write_bit(unsigned char bit);
 
+/**
+ * @brief Load a multi-bit field into the write accumulator (MSB first)
+ * 
+ * @param value Field to be loaded, only the low count bits are used
+ * @param count Number of bits in the field (1-MAX_FIELD_BITS)
+ */
+int write_bits(uint32_t value, unsigned int count);
+
 /**
  * @brief Write an entire byte to STDOUT
  * 
@@ -88,10 +164,80 @@ int write_bit(unsigned char bit);
 int write_byte(unsigned char byte);
 
 /**
- * @brief Flush any remaining bits to STDOUT
+ * @brief Pad the last byte with 1 bits and flush all buffered data to STDOUT
  * 
  */
 int flush_write_buffer();
 
+/**
+ * @brief Place bytes already read from STDIN back in front of the input
+ * 
+ * @param data Bytes to be read again
+ * @param length Number of bytes (at most INPUT_BUFFER_SIZE), must be
+ *               called before anything else is read
+ */
+void preload_input(const unsigned char* data, size_t length);
+
+
+/* ===================================================================
+                     Span Bit Stream Declarations
+=================================================================== */
+
+/**
+ * @brief Start writing bits into a span of memory
+ * 
+ * @param writer Pointer to the writer to be initialized
+ * @param data Memory to be written
+ * @param capacity Size of the memory in bytes
+ */
+void span_writer_init(span_writer* writer, unsigned char* data, size_t capacity);
+
+/**
+ * @brief Write a multi-bit field into a span (MSB first)
+ * 
+ * @param writer Pointer to an initialized writer
+ * @param value Field to be written, only the low count bits are used
+ * @param count Number of bits in the field (1-MAX_FIELD_BITS)
+ * @return int 0 on success : ERR_OUTPUT_OVERFLOW if the span is full
+ */
+int span_write_bits(span_writer* writer, uint32_t value, unsigned int count);
+
+/**
+ * @brief Pad the last byte with 1 bits and move every bit into the span
+ * 
+ * @param writer Pointer to an initialized writer
+ * @param length Pointer loaded with the number of bytes written
+ * @return int 0 on success : ERR_OUTPUT_OVERFLOW if the span is full
+ */
+int span_writer_finish(span_writer* writer, size_t* length);
+
+/**
+ * @brief Start reading bits from a span of memory
+ * 
+ * @param reader Pointer to the reader to be initialized
+ * @param data Memory to be read
+ * @param length Size of the memory in bytes
+ */
+void span_reader_init(span_reader* reader, const unsigned char* data, size_t length);
+
+/**
+ * @brief Look at the next multi-bit field of a span without consuming it
+ * 
+ * @param reader Pointer to an initialized reader
+ * @param count Number of bits in the field (1-MAX_FIELD_BITS)
+ * @param value Pointer to field buffer to be loaded, bits past the end
+ *              of the span are zero
+ * @return unsigned int Number of bits left (up to count)
+ */
+unsigned int span_peek_bits(span_reader* reader, unsigned int count, uint32_t* value);
+
+/**
+ * @brief Consume bits previously looked at with span_peek_bits()
+ * 
+ * @param reader Pointer to an initialized reader
+ * @param count Number of bits to consume (at most the bits available)
+ */
+void span_skip_bits(span_reader* reader, unsigned int count);
+
 
 #endif // BIT_OPS_H
\ No newline at end of file
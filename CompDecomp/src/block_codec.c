@@ -0,0 +1,475 @@
+/*
+===========================================================================
+ PROJECT: Compression and Decompression Algorithm
+===========================================================================
+ NAME: Tyler Neal
+ DATE: 02/20/2025
+ FILE NAME: block_codec.c
+ DESCRIPTION:
+    This file contains function implementations for compressing and
+    decompressing a block held in memory.
+
+    Every byte is compared against the 8 previously seen bytes of the
+    block. A match is written as a 0 bit followed by its 3-bit position,
+    anything else as a 1 bit followed by the byte. The original length of
+    the block is known to the decoder, so it stops after the last token
+    and the padding of the last byte is never mistaken for a token.
+
+    Version 2 blocks are compressed greedily: at every position the longest
+    match in the hash chains and the run of the previous byte are compared
+    with the cost of coding the same bytes one at a time, and the token
+    saving the most bits is written.
+===========================================================================
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include "bit_ops.h"
+#include "block_codec.h"
+#include "history_match.h"
+
+/* ===================================================================
+                                Macros
+=================================================================== */
+
+#define TOKEN_BITS 9             // widest token: a 1 bit followed by a literal
+
+// Version 2 token sizes in bits
+#define HISTORY_TOKEN_BITS 4
+#define LITERAL_TOKEN_BITS 10
+#define LZ_TOKEN_BITS (3 + 8 + LZ_OFFSET_BITS)
+#define RUN_TOKEN_BITS (3 + 8)
+
+/* ===================================================================
+                      Version 1 Coding Functions
+=================================================================== */
+
+/**
+ * @brief Compress a block of memory
+ * 
+ * @param input Block to be compressed
+ * @param length Length of the block in bytes
+ * @param output Memory to hold the compressed block
+ * @param capacity Size of the output memory (MAX_ENCODED_SIZE(length) always fits)
+ * @param encoded_length Pointer loaded with the length of the compressed block
+ * @return int 0 on success : negative on failure
+ */
+int encode_block(const unsigned char* input, size_t length,
+                 unsigned char* output, size_t capacity, size_t* encoded_length) {
+    span_writer writer;
+    span_writer_init(&writer, output, capacity);
+
+    // Previously seen characters, packed latest first (see history_match.h).
+    uint64_t history = 0;
+    int status;
+
+    for (size_t i = 0; i < length; i++) {
+        unsigned char byte = input[i];
+        int match = match_history(history, byte);
+
+        if (match != NO_MATCH) {
+            // Write a 0 bit followed by a 3-bit offset.
+            status = span_write_bits(&writer, match, 4);
+        } else {
+            // Write a 1 bit followed by the byte.
+            status = span_write_bits(&writer, (1 << 8) | byte, 9);
+        }
+        if (status < 0) {
+            return status;
+        }
+
+        UPDATE_HISTORY(history, byte);
+    }
+
+    return span_writer_finish(&writer, encoded_length);
+}
+
+/**
+ * @brief Load 8 bytes as a big-endian integer, so the next bit is the MSB
+ * 
+ * @param data Memory holding at least 8 bytes
+ * @return uint64_t Loaded bytes
+ */
+static inline uint64_t load_be64(const unsigned char* data) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    return __builtin_bswap64(word);
+}
+
+/**
+ * @brief Look at the token bits at a bit position, checking the end of the block
+ * 
+ * @param input Compressed block
+ * @param encoded_length Length of the compressed block in bytes
+ * @param bit_position Position of the next bit
+ * @param available Pointer loaded with the number of bits left (up to TOKEN_BITS)
+ * @return uint32_t Next TOKEN_BITS bits, bits past the end of the block are zero
+ */
+static uint32_t peek_tail(const unsigned char* input, size_t encoded_length,
+                          size_t bit_position, unsigned int* available) {
+    uint32_t bits = 0;
+    size_t byte = bit_position >> 3;
+
+    // Load the three bytes any token can touch
+    for (size_t i = byte; i < byte + 3; i++) {
+        bits = (bits << 8) | ((i < encoded_length) ? input[i] : 0);
+    }
+
+    size_t left = (encoded_length * 8) - bit_position;
+    *available = (left < TOKEN_BITS) ? (unsigned int)left : TOKEN_BITS;
+    return (bits >> (24 - TOKEN_BITS - (bit_position & 7))) & ((1u << TOKEN_BITS) - 1);
+}
+
+/**
+ * @brief Decompress a block of memory
+ * 
+ * Tokens are decoded without any bounds checks while 8 bytes of the block
+ * are left (every token fits in the 8 bytes loaded at its position), only
+ * the last few bytes are decoded with checks.
+ * 
+ * @param input Compressed block
+ * @param encoded_length Length of the compressed block in bytes
+ * @param output Memory to hold the original block
+ * @param length Length of the original block in bytes
+ * @return int 0 on success : negative on failure
+ */
+int decode_block(const unsigned char* input, size_t encoded_length,
+                 unsigned char* output, size_t length) {
+
+    // Previously seen characters, packed latest first (see history_match.h).
+    uint64_t history = 0;
+    size_t bit_position = 0;
+    size_t i = 0;
+
+    // Decode the bulk of the block unchecked
+    if (encoded_length >= sizeof(uint64_t)) {
+        size_t last_load = encoded_length - sizeof(uint64_t);
+        while (i < length && (bit_position >> 3) <= last_load) {
+            uint64_t word = load_be64(input + (bit_position >> 3)) << (bit_position & 7);
+            uint32_t bits = (uint32_t)(word >> (64 - TOKEN_BITS));
+            unsigned char byte;
+
+            if (bits >> 8) {
+                // 1 bit followed by the byte
+                byte = (unsigned char)(bits & 0xFF);
+                bit_position += 9;
+            } else {
+                // 0 bit followed by a 3-bit offset
+                byte = (unsigned char)(history >> (((bits >> 5) & 0x7) * 8));
+                bit_position += 4;
+            }
+
+            output[i++] = byte;
+            UPDATE_HISTORY(history, byte);
+        }
+    }
+
+    // Decode the tail with bounds checks
+    for (; i < length; i++) {
+        unsigned int available;
+        uint32_t bits = peek_tail(input, encoded_length, bit_position, &available);
+        unsigned char byte;
+
+        if (bits >> 8) {
+            // 1 bit followed by the byte
+            if (available < 9) {
+                return ERR_INVALID_CONTAINER;
+            }
+            byte = (unsigned char)(bits & 0xFF);
+            bit_position += 9;
+        } else {
+            // 0 bit followed by a 3-bit offset
+            if (available < 4) {
+                return ERR_INVALID_CONTAINER;
+            }
+            byte = (unsigned char)(history >> (((bits >> 5) & 0x7) * 8));
+            bit_position += 4;
+        }
+
+        output[i] = byte;
+        UPDATE_HISTORY(history, byte);
+    }
+
+    // Only the padding of the last byte may be left
+    if (((bit_position + 7) >> 3) != encoded_length) {
+        return ERR_INVALID_CONTAINER;
+    }
+
+    return SUCCESS;
+}
+
+/* ===================================================================
+                      Version 2 Coding Functions
+=================================================================== */
+
+/**
+ * @brief Hash the 4 bytes starting at a position
+ * 
+ * @param data Memory holding at least 4 bytes
+ * @return uint32_t Hash of the bytes (0 to LZ_HASH_SIZE - 1)
+ */
+static inline uint32_t hash_position(const unsigned char* data) {
+    uint32_t word;
+    memcpy(&word, data, sizeof(word));
+    return (word * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/**
+ * @brief Record a position in its hash chain
+ * 
+ * @param finder Match finder of the block
+ * @param input Block being compressed
+ * @param position Position to be recorded (at least 4 bytes before the end)
+ */
+static inline void insert_position(match_finder* finder, const unsigned char* input, size_t position) {
+    uint32_t hash = hash_position(input + position);
+    finder->chain[position & LZ_WINDOW_MASK] = finder->head[hash];
+    finder->head[hash] = (uint32_t)(position + 1);
+}
+
+/**
+ * @brief Find the longest earlier match of the bytes at a position
+ * 
+ * @param finder Match finder of the block
+ * @param input Block being compressed
+ * @param length Length of the block in bytes
+ * @param position Position to be matched
+ * @param offset Pointer loaded with the distance back to the match
+ * @return size_t Length of the match (0 if none)
+ */
+static size_t find_match(const match_finder* finder, const unsigned char* input, size_t length,
+                         size_t position, size_t* offset) {
+    size_t limit = length - position;
+    if (limit > LZ_MAX_MATCH) {
+        limit = LZ_MAX_MATCH;
+    }
+
+    size_t best = 0;
+    uint32_t candidate = finder->head[hash_position(input + position)];
+    for (unsigned int depth = 0; candidate != 0 && depth < LZ_MAX_CHAIN; depth++) {
+        size_t earlier = candidate - 1;
+        if (position - earlier > LZ_WINDOW_SIZE) {
+            break;
+        }
+
+        // Check the byte past the best first, most candidates fail there
+        if (input[earlier + best] == input[position + best]) {
+            size_t match = 0;
+            while (match < limit && input[earlier + match] == input[position + match]) {
+                match++;
+            }
+            if (match > best) {
+                best = match;
+                *offset = position - earlier;
+                if (best == limit) {
+                    break;
+                }
+            }
+        }
+
+        candidate = finder->chain[earlier & LZ_WINDOW_MASK];
+    }
+
+    return best;
+}
+
+/**
+ * @brief Count the bits needed to code bytes one at a time
+ * 
+ * @param history Packed history before the first byte (see history_match.h)
+ * @param input First byte to be coded
+ * @param count Number of bytes to be coded
+ * @return size_t Bits taken by history and literal tokens
+ */
+static size_t plain_cost(uint64_t history, const unsigned char* input, size_t count) {
+    size_t bits = 0;
+    for (size_t i = 0; i < count; i++) {
+        bits += (match_history(history, input[i]) != NO_MATCH) ? HISTORY_TOKEN_BITS : LITERAL_TOKEN_BITS;
+        UPDATE_HISTORY(history, input[i]);
+    }
+    return bits;
+}
+
+/**
+ * @brief Compress a block of memory with the version 2 tokens
+ * 
+ * @param input Block to be compressed
+ * @param length Length of the block in bytes
+ * @param output Memory to hold the compressed block
+ * @param capacity Size of the output memory (MAX_ENCODED_SIZE(length) always fits)
+ * @param encoded_length Pointer loaded with the length of the compressed block
+ * @param finder Match finder to be reset and used for the block
+ * @return int 0 on success : negative on failure
+ */
+int encode_block_lz(const unsigned char* input, size_t length,
+                    unsigned char* output, size_t capacity, size_t* encoded_length,
+                    match_finder* finder) {
+    span_writer writer;
+    span_writer_init(&writer, output, capacity);
+
+    // Matches never reach into an earlier block
+    memset(finder->head, 0, sizeof(finder->head));
+
+    // Previously seen characters, packed latest first (see history_match.h).
+    uint64_t history = 0;
+    int status = SUCCESS;
+    size_t i = 0;
+
+    while (i < length && status == SUCCESS) {
+
+        // Measure the run of the previous byte
+        size_t run = 0;
+        if (i > 0) {
+            while (run < RUN_MAX_LENGTH && i + run < length && input[i + run] == input[i - 1]) {
+                run++;
+            }
+        }
+
+        // Find the longest match in the window
+        size_t offset = 0;
+        size_t match = 0;
+        if (i + LZ_MIN_MATCH <= length) {
+            match = find_match(finder, input, length, i, &offset);
+        }
+
+        // Keep the token saving the most bits over single byte tokens
+        long run_saving = 0;
+        long match_saving = 0;
+        if (run >= RUN_MIN_LENGTH) {
+            run_saving = (long)plain_cost(history, input + i, run) - RUN_TOKEN_BITS;
+        }
+        if (match >= LZ_MIN_MATCH) {
+            match_saving = (long)plain_cost(history, input + i, match) - LZ_TOKEN_BITS;
+        }
+
+        size_t count = 1;
+        if (run_saving > 0 && run_saving >= match_saving) {
+            // Write 111 followed by the length of the run.
+            status = span_write_bits(&writer, (0x7u << 8) | (uint32_t)(run - RUN_MIN_LENGTH), RUN_TOKEN_BITS);
+            count = run;
+        } else if (match_saving > 0) {
+            // Write 110 followed by the length and offset of the match.
+            status = span_write_bits(&writer, (0x6u << 8) | (uint32_t)(match - LZ_MIN_MATCH), 11);
+            if (status == SUCCESS) {
+                status = span_write_bits(&writer, (uint32_t)(offset - 1), LZ_OFFSET_BITS);
+            }
+            count = match;
+        } else {
+            int index = match_history(history, input[i]);
+            if (index != NO_MATCH) {
+                // Write a 0 bit followed by a 3-bit offset.
+                status = span_write_bits(&writer, (uint32_t)index, HISTORY_TOKEN_BITS);
+            } else {
+                // Write 10 followed by the byte.
+                status = span_write_bits(&writer, (0x2u << 8) | input[i], LITERAL_TOKEN_BITS);
+            }
+        }
+
+        // Record every coded position
+        for (size_t end = i + count; i < end; i++) {
+            if (i + LZ_MIN_MATCH <= length) {
+                insert_position(finder, input, i);
+            }
+            UPDATE_HISTORY(history, input[i]);
+        }
+    }
+
+    if (status < 0) {
+        return status;
+    }
+    return span_writer_finish(&writer, encoded_length);
+}
+
+/**
+ * @brief Load the next 64 bits at a bit position, bits past the end are zero
+ * 
+ * @param input Compressed block
+ * @param encoded_length Length of the compressed block in bytes
+ * @param bit_position Position of the next bit
+ * @return uint64_t Next bits, the next bit at the MSB (57 or more are valid)
+ */
+static inline uint64_t peek_word(const unsigned char* input, size_t encoded_length, size_t bit_position) {
+    size_t byte = bit_position >> 3;
+    uint64_t word = 0;
+
+    if (byte + sizeof(uint64_t) <= encoded_length) {
+        word = load_be64(input + byte);
+    } else {
+        for (size_t i = byte; i < byte + sizeof(uint64_t); i++) {
+            word = (word << 8) | ((i < encoded_length) ? input[i] : 0);
+        }
+    }
+
+    return word << (bit_position & 7);
+}
+
+/**
+ * @brief Decompress a block of memory holding version 2 tokens
+ * 
+ * @param input Compressed block
+ * @param encoded_length Length of the compressed block in bytes
+ * @param output Memory to hold the original block
+ * @param length Length of the original block in bytes
+ * @return int 0 on success : negative on failure
+ */
+int decode_block_lz(const unsigned char* input, size_t encoded_length,
+                    unsigned char* output, size_t length) {
+    size_t total_bits = encoded_length * 8;
+    size_t bit_position = 0;
+    size_t i = 0;
+
+    while (i < length) {
+        uint64_t word = peek_word(input, encoded_length, bit_position);
+        unsigned int bits;
+        size_t count = 1;
+
+        if ((word >> 63) == 0) {
+            // 0 bit followed by a 3-bit offset, counting back from the latest byte
+            size_t index = (word >> 60) & 0x7;
+            output[i] = (index < i) ? output[i - 1 - index] : 0;
+            bits = HISTORY_TOKEN_BITS;
+        } else if ((word >> 62) == 0x2) {
+            // 10 followed by the byte
+            output[i] = (unsigned char)(word >> 54);
+            bits = LITERAL_TOKEN_BITS;
+        } else {
+            count = (size_t)((word >> 53) & 0xFF);
+            if ((word >> 61) == 0x6) {
+                // 110 followed by the length and offset of the match
+                size_t offset = (size_t)((word >> (53 - LZ_OFFSET_BITS)) & LZ_WINDOW_MASK) + 1;
+                count += LZ_MIN_MATCH;
+                bits = LZ_TOKEN_BITS;
+                if (offset > i || count > length - i) {
+                    return ERR_INVALID_CONTAINER;
+                }
+
+                // Copy a byte at a time, the match may overlap the bytes it writes
+                for (size_t j = i; j < i + count; j++) {
+                    output[j] = output[j - offset];
+                }
+            } else {
+                // 111 followed by the length of the run
+                count += RUN_MIN_LENGTH;
+                bits = RUN_TOKEN_BITS;
+                if (i == 0 || count > length - i) {
+                    return ERR_INVALID_CONTAINER;
+                }
+                memset(output + i, output[i - 1], count);
+            }
+        }
+
+        // Every token must lie within the block
+        if (bits > total_bits - bit_position) {
+            return ERR_INVALID_CONTAINER;
+        }
+        bit_position += bits;
+        i += count;
+    }
+
+    // Only the padding of the last byte may be left
+    if (((bit_position + 7) >> 3) != encoded_length) {
+        return ERR_INVALID_CONTAINER;
+    }
+
+    return SUCCESS;
+}
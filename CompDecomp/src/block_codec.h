@@ -0,0 +1,119 @@
+/*
+===========================================================================
+ PROJECT: Compression and Decompression Algorithm
+===========================================================================
+ NAME: Tyler Neal
+ DATE: 02/20/2025
+ FILE NAME: block_codec.h
+ DESCRIPTION:
+    This file contains function definitions for compressing and
+    decompressing a block held in memory, as well as additional macros.
+
+    A block is coded with the same tokens as the original stream, but the
+    history starts empty for every block and no state is shared between
+    calls, so blocks can be coded independently and in parallel.
+
+    Version 2 blocks add LZ77 tokens copying up to LZ_MAX_MATCH bytes from
+    the last LZ_WINDOW_SIZE bytes of the block, and run tokens repeating
+    the previous byte:
+
+        0   <history index (3)>
+        10  <byte (8)>
+        110 <length - LZ_MIN_MATCH (8)> <offset - 1 (LZ_OFFSET_BITS)>
+        111 <length - RUN_MIN_LENGTH (8)>
+===========================================================================
+*/
+
+#ifndef BLOCK_CODEC_H
+#define BLOCK_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* ===================================================================
+                                Macros
+=================================================================== */
+
+// Every byte costs at most 10 bits, plus padding of the last byte
+#define MAX_ENCODED_SIZE(length) ((length) + ((length) / 4) + 8)
+
+#define LZ_OFFSET_BITS 16
+#define LZ_WINDOW_SIZE (1 << LZ_OFFSET_BITS)    // farthest match offset
+#define LZ_WINDOW_MASK (LZ_WINDOW_SIZE - 1)
+#define LZ_HASH_BITS 15
+#define LZ_HASH_SIZE (1 << LZ_HASH_BITS)
+#define LZ_MAX_CHAIN 32                          // candidates tried per position
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_MATCH (LZ_MIN_MATCH + 255)
+#define RUN_MIN_LENGTH 3
+#define RUN_MAX_LENGTH (RUN_MIN_LENGTH + 255)
+
+/* ===================================================================
+                              Structures
+=================================================================== */
+
+// Hash chains over the window of a version 2 block, allocated once per
+// stream (or thread) and reused for every block
+typedef struct {
+    uint32_t head[LZ_HASH_SIZE];        // latest position + 1 of each hash (0 if none)
+    uint32_t chain[LZ_WINDOW_SIZE];     // previous position + 1 with the same hash
+} match_finder;
+
+/* ===================================================================
+                         Function Declarations
+=================================================================== */
+
+/**
+ * @brief Compress a block of memory
+ * 
+ * @param input Block to be compressed
+ * @param length Length of the block in bytes
+ * @param output Memory to hold the compressed block
+ * @param capacity Size of the output memory (MAX_ENCODED_SIZE(length) always fits)
+ * @param encoded_length Pointer loaded with the length of the compressed block
+ * @return int 0 on success : negative on failure
+ */
+int encode_block(const unsigned char* input, size_t length,
+                 unsigned char* output, size_t capacity, size_t* encoded_length);
+
+/**
+ * @brief Decompress a block of memory
+ * 
+ * @param input Compressed block
+ * @param encoded_length Length of the compressed block in bytes
+ * @param output Memory to hold the original block
+ * @param length Length of the original block in bytes
+ * @return int 0 on success : negative on failure
+ */
+int decode_block(const unsigned char* input, size_t encoded_length,
+                 unsigned char* output, size_t length);
+
+/**
+ * @brief Compress a block of memory with the version 2 tokens
+ * 
+ * @param input Block to be compressed
+ * @param length Length of the block in bytes
+ * @param output Memory to hold the compressed block
+ * @param capacity Size of the output memory (MAX_ENCODED_SIZE(length) always fits)
+ * @param encoded_length Pointer loaded with the length of the compressed block
+ * @param finder Match finder to be reset and used for the block
+ * @return int 0 on success : negative on failure
+ */
+int encode_block_lz(const unsigned char* input, size_t length,
+                    unsigned char* output, size_t capacity, size_t* encoded_length,
+                    match_finder* finder);
+
+/**
+ * @brief Decompress a block of memory holding version 2 tokens
+ * 
+ * @param input Compressed block
+ * @param encoded_length Length of the compressed block in bytes
+ * @param output Memory to hold the original block
+ * @param length Length of the original block in bytes
+ * @return int 0 on success : negative on failure
+ */
+int decode_block_lz(const unsigned char* input, size_t encoded_length,
+                    unsigned char* output, size_t length);
+
+
+#endif // BLOCK_CODEC_H
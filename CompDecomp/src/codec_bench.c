@@ -0,0 +1,430 @@
+/*
+===========================================================================
+ PROJECT: Compression and Decompression Algorithm
+===========================================================================
+ NAME: Tyler Neal
+ DATE: 02/20/2025
+ FILE NAME: codec_bench.c
+ DESCRIPTION:
+    This program benchmarks every mode of the compress and decompress
+    executables on the files given as arguments.
+
+    Each mode compresses and decompresses every file the given number of
+    rounds through the executables, exactly as a user would run them. The
+    wall time and peak resident memory of every run are recorded, and the
+    decompressed output must match the original file. The median and 95th
+    percentile throughput, the compression ratio and the peak memory of
+    every mode are printed, and can also be written as CSV or JSON to
+    track regressions between builds.
+
+    Usage: ./codec_bench [-r <rounds>] [-t <threads>] [-d <executable directory>]
+                         [-c <csv file>] [-j <json file>] <file> [<file> ...]
+===========================================================================
+*/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+/* ===================================================================
+                                Macros
+=================================================================== */
+
+#define ROUNDS_FLAG "-r"
+#define THREADS_FLAG "-t"
+#define DIRECTORY_FLAG "-d"
+#define CSV_FLAG "-c"
+#define JSON_FLAG "-j"
+#define DEFAULT_ROUNDS 5
+#define DEFAULT_THREADS 4
+#define MAX_ARGUMENTS 8
+
+/* ===================================================================
+                              Structures
+=================================================================== */
+
+// Flags passed to the executables by a mode, "-t" is followed by the thread count
+typedef struct {
+    const char* name;
+    const char* compress_flags[MAX_ARGUMENTS];
+    const char* decompress_flags[MAX_ARGUMENTS];
+} bench_mode;
+
+static const bench_mode modes[] = {
+    { "stream-serial",  { "-l", NULL },                 { "-s", NULL } },
+    { "stream-table",   { "-l", NULL },                 { NULL } },
+    { "block",          { "-t", "1", NULL },            { "-t", "1", NULL } },
+    { "block-parallel", { "-t", NULL },                 { "-t", NULL } },
+    { "block-v2",       { "-v", "2", "-t", NULL },      { "-t", NULL } },
+};
+#define MODE_COUNT (sizeof(modes) / sizeof(modes[0]))
+
+// Measurements of one mode on one file
+typedef struct {
+    const char* mode;
+    const char* file;
+    size_t original_bytes;
+    size_t compressed_bytes;
+    double compress_median;         // MB/s
+    double compress_p95;            // MB/s of the 95th percentile slowest run
+    double decompress_median;
+    double decompress_p95;
+    long compress_rss;              // peak KB over every round
+    long decompress_rss;
+    int verified;                   // 1 if every round trip matched
+} bench_result;
+
+/* ===================================================================
+                           Helper Functions
+=================================================================== */
+
+/**
+ * @brief Get the current monotonic time
+ *
+ * @return double Time in seconds
+ */
+static double now_seconds() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + (time.tv_nsec / 1e9);
+}
+
+/**
+ * @brief Load an entire file into memory
+ *
+ * @param path Path of the file to be loaded
+ * @param length Pointer loaded with the length of the file
+ * @return unsigned char* Contents of the file : NULL on failure
+ */
+static unsigned char* load_file(const char* path, size_t* length) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char* data = malloc((size > 0) ? (size_t)size : 1);
+    if (data == NULL || size < 0 || fread(data, 1, (size_t)size, file) != (size_t)size) {
+        free(data);
+        fclose(file);
+        return NULL;
+    }
+
+    fclose(file);
+    *length = (size_t)size;
+    return data;
+}
+
+/**
+ * @brief Run an executable with its standard input and output redirected to files
+ *
+ * @param arguments Executable followed by its flags, NULL terminated
+ * @param input_path File read as standard input
+ * @param output_path File written as standard output
+ * @param seconds Pointer loaded with the wall time of the run
+ * @param rss Pointer loaded with the peak resident memory of the run in KB
+ * @return int 0 if the executable succeeded : -1 otherwise
+ */
+static int run_executable(char* const arguments[], const char* input_path, const char* output_path,
+                          double* seconds, long* rss) {
+    double start = now_seconds();
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        return -1;
+    }
+    if (pid == 0) {
+        int input = open(input_path, O_RDONLY);
+        int output = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (input == -1 || output == -1 ||
+            dup2(input, STDIN_FILENO) == -1 || dup2(output, STDOUT_FILENO) == -1) {
+            _exit(127);
+        }
+        execv(arguments[0], arguments);
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) == -1) {
+        return -1;
+    }
+    *seconds = now_seconds() - start;
+    *rss = usage.ru_maxrss;
+
+    return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? 0 : -1;
+}
+
+/**
+ * @brief Build the argument list of an executable for a mode
+ *
+ * @param arguments Array to be loaded (MAX_ARGUMENTS + 2 entries)
+ * @param executable Path of the executable
+ * @param flags Flags of the mode, NULL terminated
+ * @param threads Thread count following a "-t" flag without one
+ */
+static void build_arguments(char* arguments[], char* executable, const char* const flags[],
+                            char* threads) {
+    int count = 0;
+    arguments[count++] = executable;
+    for (int i = 0; i < MAX_ARGUMENTS && flags[i] != NULL; i++) {
+        arguments[count++] = (char*)flags[i];
+        if (strcmp(flags[i], THREADS_FLAG) == 0 && (i + 1 == MAX_ARGUMENTS || flags[i + 1] == NULL)) {
+            arguments[count++] = threads;
+        }
+    }
+    arguments[count] = NULL;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double difference = *(const double*)a - *(const double*)b;
+    return (difference > 0) - (difference < 0);
+}
+
+/**
+ * @brief Get a nearest rank percentile of the run times
+ *
+ * @param times Run times, sorted in place
+ * @param count Number of runs
+ * @param percentile Percentile to be found (1-100)
+ * @return double Run time at the percentile
+ */
+static double percentile_time(double* times, int count, int percentile) {
+    qsort(times, (size_t)count, sizeof(double), compare_doubles);
+    int rank = (percentile * count + 99) / 100;
+    return times[(rank > 0) ? (rank - 1) : 0];
+}
+
+/* ===================================================================
+                               Reports
+=================================================================== */
+
+static void write_csv(FILE* file, const bench_result* results, size_t count) {
+    fprintf(file, "mode,file,original_bytes,compressed_bytes,ratio,"
+                  "compress_mbps_median,compress_mbps_p95,decompress_mbps_median,"
+                  "decompress_mbps_p95,compress_rss_kb,decompress_rss_kb,verified\n");
+    for (size_t i = 0; i < count; i++) {
+        const bench_result* r = &results[i];
+        fprintf(file, "%s,%s,%zu,%zu,%.4f,%.2f,%.2f,%.2f,%.2f,%ld,%ld,%s\n",
+                r->mode, r->file, r->original_bytes, r->compressed_bytes,
+                r->original_bytes ? (double)r->compressed_bytes / r->original_bytes : 0.0,
+                r->compress_median, r->compress_p95, r->decompress_median, r->decompress_p95,
+                r->compress_rss, r->decompress_rss, r->verified ? "true" : "false");
+    }
+}
+
+static void write_json(FILE* file, const bench_result* results, size_t count, int rounds, int threads) {
+    fprintf(file, "{\n  \"rounds\": %d,\n  \"threads\": %d,\n  \"results\": [\n", rounds, threads);
+    for (size_t i = 0; i < count; i++) {
+        const bench_result* r = &results[i];
+        fprintf(file, "    {\"mode\": \"%s\", \"file\": \"%s\", \"original_bytes\": %zu, "
+                      "\"compressed_bytes\": %zu, \"ratio\": %.4f, "
+                      "\"compress_mbps_median\": %.2f, \"compress_mbps_p95\": %.2f, "
+                      "\"decompress_mbps_median\": %.2f, \"decompress_mbps_p95\": %.2f, "
+                      "\"compress_rss_kb\": %ld, \"decompress_rss_kb\": %ld, \"verified\": %s}%s\n",
+                r->mode, r->file, r->original_bytes, r->compressed_bytes,
+                r->original_bytes ? (double)r->compressed_bytes / r->original_bytes : 0.0,
+                r->compress_median, r->compress_p95, r->decompress_median, r->decompress_p95,
+                r->compress_rss, r->decompress_rss, r->verified ? "true" : "false",
+                (i + 1 < count) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+}
+
+/* ===================================================================
+                                 Main
+=================================================================== */
+
+int main(int argc, char *argv[]) {
+    int rounds = DEFAULT_ROUNDS;
+    int threads = DEFAULT_THREADS;
+    const char* directory = ".";
+    const char* csv_path = NULL;
+    const char* json_path = NULL;
+
+    // Parse the flags
+    int first_file = 1;
+    while (first_file + 1 < argc && argv[first_file][0] == '-') {
+        const char* flag = argv[first_file];
+        const char* value = argv[first_file + 1];
+        if (strcmp(flag, ROUNDS_FLAG) == 0) {
+            rounds = atoi(value);
+        } else if (strcmp(flag, THREADS_FLAG) == 0) {
+            threads = atoi(value);
+        } else if (strcmp(flag, DIRECTORY_FLAG) == 0) {
+            directory = value;
+        } else if (strcmp(flag, CSV_FLAG) == 0) {
+            csv_path = value;
+        } else if (strcmp(flag, JSON_FLAG) == 0) {
+            json_path = value;
+        } else {
+            break;
+        }
+        first_file += 2;
+    }
+    if (rounds < 1 || threads < 1 || first_file >= argc) {
+        fprintf(stderr, "Usage: %s [" ROUNDS_FLAG " <rounds>] [" THREADS_FLAG " <threads>] "
+                        "[" DIRECTORY_FLAG " <executable directory>] [" CSV_FLAG " <csv file>] "
+                        "[" JSON_FLAG " <json file>] <file> [<file> ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Every file must be readable before anything is run or printed
+    for (int f = first_file; f < argc; f++) {
+        size_t length = 0;
+        unsigned char* original = load_file(argv[f], &length);
+        if (original == NULL) {
+            fprintf(stderr, "Failed to load '%s'\n", argv[f]);
+            return EXIT_FAILURE;
+        }
+        free(original);
+    }
+
+    // Executables and scratch files shared by every run
+    char compress_path[4096];
+    char decompress_path[4096];
+    char thread_count[16];
+    snprintf(compress_path, sizeof(compress_path), "%s/compress", directory);
+    snprintf(decompress_path, sizeof(decompress_path), "%s/decompress", directory);
+    snprintf(thread_count, sizeof(thread_count), "%d", threads);
+
+    char compressed_path[] = "/tmp/codec_bench_XXXXXX";
+    char decompressed_path[] = "/tmp/codec_bench_XXXXXX";
+    int compressed_fd = mkstemp(compressed_path);
+    int decompressed_fd = mkstemp(decompressed_path);
+
+    // Every exit from here on goes through cleanup, which unlinks the scratch files
+    int failed = 0;
+    size_t count = 0;
+    size_t file_count = (size_t)(argc - first_file);
+    bench_result* results = NULL;
+    double* compress_times = NULL;
+    double* decompress_times = NULL;
+    if (compressed_fd == -1 || decompressed_fd == -1) {
+        fprintf(stderr, "Failed to create scratch files\n");
+        failed = 1;
+        goto cleanup;
+    }
+    close(compressed_fd);
+    close(decompressed_fd);
+
+    results = calloc(MODE_COUNT * file_count, sizeof(bench_result));
+    compress_times = malloc((size_t)rounds * sizeof(double));
+    decompress_times = malloc((size_t)rounds * sizeof(double));
+    if (results == NULL || compress_times == NULL || decompress_times == NULL) {
+        fprintf(stderr, "Failed to allocate results\n");
+        failed = 1;
+        goto cleanup;
+    }
+
+    printf("%-15s %-14s %9s %7s %9s %9s %9s %9s %9s %9s %s\n", "Mode", "File", "Bytes", "Ratio",
+           "C MB/s", "C p95", "D MB/s", "D p95", "C RSS KB", "D RSS KB", "Check");
+    for (size_t m = 0; m < MODE_COUNT; m++) {
+        char* compress_arguments[MAX_ARGUMENTS + 2];
+        char* decompress_arguments[MAX_ARGUMENTS + 2];
+        build_arguments(compress_arguments, compress_path, modes[m].compress_flags, thread_count);
+        build_arguments(decompress_arguments, decompress_path, modes[m].decompress_flags, thread_count);
+
+        for (int f = first_file; f < argc; f++) {
+            size_t length = 0;
+            unsigned char* original = load_file(argv[f], &length);
+            if (original == NULL) {
+                fprintf(stderr, "Failed to load '%s'\n", argv[f]);
+                failed = 1;
+                goto cleanup;
+            }
+
+            bench_result* result = &results[count++];
+            const char* name = strrchr(argv[f], '/');
+            result->mode = modes[m].name;
+            result->file = (name != NULL) ? (name + 1) : argv[f];
+            result->original_bytes = length;
+            result->verified = 1;
+
+            // Time every round trip, each must reproduce the original file
+            for (int r = 0; r < rounds; r++) {
+                long rss = 0;
+                if (run_executable(compress_arguments, argv[f], compressed_path,
+                                   &compress_times[r], &rss) < 0) {
+                    result->verified = 0;
+                }
+                result->compress_rss = (rss > result->compress_rss) ? rss : result->compress_rss;
+
+                if (run_executable(decompress_arguments, compressed_path, decompressed_path,
+                                   &decompress_times[r], &rss) < 0) {
+                    result->verified = 0;
+                }
+                result->decompress_rss = (rss > result->decompress_rss) ? rss : result->decompress_rss;
+
+                size_t decompressed_length = 0;
+                unsigned char* decompressed = load_file(decompressed_path, &decompressed_length);
+                if (decompressed == NULL || decompressed_length != length ||
+                    memcmp(decompressed, original, length) != 0) {
+                    result->verified = 0;
+                }
+                free(decompressed);
+
+                unsigned char* compressed = load_file(compressed_path, &result->compressed_bytes);
+                free(compressed);
+            }
+            free(original);
+
+            // The 95th percentile run is the slow tail, so its throughput is the lower one
+            double megabytes = (double)length / 1e6;
+            result->compress_median = megabytes / percentile_time(compress_times, rounds, 50);
+            result->compress_p95 = megabytes / percentile_time(compress_times, rounds, 95);
+            result->decompress_median = megabytes / percentile_time(decompress_times, rounds, 50);
+            result->decompress_p95 = megabytes / percentile_time(decompress_times, rounds, 95);
+            failed |= !result->verified;
+
+            printf("%-15s %-14s %9zu %6.1f%% %9.1f %9.1f %9.1f %9.1f %9ld %9ld %s\n",
+                   result->mode, result->file, length,
+                   length ? (100.0 * result->compressed_bytes) / length : 0.0,
+                   result->compress_median, result->compress_p95,
+                   result->decompress_median, result->decompress_p95,
+                   result->compress_rss, result->decompress_rss,
+                   result->verified ? "ok" : "FAILED");
+        }
+    }
+
+    // Write the machine readable reports
+    const char* paths[2] = { csv_path, json_path };
+    for (int p = 0; p < 2; p++) {
+        if (paths[p] == NULL) {
+            continue;
+        }
+        FILE* file = fopen(paths[p], "w");
+        if (file == NULL) {
+            fprintf(stderr, "Failed to write '%s'\n", paths[p]);
+            failed = 1;
+            continue;
+        }
+        if (p == 0) {
+            write_csv(file, results, count);
+        } else {
+            write_json(file, results, count, rounds, threads);
+        }
+        fclose(file);
+    }
+
+cleanup:
+    if (compressed_fd != -1) {
+        unlink(compressed_path);
+    }
+    if (decompressed_fd != -1) {
+        unlink(decompressed_path);
+    }
+    free(results);
+    free(compress_times);
+    free(decompress_times);
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -16,17 +16,50 @@
     symbol. If the byte has been seen before, it outputs the position of 
     the previous byte relative to the current position. Otherwise, the symbol 
     is output as is, prefixed with a binary one.
+
+    The 8 previous bytes are packed into a single 64-bit value, so a match
+    is found with one vector compare (see history_match.c) and the history
+    is updated with a shift.
+
+    By default the input is split into blocks of DEFAULT_BLOCK_SIZE bytes
+    that are compressed independently on several threads and framed in a
+    block container (see container.h). Passing VERSION_FLAG 2 codes the
+    blocks with LZ77 and run tokens as well (see block_codec.h), and
+    passing LEGACY_STREAM_FLAG writes the original single stream instead.
 ===========================================================================
 */
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include "bit_ops.h"
-
-
-int main(int argc, char *argv[]) {
-
-    // Array of previously seen characters.
-    char previous[8] = {0};
+#include "container.h"
+#include "history_match.h"
+
+/* ===================================================================
+                                Macros
+=================================================================== */
+
+#define LEGACY_STREAM_FLAG "-l"
+#define THREADS_FLAG "-t"            // followed by the number of threads
+#define BLOCK_SIZE_FLAG "-k"         // followed by the block size in KB
+#define VERSION_FLAG "-v"            // followed by the codec version of the container
+
+/* ===================================================================
+                              Compressors
+=================================================================== */
+
+/**
+ * @brief Compress the input as a single stream (no container)
+ *
+ * @return int 0 on success : negative on failure
+ */
+static int compress_stream() {
+
+    // Previously seen characters, packed latest first (see history_match.h).
+    uint64_t history = 0;
     unsigned short byte = 0;
 
     // Continue processing until EOF.
@@ -41,41 +74,56 @@ int main(int argc, char *argv[]) {
             break;
         }
 
-        // Compare with the previous eight bytes.
-        bool is_duplicate = false;
-        for (int i = 0; i < 8; i++) {
-
-            // Skip until matchi is found
-            if (byte != previous[i]) {
-                continue;
-            }
+        // Compare with the previous eight bytes in one operation.
+        int match = match_history(history, byte);
 
+        if (match != NO_MATCH) {
             // Write a 0 bit followed by a 3-bit offset.
-            CHECK_WRITE(write_bit(0));
-            for (int j = 2; j >= 0; j--) {
-                write_bit((i >> j) & 1);
-            }
-
-            is_duplicate = true;
-            break; // Exit the loop if a match is found.
-        }
-
-        // If no match was found.
-        if (!is_duplicate) {
-            CHECK_WRITE(write_bit(1));
-            CHECK_WRITE(write_byte(byte));
+            CHECK_WRITE(write_bits(match, 4));
+        } else {
+            // Write a 1 bit followed by the byte.
+            CHECK_WRITE(write_bits((1 << 8) | byte, 9));
         }
 
         // Update the list of previously seen bytes.
-        for (int i = 7; i > 0; i--) {
-            previous[i] = previous[i - 1];
-        }
-        previous[0] = byte;
+        UPDATE_HISTORY(history, byte);
     }
 
     // Flush any remaining data in the write buffer.
     CHECK_WRITE(flush_write_buffer());
 
-    // Exit successfully.
     return SUCCESS;
-}
\ No newline at end of file
+}
+
+/* ===================================================================
+                                 Main
+=================================================================== */
+
+int main(int argc, char *argv[]) {
+    bool legacy = false;
+    unsigned int threads = default_thread_count();
+    size_t block_size = DEFAULT_BLOCK_SIZE;
+    unsigned int version = CONTAINER_VERSION;
+
+    // Parse the flags
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], LEGACY_STREAM_FLAG) == 0) {
+            legacy = true;
+        } else if (strcmp(argv[i], THREADS_FLAG) == 0 && i + 1 < argc) {
+            threads = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], BLOCK_SIZE_FLAG) == 0 && i + 1 < argc) {
+            block_size = (size_t)strtoul(argv[++i], NULL, 10) * 1024;
+        } else if (strcmp(argv[i], VERSION_FLAG) == 0 && i + 1 < argc) {
+            version = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else {
+            return ERR_INVALID_ARGUMENT;
+        }
+    }
+
+    // The single stream only has the original tokens
+    if (legacy) {
+        return (version == CONTAINER_VERSION) ? compress_stream() : ERR_INVALID_ARGUMENT;
+    }
+
+    return compress_container(STDIN_FILENO, STDOUT_FILENO, block_size, threads, version);
+}
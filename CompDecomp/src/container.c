@@ -0,0 +1,600 @@
+/*
+===========================================================================
+ PROJECT: Compression and Decompression Algorithm
+===========================================================================
+ NAME: Tyler Neal
+ DATE: 02/20/2025
+ FILE NAME: container.c
+ DESCRIPTION:
+    This file contains function implementations for the framed block
+    container (see container.h for the layout).
+
+    Compression reads up to one block per thread, codes the blocks on
+    their own threads, and then writes them in their original order
+    before reading the next group. Decompression does the same with the
+    compressed blocks, and a single block can be decoded by looking up
+    its offset in the index at the end of the container.
+===========================================================================
+*/
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "bit_ops.h"
+#include "block_codec.h"
+#include "container.h"
+
+/* ===================================================================
+                              Structures
+=================================================================== */
+
+// One block of a group, coded on its own thread
+typedef struct {
+    pthread_t thread;
+    int compressing;                // 1 to compress : 0 to decompress
+    unsigned int version;           // codec version of the block
+    match_finder* finder;           // version 2 compression only (else NULL)
+    unsigned char* input;
+    size_t input_length;
+    unsigned char* output;
+    size_t output_capacity;
+    size_t output_length;
+    int status;
+} block_slot;
+
+/* ===================================================================
+                           Helper Functions
+=================================================================== */
+
+/**
+ * @brief Store a 32-bit integer in little-endian order
+ * 
+ * @param data Memory holding at least 4 bytes
+ * @param value Integer to be stored
+ */
+void store_u32(unsigned char* data, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        data[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+/**
+ * @brief Store a 64-bit integer in little-endian order
+ * 
+ * @param data Memory holding at least 8 bytes
+ * @param value Integer to be stored
+ */
+void store_u64(unsigned char* data, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        data[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+/**
+ * @brief Load a 32-bit integer stored in little-endian order
+ * 
+ * @param data Memory holding at least 4 bytes
+ * @return uint32_t Loaded integer
+ */
+uint32_t load_u32(const unsigned char* data) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; i--) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+/**
+ * @brief Load a 64-bit integer stored in little-endian order
+ * 
+ * @param data Memory holding at least 8 bytes
+ * @return uint64_t Loaded integer
+ */
+uint64_t load_u64(const unsigned char* data) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+/**
+ * @brief Read until a buffer is full or the end of file is reached
+ * 
+ * @param fd File descriptor to read from
+ * @param buffer Buffer to be filled
+ * @param length Number of bytes wanted
+ * @return ssize_t Number of bytes read (less than length at end of file),
+ *                 negative on failure
+ */
+ssize_t read_full(int fd, unsigned char* buffer, size_t length) {
+    size_t total = 0;
+
+    while (total < length) {
+        ssize_t bytes_read = read(fd, buffer + total, length - total);
+        if (bytes_read == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return ERR_READ_FAILURE;
+        }
+
+        // Check for end of file.
+        if (bytes_read == 0) {
+            break;
+        }
+        total += (size_t)bytes_read;
+    }
+
+    return (ssize_t)total;
+}
+
+/**
+ * @brief Write an entire buffer
+ * 
+ * @param fd File descriptor to write to
+ * @param buffer Buffer to be written
+ * @param length Number of bytes in the buffer
+ * @return int 0 on success : negative on failure
+ */
+static int write_full(int fd, const unsigned char* buffer, size_t length) {
+    size_t total = 0;
+
+    while (total < length) {
+        ssize_t bytes_wrote = write(fd, buffer + total, length - total);
+        if (bytes_wrote == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return ERR_WRITE_FAILURE;
+        }
+        total += (size_t)bytes_wrote;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Read a range of a file at an offset
+ * 
+ * @param fd File descriptor to read from
+ * @param buffer Buffer to be filled
+ * @param length Number of bytes wanted
+ * @param offset Offset of the range in the file
+ * @return int 0 on success : negative on failure (including a short range)
+ */
+static int read_range(int fd, unsigned char* buffer, size_t length, uint64_t offset) {
+    size_t total = 0;
+
+    while (total < length) {
+        ssize_t bytes_read = pread(fd, buffer + total, length - total, (off_t)(offset + total));
+        if (bytes_read == -1 && errno == EINTR) {
+            continue;
+        }
+        if (bytes_read <= 0) {
+            return (bytes_read == 0) ? ERR_INVALID_CONTAINER : ERR_READ_FAILURE;
+        }
+        total += (size_t)bytes_read;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Compress or decompress the block of a slot
+ * 
+ * @param arg Pointer to the slot
+ * @return void* Always NULL, the status is stored in the slot
+ */
+static void* code_slot(void* arg) {
+    block_slot* slot = (block_slot*)arg;
+
+    if (slot->compressing && slot->version == 2) {
+        slot->status = encode_block_lz(slot->input, slot->input_length, slot->output,
+                                       slot->output_capacity, &slot->output_length, slot->finder);
+    } else if (slot->compressing) {
+        slot->status = encode_block(slot->input, slot->input_length, slot->output,
+                                    slot->output_capacity, &slot->output_length);
+    } else if (slot->version == 2) {
+        slot->status = decode_block_lz(slot->input, slot->input_length, slot->output,
+                                       slot->output_length);
+    } else {
+        slot->status = decode_block(slot->input, slot->input_length, slot->output,
+                                    slot->output_length);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Code a group of slots, one thread per slot
+ * 
+ * @param slots Array of slots to be coded
+ * @param count Number of slots in the group
+ * @return int 0 on success : negative on failure
+ */
+static int code_group(block_slot* slots, unsigned int count) {
+
+    // A single block is coded on the calling thread
+    if (count == 1) {
+        code_slot(&slots[0]);
+        return slots[0].status;
+    }
+
+    unsigned int started = 0;
+    int status = SUCCESS;
+    for (; started < count; started++) {
+        if (pthread_create(&slots[started].thread, NULL, code_slot, &slots[started]) != 0) {
+            status = ERR_THREAD_FAILURE;
+            break;
+        }
+    }
+
+    // Wait for every block, keeping the first error in block order
+    for (unsigned int i = 0; i < started; i++) {
+        pthread_join(slots[i].thread, NULL);
+        if (status == SUCCESS && slots[i].status < 0) {
+            status = slots[i].status;
+        }
+    }
+
+    return status;
+}
+
+static void free_slots(block_slot* slots, unsigned int threads) {
+    for (unsigned int i = 0; i < threads; i++) {
+        free(slots[i].input);
+        free(slots[i].output);
+        free(slots[i].finder);
+    }
+    free(slots);
+}
+
+/**
+ * @brief Allocate the input and output buffers of every slot
+ * 
+ * @param threads Number of slots
+ * @param input_size Size of each input buffer
+ * @param output_size Size of each output buffer
+ * @param compressing 1 to compress : 0 to decompress
+ * @param version Codec version of the blocks
+ * @return block_slot* Array of slots : NULL on failure
+ */
+static block_slot* allocate_slots(unsigned int threads, size_t input_size, size_t output_size,
+                                  int compressing, unsigned int version) {
+    block_slot* slots = calloc(threads, sizeof(block_slot));
+    if (slots == NULL) {
+        return NULL;
+    }
+
+    for (unsigned int i = 0; i < threads; i++) {
+        slots[i].compressing = compressing;
+        slots[i].version = version;
+        slots[i].input = malloc(input_size);
+        slots[i].output = malloc(output_size);
+        slots[i].output_capacity = output_size;
+
+        // The match finder is reused by every block coded in the slot
+        int needs_finder = (compressing && version == 2);
+        if (needs_finder) {
+            slots[i].finder = malloc(sizeof(match_finder));
+        }
+        if (slots[i].input == NULL || slots[i].output == NULL ||
+           (needs_finder && slots[i].finder == NULL)) {
+            free_slots(slots, i + 1);
+            return NULL;
+        }
+    }
+
+    return slots;
+}
+
+/* ===================================================================
+                         Container Functions
+=================================================================== */
+
+/**
+ * @brief Compress a stream into a block container
+ * 
+ * @param input_fd File descriptor of the original stream
+ * @param output_fd File descriptor to write the container to
+ * @param block_size Bytes of input per block (1-MAX_BLOCK_SIZE)
+ * @param threads Number of blocks compressed at once (1-MAX_THREADS)
+ * @param version Codec version of the blocks (1-MAX_CONTAINER_VERSION)
+ * @return int 0 on success : negative on failure
+ */
+int compress_container(int input_fd, int output_fd, size_t block_size, unsigned int threads,
+                       unsigned int version) {
+    if (block_size == 0 || block_size > MAX_BLOCK_SIZE || threads == 0 || threads > MAX_THREADS ||
+        version == 0 || version > MAX_CONTAINER_VERSION) {
+        return ERR_INVALID_ARGUMENT;
+    }
+
+    block_slot* slots = allocate_slots(threads, block_size, MAX_ENCODED_SIZE(block_size), 1, version);
+    if (slots == NULL) {
+        return ERR_ALLOCATION_FAILURE;
+    }
+
+    // Index entries, grown as blocks are written
+    unsigned char* index = NULL;
+    size_t index_capacity = 0;
+    uint32_t block_count = 0;
+    int status = SUCCESS;
+
+    // Write the header
+    unsigned char header[CONTAINER_HEADER_SIZE] = {0};
+    memcpy(header, CONTAINER_MAGIC, CONTAINER_MAGIC_SIZE);
+    header[4] = (unsigned char)version;
+    store_u32(header + 8, (uint32_t)block_size);
+    status = write_full(output_fd, header, sizeof(header));
+    uint64_t offset = CONTAINER_HEADER_SIZE;
+
+    int end_of_file = 0;
+    while (status == SUCCESS && !end_of_file) {
+
+        // Read one block per slot
+        unsigned int count = 0;
+        while (count < threads) {
+            ssize_t bytes_read = read_full(input_fd, slots[count].input, block_size);
+            if (bytes_read < 0) {
+                status = ERR_READ_FAILURE;
+                break;
+            }
+            if (bytes_read > 0) {
+                slots[count++].input_length = (size_t)bytes_read;
+            }
+            if ((size_t)bytes_read < block_size) {
+                end_of_file = 1;
+                break;
+            }
+        }
+        if (status != SUCCESS || count == 0) {
+            break;
+        }
+
+        status = code_group(slots, count);
+
+        // Write the blocks in their original order
+        for (unsigned int i = 0; i < count && status == SUCCESS; i++) {
+            unsigned char block_header[BLOCK_HEADER_SIZE];
+            store_u32(block_header, (uint32_t)slots[i].output_length);
+            store_u32(block_header + 4, (uint32_t)slots[i].input_length);
+
+            // Record the block in the index
+            if ((size_t)(block_count + 1) * INDEX_ENTRY_SIZE > index_capacity) {
+                size_t capacity = (index_capacity == 0) ? (64 * INDEX_ENTRY_SIZE) : (index_capacity * 2);
+                unsigned char* grown = realloc(index, capacity);
+                if (grown == NULL) {
+                    status = ERR_ALLOCATION_FAILURE;
+                    break;
+                }
+                index = grown;
+                index_capacity = capacity;
+            }
+            unsigned char* entry = index + ((size_t)block_count * INDEX_ENTRY_SIZE);
+            store_u64(entry, offset);
+            memcpy(entry + 8, block_header, BLOCK_HEADER_SIZE);
+            block_count++;
+
+            status = write_full(output_fd, block_header, sizeof(block_header));
+            if (status == SUCCESS) {
+                status = write_full(output_fd, slots[i].output, slots[i].output_length);
+            }
+            offset += BLOCK_HEADER_SIZE + slots[i].output_length;
+        }
+    }
+
+    // Write the end marker, index and footer
+    if (status == SUCCESS) {
+        unsigned char end[BLOCK_HEADER_SIZE] = {0};
+        status = write_full(output_fd, end, sizeof(end));
+        offset += BLOCK_HEADER_SIZE;
+    }
+    if (status == SUCCESS && block_count > 0) {
+        status = write_full(output_fd, index, (size_t)block_count * INDEX_ENTRY_SIZE);
+    }
+    if (status == SUCCESS) {
+        unsigned char footer[FOOTER_SIZE];
+        store_u64(footer, offset);
+        store_u32(footer + 8, block_count);
+        memcpy(footer + 12, FOOTER_MAGIC, 4);
+        status = write_full(output_fd, footer, sizeof(footer));
+    }
+
+    free(index);
+    free_slots(slots, threads);
+    return status;
+}
+
+/**
+ * @brief Decompress a block container into a stream
+ * 
+ * @param input_fd File descriptor of the container, positioned after the header
+ * @param output_fd File descriptor to write the original stream to
+ * @param header Container header already read from input_fd
+ * @param threads Number of blocks decompressed at once (1-MAX_THREADS)
+ * @return int 0 on success : negative on failure
+ */
+int decompress_container(int input_fd, int output_fd,
+                         const unsigned char header[CONTAINER_HEADER_SIZE], unsigned int threads) {
+    if (threads == 0 || threads > MAX_THREADS) {
+        return ERR_INVALID_ARGUMENT;
+    }
+
+    // Validate the header
+    size_t block_size = load_u32(header + 8);
+    unsigned int version = header[4];
+    if (!is_container(header, CONTAINER_HEADER_SIZE) || version == 0 || version > MAX_CONTAINER_VERSION ||
+        block_size == 0 || block_size > MAX_BLOCK_SIZE) {
+        return ERR_INVALID_CONTAINER;
+    }
+
+    block_slot* slots = allocate_slots(threads, MAX_ENCODED_SIZE(block_size), block_size, 0, version);
+    if (slots == NULL) {
+        return ERR_ALLOCATION_FAILURE;
+    }
+
+    uint32_t block_count = 0;
+    int status = SUCCESS;
+    int end_of_blocks = 0;
+    while (status == SUCCESS && !end_of_blocks) {
+
+        // Read one compressed block per slot
+        unsigned int count = 0;
+        while (count < threads) {
+            unsigned char block_header[BLOCK_HEADER_SIZE];
+            ssize_t bytes_read = read_full(input_fd, block_header, sizeof(block_header));
+            if (bytes_read != sizeof(block_header)) {
+                status = (bytes_read < 0) ? ERR_READ_FAILURE : ERR_INVALID_CONTAINER;
+                break;
+            }
+
+            size_t encoded_size = load_u32(block_header);
+            size_t original_size = load_u32(block_header + 4);
+            if (encoded_size == 0 && original_size == 0) {
+                end_of_blocks = 1;
+                break;
+            }
+            if (original_size > block_size || encoded_size > MAX_ENCODED_SIZE(original_size)) {
+                status = ERR_INVALID_CONTAINER;
+                break;
+            }
+
+            bytes_read = read_full(input_fd, slots[count].input, encoded_size);
+            if (bytes_read < 0 || (size_t)bytes_read != encoded_size) {
+                status = (bytes_read < 0) ? ERR_READ_FAILURE : ERR_INVALID_CONTAINER;
+                break;
+            }
+            slots[count].input_length = encoded_size;
+            slots[count].output_length = original_size;
+            count++;
+        }
+        if (status != SUCCESS || count == 0) {
+            break;
+        }
+
+        status = code_group(slots, count);
+
+        // Write the blocks in their original order
+        for (unsigned int i = 0; i < count && status == SUCCESS; i++) {
+            status = write_full(output_fd, slots[i].output, slots[i].output_length);
+        }
+        block_count += count;
+    }
+
+    // Skip the index, then check the footer
+    if (status == SUCCESS) {
+        unsigned char entry[INDEX_ENTRY_SIZE];
+        for (uint32_t i = 0; i < block_count && status == SUCCESS; i++) {
+            if (read_full(input_fd, entry, sizeof(entry)) != sizeof(entry)) {
+                status = ERR_INVALID_CONTAINER;
+            }
+        }
+
+        unsigned char footer[FOOTER_SIZE];
+        if (status == SUCCESS &&
+           (read_full(input_fd, footer, sizeof(footer)) != sizeof(footer) ||
+            load_u32(footer + 8) != block_count || memcmp(footer + 12, FOOTER_MAGIC, 4) != 0)) {
+            status = ERR_INVALID_CONTAINER;
+        }
+    }
+
+    free_slots(slots, threads);
+    return status;
+}
+
+/**
+ * @brief Decompress a single block of a container file through its index
+ * 
+ * @param input_fd File descriptor of the container (must be seekable)
+ * @param output_fd File descriptor to write the original block to
+ * @param block Index of the block to be decompressed (0-indexed)
+ * @return int 0 on success : negative on failure
+ */
+int extract_block(int input_fd, int output_fd, uint64_t block) {
+    struct stat file_stat;
+    if (fstat(input_fd, &file_stat) == -1 || !S_ISREG(file_stat.st_mode) ||
+        (uint64_t)file_stat.st_size < CONTAINER_HEADER_SIZE + BLOCK_HEADER_SIZE + FOOTER_SIZE) {
+        return ERR_INVALID_ARGUMENT;
+    }
+    uint64_t file_size = (uint64_t)file_stat.st_size;
+
+    // Validate the header and footer
+    unsigned char header[CONTAINER_HEADER_SIZE];
+    unsigned char footer[FOOTER_SIZE];
+    CHECK_READ(read_range(input_fd, header, sizeof(header), 0));
+    CHECK_READ(read_range(input_fd, footer, sizeof(footer), file_size - FOOTER_SIZE));
+
+    size_t block_size = load_u32(header + 8);
+    uint64_t index_offset = load_u64(footer);
+    uint32_t block_count = load_u32(footer + 8);
+    unsigned int version = header[4];
+    if (!is_container(header, sizeof(header)) || version == 0 || version > MAX_CONTAINER_VERSION ||
+        block_size == 0 || block_size > MAX_BLOCK_SIZE ||
+        memcmp(footer + 12, FOOTER_MAGIC, 4) != 0 ||
+        index_offset + ((uint64_t)block_count * INDEX_ENTRY_SIZE) + FOOTER_SIZE != file_size) {
+        return ERR_INVALID_CONTAINER;
+    }
+    if (block >= block_count) {
+        return ERR_INDEX_OUT_OF_BOUNDS;
+    }
+
+    // Look up the block in the index
+    unsigned char entry[INDEX_ENTRY_SIZE];
+    CHECK_READ(read_range(input_fd, entry, sizeof(entry), index_offset + (block * INDEX_ENTRY_SIZE)));
+    uint64_t offset = load_u64(entry);
+    size_t encoded_size = load_u32(entry + 8);
+    size_t original_size = load_u32(entry + 12);
+    if (original_size > block_size || encoded_size > MAX_ENCODED_SIZE(original_size) ||
+        offset + BLOCK_HEADER_SIZE + encoded_size > index_offset) {
+        return ERR_INVALID_CONTAINER;
+    }
+
+    block_slot* slots = allocate_slots(1, MAX_ENCODED_SIZE(original_size), original_size + 1, 0, version);
+    if (slots == NULL) {
+        return ERR_ALLOCATION_FAILURE;
+    }
+
+    // Decode the block alone
+    int status = read_range(input_fd, slots[0].input, encoded_size, offset + BLOCK_HEADER_SIZE);
+    if (status == SUCCESS) {
+        slots[0].input_length = encoded_size;
+        slots[0].output_length = original_size;
+        status = code_group(slots, 1);
+    }
+    if (status == SUCCESS) {
+        status = write_full(output_fd, slots[0].output, original_size);
+    }
+
+    free_slots(slots, 1);
+    return status;
+}
+
+/**
+ * @brief Check if data begins with the container magic
+ * 
+ * @param data Data to be checked
+ * @param length Length of the data in bytes
+ * @return int 1 if the data is a container : 0 otherwise
+ */
+int is_container(const unsigned char* data, size_t length) {
+    return (length >= CONTAINER_MAGIC_SIZE &&
+            memcmp(data, CONTAINER_MAGIC, CONTAINER_MAGIC_SIZE) == 0);
+}
+
+/**
+ * @brief Get the default number of coding threads
+ * 
+ * @return unsigned int Number of online cores (1-MAX_THREADS)
+ */
+unsigned int default_thread_count() {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cores < 1) {
+        return 1;
+    }
+    return (cores > MAX_THREADS) ? MAX_THREADS : (unsigned int)cores;
+}
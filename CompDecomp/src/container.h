@@ -0,0 +1,152 @@
+/*
+===========================================================================
+ PROJECT: Compression and Decompression Algorithm
+===========================================================================
+ NAME: Tyler Neal
+ DATE: 02/20/2025
+ FILE NAME: container.h
+ DESCRIPTION:
+    This file contains function definitions for the framed block
+    container, as well as additional macros.
+
+    Layout (all integers little-endian):
+
+        Header:  <magic "\x89CZY" (4)> <codec version (1)> <reserved (3)>
+                 <block size (4)> <reserved (4)>
+        Blocks:  <compressed size (4)> <original size (4)> <compressed data>
+        End:     <0 (4)> <0 (4)>
+        Index:   <block offset (8)> <compressed size (4)> <original size (4)>
+                 (one entry per block, offsets from the start of the header)
+        Footer:  <index offset (8)> <block count (4)> <magic "CZYE" (4)>
+
+    Blocks are compressed independently, so they can be coded on any
+    number of threads, and any block can be found through the index
+    without decoding the blocks before it.
+===========================================================================
+*/
+
+#ifndef CONTAINER_H
+#define CONTAINER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/* ===================================================================
+                                Macros
+=================================================================== */
+
+#define CONTAINER_MAGIC "\x89" "CZY"
+#define CONTAINER_MAGIC_SIZE 4
+#define CONTAINER_VERSION 1      // default codec version (see block_codec.h)
+#define MAX_CONTAINER_VERSION 2
+#define CONTAINER_HEADER_SIZE 16
+#define BLOCK_HEADER_SIZE 8
+#define INDEX_ENTRY_SIZE 16
+#define FOOTER_SIZE 16
+#define FOOTER_MAGIC "CZYE"
+
+#define DEFAULT_BLOCK_SIZE (1 << 20)     // bytes of input per block
+#define MAX_BLOCK_SIZE (1 << 26)
+#define MAX_THREADS 64
+
+/* ===================================================================
+                         Function Declarations
+=================================================================== */
+
+/**
+ * @brief Compress a stream into a block container
+ * 
+ * @param input_fd File descriptor of the original stream
+ * @param output_fd File descriptor to write the container to
+ * @param block_size Bytes of input per block (1-MAX_BLOCK_SIZE)
+ * @param threads Number of blocks compressed at once (1-MAX_THREADS)
+ * @param version Codec version of the blocks (1-MAX_CONTAINER_VERSION)
+ * @return int 0 on success : negative on failure
+ */
+int compress_container(int input_fd, int output_fd, size_t block_size, unsigned int threads,
+                       unsigned int version);
+
+/**
+ * @brief Decompress a block container into a stream
+ * 
+ * @param input_fd File descriptor of the container, positioned after the header
+ * @param output_fd File descriptor to write the original stream to
+ * @param header Container header already read from input_fd
+ * @param threads Number of blocks decompressed at once (1-MAX_THREADS)
+ * @return int 0 on success : negative on failure
+ */
+int decompress_container(int input_fd, int output_fd,
+                         const unsigned char header[CONTAINER_HEADER_SIZE], unsigned int threads);
+
+/**
+ * @brief Decompress a single block of a container file through its index
+ * 
+ * @param input_fd File descriptor of the container (must be seekable)
+ * @param output_fd File descriptor to write the original block to
+ * @param block Index of the block to be decompressed (0-indexed)
+ * @return int 0 on success : negative on failure
+ */
+int extract_block(int input_fd, int output_fd, uint64_t block);
+
+/**
+ * @brief Check if data begins with the container magic
+ * 
+ * @param data Data to be checked
+ * @param length Length of the data in bytes
+ * @return int 1 if the data is a container : 0 otherwise
+ */
+int is_container(const unsigned char* data, size_t length);
+
+/**
+ * @brief Get the default number of coding threads
+ * 
+ * @return unsigned int Number of online cores (1-MAX_THREADS)
+ */
+unsigned int default_thread_count();
+
+/**
+ * @brief Read until a buffer is full or the end of file is reached
+ * 
+ * @param fd File descriptor to read from
+ * @param buffer Buffer to be filled
+ * @param length Number of bytes wanted
+ * @return ssize_t Number of bytes read (less than length at end of file),
+ *                 negative on failure
+ */
+ssize_t read_full(int fd, unsigned char* buffer, size_t length);
+
+/**
+ * @brief Store a 32-bit integer in little-endian order
+ * 
+ * @param data Memory holding at least 4 bytes
+ * @param value Integer to be stored
+ */
+void store_u32(unsigned char* data, uint32_t value);
+
+/**
+ * @brief Store a 64-bit integer in little-endian order
+ * 
+ * @param data Memory holding at least 8 bytes
+ * @param value Integer to be stored
+ */
+void store_u64(unsigned char* data, uint64_t value);
+
+/**
+ * @brief Load a 32-bit integer stored in little-endian order
+ * 
+ * @param data Memory holding at least 4 bytes
+ * @return uint32_t Loaded integer
+ */
+uint32_t load_u32(const unsigned char* data);
+
+/**
+ * @brief Load a 64-bit integer stored in little-endian order
+ * 
+ * @param data Memory holding at least 8 bytes
+ * @return uint64_t Loaded integer
+ */
+uint64_t load_u64(const unsigned char* data);
+
+
+#endif // CONTAINER_H
@@ -0,0 +1,503 @@
+/*
+===========================================================================
+ PROJECT: Compression and Decompression Algorithm
+===========================================================================
+ NAME: Tyler Neal
+ DATE: 02/20/2025
+ FILE NAME: czy.c
+ DESCRIPTION:
+    This file contains function implementations for the library
+    interface (see czy.h).
+
+    A stream moves through the stages of the container one at a time.
+    Every call first hands any pending bytes to the output, then codes
+    the current stage, and returns as soon as it runs out of input or
+    output room, so a call can stop and resume at any byte.
+===========================================================================
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "bit_ops.h"
+#include "czy.h"
+
+/* ===================================================================
+                           Helper Functions
+=================================================================== */
+
+static size_t min_size(size_t a, size_t b) {
+    return (a < b) ? a : b;
+}
+
+/**
+ * @brief Move pending bytes into the output
+ *
+ * @param stream Stream with pending bytes
+ * @return int 1 once nothing is pending : 0 if the output is full
+ */
+static int flush_pending(czy_stream* stream) {
+    size_t length = min_size(stream->pending_length, stream->avail_out);
+
+    // Most stages have nothing pending (pending and next_out may then be NULL)
+    if (length > 0) {
+        memcpy(stream->next_out, stream->pending, length);
+        stream->next_out += length;
+        stream->avail_out -= length;
+        stream->pending += length;
+        stream->pending_length -= length;
+    }
+
+    return (stream->pending_length == 0);
+}
+
+/**
+ * @brief Gather input into the field of a stream
+ *
+ * @param stream Stream gathering a field
+ * @param length Length of the field in bytes
+ * @return int 1 once the field is complete : 0 if more input is needed
+ */
+static int gather_field(czy_stream* stream, size_t length) {
+    size_t take = min_size(length - stream->field_length, stream->avail_in);
+
+    // The caller may pass no input (and next_in may be NULL)
+    if (take > 0) {
+        memcpy(stream->field + stream->field_length, stream->next_in, take);
+        stream->next_in += take;
+        stream->avail_in -= take;
+        stream->field_length += take;
+    }
+
+    if (stream->field_length < length) {
+        return 0;
+    }
+    stream->field_length = 0;
+    return 1;
+}
+
+/**
+ * @brief Allocate the buffers shared by both directions
+ *
+ * @param stream Stream to be initialized
+ * @param block_size Bytes per block
+ * @return int 0 on success : negative on failure
+ */
+static int init_stream(czy_stream* stream, size_t block_size) {
+    memset(stream, 0, sizeof(*stream));
+    if (block_size > MAX_BLOCK_SIZE) {
+        return ERR_INVALID_ARGUMENT;
+    }
+
+    stream->block_size = (block_size == 0) ? DEFAULT_BLOCK_SIZE : block_size;
+    stream->block = malloc(stream->block_size);
+    stream->encoded = malloc(BLOCK_HEADER_SIZE + MAX_ENCODED_SIZE(stream->block_size));
+    if (stream->block == NULL || stream->encoded == NULL) {
+        czy_end(stream);
+        return ERR_ALLOCATION_FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+/* ===================================================================
+                             Compression
+=================================================================== */
+
+/**
+ * @brief Set up a stream to compress into a container
+ *
+ * @param stream Stream to be initialized
+ * @param block_size Bytes of input per block (0 for DEFAULT_BLOCK_SIZE)
+ * @param version Codec version of the blocks (1-MAX_CONTAINER_VERSION)
+ * @return int 0 on success : negative on failure
+ */
+int czy_compress_init(czy_stream* stream, size_t block_size, unsigned int version) {
+    if (version == 0 || version > MAX_CONTAINER_VERSION) {
+        memset(stream, 0, sizeof(*stream));
+        return ERR_INVALID_ARGUMENT;
+    }
+
+    int status = init_stream(stream, block_size);
+    if (status < 0) {
+        return status;
+    }
+    stream->compressing = 1;
+    stream->version = version;
+
+    stream->index = malloc(CZY_INDEX_ENTRIES * INDEX_ENTRY_SIZE);
+    stream->index_capacity = CZY_INDEX_ENTRIES;
+    if (version == 2) {
+        stream->finder = malloc(sizeof(match_finder));
+    }
+    if (stream->index == NULL || (version == 2 && stream->finder == NULL)) {
+        czy_end(stream);
+        return ERR_ALLOCATION_FAILURE;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Compress a block, straight into the output when it has room
+ *
+ * @param stream Stream compressing the block (nothing pending)
+ * @param data Original bytes of the block
+ * @param length Length of the block in bytes
+ * @return int 0 on success : negative on failure
+ */
+static int compress_block(czy_stream* stream, const unsigned char* data, size_t length) {
+
+    // Record the block in the index
+    if (stream->block_count == stream->index_capacity) {
+        unsigned char* grown = realloc(stream->index, stream->index_capacity * 2 * INDEX_ENTRY_SIZE);
+        if (grown == NULL) {
+            return ERR_ALLOCATION_FAILURE;
+        }
+        stream->index = grown;
+        stream->index_capacity *= 2;
+    }
+
+    size_t capacity = MAX_ENCODED_SIZE(length);
+    int direct = (stream->avail_out >= BLOCK_HEADER_SIZE + capacity);
+    unsigned char* target = direct ? stream->next_out : stream->encoded;
+
+    size_t encoded_length = 0;
+    int status;
+    if (stream->version == 2) {
+        status = encode_block_lz(data, length, target + BLOCK_HEADER_SIZE, capacity,
+                                 &encoded_length, stream->finder);
+    } else {
+        status = encode_block(data, length, target + BLOCK_HEADER_SIZE, capacity, &encoded_length);
+    }
+    if (status < 0) {
+        return status;
+    }
+
+    store_u32(target, (uint32_t)encoded_length);
+    store_u32(target + 4, (uint32_t)length);
+
+    unsigned char* entry = stream->index + ((size_t)stream->block_count * INDEX_ENTRY_SIZE);
+    store_u64(entry, stream->offset);
+    memcpy(entry + 8, target, BLOCK_HEADER_SIZE);
+    stream->block_count++;
+
+    size_t total = BLOCK_HEADER_SIZE + encoded_length;
+    stream->offset += total;
+    if (direct) {
+        stream->next_out += total;
+        stream->avail_out -= total;
+    } else {
+        stream->pending = stream->encoded;
+        stream->pending_length = total;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Compress as much of the input as the output has room for
+ *
+ * @param stream Stream set up by czy_compress_init()
+ * @param finish 1 once the input holds the end of the data : 0 otherwise
+ * @return int CZY_DONE, CZY_NEED_INPUT or CZY_NEED_OUTPUT : negative on failure
+ */
+int czy_compress(czy_stream* stream, int finish) {
+    if (!stream->compressing) {
+        return ERR_INVALID_ARGUMENT;
+    }
+
+    while (1) {
+        if (!flush_pending(stream)) {
+            return CZY_NEED_OUTPUT;
+        }
+
+        switch (stream->stage) {
+        case CZY_STAGE_HEADER:
+            memset(stream->field, 0, CONTAINER_HEADER_SIZE);
+            memcpy(stream->field, CONTAINER_MAGIC, CONTAINER_MAGIC_SIZE);
+            stream->field[4] = (unsigned char)stream->version;
+            store_u32(stream->field + 8, (uint32_t)stream->block_size);
+
+            stream->pending = stream->field;
+            stream->pending_length = CONTAINER_HEADER_SIZE;
+            stream->offset = CONTAINER_HEADER_SIZE;
+            stream->stage = CZY_STAGE_BLOCK;
+            break;
+
+        case CZY_STAGE_BLOCK: {
+            const unsigned char* data = stream->next_in;
+            size_t length = stream->block_size;
+
+            if (stream->block_length == 0 && stream->avail_in >= stream->block_size) {
+                // The whole block is in the input, so compress it in place
+                stream->next_in += length;
+                stream->avail_in -= length;
+            } else {
+                size_t take = min_size(stream->block_size - stream->block_length, stream->avail_in);
+                if (take > 0) {
+                    memcpy(stream->block + stream->block_length, stream->next_in, take);
+                    stream->next_in += take;
+                    stream->avail_in -= take;
+                    stream->block_length += take;
+                }
+
+                // A partial block waits for more input until the end of the data
+                if (stream->block_length < stream->block_size) {
+                    if (!finish) {
+                        return CZY_NEED_INPUT;
+                    }
+                    if (stream->block_length == 0) {
+                        stream->stage = CZY_STAGE_END;
+                        break;
+                    }
+                }
+                data = stream->block;
+                length = stream->block_length;
+                stream->block_length = 0;
+            }
+
+            int status = compress_block(stream, data, length);
+            if (status < 0) {
+                return status;
+            }
+            break;
+        }
+
+        case CZY_STAGE_END:
+            memset(stream->field, 0, BLOCK_HEADER_SIZE);
+            stream->pending = stream->field;
+            stream->pending_length = BLOCK_HEADER_SIZE;
+            stream->offset += BLOCK_HEADER_SIZE;
+            stream->stage = CZY_STAGE_INDEX;
+            break;
+
+        case CZY_STAGE_INDEX:
+            stream->pending = stream->index;
+            stream->pending_length = (size_t)stream->block_count * INDEX_ENTRY_SIZE;
+            stream->stage = CZY_STAGE_FOOTER;
+            break;
+
+        case CZY_STAGE_FOOTER:
+            store_u64(stream->field, stream->offset);
+            store_u32(stream->field + 8, stream->block_count);
+            memcpy(stream->field + 12, FOOTER_MAGIC, 4);
+            stream->pending = stream->field;
+            stream->pending_length = FOOTER_SIZE;
+            stream->stage = CZY_STAGE_DONE;
+            break;
+
+        case CZY_STAGE_DONE:
+            return (stream->avail_in == 0) ? CZY_DONE : ERR_INVALID_ARGUMENT;
+
+        default:
+            return ERR_INVALID_ARGUMENT;
+        }
+    }
+}
+
+/* ===================================================================
+                            Decompression
+=================================================================== */
+
+/**
+ * @brief Set up a stream to decompress a container
+ *
+ * @param stream Stream to be initialized
+ * @param max_block_size Largest block size accepted (0 for DEFAULT_BLOCK_SIZE)
+ * @return int 0 on success : negative on failure
+ */
+int czy_decompress_init(czy_stream* stream, size_t max_block_size) {
+    return init_stream(stream, max_block_size);
+}
+
+/**
+ * @brief Decompress a block, straight into the output when it has room
+ *
+ * @param stream Stream decompressing the block (nothing pending)
+ * @param data Compressed bytes of the block
+ * @return int 0 on success : negative on failure
+ */
+static int decompress_block(czy_stream* stream, const unsigned char* data) {
+    int direct = (stream->avail_out >= stream->original_size);
+    unsigned char* target = direct ? stream->next_out : stream->block;
+
+    int status;
+    if (stream->version == 2) {
+        status = decode_block_lz(data, stream->encoded_size, target, stream->original_size);
+    } else {
+        status = decode_block(data, stream->encoded_size, target, stream->original_size);
+    }
+    if (status < 0) {
+        return status;
+    }
+
+    if (direct) {
+        stream->next_out += stream->original_size;
+        stream->avail_out -= stream->original_size;
+    } else {
+        stream->pending = stream->block;
+        stream->pending_length = stream->original_size;
+    }
+    stream->block_count++;
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Decompress as much of the input as the output has room for
+ *
+ * @param stream Stream set up by czy_decompress_init()
+ * @return int CZY_DONE, CZY_NEED_INPUT or CZY_NEED_OUTPUT : negative on failure
+ */
+int czy_decompress(czy_stream* stream) {
+    if (stream->compressing) {
+        return ERR_INVALID_ARGUMENT;
+    }
+
+    while (1) {
+        if (!flush_pending(stream)) {
+            return CZY_NEED_OUTPUT;
+        }
+
+        switch (stream->stage) {
+        case CZY_STAGE_HEADER:
+            if (!gather_field(stream, CONTAINER_HEADER_SIZE)) {
+                return CZY_NEED_INPUT;
+            }
+
+            // Validate the header
+            stream->version = stream->field[4];
+            stream->container_block_size = load_u32(stream->field + 8);
+            if (!is_container(stream->field, CONTAINER_HEADER_SIZE) ||
+                stream->version == 0 || stream->version > MAX_CONTAINER_VERSION ||
+                stream->container_block_size == 0) {
+                return ERR_INVALID_CONTAINER;
+            }
+            if (stream->container_block_size > stream->block_size) {
+                return ERR_INVALID_ARGUMENT;
+            }
+            stream->stage = CZY_STAGE_BLOCK_HEADER;
+            break;
+
+        case CZY_STAGE_BLOCK_HEADER:
+            if (!gather_field(stream, BLOCK_HEADER_SIZE)) {
+                return CZY_NEED_INPUT;
+            }
+
+            stream->encoded_size = load_u32(stream->field);
+            stream->original_size = load_u32(stream->field + 4);
+            if (stream->encoded_size == 0 && stream->original_size == 0) {
+                stream->skip_length = (uint64_t)stream->block_count * INDEX_ENTRY_SIZE;
+                stream->stage = CZY_STAGE_INDEX;
+                break;
+            }
+            if (stream->original_size > stream->container_block_size ||
+                stream->encoded_size > MAX_ENCODED_SIZE(stream->original_size)) {
+                return ERR_INVALID_CONTAINER;
+            }
+            stream->stage = CZY_STAGE_BLOCK;
+            break;
+
+        case CZY_STAGE_BLOCK: {
+            const unsigned char* data = stream->next_in;
+
+            if (stream->encoded_length == 0 && stream->avail_in >= stream->encoded_size) {
+                // The whole block is in the input, so decompress it in place
+                stream->next_in += stream->encoded_size;
+                stream->avail_in -= stream->encoded_size;
+            } else {
+                size_t take = min_size(stream->encoded_size - stream->encoded_length, stream->avail_in);
+                if (take > 0) {
+                    memcpy(stream->encoded + stream->encoded_length, stream->next_in, take);
+                    stream->next_in += take;
+                    stream->avail_in -= take;
+                    stream->encoded_length += take;
+                }
+                if (stream->encoded_length < stream->encoded_size) {
+                    return CZY_NEED_INPUT;
+                }
+                data = stream->encoded;
+                stream->encoded_length = 0;
+            }
+
+            int status = decompress_block(stream, data);
+            if (status < 0) {
+                return status;
+            }
+            stream->stage = CZY_STAGE_BLOCK_HEADER;
+            break;
+        }
+
+        case CZY_STAGE_INDEX: {
+            // Blocks are found in order, so the index is only skipped
+            size_t take = (size_t)((stream->skip_length < stream->avail_in) ? stream->skip_length : stream->avail_in);
+            if (take > 0) {
+                stream->next_in += take;
+                stream->avail_in -= take;
+                stream->skip_length -= take;
+            }
+            if (stream->skip_length > 0) {
+                return CZY_NEED_INPUT;
+            }
+            stream->stage = CZY_STAGE_FOOTER;
+            break;
+        }
+
+        case CZY_STAGE_FOOTER:
+            if (!gather_field(stream, FOOTER_SIZE)) {
+                return CZY_NEED_INPUT;
+            }
+            if (load_u32(stream->field + 8) != stream->block_count ||
+                memcmp(stream->field + 12, FOOTER_MAGIC, 4) != 0) {
+                return ERR_INVALID_CONTAINER;
+            }
+            stream->stage = CZY_STAGE_DONE;
+            break;
+
+        // Input past the footer is left for the caller (e.g. the next container)
+        case CZY_STAGE_DONE:
+            return CZY_DONE;
+
+        default:
+            return ERR_INVALID_ARGUMENT;
+        }
+    }
+}
+
+/* ===================================================================
+                           Stream Lifetime
+=================================================================== */
+
+/**
+ * @brief Start the next container on a stream, keeping its buffers
+ *
+ * @param stream Stream set up by czy_compress_init() or czy_decompress_init()
+ */
+void czy_reset(czy_stream* stream) {
+    stream->stage = CZY_STAGE_HEADER;
+    stream->block_length = 0;
+    stream->encoded_length = 0;
+    stream->field_length = 0;
+    stream->pending = NULL;
+    stream->pending_length = 0;
+    stream->block_count = 0;
+    stream->offset = 0;
+    stream->skip_length = 0;
+}
+
+/**
+ * @brief Free the buffers of a stream
+ *
+ * @param stream Stream set up by czy_compress_init() or czy_decompress_init()
+ */
+void czy_end(czy_stream* stream) {
+    free(stream->block);
+    free(stream->encoded);
+    free(stream->finder);
+    free(stream->index);
+    stream->block = NULL;
+    stream->encoded = NULL;
+    stream->finder = NULL;
+    stream->index = NULL;
+    stream->stage = CZY_STAGE_DONE;
+}
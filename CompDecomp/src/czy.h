@@ -0,0 +1,169 @@
+/*
+===========================================================================
+ PROJECT: Compression and Decompression Algorithm
+===========================================================================
+ NAME: Tyler Neal
+ DATE: 02/20/2025
+ FILE NAME: czy.h
+ DESCRIPTION:
+    This file contains the library interface for compressing and
+    decompressing block containers (see container.h) in memory.
+
+    Every stream is held in a czy_stream owned by the caller, so any
+    number of streams can be coded at once in one process. The caller
+    points the stream at its own input and output memory and calls
+    czy_compress() or czy_decompress() until CZY_DONE is returned,
+    supplying more input on CZY_NEED_INPUT and more output room on
+    CZY_NEED_OUTPUT. Memory is only allocated by the init functions (and
+    when the index of a compressed stream doubles), never per call.
+
+    Whole blocks are coded straight from the caller's input and into the
+    caller's output when they fit, and only copied through the stream's
+    own buffers when a block is split across calls.
+
+    Example:
+
+        czy_stream stream;
+        czy_compress_init(&stream, 0, 1);
+        stream.next_in = data;
+        stream.avail_in = length;
+        stream.next_out = output;
+        stream.avail_out = capacity;
+        while ((status = czy_compress(&stream, 1)) == CZY_NEED_OUTPUT) {
+            ... write the output and reset next_out / avail_out ...
+        }
+        czy_end(&stream);
+===========================================================================
+*/
+
+#ifndef CZY_H
+#define CZY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "block_codec.h"
+#include "container.h"
+
+/* ===================================================================
+                                Macros
+=================================================================== */
+
+#define CZY_INDEX_ENTRIES 64     // index entries allocated by czy_compress_init()
+
+/* ===================================================================
+                              Structures
+=================================================================== */
+
+// Results of czy_compress() and czy_decompress() (errors are negative, see bit_ops.h)
+typedef enum {
+    CZY_DONE = 0,            // the whole container was coded
+    CZY_NEED_INPUT = 1,      // every input byte was consumed
+    CZY_NEED_OUTPUT = 2      // the output is full
+} czy_status;
+
+// Part of the container being coded
+typedef enum {
+    CZY_STAGE_HEADER,
+    CZY_STAGE_BLOCK_HEADER,
+    CZY_STAGE_BLOCK,
+    CZY_STAGE_END,
+    CZY_STAGE_INDEX,
+    CZY_STAGE_FOOTER,
+    CZY_STAGE_DONE
+} czy_stage;
+
+typedef struct {
+    // Caller owned memory, advanced past the bytes consumed and produced
+    const unsigned char* next_in;
+    size_t avail_in;
+    unsigned char* next_out;
+    size_t avail_out;
+
+    // Stream settings
+    int compressing;                // 1 to compress : 0 to decompress
+    unsigned int version;           // codec version of the blocks
+    size_t block_size;              // bytes per block (largest accepted when decompressing)
+    czy_stage stage;
+
+    // Buffers for blocks split across calls
+    unsigned char* block;           // original bytes of the current block
+    size_t block_length;
+    unsigned char* encoded;         // compressed bytes of the current block
+    size_t encoded_length;
+    match_finder* finder;           // version 2 compression only (else NULL)
+
+    // Header, block header or footer being written or gathered
+    unsigned char field[CONTAINER_HEADER_SIZE];
+    size_t field_length;
+
+    // Bytes waiting for room in the output
+    const unsigned char* pending;
+    size_t pending_length;
+
+    // Framing of the container
+    size_t container_block_size;    // block size in the header being decompressed
+    size_t encoded_size;            // sizes of the block being decompressed
+    size_t original_size;
+    uint32_t block_count;
+    uint64_t offset;                // container bytes produced so far (compressing)
+    uint64_t skip_length;           // index bytes left to skip (decompressing)
+    unsigned char* index;           // index entries of a compressed stream
+    size_t index_capacity;          // entries allocated in the index
+} czy_stream;
+
+/* ===================================================================
+                         Function Declarations
+=================================================================== */
+
+/**
+ * @brief Set up a stream to compress into a container
+ *
+ * @param stream Stream to be initialized
+ * @param block_size Bytes of input per block (0 for DEFAULT_BLOCK_SIZE)
+ * @param version Codec version of the blocks (1-MAX_CONTAINER_VERSION)
+ * @return int 0 on success : negative on failure
+ */
+int czy_compress_init(czy_stream* stream, size_t block_size, unsigned int version);
+
+/**
+ * @brief Compress as much of the input as the output has room for
+ *
+ * @param stream Stream set up by czy_compress_init()
+ * @param finish 1 once the input holds the end of the data : 0 otherwise
+ * @return int CZY_DONE, CZY_NEED_INPUT or CZY_NEED_OUTPUT : negative on failure
+ */
+int czy_compress(czy_stream* stream, int finish);
+
+/**
+ * @brief Set up a stream to decompress a container
+ *
+ * @param stream Stream to be initialized
+ * @param max_block_size Largest block size accepted (0 for DEFAULT_BLOCK_SIZE)
+ * @return int 0 on success : negative on failure
+ */
+int czy_decompress_init(czy_stream* stream, size_t max_block_size);
+
+/**
+ * @brief Decompress as much of the input as the output has room for
+ *
+ * @param stream Stream set up by czy_decompress_init()
+ * @return int CZY_DONE, CZY_NEED_INPUT or CZY_NEED_OUTPUT : negative on failure
+ */
+int czy_decompress(czy_stream* stream);
+
+/**
+ * @brief Start the next container on a stream, keeping its buffers
+ *
+ * @param stream Stream set up by czy_compress_init() or czy_decompress_init()
+ */
+void czy_reset(czy_stream* stream);
+
+/**
+ * @brief Free the buffers of a stream
+ *
+ * @param stream Stream set up by czy_compress_init() or czy_decompress_init()
+ */
+void czy_end(czy_stream* stream);
+
+
+#endif // CZY_H
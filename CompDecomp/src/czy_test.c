@@ -0,0 +1,314 @@
+/*
+===========================================================================
+ PROJECT: Compression and Decompression Algorithm
+===========================================================================
+ NAME: Tyler Neal
+ DATE: 02/20/2025
+ FILE NAME: czy_test.c
+ DESCRIPTION:
+    This program round trips the files given as arguments through the
+    library interface (see czy.h) with small buffers.
+
+    Every file is compressed with both codec versions while the input
+    and output are handed to the library a few bytes at a time, so
+    every stage is split across calls. The container must decompress
+    back to the original file through the library (with the same
+    buffer sizes) and through the decompress executable.
+
+    Usage: ./czy_test [-d <executable directory>] <file> [<file> ...]
+===========================================================================
+*/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "czy.h"
+
+/* ===================================================================
+                                Macros
+=================================================================== */
+
+#define DIRECTORY_FLAG "-d"
+#define LARGE_CHUNK (256 * 1024)
+
+/* ===================================================================
+                              Structures
+=================================================================== */
+
+// Bytes handed to the library per call
+typedef struct {
+    const char* name;
+    size_t input;
+    size_t output;
+} test_chunks;
+
+static const test_chunks chunks[] = {
+    { "1/1",   1,           1 },
+    { "7/13",  7,           13 },
+    { "large", LARGE_CHUNK, LARGE_CHUNK },
+};
+#define CHUNKS_COUNT (sizeof(chunks) / sizeof(chunks[0]))
+
+// Growing buffer the library's output is collected in
+typedef struct {
+    unsigned char* data;
+    size_t length;
+    size_t capacity;
+} test_buffer;
+
+/* ===================================================================
+                           Helper Functions
+=================================================================== */
+
+/**
+ * @brief Load an entire file into memory
+ *
+ * @param path Path of the file to be loaded
+ * @param length Pointer loaded with the length of the file
+ * @return unsigned char* Contents of the file : NULL on failure
+ */
+static unsigned char* load_file(const char* path, size_t* length) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char* data = malloc((size > 0) ? (size_t)size : 1);
+    if (data == NULL || size < 0 || fread(data, 1, (size_t)size, file) != (size_t)size) {
+        free(data);
+        fclose(file);
+        return NULL;
+    }
+
+    fclose(file);
+    *length = (size_t)size;
+    return data;
+}
+
+/**
+ * @brief Append bytes to a buffer, growing it as needed
+ *
+ * @param buffer Buffer to be appended to
+ * @param data Bytes to append
+ * @param length Number of bytes
+ * @return int 0 on success : -1 on failure
+ */
+static int append_bytes(test_buffer* buffer, const unsigned char* data, size_t length) {
+    if (buffer->length + length > buffer->capacity) {
+        size_t capacity = (buffer->capacity > 0) ? buffer->capacity : 4096;
+        while (capacity < buffer->length + length) {
+            capacity *= 2;
+        }
+        unsigned char* grown = realloc(buffer->data, capacity);
+        if (grown == NULL) {
+            return -1;
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    if (length > 0) {
+        memcpy(buffer->data + buffer->length, data, length);
+        buffer->length += length;
+    }
+    return 0;
+}
+
+/**
+ * @brief Code data through a stream, handing it a chunk of input and output room per call
+ *
+ * @param stream Stream set up by czy_compress_init() or czy_decompress_init()
+ * @param data Input to be coded
+ * @param length Length of the input
+ * @param chunk Bytes of input and output room per call
+ * @param result Buffer loaded with the output
+ * @return int 0 on success : -1 on failure
+ */
+static int code_chunked(czy_stream* stream, const unsigned char* data, size_t length,
+                        const test_chunks* chunk, test_buffer* result) {
+    unsigned char* output = malloc(chunk->output);
+    if (output == NULL) {
+        return -1;
+    }
+
+    size_t consumed = 0;
+    int status = CZY_NEED_INPUT;
+    while (status != CZY_DONE) {
+        // Supply the next chunk of input once the last one is used up
+        if (stream->avail_in == 0) {
+            size_t take = (length - consumed < chunk->input) ? (length - consumed) : chunk->input;
+            stream->next_in = (take > 0) ? (data + consumed) : NULL;
+            stream->avail_in = take;
+            consumed += take;
+        }
+        stream->next_out = output;
+        stream->avail_out = chunk->output;
+
+        status = stream->compressing ? czy_compress(stream, consumed == length)
+                                     : czy_decompress(stream);
+
+        // Needing input after the end of the data means the data is truncated
+        if (status < 0 || append_bytes(result, output, chunk->output - stream->avail_out) < 0 ||
+            (status == CZY_NEED_INPUT && consumed == length && stream->avail_in == 0)) {
+            free(output);
+            return -1;
+        }
+    }
+
+    free(output);
+    return 0;
+}
+
+/**
+ * @brief Decompress a container with the decompress executable
+ *
+ * @param executable Path of the decompress executable
+ * @param container Container to be decompressed
+ * @param original Data the container must decompress to
+ * @param length Length of the original data
+ * @return int 0 if the executable reproduced the data : -1 otherwise
+ */
+static int check_executable(const char* executable, const test_buffer* container,
+                            const unsigned char* original, size_t length) {
+    char compressed_path[] = "/tmp/czy_test_XXXXXX";
+    char decompressed_path[] = "/tmp/czy_test_XXXXXX";
+    int compressed_fd = mkstemp(compressed_path);
+    int decompressed_fd = mkstemp(decompressed_path);
+    int result = -1;
+
+    if (compressed_fd != -1 && decompressed_fd != -1 &&
+        write(compressed_fd, container->data, container->length) == (ssize_t)container->length) {
+        lseek(compressed_fd, 0, SEEK_SET);
+
+        pid_t pid = fork();
+        if (pid == 0) {
+            if (dup2(compressed_fd, STDIN_FILENO) == -1 || dup2(decompressed_fd, STDOUT_FILENO) == -1) {
+                _exit(127);
+            }
+            execl(executable, executable, (char*)NULL);
+            _exit(127);
+        }
+
+        int status = 0;
+        if (pid > 0 && waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+            WEXITSTATUS(status) == 0) {
+            size_t decompressed_length = 0;
+            unsigned char* decompressed = load_file(decompressed_path, &decompressed_length);
+            if (decompressed != NULL && decompressed_length == length &&
+                memcmp(decompressed, original, length) == 0) {
+                result = 0;
+            }
+            free(decompressed);
+        }
+    }
+
+    if (compressed_fd != -1) {
+        close(compressed_fd);
+        unlink(compressed_path);
+    }
+    if (decompressed_fd != -1) {
+        close(decompressed_fd);
+        unlink(decompressed_path);
+    }
+    return result;
+}
+
+/**
+ * @brief Round trip data through the library with one codec version and chunk size
+ *
+ * @param executable Path of the decompress executable
+ * @param original Data to be round tripped
+ * @param length Length of the data
+ * @param version Codec version of the blocks
+ * @param chunk Bytes of input and output room per call
+ * @return const char* NULL on success : the step that failed otherwise
+ */
+static const char* round_trip(const char* executable, const unsigned char* original, size_t length,
+                              unsigned int version, const test_chunks* chunk) {
+    czy_stream stream;
+    test_buffer container = { 0 };
+    test_buffer decompressed = { 0 };
+    const char* failure = NULL;
+
+    if (czy_compress_init(&stream, 0, version) < 0) {
+        return "compress init";
+    }
+    if (code_chunked(&stream, original, length, chunk, &container) < 0) {
+        failure = "compress";
+    }
+    czy_end(&stream);
+
+    if (failure == NULL && czy_decompress_init(&stream, 0) < 0) {
+        failure = "decompress init";
+    } else if (failure == NULL) {
+        if (code_chunked(&stream, container.data, container.length, chunk, &decompressed) < 0 ||
+            decompressed.length != length ||
+            (length > 0 && memcmp(decompressed.data, original, length) != 0)) {
+            failure = "decompress";
+        }
+        czy_end(&stream);
+    }
+
+    if (failure == NULL && check_executable(executable, &container, original, length) < 0) {
+        failure = "executable";
+    }
+
+    free(container.data);
+    free(decompressed.data);
+    return failure;
+}
+
+/* ===================================================================
+                                 Main
+=================================================================== */
+
+int main(int argc, char *argv[]) {
+    const char* directory = ".";
+
+    // Parse the flags
+    int first_file = 1;
+    if (first_file + 1 < argc && strcmp(argv[first_file], DIRECTORY_FLAG) == 0) {
+        directory = argv[first_file + 1];
+        first_file += 2;
+    }
+    if (first_file >= argc) {
+        fprintf(stderr, "Usage: %s [" DIRECTORY_FLAG " <executable directory>] "
+                        "<file> [<file> ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    char decompress_path[4096];
+    snprintf(decompress_path, sizeof(decompress_path), "%s/decompress", directory);
+
+    int failed = 0;
+    printf("%-14s %9s %8s %-6s %s\n", "File", "Bytes", "Version", "Chunks", "Check");
+    for (int f = first_file; f < argc; f++) {
+        size_t length = 0;
+        unsigned char* original = load_file(argv[f], &length);
+        if (original == NULL) {
+            fprintf(stderr, "Failed to load '%s'\n", argv[f]);
+            return EXIT_FAILURE;
+        }
+        const char* name = strrchr(argv[f], '/');
+        name = (name != NULL) ? (name + 1) : argv[f];
+
+        for (unsigned int version = 1; version <= MAX_CONTAINER_VERSION; version++) {
+            for (size_t c = 0; c < CHUNKS_COUNT; c++) {
+                const char* failure = round_trip(decompress_path, original, length, version,
+                                                 &chunks[c]);
+                failed |= (failure != NULL);
+                printf("%-14s %9zu %8u %-6s %s%s\n", name, length, version, chunks[c].name,
+                       failure ? "FAILED at " : "ok", failure ? failure : "");
+            }
+        }
+        free(original);
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
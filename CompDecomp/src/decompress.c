@@ -1,4 +1,3 @@
-
 /*
 ===========================================================================
  PROJECT: Compression and Decompression Algorithm
@@ -8,17 +7,142 @@
  FILE NAME: decompress.c
  DESCRIPTION:
     Main function for the dzy de-compression implementation.
-  
-    This program decompresses a compressed stream directed at its standard input 
+
+    This program decompresses a compressed stream directed at its standard input
     and writes the decompressed data to its standard output.
+
+    By default every token is decoded with a single lookup: the next
+    DECODE_TABLE_BITS bits are peeked and a precomputed table gives the
+    token type, its length and its literal or history index. Passing
+    SERIAL_DECODER_FLAG selects the original bit at a time decoder.
+
+    Block containers (see container.h) are recognized by their magic and
+    their blocks are decompressed on several threads, or a single block
+    is decompressed through the index with EXTRACT_BLOCK_FLAG. A container
+    ends with an explicit end marker, index and footer, so concatenated
+    containers are decompressed one after another.
 ===========================================================================
 */
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include "bit_ops.h"
+#include "container.h"
 
+/* ===================================================================
+                                Macros
+=================================================================== */
 
-int main(int argc, char *argv[]) {
+#define SERIAL_DECODER_FLAG "-s"
+#define THREADS_FLAG "-t"            // followed by the number of threads
+#define EXTRACT_BLOCK_FLAG "-x"      // followed by the index of the block
+#define DECODE_TABLE_BITS 9      // widest token: a 1 bit followed by a literal
+#define DECODE_TABLE_SIZE (1 << DECODE_TABLE_BITS)
+#define HISTORY_SIZE 8           // previously seen bytes (must be a power of two)
+#define HISTORY_MASK (HISTORY_SIZE - 1)
+
+/* ===================================================================
+                              Decode Table
+=================================================================== */
+
+typedef enum {
+    TOKEN_LITERAL = 0,  // 1 bit followed by an 8-bit literal
+    TOKEN_MATCH = 1     // 0 bit followed by a 3-bit history index
+} token_type;
+
+typedef struct {
+    unsigned char type;     // token_type
+    unsigned char length;   // bits used by the token
+    unsigned char value;    // literal byte or history index
+} decode_entry;
+
+static decode_entry decode_table[DECODE_TABLE_SIZE];
+
+/**
+ * @brief Fill the decode table with the token starting at every possible
+ * DECODE_TABLE_BITS bit prefix.
+ *
+ */
+static void build_decode_table() {
+    for (unsigned int bits = 0; bits < DECODE_TABLE_SIZE; bits++) {
+        if (bits >> (DECODE_TABLE_BITS - 1)) {
+            decode_table[bits].type = TOKEN_LITERAL;
+            decode_table[bits].length = 9;
+            decode_table[bits].value = (unsigned char)(bits & 0xFF);
+        } else {
+            decode_table[bits].type = TOKEN_MATCH;
+            decode_table[bits].length = 4;
+            decode_table[bits].value = (unsigned char)((bits >> (DECODE_TABLE_BITS - 4)) & 0x7);
+        }
+    }
+}
+
+/* ===================================================================
+                               Decoders
+=================================================================== */
+
+/**
+ * @brief Decode the stream with one table lookup per token
+ *
+ * The history is a ring, so recording a byte moves the head instead of
+ * shifting every previously seen byte.
+ *
+ * @return int 0 on success : negative on failure
+ */
+static int decode_table_driven() {
+
+    // Ring of previously seen characters, history[head] is the latest.
+    unsigned char history[HISTORY_SIZE] = {0};
+    unsigned int head = 0;
+
+    build_decode_table();
+
+    // Continue processing until EOF.
+    while (true) {
+
+        // Peek enough bits for the widest token
+        uint32_t bits = 0;
+        unsigned int available = 0;
+        CHECK_READ(peek_bits(DECODE_TABLE_BITS, &bits, &available));
+
+        // Break at end of input stream (only padding is left)
+        const decode_entry* entry = &decode_table[bits];
+        if (available == 0 ||
+           (entry->type == TOKEN_LITERAL && available < entry->length)) {
+            break;
+        }
+
+        // A match cut short by the end of the stream has no index
+        if (available < entry->length) {
+            return ERR_INDEX_OUT_OF_BOUNDS;
+        }
+        skip_bits(entry->length);
+
+        // Resolve the byte, matches count back from the latest byte
+        unsigned char byte = entry->value;
+        if (entry->type == TOKEN_MATCH) {
+            byte = history[(head - entry->value) & HISTORY_MASK];
+        }
+
+        CHECK_WRITE(write_byte(byte));
+
+        // Record the byte as the latest seen
+        head = (head + 1) & HISTORY_MASK;
+        history[head] = byte;
+    }
+
+    return SUCCESS;
+}
+
+/**
+ * @brief Decode the stream one bit at a time
+ *
+ * @return int 0 on success : negative on failure
+ */
+static int decode_serial() {
 
     // Array of previously seen characters.
     char previous[8] = {0};
@@ -51,20 +175,16 @@ int main(int argc, char *argv[]) {
 
             CHECK_WRITE(write_byte(byte));
 
-        // Bit indicates duplicate value    
+        // Bit indicates duplicate value
         } else if (bit == 0) {
 
             // Read the next 3 bits to determine the index of the previous byte.
-            unsigned short buffer[3];
-            for (unsigned int i = 0; i < 3; i++) {
-                CHECK_READ(read_bit(&buffer[i]));
-            }
-
-            // Convert the 3 bits to an integer index.
-            int index = ((buffer[0] << 2) | (buffer[1] << 1) | buffer[2]);
+            uint32_t index = 0;
+            int status = read_bits(3, &index);
+            CHECK_READ(status);
 
-            // Check the index bounds
-            if (index > 7 || index < 0) {
+            // Check the index bounds (a truncated stream has no index)
+            if (status == EOF_BITS || index > 7) {
                 return ERR_INDEX_OUT_OF_BOUNDS;
             }
 
@@ -82,9 +202,74 @@ int main(int argc, char *argv[]) {
         previous[0] = byte;
     }
 
+    return SUCCESS;
+}
+
+/* ===================================================================
+                                 Main
+=================================================================== */
+
+int main(int argc, char *argv[]) {
+    bool serial = false;
+    bool extract = false;
+    unsigned int threads = default_thread_count();
+    uint64_t block = 0;
+
+    // Parse the flags
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], SERIAL_DECODER_FLAG) == 0) {
+            serial = true;
+        } else if (strcmp(argv[i], THREADS_FLAG) == 0 && i + 1 < argc) {
+            threads = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], EXTRACT_BLOCK_FLAG) == 0 && i + 1 < argc) {
+            extract = true;
+            block = strtoull(argv[++i], NULL, 10);
+        } else {
+            return ERR_INVALID_ARGUMENT;
+        }
+    }
+
+    // Random access reads the container through its index
+    if (extract) {
+        return extract_block(STDIN_FILENO, STDOUT_FILENO, block);
+    }
+
+    // Check for a container header
+    unsigned char header[CONTAINER_HEADER_SIZE];
+    ssize_t header_length = read_full(STDIN_FILENO, header, sizeof(header));
+    if (header_length < 0) {
+        return ERR_READ_FAILURE;
+    }
+    if (is_container(header, (size_t)header_length)) {
+
+        // Containers end explicitly, so any number may be concatenated
+        while (header_length > 0) {
+            if (header_length != CONTAINER_HEADER_SIZE || !is_container(header, sizeof(header))) {
+                return ERR_INVALID_CONTAINER;
+            }
+            int status = decompress_container(STDIN_FILENO, STDOUT_FILENO, header, threads);
+            if (status < 0) {
+                return status;
+            }
+
+            header_length = read_full(STDIN_FILENO, header, sizeof(header));
+            if (header_length < 0) {
+                return ERR_READ_FAILURE;
+            }
+        }
+        return SUCCESS;
+    }
+
+    // Otherwise decode a single stream, starting with the bytes already read
+    preload_input(header, (size_t)header_length);
+    int status = serial ? decode_serial() : decode_table_driven();
+    if (status < 0) {
+        return status;
+    }
+
     // Flush any remaining data in the write buffer.
     CHECK_WRITE(flush_write_buffer());
 
     // Exit successfully.
     return SUCCESS;
-}
\ No newline at end of file
+}
@@ -0,0 +1,113 @@
+/*
+===========================================================================
+ PROJECT: Compression and Decompression Algorithm
+===========================================================================
+ NAME: Tyler Neal
+ DATE: 02/20/2025
+ FILE NAME: history_match.c
+ DESCRIPTION:
+    This file contains function implementations for finding a byte among
+    the 8 previously seen bytes.
+
+    The compressor has always compared an unsigned byte against a signed
+    char history, so bytes above 127 never match. Every matcher keeps
+    that behavior so the compressed output does not change.
+===========================================================================
+*/
+
+#include <stdint.h>
+#include "history_match.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define SWAR_ONES 0x0101010101010101ull
+#define SWAR_HIGHS 0x8080808080808080ull
+
+/* ===================================================================
+                           Matching Functions
+=================================================================== */
+
+/**
+ * @brief Find the first position holding a byte with the original loop
+ * 
+ * @param previous Array of previously seen bytes, latest first
+ * @param byte Byte to be found
+ * @return int Position of the first match : NO_MATCH if not found
+ */
+int match_history_scalar(const char previous[HISTORY_LENGTH], unsigned short byte) {
+    for (int i = 0; i < HISTORY_LENGTH; i++) {
+        if (byte == previous[i]) {
+            return i;
+        }
+    }
+    return NO_MATCH;
+}
+
+/**
+ * @brief Find the first position holding a byte with SWAR arithmetic
+ * 
+ * XOR-ing with the byte repeated in every lane zeroes the matching lanes.
+ * Subtracting one from every lane then sets the high bit of each zero
+ * lane, the lowest flagged lane is always exact.
+ * 
+ * @param history Packed history of previously seen bytes
+ * @param byte Byte to be found
+ * @return int Position of the first match : NO_MATCH if not found
+ */
+int match_history_swar(uint64_t history, unsigned short byte) {
+    if (byte > 0x7F) {
+        return NO_MATCH;
+    }
+
+    uint64_t lanes = history ^ (SWAR_ONES * byte);
+    uint64_t zeros = (lanes - SWAR_ONES) & ~lanes & SWAR_HIGHS;
+    if (zeros == 0) {
+        return NO_MATCH;
+    }
+    return (__builtin_ctzll(zeros) >> 3);
+}
+
+/**
+ * @brief Find the first position holding a byte with an SSE2 compare
+ * (falls back to SWAR arithmetic without SSE2)
+ * 
+ * @param history Packed history of previously seen bytes
+ * @param byte Byte to be found
+ * @return int Position of the first match : NO_MATCH if not found
+ */
+int match_history_sse2(uint64_t history, unsigned short byte) {
+#ifdef __SSE2__
+    if (byte > 0x7F) {
+        return NO_MATCH;
+    }
+
+    // One bit per matching lane, only the low 8 lanes hold history
+    __m128i lanes = _mm_cvtsi64_si128((long long)history);
+    __m128i needle = _mm_set1_epi8((char)byte);
+    unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(lanes, needle)) & 0xFF;
+    if (mask == 0) {
+        return NO_MATCH;
+    }
+    return __builtin_ctz(mask);
+#else
+    return match_history_swar(history, byte);
+#endif
+}
+
+/**
+ * @brief Find the first position holding a byte with the fastest matcher
+ * available on the target
+ * 
+ * @param history Packed history of previously seen bytes
+ * @param byte Byte to be found
+ * @return int Position of the first match : NO_MATCH if not found
+ */
+int match_history(uint64_t history, unsigned short byte) {
+#ifdef __SSE2__
+    return match_history_sse2(history, byte);
+#else
+    return match_history_swar(history, byte);
+#endif
+}
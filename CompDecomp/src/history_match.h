@@ -0,0 +1,76 @@
+/*
+===========================================================================
+ PROJECT: Compression and Decompression Algorithm
+===========================================================================
+ NAME: Tyler Neal
+ DATE: 02/20/2025
+ FILE NAME: history_match.h
+ DESCRIPTION:
+    This file contains function definitions for finding a byte among the
+    8 previously seen bytes, as well as additional macros.
+
+    The packed history keeps previous[i] in byte i of a 64-bit value, so
+    the latest byte is always the least significant one.
+===========================================================================
+*/
+
+#ifndef HISTORY_MATCH_H
+#define HISTORY_MATCH_H
+
+#include <stdint.h>
+
+/* ===================================================================
+                                Macros
+=================================================================== */
+
+#define HISTORY_LENGTH 8
+#define NO_MATCH -1
+
+// Record a byte as the latest seen, the oldest byte is shifted out
+#define UPDATE_HISTORY(history, byte) \
+        ((history) = ((uint64_t)(history) << 8) | (uint8_t)(byte))
+
+/* ===================================================================
+                         Function Declarations
+=================================================================== */
+
+/**
+ * @brief Find the first position holding a byte with the original loop
+ * 
+ * @param previous Array of previously seen bytes, latest first
+ * @param byte Byte to be found
+ * @return int Position of the first match : NO_MATCH if not found
+ */
+int match_history_scalar(const char previous[HISTORY_LENGTH], unsigned short byte);
+
+/**
+ * @brief Find the first position holding a byte with SWAR arithmetic
+ * 
+ * @param history Packed history of previously seen bytes
+ * @param byte Byte to be found
+ * @return int Position of the first match : NO_MATCH if not found
+ */
+int match_history_swar(uint64_t history, unsigned short byte);
+
+/**
+ * @brief Find the first position holding a byte with an SSE2 compare
+ * (falls back to SWAR arithmetic without SSE2)
+ * 
+ * @param history Packed history of previously seen bytes
+ * @param byte Byte to be found
+ * @return int Position of the first match : NO_MATCH if not found
+ */
+int match_history_sse2(uint64_t history, unsigned short byte);
+
+/**
+ * @brief Find the first position holding a byte with the fastest matcher
+ * available on the target
+ * 
+ * @param history Packed history of previously seen bytes
+ * @param byte Byte to be found
+ * @return int Position of the first match : NO_MATCH if not found
+ */
+int match_history(uint64_t history, unsigned short byte);
+
+
+#endif // HISTORY_MATCH_H
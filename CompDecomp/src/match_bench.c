@@ -0,0 +1,194 @@
+/*
+===========================================================================
+ PROJECT: Compression and Decompression Algorithm
+===========================================================================
+ NAME: Tyler Neal
+ DATE: 02/20/2025
+ FILE NAME: match_bench.c
+ DESCRIPTION:
+    This program benchmarks the history matchers of the compressor on the
+    files given as arguments.
+
+    Each file is loaded into memory and run through every matcher the given
+    number of rounds, updating the history after each byte as the compressor
+    does. The matchers must agree on every position, and the throughput of
+    each one is reported against the original scalar loop.
+
+    Usage: ./match_bench [-r <rounds>] <file> [<file> ...]
+===========================================================================
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "history_match.h"
+
+/* ===================================================================
+                                Macros
+=================================================================== */
+
+#define ROUNDS_FLAG "-r"
+#define DEFAULT_ROUNDS 20
+
+typedef enum {
+    MATCHER_SCALAR = 0,
+    MATCHER_SWAR = 1,
+    MATCHER_SSE2 = 2,
+    MATCHER_COUNT = 3
+} matcher_type;
+
+static const char* matcher_names[MATCHER_COUNT] = { "scalar", "swar", "sse2" };
+
+/* ===================================================================
+                           Helper Functions
+=================================================================== */
+
+/**
+ * @brief Get the current monotonic time
+ * 
+ * @return double Time in seconds
+ */
+static double now_seconds() {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return time.tv_sec + (time.tv_nsec / 1e9);
+}
+
+/**
+ * @brief Load an entire file into memory
+ * 
+ * @param path Path of the file to be loaded
+ * @param length Pointer loaded with the length of the file
+ * @return unsigned char* Contents of the file : NULL on failure
+ */
+static unsigned char* load_file(const char* path, size_t* length) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) {
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char* data = malloc((size > 0) ? (size_t)size : 1);
+    if (data == NULL || size < 0 || fread(data, 1, (size_t)size, file) != (size_t)size) {
+        free(data);
+        fclose(file);
+        return NULL;
+    }
+
+    fclose(file);
+    *length = (size_t)size;
+    return data;
+}
+
+/**
+ * @brief Run a matcher over a buffer, updating the history like the compressor
+ * 
+ * @param type Matcher to be run
+ * @param data Buffer of bytes to be matched
+ * @param length Length of the buffer
+ * @return uint64_t Checksum of every match position
+ */
+static uint64_t run_matcher(matcher_type type, const unsigned char* data, size_t length) {
+    uint64_t checksum = 0;
+
+    if (type == MATCHER_SCALAR) {
+        // Original array history, shifted by hand after every byte
+        char previous[HISTORY_LENGTH] = {0};
+        for (size_t b = 0; b < length; b++) {
+            int match = match_history_scalar(previous, data[b]);
+            checksum = (checksum * 31) + (unsigned int)(match + 1);
+
+            for (int i = HISTORY_LENGTH - 1; i > 0; i--) {
+                previous[i] = previous[i - 1];
+            }
+            previous[0] = data[b];
+        }
+        return checksum;
+    }
+
+    uint64_t history = 0;
+    for (size_t b = 0; b < length; b++) {
+        int match = (type == MATCHER_SWAR) ? match_history_swar(history, data[b])
+                                           : match_history_sse2(history, data[b]);
+        checksum = (checksum * 31) + (unsigned int)(match + 1);
+        UPDATE_HISTORY(history, data[b]);
+    }
+    return checksum;
+}
+
+/* ===================================================================
+                                 Main
+=================================================================== */
+
+int main(int argc, char *argv[]) {
+
+    // Retrieve the round count
+    int rounds = DEFAULT_ROUNDS;
+    int first_file = 1;
+    if (argc > 2 && strcmp(argv[1], ROUNDS_FLAG) == 0) {
+        rounds = atoi(argv[2]);
+        first_file = 3;
+    }
+    if (rounds < 1 || first_file >= argc) {
+        fprintf(stderr, "Usage: %s [" ROUNDS_FLAG " <rounds>] <file> [<file> ...]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    double total_time[MATCHER_COUNT] = {0};
+    size_t total_bytes = 0;
+
+    printf("%-16s %10s %12s %12s %12s\n", "File", "Bytes", "scalar MB/s", "swar MB/s", "sse2 MB/s");
+    for (int f = first_file; f < argc; f++) {
+        size_t length = 0;
+        unsigned char* data = load_file(argv[f], &length);
+        if (data == NULL) {
+            fprintf(stderr, "Failed to load '%s'\n", argv[f]);
+            return EXIT_FAILURE;
+        }
+
+        // Time every matcher, each must produce the same positions
+        double elapsed[MATCHER_COUNT];
+        uint64_t checksums[MATCHER_COUNT];
+        for (int m = 0; m < MATCHER_COUNT; m++) {
+            double start = now_seconds();
+            for (int r = 0; r < rounds; r++) {
+                checksums[m] = run_matcher((matcher_type)m, data, length);
+            }
+            elapsed[m] = now_seconds() - start;
+            total_time[m] += elapsed[m];
+
+            if (checksums[m] != checksums[MATCHER_SCALAR]) {
+                fprintf(stderr, "Matcher '%s' disagrees with the scalar loop on '%s'\n",
+                        matcher_names[m], argv[f]);
+                free(data);
+                return EXIT_FAILURE;
+            }
+        }
+        total_bytes += length;
+
+        // Report throughput of every matcher
+        const char* name = strrchr(argv[f], '/');
+        name = (name != NULL) ? (name + 1) : argv[f];
+        double megabytes = ((double)length * rounds) / 1e6;
+        printf("%-16s %10zu %12.1f %12.1f %12.1f\n", name, length,
+               megabytes / elapsed[MATCHER_SCALAR], megabytes / elapsed[MATCHER_SWAR],
+               megabytes / elapsed[MATCHER_SSE2]);
+        free(data);
+    }
+
+    // Report totals and speedups over the scalar loop
+    double megabytes = ((double)total_bytes * rounds) / 1e6;
+    printf("%-16s %10zu %12.1f %12.1f %12.1f\n", "Total", total_bytes,
+           megabytes / total_time[MATCHER_SCALAR], megabytes / total_time[MATCHER_SWAR],
+           megabytes / total_time[MATCHER_SSE2]);
+    printf("Speedup over scalar: swar %.2fx | sse2 %.2fx\n",
+           total_time[MATCHER_SCALAR] / total_time[MATCHER_SWAR],
+           total_time[MATCHER_SCALAR] / total_time[MATCHER_SSE2]);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,25 @@
+#!/usr/bin/env bash
+
+EXEC_DIRECTORY="../src"
+TEST_FILES_DIRECTORY="../canterbury"
+ROUNDS=${1:-20}
+
+cd "$EXEC_DIRECTORY" || exit 1
+
+echo ""
+echo "Building Environment in $(pwd)"
+echo "---------------------"
+make clean
+if ! make all; then
+    echo "Make failed, exiting."
+    exit 1
+fi
+
+# Compare the history matchers against the original loop on every benchmark file
+echo ""
+echo "History Match Benchmark ($ROUNDS rounds)"
+echo "---------------------"
+./match_bench -r "$ROUNDS" "$TEST_FILES_DIRECTORY"/*
+
+echo ""
+echo "Script finished."
@@ -0,0 +1,41 @@
+#!/usr/bin/env bash
+
+EXEC_DIRECTORY="../src"
+TEST_FILES_DIRECTORY="../canterbury"
+ROUNDS=${1:-5}
+THREADS=${2:-$(nproc)}
+RESULTS_DIRECTORY=${3:-"$(pwd)/results"}
+
+cd "$EXEC_DIRECTORY" || exit 1
+
+echo ""
+echo "Building Environment in $(pwd)"
+echo "---------------------"
+make clean
+if ! make all; then
+    echo "Make failed, exiting."
+    exit 1
+fi
+
+# Results are named by commit, so runs of different builds can be compared
+mkdir -p "$RESULTS_DIRECTORY" || exit 1
+build=$(git rev-parse --short HEAD 2>/dev/null || echo "unknown")
+csv_file="$RESULTS_DIRECTORY/codec_bench_$build.csv"
+json_file="$RESULTS_DIRECTORY/codec_bench_$build.json"
+
+# Round trip every benchmark file through every mode of the executables
+echo ""
+echo "Codec Benchmark ($ROUNDS rounds, $THREADS threads)"
+echo "---------------------"
+./codec_bench -r "$ROUNDS" -t "$THREADS" -c "$csv_file" -j "$json_file" "$TEST_FILES_DIRECTORY"/*
+status=$?
+
+echo ""
+echo "Results written to $csv_file and $json_file"
+if [[ "$status" -ne 0 ]]; then
+    echo "Some round trips FAILED."
+fi
+
+echo ""
+echo "Script finished."
+exit "$status"
@@ -0,0 +1,30 @@
+#!/usr/bin/env bash
+
+EXEC_DIRECTORY="../src"
+TEST_FILES_DIRECTORY="../canterbury"
+
+cd "$EXEC_DIRECTORY" || exit 1
+
+echo ""
+echo "Building Environment in $(pwd)"
+echo "---------------------"
+make clean
+if ! make all; then
+    echo "Make failed, exiting."
+    exit 1
+fi
+
+# Round trip every test file through the library with small buffers
+echo ""
+echo "Library Round Trip"
+echo "---------------------"
+./czy_test "$TEST_FILES_DIRECTORY"/*
+status=$?
+
+if [[ "$status" -ne 0 ]]; then
+    echo "Some round trips FAILED."
+fi
+
+echo ""
+echo "Script finished."
+exit "$status"
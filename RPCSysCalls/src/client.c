@@ -6,24 +6,39 @@
 * @brief Implementations of the client rpc request functions.
 *
 * These functions act as a means to request a system call is performed on the
-* remote server. The client begins by sending arguments to the server, after 
-* which, the server will send back the result of the operation, as well as the
-* errno if an error was encountered.
+* remote server. The client sends the arguments to the server as a single frame,
+* after which, the server will send back a frame holding the result of the
+* operation and its errno (see protocol.h).
+*
+* The asynchronous calls keep several requests in flight on one connection, and
+* pair each reply with its call by request id as it arrives.
+*
+* A delta sync sends the signatures of a local copy's blocks, and the server replies with the
+* remote file as the blocks to copy locally and the literal bytes between them.
+*
+* The bulk transfers move file data between the connection and a local file descriptor without
+* passing it through a user buffer, using splice() and sendfile().
 *
 * @author Tyler Neal
 * @date 2/26/2025
 ***************************************************************************************************/
 
+#define _GNU_SOURCE // splice()
+
 #include <errno.h>
 #include <fcntl.h>
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
 #include <arpa/inet.h>
+#include <endian.h>
 #include <netinet/in.h>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 
 #include "client.h"
@@ -31,6 +46,8 @@
 #include "protocol.h"
 #include "util.h"
 
+static uint32_t next_request_id = 1; // id of the next request sent
+
 /*==================================================================================================
     Connection Setup
 ==================================================================================================*/
@@ -82,37 +99,30 @@ int rp_connect(int* socket_fd, int port, char* hostname) {
  * @return File descriptor on success, -1 on error with errno set
  */
 int32_t rp_open(int server_fd, char* pathname, int flags, ...) {
-    // Set errno for early exit
-    errno = CLIENT_ERROR_SENDING_RPC_ARGS;
-    
-    // Send call type to server
-    uint32_t call_code_net = htonl(OPEN_CALL);
-    if (send_to_connection(server_fd, &call_code_net, sizeof(call_code_net)) == -1)
-        return -1;
-
-    // Send pathname
-    if (send_to_connection(server_fd, pathname, strlen(pathname)+1) == -1)
-        return -1;
 
-    // Send flags
-    uint32_t flags_net = htonl((uint32_t)flags);
-    if (send_to_connection(server_fd, &flags_net, sizeof(flags_net)) == -1)
-        return -1;
-
-    // Send mode if creating a new file
+    // Retrieve mode if creating a new file
+    mode_t mode = 0;
     if (flags & O_CREAT) {
         va_list args;
         va_start(args, flags);
-        mode_t mode = va_arg(args, mode_t);
+        mode = va_arg(args, mode_t);
         va_end(args);
-        uint32_t mode_net = htonl((uint32_t)mode);
-        if (send_to_connection(server_fd, &mode_net, sizeof(mode_net)) == -1)
-            return -1;
+    }
+
+    // Send flags, mode and pathname in one frame
+    rp_open_args_s args;
+    args.flags = htonl((uint32_t)flags);
+    args.mode = htonl((uint32_t)mode);
+    uint32_t request_id = next_request_id++;
+    if (send_frame(server_fd, OPEN_CALL, request_id, &args, sizeof(args),
+                   pathname, strlen(pathname) + 1) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
+        return -1;
     }
 
     // Recieve result from server
     int32_t result;
-    if (recieve_result(server_fd, &result, INT32) == -1)
+    if (recieve_result(server_fd, OPEN_CALL, request_id, &result, NULL, 0) == -1)
         return -1;
 
     return result;
@@ -126,22 +136,19 @@ int32_t rp_open(int server_fd, char* pathname, int flags, ...) {
  * @return 0 on success, -1 on error with errno set
  */
 int32_t rp_close(int server_fd, int file_fd) {
-    // Set errno for early exit
-    errno = CLIENT_ERROR_SENDING_RPC_ARGS;
-    
-    // Send call type to server
-    uint32_t call_code_net = htonl(CLOSE_CALL);
-    if (send_to_connection(server_fd, &call_code_net, sizeof(call_code_net)) == -1)
-        return -1;
 
     // Send file descriptor
-    uint32_t file_fd_net = htonl((uint32_t)file_fd);
-    if (send_to_connection(server_fd, &file_fd_net, sizeof(file_fd_net)) == -1)
+    rp_close_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    uint32_t request_id = next_request_id++;
+    if (send_frame(server_fd, CLOSE_CALL, request_id, &args, sizeof(args), NULL, 0) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
         return -1;
+    }
 
     // Recieve result from server
     int32_t result;
-    if (recieve_result(server_fd, &result, INT32) == -1) 
+    if (recieve_result(server_fd, CLOSE_CALL, request_id, &result, NULL, 0) == -1) 
         return -1;
 
     return result;
@@ -157,41 +164,22 @@ int32_t rp_close(int server_fd, int file_fd) {
  * @return Number of bytes read, 0 at EOF, -1 on error with errno set
  */
 int32_t rp_read(int server_fd, int file_fd, char* buffer, size_t count) {
-    // Set errno for early exit
-    errno = CLIENT_ERROR_SENDING_RPC_ARGS;
 
-    // Send call type to server
-    uint32_t call_code_net = htonl(READ_CALL);
-    if (send_to_connection(server_fd, &call_code_net, sizeof(call_code_net)) == -1)
-        return -1;
-
-    // Send file descriptor
-    uint32_t file_fd_net = htonl((uint32_t)file_fd);
-    if (send_to_connection(server_fd, &file_fd_net, sizeof(file_fd_net)) == -1)
-        return -1;
-
-    // Send buffer
-    if (send_to_connection(server_fd, buffer, count) == -1)
-        return -1;
-
-    // Send count
-    uint32_t count_net = htonl((uint32_t)count);
-    if (send_to_connection(server_fd, &count_net, sizeof(count_net)) == -1)
+    // Send file descriptor and count, the buffer stays local
+    rp_read_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    args.count = htonl((uint32_t)count);
+    uint32_t request_id = next_request_id++;
+    if (send_frame(server_fd, READ_CALL, request_id, &args, sizeof(args), NULL, 0) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
         return -1;
+    }
 
-    // Recieve result from server
+    // Recieve result and data read from server
     int32_t data_read;
-    if (recieve_result(server_fd, &data_read, INT32) == -1) 
+    if (recieve_result(server_fd, READ_CALL, request_id, &data_read, buffer, count) == -1) 
         return -1;
 
-    // Copy in data read
-    if (data_read > 0) {
-        char* remote_buffer = (char*)read_from_connection(server_fd);
-        memcpy(buffer, remote_buffer, data_read);
-        free(remote_buffer);
-    }
-   
-
     return data_read;
 }
 
@@ -205,38 +193,57 @@ int32_t rp_read(int server_fd, int file_fd, char* buffer, size_t count) {
  * @return Number of bytes written, -1 on error with errno set
  */
 int32_t rp_write(int server_fd, int file_fd, char* buffer, size_t count) {
-    // Set errno for early exit
-    errno = CLIENT_ERROR_SENDING_RPC_ARGS;
 
-    // Send call type to server
-    uint32_t call_code_net = htonl(WRITE_CALL);
-    if (send_to_connection(server_fd, &call_code_net, sizeof(call_code_net)) == -1)
+    // Send file descriptor, count and buffer
+    rp_write_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    args.count = htonl((uint32_t)count);
+    uint32_t request_id = next_request_id++;
+    if (send_frame(server_fd, WRITE_CALL, request_id, &args, sizeof(args), buffer, count) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
         return -1;
+    }
 
-    // Send file descriptor
-    uint32_t file_fd_net = htonl((uint32_t)file_fd);
-    if (send_to_connection(server_fd, &file_fd_net, sizeof(file_fd_net)) == -1)
+    // Recieve result from server
+    int32_t data_wrote;
+    if (recieve_result(server_fd, WRITE_CALL, request_id, &data_wrote, NULL, 0) == -1)
         return -1;
 
-    // Send buffer
-    if (send_to_connection(server_fd, buffer, count) == -1)
-        return -1;
+    return data_wrote;
+}
+
+/**
+ * @brief Remote procedure call for lseek system call
+ * 
+ * @param server_fd Server connection file descriptor
+ * @param file_fd File descriptor to seek on
+ * @param offset Offset for the seek operation
+ * @param whence Base position for seek (SEEK_SET, SEEK_CUR, SEEK_END)
+ * @return New file offset on success, -1 on error with errno set
+ */
+int32_t rp_lseek(int server_fd, int file_fd, off_t offset, int whence) {
 
-    // Send count
-    uint32_t count_net = htonl((uint32_t)count);
-    if (send_to_connection(server_fd, &count_net, sizeof(count_net)) == -1)
+    // Send file descriptor, offset and lseek origin
+    rp_lseek_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    args.offset = (int32_t)htonl((uint32_t)offset);
+    args.whence = htonl((uint32_t)whence);
+    uint32_t request_id = next_request_id++;
+    if (send_frame(server_fd, LSEEK_CALL, request_id, &args, sizeof(args), NULL, 0) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
         return -1;
+    }
 
     // Recieve result from server
-    int32_t data_wrote;
-    if (recieve_result(server_fd, &data_wrote, INT32) == -1)
+    int32_t result;
+    if (recieve_result(server_fd, LSEEK_CALL, request_id, &result, NULL, 0) == -1)
         return -1;
 
-    return data_wrote;
+    return result;
 }
 
 /**
- * @brief Remote procedure call for lseek system call
+ * @brief Remote procedure call for lseek system call with a 64-bit offset
  * 
  * @param server_fd Server connection file descriptor
  * @param file_fd File descriptor to seek on
@@ -244,36 +251,88 @@ int32_t rp_write(int server_fd, int file_fd, char* buffer, size_t count) {
  * @param whence Base position for seek (SEEK_SET, SEEK_CUR, SEEK_END)
  * @return New file offset on success, -1 on error with errno set
  */
-int32_t rp_lseek(int server_fd, int file_fd, off_t offset, int whence) {
-    // Set errno for early exit
-    errno = CLIENT_ERROR_SENDING_RPC_ARGS;
+int64_t rp_lseek64(int server_fd, int file_fd, off_t offset, int whence) {
 
-    // Send call type to server
-    uint32_t call_code_net = htonl(LSEEK_CALL);
-    if (send_to_connection(server_fd, &call_code_net, sizeof(call_code_net)) == -1)
+    // Send file descriptor, offset and lseek origin
+    rp_lseek64_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    args.offset = (int64_t)htobe64((uint64_t)offset);
+    args.whence = htonl((uint32_t)whence);
+    uint32_t request_id = next_request_id++;
+    if (send_frame(server_fd, LSEEK64_CALL, request_id, &args, sizeof(args), NULL, 0) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
         return -1;
+    }
 
-    // Send file descriptor
-    uint32_t file_fd_net = htonl((uint32_t)file_fd);
-    if (send_to_connection(server_fd, &file_fd_net, sizeof(file_fd_net)) == -1)
+    // Recieve result from server
+    int64_t result;
+    if (recieve_result64(server_fd, LSEEK64_CALL, request_id, &result, NULL, 0) == -1)
         return -1;
 
-    // Send offset
-    uint32_t offset_net = htonl((uint32_t)offset);
-    if (send_to_connection(server_fd, &offset_net, sizeof(offset_net)) == -1)
+    return result;
+}
+
+/**
+ * @brief Remote procedure call for pread system call with a 64-bit offset
+ * 
+ * @param server_fd Server connection file descriptor
+ * @param file_fd File descriptor to read from
+ * @param buffer Buffer to store the data read
+ * @param count Number of bytes to read, fewer are read past the largest frame
+ * @param offset File position to read from
+ * @return Number of bytes read, 0 at EOF, -1 on error with errno set
+ */
+int64_t rp_pread64(int server_fd, int file_fd, char* buffer, size_t count, off_t offset) {
+
+    // Send file descriptor, count and offset
+    rp_pread64_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    args.count = htobe64((uint64_t)count);
+    args.offset = htobe64((uint64_t)offset);
+    uint32_t request_id = next_request_id++;
+    if (send_frame(server_fd, PREAD64_CALL, request_id, &args, sizeof(args), NULL, 0) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
+        return -1;
+    }
+
+    // Recieve result from server, the data read lands in the buffer
+    int64_t data_read;
+    if (recieve_result64(server_fd, PREAD64_CALL, request_id, &data_read, buffer, count) == -1)
         return -1;
 
-    // Send lseek origin
-    uint32_t whence_net = htonl((uint32_t)whence);
-    if (send_to_connection(server_fd, &whence_net, sizeof(whence_net)) == -1)
+    return data_read;
+}
+
+/**
+ * @brief Remote procedure call for pwrite system call with a 64-bit offset
+ * 
+ * @param server_fd Server connection file descriptor
+ * @param file_fd File descriptor to write to
+ * @param buffer Data to write
+ * @param count Number of bytes to write, at most a frame's worth
+ * @param offset File position to write at
+ * @return Number of bytes written, -1 on error with errno set
+ */
+int64_t rp_pwrite64(int server_fd, int file_fd, char* buffer, size_t count, off_t offset) {
+
+    // Send file descriptor, count and offset, followed by the data
+    rp_pwrite64_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    args.count = htobe64((uint64_t)count);
+    args.offset = htobe64((uint64_t)offset);
+    uint32_t request_id = next_request_id++;
+    if (send_frame(server_fd, PWRITE64_CALL, request_id, &args, sizeof(args), buffer,
+                   count) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
         return -1;
+    }
 
     // Recieve result from server
-    int32_t result;
-    if (recieve_result(server_fd, &result, INT32) == -1)
+    int64_t data_wrote;
+    if (recieve_result64(server_fd, PWRITE64_CALL, request_id, &data_wrote, NULL, 0) == -1)
         return -1;
 
-    return result;
+    return data_wrote;
 }
 
 /**
@@ -285,78 +344,871 @@ int32_t rp_lseek(int server_fd, int file_fd, off_t offset, int whence) {
  * @return Calculated checksum value, -1 on error with errno set
  */
 int16_t rp_checksum(int server_fd, int file_fd, size_t block_size) {
-    // Set errno for early exit
-    errno = CLIENT_ERROR_SENDING_RPC_ARGS;
 
-    // Send call type to server
-    uint32_t call_code_net = htonl(CHECKSUM_CALL);
-    if (send_to_connection(server_fd, &call_code_net, sizeof(call_code_net)) < 0)
+    // Send file descriptor and block_size
+    rp_checksum_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    args.block_size = htonl((uint32_t)block_size);
+    uint32_t request_id = next_request_id++;
+    if (send_frame(server_fd, CHECKSUM_CALL, request_id, &args, sizeof(args), NULL, 0) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
         return -1;
+    }
 
-    // Send file descriptor
-    uint32_t file_fd_net = htonl((uint32_t)file_fd);
-    if (send_to_connection(server_fd, &file_fd_net, sizeof(file_fd_net)) < 0)
+    // Recieve result from server
+    int32_t checksum;
+    if (recieve_result(server_fd, CHECKSUM_CALL, request_id, &checksum, NULL, 0) == -1)
+        return -1;
+    
+    return (int16_t)checksum;
+}
+
+/**
+ * @brief Remote procedure call to hash a file in chunks, so differing ranges can be found
+ * 
+ * @param server_fd Server connection file descriptor
+ * @param file_fd File descriptor to hash
+ * @param chunk_size Bytes per chunk (DIGEST_CHUNK_SIZE if 0), at least DIGEST_MIN_CHUNK_SIZE
+ * @param digests Array to store the file digest in, followed by the first capacity - 1 chunk
+ *                digests (the same layout as digest_file())
+ * @param capacity Entries in digests (at least 1)
+ * @return Number of chunks in the file, -1 on error with errno set
+ */
+int32_t rp_digest(int server_fd, int file_fd, size_t chunk_size, uint64_t* digests,
+                  size_t capacity) {
+
+    // Send file descriptor, chunk size and the most chunk digests wanted
+    rp_digest_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    args.chunk_size = htonl((uint32_t)chunk_size);
+    args.max_digests = htonl((uint32_t)(capacity - 1));
+    uint32_t request_id = next_request_id++;
+    if (send_frame(server_fd, DIGEST_CALL, request_id, &args, sizeof(args), NULL, 0) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
         return -1;
+    }
 
-    // Send block_size
-    uint32_t block_size_net = htonl((uint32_t)block_size);
-    if (send_to_connection(server_fd, &block_size_net, sizeof(block_size_net)) < 0)
+    // Recieve the chunk count and digests from server
+    int32_t chunk_count;
+    if (recieve_result(server_fd, DIGEST_CALL, request_id, &chunk_count, (char*)digests,
+                       capacity * sizeof(uint64_t)) == -1)
         return -1;
 
-    // Recieve result from server
-    int16_t checksum;
-    if (recieve_result(server_fd, &checksum, INT16) < 0)
+    if (chunk_count != -1) {
+        size_t digest_count = ((size_t)chunk_count < capacity - 1) ? (size_t)chunk_count + 1 :
+                                                                      capacity;
+        for (size_t i = 0; i < digest_count; i++) {
+            digests[i] = be64toh(digests[i]);
+        }
+    }
+
+    return chunk_count;
+}
+
+/**
+ * @brief Remote procedure call fetching the statistics of every call the server has answered
+ * 
+ * @param server_fd Server connection file descriptor
+ * @param stats Array to store the statistics in (in host byte order)
+ * @param capacity Entries in stats (RP_CALL_COUNT holds every call)
+ * @return Number of calls with statistics, -1 on error with errno set
+ */
+int32_t rp_stats(int server_fd, rp_call_stats_s* stats, size_t capacity) {
+
+    // The call takes no arguments
+    uint32_t request_id = next_request_id++;
+    if (send_frame(server_fd, STATS_CALL, request_id, NULL, 0, NULL, 0) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
         return -1;
-    
-    return checksum;
+    }
+
+    // Recieve the statistics from server
+    int32_t count;
+    if (recieve_result(server_fd, STATS_CALL, request_id, &count, (char*)stats,
+                       capacity * sizeof(*stats)) == -1)
+        return -1;
+
+    for (int32_t i = 0; i < count; i++) {
+        stats[i].opcode = ntohl(stats[i].opcode);
+        stats[i].count = be64toh(stats[i].count);
+        stats[i].errors = be64toh(stats[i].errors);
+        stats[i].bytes_in = be64toh(stats[i].bytes_in);
+        stats[i].bytes_out = be64toh(stats[i].bytes_out);
+        stats[i].p50 = be64toh(stats[i].p50);
+        stats[i].p90 = be64toh(stats[i].p90);
+        stats[i].p99 = be64toh(stats[i].p99);
+        stats[i].max = be64toh(stats[i].max);
+    }
+
+    return count;
 }
 
 /*==================================================================================================
-    Client Specific Helpers
+    Delta Sync
 ==================================================================================================*/
 
 /**
- * @brief Updates the local errno from the server's errno
+ * @brief Remote procedure call comparing a range of a remote file against blocks of a local file
  * 
  * @param server_fd Server connection file descriptor
- * @return 0 on success, -1 on error
+ * @param file_fd Remote file descriptor to compare
+ * @param block_size Bytes per block
+ * @param signatures Signatures of the local blocks (in network byte order)
+ * @param block_count Number of blocks
+ * @param offset Remote file position of the range
+ * @param length Bytes in the range
+ * @param delta Buffer to store the delta operations in (see rp_delta_op_s)
+ * @param capacity Size of the delta buffer in bytes
+ * @param delta_length Pointer to store the bytes of delta operations recieved
+ * @return Bytes of the remote file the delta covers, 0 at EOF, -1 on error with errno set
  */
- int update_errno(int server_fd) {
-    uint32_t* errno_ptr = (uint32_t*)read_from_connection(server_fd);
-    if (!errno_ptr)
+int32_t rp_delta(int server_fd, int file_fd, size_t block_size,
+                 const rp_block_signature_s* signatures, size_t block_count, off_t offset,
+                 size_t length, uint8_t* delta, size_t capacity, size_t* delta_length) {
+
+    // Send file descriptor, blocks and range, followed by the signatures
+    rp_delta_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    args.block_size = htonl((uint32_t)block_size);
+    args.block_count = htonl((uint32_t)block_count);
+    args.offset = htobe64((uint64_t)offset);
+    args.length = htonl((uint32_t)length);
+    uint32_t request_id = next_request_id++;
+    if (send_frame(server_fd, DELTA_CALL, request_id, &args, sizeof(args), signatures,
+                   block_count * sizeof(*signatures)) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
         return -1;
-    errno = (int)ntohl(*errno_ptr);
+    }
+
+    // Recieve result and delta from server
+    int32_t covered;
+    int received = recieve_result(server_fd, DELTA_CALL, request_id, &covered, (char*)delta,
+                                  capacity);
+    if (received == -1)
+        return -1;
+
+    *delta_length = (size_t)received;
+    return covered;
+}
+
+/**
+ * @brief Writes a whole buffer to a file descriptor
+ * 
+ * @param fd File descriptor to write to
+ * @param data Bytes to write
+ * @param length Number of bytes
+ * @return int 0 on success : -1 on error
+ */
+static int write_all(int fd, const uint8_t* data, size_t length) {
+    while (length > 0) {
+        ssize_t bytes_wrote = write(fd, data, length);
+        if (bytes_wrote == -1 && errno == EINTR)
+            continue;
+        if (bytes_wrote <= 0)
+            return -1;
+        data += bytes_wrote;
+        length -= bytes_wrote;
+    }
     return 0;
 }
 
 /**
- * @brief Recieve the return of a system call from the server, and an error code if an error 
+ * @brief Computes the signature of every whole block of a local file
+ * 
+ * @param basis_fd Local file to sign
+ * @param block_size Bytes per block
+ * @param block_count Number of blocks
+ * @param signatures Array to store the signatures in (in network byte order)
+ * @param block Buffer of block_size bytes
+ * @return int 0 on success : -1 on error
+ */
+static int sign_blocks(int basis_fd, size_t block_size, size_t block_count,
+                       rp_block_signature_s* signatures, uint8_t* block) {
+    for (size_t i = 0; i < block_count; i++) {
+        if (pread(basis_fd, block, block_size, (off_t)(i * block_size)) != (ssize_t)block_size) {
+            return -1;
+        }
+        rolling_sum_s sum;
+        rolling_init(&sum, block, block_size);
+        signatures[i].weak = htonl(rolling_digest(&sum));
+        signatures[i].strong = htobe64(hash_buffer(block, block_size));
+    }
+    return 0;
+}
+
+/**
+ * @brief Writes the bytes a delta covers, copying the local blocks and writing the literal bytes
+ * 
+ * @param delta Delta operations returned by rp_delta()
+ * @param delta_length Bytes of delta operations recieved
+ * @param covered Bytes the delta covers
+ * @param basis_fd Local file the blocks are copied from
+ * @param output_fd File descriptor to write to
+ * @param block_size Bytes per block
+ * @param block_count Number of blocks
+ * @param block Buffer of block_size bytes
+ * @param literal_bytes Pointer to add the literal bytes written to
+ * @return int 0 on success : -1 on error (CLIENT_REPLY_MISMATCH if the delta is inconsistent)
+ */
+static int apply_delta(const uint8_t* delta, size_t delta_length, size_t covered, int basis_fd,
+                       int output_fd, size_t block_size, size_t block_count, uint8_t* block,
+                       size_t* literal_bytes) {
+    const uint8_t* next = delta;
+    const uint8_t* end = delta + delta_length;
+    for (size_t produced = 0; produced < covered;) {
+        // Every operation (and its literal bytes) must lie within the bytes recieved
+        rp_delta_op_s operation;
+        if ((size_t)(end - next) < sizeof(operation)) {
+            errno = CLIENT_REPLY_MISMATCH;
+            return -1;
+        }
+        memcpy(&operation, next, sizeof(operation));
+        next += sizeof(operation);
+        uint32_t first = ntohl(operation.block);
+        size_t count = ntohl(operation.count);
+        if (count == 0) {
+            errno = CLIENT_REPLY_MISMATCH;
+            return -1;
+        }
+
+        if (first == DELTA_LITERAL) {
+            if (count > (size_t)(end - next)) {
+                errno = CLIENT_REPLY_MISMATCH;
+                return -1;
+            }
+            if (write_all(output_fd, next, count) == -1) {
+                return -1;
+            }
+            next += count;
+            produced += count;
+            *literal_bytes += count;
+            continue;
+        }
+
+        if ((size_t)first + count > block_count) {
+            errno = CLIENT_REPLY_MISMATCH;
+            return -1;
+        }
+        for (size_t i = first; i < first + count; i++) {
+            ssize_t bytes_read = pread(basis_fd, block, block_size, (off_t)(i * block_size));
+            if (bytes_read != (ssize_t)block_size ||
+                write_all(output_fd, block, block_size) == -1) {
+                return -1;
+            }
+        }
+        produced += count * block_size;
+    }
+    return 0;
+}
+
+/**
+ * @brief Syncs a remote file to a local copy in the manner of rsync: the local copy's blocks are
+ *        found anywhere in the remote file (even after data is inserted or shifted), and only the
+ *        bytes between them are transferred
+ * 
+ * @param server_fd Server connection file descriptor
+ * @param file_fd Remote file descriptor to sync from
+ * @param basis_fd Local copy (an older version of the remote file, or empty)
+ * @param output_fd File descriptor the synced file is written to (at its file position)
+ * @param literal_bytes Pointer to store the bytes transferred as is, NULL if not needed
+ * @return Size of the synced file, -1 on error with errno set
+ */
+ssize_t rp_sync(int server_fd, int file_fd, int basis_fd, int output_fd, size_t* literal_bytes) {
+    struct stat status;
+    if (fstat(basis_fd, &status) == -1) {
+        return -1;
+    }
+
+    // Larger files use larger blocks, so their signatures stay small
+    size_t block_size = ((size_t)status.st_size + SYNC_MAX_BLOCKS - 1) / SYNC_MAX_BLOCKS;
+    if (block_size < SYNC_MIN_BLOCK_SIZE) {
+        block_size = SYNC_MIN_BLOCK_SIZE;
+    }
+    size_t block_count = (size_t)status.st_size / block_size; // a partial last block isn't matched
+
+    size_t capacity = SYNC_RANGE_SIZE + (SYNC_RANGE_SIZE / block_size + 2) * 2 *
+                      sizeof(rp_delta_op_s);
+    rp_block_signature_s* signatures = malloc(block_count * sizeof(*signatures) + 1);
+    uint8_t* block = malloc(block_size);
+    uint8_t* delta = malloc(capacity);
+
+    // Rebuild the remote file a range at a time from local blocks and the literal bytes between
+    ssize_t total = -1;
+    size_t literals = 0;
+    if (signatures && block && delta &&
+        sign_blocks(basis_fd, block_size, block_count, signatures, block) == 0) {
+        total = 0;
+        while (1) {
+            size_t delta_length = 0;
+            int32_t covered = rp_delta(server_fd, file_fd, block_size, signatures, block_count,
+                                       total, SYNC_RANGE_SIZE, delta, capacity, &delta_length);
+            if (covered <= 0) {
+                total = (covered == -1) ? -1 : total;
+                break;
+            }
+            if (apply_delta(delta, delta_length, covered, basis_fd, output_fd, block_size,
+                            block_count, block, &literals) == -1) {
+                total = -1;
+                break;
+            }
+            total += covered;
+        }
+    }
+    free(signatures);
+    free(block);
+    free(delta);
+
+    if (total != -1 && literal_bytes) {
+        *literal_bytes = literals;
+    }
+    return total;
+}
+
+/*==================================================================================================
+    Asynchronous Calls
+==================================================================================================*/
+
+/**
+ * @brief Sets up a connection to keep several calls in flight. Calls are submitted without waiting
+ *        and reaped as their replies arrive, which may be in any order, so calls in flight together
+ *        must not depend on each other.
+ * 
+ * @param async Asynchronous state to initialize
+ * @param server_fd Server connection file descriptor
+ * @param depth Most calls in flight at once
+ * @return int 0 on success : -1 on error
+ * @note Synchronous calls must not be made on the connection while calls are in flight
+ */
+int rp_async_init(rp_async_s* async, int server_fd, size_t depth) {
+    async->calls = calloc(depth, sizeof(*async->calls));
+    if (!async->calls) {
+        return -1;
+    }
+    async->server_fd = server_fd;
+    async->depth = depth;
+    async->in_flight = 0;
+    return 0;
+}
+
+/**
+ * @brief Frees the asynchronous state of a connection
+ * 
+ * @param async Asynchronous state to free
+ */
+void rp_async_free(rp_async_s* async) {
+    free(async->calls);
+    async->calls = NULL;
+    async->depth = 0;
+    async->in_flight = 0;
+}
+
+/**
+ * @brief Sends the frame of a call and records it as in flight
+ * 
+ * @param async Asynchronous state of the connection
+ * @param call Call to submit, which must stay valid until reaped
+ * @param opcode Call type of the frame
+ * @param args Packed arguments of the call
+ * @param args_size Size of the arguments in bytes
+ * @param data Data following the arguments, NULL if none
+ * @param data_size Size of the data in bytes
+ * @return int 0 on success : -1 on error
+ */
+static int submit_call(rp_async_s* async, rp_call_s* call, uint16_t opcode, const void* args,
+                       size_t args_size, const void* data, size_t data_size) {
+    if (async->in_flight == async->depth) {
+        errno = CLIENT_PIPELINE_FULL;
+        return -1;
+    }
+
+    call->opcode = opcode;
+    call->request_id = next_request_id++;
+    if (send_frame(async->server_fd, opcode, call->request_id, args, args_size,
+                   data, data_size) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
+        return -1;
+    }
+
+    // Take a free slot (there is one, as fewer than depth calls are in flight)
+    size_t slot = 0;
+    while (async->calls[slot]) {
+        slot++;
+    }
+    async->calls[slot] = call;
+    async->in_flight++;
+    return 0;
+}
+
+/**
+ * @brief Submits a pread system call, reading at an offset without moving the file position
+ * 
+ * @param async Asynchronous state of the connection
+ * @param call Call to submit, which must stay valid until reaped
+ * @param file_fd File descriptor to read from
+ * @param buffer Buffer to store read data, which must stay valid until reaped
+ * @param count Maximum number of bytes to read
+ * @param offset File position to read from
+ * @return int 0 on success : -1 on error with errno set
+ */
+int rp_submit_pread(rp_async_s* async, rp_call_s* call, int file_fd, char* buffer, size_t count,
+                    off_t offset) {
+    rp_pread_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    args.count = htonl((uint32_t)count);
+    args.offset = htonl((uint32_t)offset);
+    call->data = buffer;
+    call->data_capacity = count;
+    return submit_call(async, call, PREAD_CALL, &args, sizeof(args), NULL, 0);
+}
+
+/**
+ * @brief Submits a pwrite system call, writing at an offset without moving the file position
+ * 
+ * @param async Asynchronous state of the connection
+ * @param call Call to submit, which must stay valid until reaped
+ * @param file_fd File descriptor to write to
+ * @param buffer Buffer containing data to write (sent before returning)
+ * @param count Number of bytes to write
+ * @param offset File position to write at
+ * @return int 0 on success : -1 on error with errno set
+ */
+int rp_submit_pwrite(rp_async_s* async, rp_call_s* call, int file_fd, char* buffer, size_t count,
+                     off_t offset) {
+    rp_pwrite_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    args.count = htonl((uint32_t)count);
+    args.offset = htonl((uint32_t)offset);
+    call->data = NULL;
+    call->data_capacity = 0;
+    return submit_call(async, call, PWRITE_CALL, &args, sizeof(args), buffer, count);
+}
+
+/**
+ * @brief Waits for the next reply and completes the call it answers, landing any data read
+ *        straight in the call's buffer
+ * 
+ * @param async Asynchronous state of the connection
+ * @return The completed call (with its result and error set), NULL on error with errno set
+ */
+rp_call_s* rp_reap(rp_async_s* async) {
+    if (async->in_flight == 0) {
+        errno = CLIENT_REPLY_MISMATCH;
+        return NULL;
+    }
+
+    // Retrieve the reply header, result and errno
+    struct __attribute__((packed)) {
+        rp_header_s header;
+        rp_reply_s reply;
+    } frame;
+    if (read_exact(async->server_fd, &frame, sizeof(frame)) == -1) {
+        errno = CLIENT_ERROR_RECIEVING_RPC_RESULT;
+        return NULL;
+    }
+    uint32_t request_id = ntohl(frame.header.request_id);
+    size_t payload_length = ntohl(frame.header.payload_length);
+
+    // Find the call answered
+    size_t slot = 0;
+    while (slot < async->depth &&
+           (!async->calls[slot] || async->calls[slot]->request_id != request_id)) {
+        slot++;
+    }
+    if (slot == async->depth) {
+        errno = CLIENT_REPLY_MISMATCH;
+        return NULL;
+    }
+    rp_call_s* call = async->calls[slot];
+    if (ntohs(frame.header.opcode) != call->opcode || payload_length < sizeof(rp_reply_s) ||
+        payload_length - sizeof(rp_reply_s) > call->data_capacity) {
+        errno = CLIENT_REPLY_MISMATCH;
+        return NULL;
+    }
+
+    // Land any data read straight in the call's buffer
+    if (payload_length > sizeof(rp_reply_s) &&
+        read_exact(async->server_fd, call->data, payload_length - sizeof(rp_reply_s)) == -1) {
+        errno = CLIENT_ERROR_RECIEVING_RPC_RESULT;
+        return NULL;
+    }
+
+    call->result = (int32_t)ntohl((uint32_t)frame.reply.result);
+    call->error = (call->result == -1) ? (int)ntohl((uint32_t)frame.reply.error) : 0;
+    async->calls[slot] = NULL;
+    async->in_flight--;
+    return call;
+}
+
+/*==================================================================================================
+    Bulk Transfers
+==================================================================================================*/
+
+/**
+ * @brief Copies bytes out of a pipe into a local file, for files that can't be spliced into
+ * 
+ * @param pipe_fd Read end of the pipe
+ * @param local_fd File descriptor to write to
+ * @param length Bytes in the pipe
+ * @return int 0 on success : -1 on error
+ */
+static int copy_from_pipe(int pipe_fd, int local_fd, size_t length) {
+    char buffer[TRANSFER_CHUNK_SIZE];
+    while (length > 0) {
+        ssize_t bytes_read = read(pipe_fd, buffer,
+                                  (length < sizeof(buffer)) ? length : sizeof(buffer));
+        if (bytes_read == -1 && errno == EINTR)
+            continue;
+        if (bytes_read <= 0)
+            return -1;
+        length -= bytes_read;
+
+        char* next = buffer;
+        while (bytes_read > 0) {
+            ssize_t bytes_wrote = write(local_fd, next, bytes_read);
+            if (bytes_wrote == -1 && errno == EINTR)
+                continue;
+            if (bytes_wrote <= 0)
+                return -1;
+            next += bytes_wrote;
+            bytes_read -= bytes_wrote;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Moves bytes from the server connection into a local file through a pipe, so they never
+ *        pass through a buffer (unless the local file can't be spliced into)
+ * 
+ * @param server_fd Server connection file descriptor
+ * @param local_fd File descriptor to write to (at its file position)
+ * @param length Bytes to move
+ * @return int 0 on success : -1 on error
+ */
+static int splice_to_fd(int server_fd, int local_fd, size_t length) {
+    int pipe_fds[2];
+    if (pipe(pipe_fds) == -1) {
+        return -1;
+    }
+    size_t remaining = length;
+    int copying = 0;
+    while (remaining > 0) {
+        size_t chunk = (remaining < TRANSFER_CHUNK_SIZE) ? remaining : TRANSFER_CHUNK_SIZE;
+        ssize_t moved = splice(server_fd, NULL, pipe_fds[1], NULL, chunk, SPLICE_F_MOVE);
+        if (moved == -1 && errno == EINTR)
+            continue;
+        if (moved <= 0) {
+            errno = CLIENT_ERROR_RECIEVING_RPC_RESULT;
+            break;
+        }
+        remaining -= moved;
+
+        // Empty the pipe, copying instead once the local file turns out not to take a splice
+        while (moved > 0 && !copying) {
+            ssize_t wrote = splice(pipe_fds[0], NULL, local_fd, NULL, moved, SPLICE_F_MOVE);
+            if (wrote == -1 && errno == EINTR)
+                continue;
+            if (wrote == -1 && errno == EINVAL) {
+                copying = 1;
+                break;
+            }
+            if (wrote <= 0) {
+                break;
+            }
+            moved -= wrote;
+        }
+        if (moved > 0 && (!copying || copy_from_pipe(pipe_fds[0], local_fd, moved) == -1)) {
+            break;
+        }
+    }
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+
+    return (remaining == 0) ? 0 : -1;
+}
+
+/**
+ * @brief Sends bytes from a local file to the server with sendfile()
+ * 
+ * @param server_fd Server connection file descriptor
+ * @param local_fd File descriptor to read from (at its file position)
+ * @param length Bytes to send, local_fd must hold at least as many
+ * @return int 0 on success : -1 on error
+ */
+static int sendfile_from_fd(int server_fd, int local_fd, size_t length) {
+    while (length > 0) {
+        ssize_t bytes_sent = sendfile(server_fd, local_fd, NULL, length);
+        if (bytes_sent == -1 && errno == EINTR)
+            continue;
+        if (bytes_sent <= 0) {
+            errno = CLIENT_ERROR_SENDING_RPC_ARGS;
+            return -1;
+        }
+        length -= bytes_sent;
+    }
+    return 0;
+}
+
+/**
+ * @brief Remote procedure call streaming a range of a remote file into a local file descriptor.
+ *        The server sends the range with sendfile(), and it is spliced from the socket into the
+ *        local file through a pipe, so the data never passes through a buffer.
+ * 
+ * @param server_fd Server connection file descriptor
+ * @param file_fd Remote file descriptor to stream from
+ * @param local_fd File descriptor the data is written to (at its file position)
+ * @param offset Remote file position to stream from
+ * @param count Most bytes to stream, fewer are streamed past the end of the remote file
+ * @return Number of bytes streamed, 0 at EOF, -1 on error with errno set
+ * @note If writing to local_fd fails partway the rest of the stream can't be read, so the
+ *       connection must be closed
+ */
+int32_t rp_stream_to_fd(int server_fd, int file_fd, int local_fd, off_t offset, size_t count) {
+
+    // Send file descriptor, count and offset
+    rp_stream_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    args.count = htonl((uint32_t)count);
+    args.offset = htonl((uint32_t)offset);
+    uint32_t request_id = next_request_id++;
+    if (send_frame(server_fd, STREAM_CALL, request_id, &args, sizeof(args), NULL, 0) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
+        return -1;
+    }
+
+    // Retrieve the reply header, result and errno
+    struct __attribute__((packed)) {
+        rp_header_s header;
+        rp_reply_s reply;
+    } frame;
+    if (read_exact(server_fd, &frame, sizeof(frame)) == -1) {
+        errno = CLIENT_ERROR_RECIEVING_RPC_RESULT;
+        return -1;
+    }
+    size_t payload_length = ntohl(frame.header.payload_length);
+    int32_t result = (int32_t)ntohl((uint32_t)frame.reply.result);
+    if (ntohs(frame.header.opcode) != STREAM_CALL || ntohl(frame.header.request_id) != request_id ||
+        payload_length != sizeof(rp_reply_s) + ((result > 0) ? (size_t)result : 0)) {
+        errno = CLIENT_REPLY_MISMATCH;
+        return -1;
+    }
+    if (result == -1) {
+        errno = (int)ntohl((uint32_t)frame.reply.error);
+        return -1;
+    }
+
+    if (result > 0 && splice_to_fd(server_fd, local_fd, (size_t)result) == -1)
+        return -1;
+
+    return result;
+}
+
+/**
+ * @brief Remote procedure call streaming a range of any size from any offset of a remote file
+ *        into a local file descriptor, moving the data the same way as rp_stream_to_fd()
+ * 
+ * @param server_fd Server connection file descriptor
+ * @param file_fd Remote file descriptor to stream from
+ * @param local_fd File descriptor the data is written to (at its file position)
+ * @param offset Remote file position to stream from
+ * @param count Most bytes to stream, fewer are streamed past the end of the remote file
+ * @return Number of bytes streamed, 0 at EOF, -1 on error with errno set
+ * @note If writing to local_fd fails partway the rest of the stream can't be read, so the
+ *       connection must be closed
+ */
+int64_t rp_stream64_to_fd(int server_fd, int file_fd, int local_fd, off_t offset, size_t count) {
+
+    // Send file descriptor, count and offset
+    rp_stream64_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    args.count = htobe64((uint64_t)count);
+    args.offset = htobe64((uint64_t)offset);
+    uint32_t request_id = next_request_id++;
+    if (send_frame(server_fd, STREAM64_CALL, request_id, &args, sizeof(args), NULL, 0) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
+        return -1;
+    }
+
+    // Recieve result from server, the streamed bytes follow the reply frame
+    int64_t result;
+    if (recieve_result64(server_fd, STREAM64_CALL, request_id, &result, NULL, 0) == -1)
+        return -1;
+    if (result > 0 && splice_to_fd(server_fd, local_fd, (size_t)result) == -1)
+        return -1;
+
+    return result;
+}
+
+/**
+ * @brief Remote procedure call writing data from a local file descriptor to a remote file at an
+ *        offset. The data is sent with sendfile(), and the server splices it from the socket into
+ *        the remote file, so it never passes through a buffer.
+ * 
+ * @param server_fd Server connection file descriptor
+ * @param file_fd Remote file descriptor to write to
+ * @param local_fd File descriptor the data is read from (at its file position)
+ * @param offset Remote file position to write at
+ * @param count Number of bytes to write, local_fd must hold at least as many
+ * @return Number of bytes written, -1 on error with errno set
+ * @note If local_fd runs short the frame can't be finished, so the connection must be closed
+ */
+int32_t rp_receive_from_fd(int server_fd, int file_fd, int local_fd, off_t offset, size_t count) {
+
+    // Send file descriptor, count and offset
+    rp_receive_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    args.count = htonl((uint32_t)count);
+    args.offset = htonl((uint32_t)offset);
+    uint32_t request_id = next_request_id++;
+    if (send_frame_head(server_fd, RECEIVE_CALL, request_id, &args, sizeof(args), count) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
+        return -1;
+    }
+
+    // Then the data, straight from the local file
+    if (sendfile_from_fd(server_fd, local_fd, count) == -1)
+        return -1;
+
+    // Recieve result from server
+    int32_t data_wrote;
+    if (recieve_result(server_fd, RECEIVE_CALL, request_id, &data_wrote, NULL, 0) == -1)
+        return -1;
+
+    return data_wrote;
+}
+
+/**
+ * @brief Remote procedure call writing any amount of data from a local file descriptor to a remote
+ *        file at any offset, moving the data the same way as rp_receive_from_fd()
+ * 
+ * @param server_fd Server connection file descriptor
+ * @param file_fd Remote file descriptor to write to
+ * @param local_fd File descriptor the data is read from (at its file position)
+ * @param offset Remote file position to write at
+ * @param count Number of bytes to write, local_fd must hold at least as many
+ * @return Number of bytes written, -1 on error with errno set
+ * @note If local_fd runs short the call can't be finished, so the connection must be closed
+ */
+int64_t rp_receive64_from_fd(int server_fd, int file_fd, int local_fd, off_t offset,
+                             size_t count) {
+
+    // Send file descriptor, count and offset, the data follows the frame
+    rp_receive64_args_s args;
+    args.file_fd = htonl((uint32_t)file_fd);
+    args.count = htobe64((uint64_t)count);
+    args.offset = htobe64((uint64_t)offset);
+    uint32_t request_id = next_request_id++;
+    if (send_frame(server_fd, RECEIVE64_CALL, request_id, &args, sizeof(args), NULL, 0) == -1) {
+        errno = CLIENT_ERROR_SENDING_RPC_ARGS;
+        return -1;
+    }
+    if (sendfile_from_fd(server_fd, local_fd, count) == -1)
+        return -1;
+
+    // Recieve result from server
+    int64_t data_wrote;
+    if (recieve_result64(server_fd, RECEIVE64_CALL, request_id, &data_wrote, NULL, 0) == -1)
+        return -1;
+
+    return data_wrote;
+}
+
+/*==================================================================================================
+    Client Specific Helpers
+==================================================================================================*/
+
+/**
+ * @brief Recieve the reply frame of a system call from the server, updating errno if an error
  *        occured.
  * 
  * @param server_fd File descriptor of the server connection
- * @param result_buffer Numberic variable to load the recieved syscall result into
- * @param type Type of variable being returned
- * @param read_buffer Buffer for read data during read calls, otherwise NULL
- * @return int 0 on success : 1 on error
+ * @param opcode Call type of the request being answered
+ * @param request_id Request id of the request being answered
+ * @param result Pointer to load the recieved syscall result into
+ * @param data Buffer for data returned by read calls, otherwise NULL
+ * @param data_capacity Size of the data buffer in bytes
+ * @return int Bytes of data recieved on success : -1 on error
  */
-int recieve_result(int server_fd, void* result_buffer, var_type_e type) {
+int recieve_result(int server_fd, uint16_t opcode, uint32_t request_id, int32_t* result,
+                   char* data, size_t data_capacity) {
 
-    // Retrieve result from server
-    if (read_data_of_type(result_buffer, type, server_fd) == -1) {
+    // Retrieve the reply header, result and errno
+    struct __attribute__((packed)) {
+        rp_header_s header;
+        rp_reply_s reply;
+    } frame;
+    if (read_exact(server_fd, &frame, sizeof(frame)) == -1) {
         errno = CLIENT_ERROR_RECIEVING_RPC_RESULT;
         return -1;
     }
+    size_t payload_length = ntohl(frame.header.payload_length);
+    if (ntohs(frame.header.opcode) != opcode || ntohl(frame.header.request_id) != request_id ||
+        payload_length < sizeof(rp_reply_s) || payload_length - sizeof(rp_reply_s) > data_capacity) {
+        errno = CLIENT_REPLY_MISMATCH;
+        return -1;
+    }
+    rp_reply_s reply = frame.reply;
 
-    // Dereference the result
-    int32_t result;
-    memcpy(&result, result_buffer, sizeof(result));
+    // Land any data read straight in the caller's buffer
+    if (payload_length > sizeof(reply) &&
+        read_exact(server_fd, data, payload_length - sizeof(reply)) == -1) {
+        errno = CLIENT_ERROR_RECIEVING_RPC_RESULT;
+        return -1;
+    }
 
     // Update errno if neccessary
-    if (result == -1) {
-        if (update_errno(server_fd) == -1) {
-            errno = CLIENT_ERROR_RECIEVING_RPC_ERRNO;
-            return -1;
-        }
+    *result = (int32_t)ntohl((uint32_t)reply.result);
+    if (*result == -1) {
+        errno = (int)ntohl((uint32_t)reply.error);
+    }
+
+    return (int)(payload_length - sizeof(reply));
+}
+
+/**
+ * @brief Recieve the reply frame of a 64-bit system call from the server, updating errno if an
+ *        error occured.
+ * 
+ * @param server_fd File descriptor of the server connection
+ * @param opcode Call type of the request being answered
+ * @param request_id Request id of the request being answered
+ * @param result Pointer to load the recieved syscall result into
+ * @param data Buffer for data returned by read calls, otherwise NULL
+ * @param data_capacity Size of the data buffer in bytes
+ * @return int 0 on success : -1 on error
+ */
+int recieve_result64(int server_fd, uint16_t opcode, uint32_t request_id, int64_t* result,
+                     char* data, size_t data_capacity) {
+
+    // Retrieve the reply header, result and errno
+    struct __attribute__((packed)) {
+        rp_header_s header;
+        rp_reply64_s reply;
+    } frame;
+    if (read_exact(server_fd, &frame, sizeof(frame)) == -1) {
+        errno = CLIENT_ERROR_RECIEVING_RPC_RESULT;
+        return -1;
+    }
+    size_t payload_length = ntohl(frame.header.payload_length);
+    if (ntohs(frame.header.opcode) != opcode || ntohl(frame.header.request_id) != request_id ||
+        payload_length < sizeof(rp_reply64_s) ||
+        payload_length - sizeof(rp_reply64_s) > data_capacity) {
+        errno = CLIENT_REPLY_MISMATCH;
+        return -1;
+    }
+    rp_reply64_s reply = frame.reply;
+
+    // Land any data read straight in the caller's buffer
+    if (payload_length > sizeof(reply) &&
+        read_exact(server_fd, data, payload_length - sizeof(reply)) == -1) {
+        errno = CLIENT_ERROR_RECIEVING_RPC_RESULT;
+        return -1;
+    }
+
+    // Update errno if neccessary
+    *result = (int64_t)be64toh((uint64_t)reply.result);
+    if (*result == -1) {
+        errno = (int)ntohl((uint32_t)reply.error);
     }
 
     return 0;
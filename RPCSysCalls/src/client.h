@@ -22,6 +22,37 @@
 
 #define USER_BUFFER_SIZE 1024 // size of buffer used to read/write from
                               // remote files
+#define USER_PIPELINE_DEPTH 16 // reads the user keeps in flight while copying
+#define PIPELINE_FLAG "-p"     // copy with pipelined reads instead of streaming
+#define USER_DIGEST_CHUNK_SIZE (4 * 1024 * 1024) // bytes per chunk the user verifies
+#define SYNC_FLAG "-s"         // sync the local file with delta transfers instead of copying
+#define STATS_FLAG "-t"        // print the server's call statistics once done
+#define USER_SYNC_SUFFIX ".sync" // appended to the local path while the synced file is built
+#define SYNC_RANGE_SIZE (16 * 1024 * 1024) // bytes of the remote file compared per delta call
+#define SYNC_MIN_BLOCK_SIZE 2048 // smallest block matched by a delta sync
+#define SYNC_MAX_BLOCKS 8192   // most blocks sent per delta call (larger files use larger blocks)
+
+/*==================================================================================================
+    Structures
+==================================================================================================*/
+
+/***************| Asynchronous Calls |***************/
+typedef struct {
+    uint32_t request_id;        // set when submitted
+    uint16_t opcode;
+    char* data;                 // buffer data read lands in, otherwise NULL
+    size_t data_capacity;
+    int32_t result;             // return value of the call, once reaped
+    int error;                  // errno of the call when result is -1
+    void* user_data;            // left for the caller
+} rp_call_s;
+
+typedef struct {
+    int server_fd;
+    rp_call_s** calls;          // calls in flight
+    size_t depth;               // most calls in flight at once
+    size_t in_flight;
+} rp_async_s;
 
 /*==================================================================================================
     Function Declarations
@@ -36,10 +67,40 @@ int32_t rp_close(int server_fd, int file_fd);
 int32_t rp_read(int server_fd, int file_fd, char* buffer, size_t count);
 int32_t rp_write(int server_fd, int file_fd, char* buffer, size_t count);
 int32_t rp_lseek(int server_fd, int file_fd, off_t offset, int whence);
+int64_t rp_lseek64(int server_fd, int file_fd, off_t offset, int whence);
+int64_t rp_pread64(int server_fd, int file_fd, char* buffer, size_t count, off_t offset);
+int64_t rp_pwrite64(int server_fd, int file_fd, char* buffer, size_t count, off_t offset);
 int16_t rp_checksum(int server_fd, int file_fd, size_t block_size);
+int32_t rp_digest(int server_fd, int file_fd, size_t chunk_size, uint64_t* digests,
+                  size_t capacity);
+int32_t rp_stats(int server_fd, rp_call_stats_s* stats, size_t capacity);
+
+/* Delta Sync */
+int32_t rp_delta(int server_fd, int file_fd, size_t block_size,
+                 const rp_block_signature_s* signatures, size_t block_count, off_t offset,
+                 size_t length, uint8_t* delta, size_t capacity, size_t* delta_length);
+ssize_t rp_sync(int server_fd, int file_fd, int basis_fd, int output_fd, size_t* literal_bytes);
+
+/* Asynchronous Calls */
+int rp_async_init(rp_async_s* async, int server_fd, size_t depth);
+void rp_async_free(rp_async_s* async);
+int rp_submit_pread(rp_async_s* async, rp_call_s* call, int file_fd, char* buffer, size_t count,
+                    off_t offset);
+int rp_submit_pwrite(rp_async_s* async, rp_call_s* call, int file_fd, char* buffer, size_t count,
+                     off_t offset);
+rp_call_s* rp_reap(rp_async_s* async);
+
+/* Bulk Transfers */
+int32_t rp_stream_to_fd(int server_fd, int file_fd, int local_fd, off_t offset, size_t count);
+int32_t rp_receive_from_fd(int server_fd, int file_fd, int local_fd, off_t offset, size_t count);
+int64_t rp_stream64_to_fd(int server_fd, int file_fd, int local_fd, off_t offset, size_t count);
+int64_t rp_receive64_from_fd(int server_fd, int file_fd, int local_fd, off_t offset,
+                             size_t count);
 
 /* Client Specific Helpers */
-int update_errno(int server_fd);
-int recieve_result(int server_fd, void* result_buffer, var_type_e type);
+int recieve_result(int server_fd, uint16_t opcode, uint32_t request_id, int32_t* result,
+                   char* data, size_t data_capacity);
+int recieve_result64(int server_fd, uint16_t opcode, uint32_t request_id, int64_t* result,
+                     char* data, size_t data_capacity);
 
 #endif // CLIENT_H
\ No newline at end of file
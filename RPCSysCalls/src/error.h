@@ -47,6 +47,10 @@ typedef enum {
     CLIENT_ERROR_SENDING_RPC_ARGS = -503,
     CLIENT_ERROR_RECIEVING_RPC_RESULT = -504,
     CLIENT_ERROR_RECIEVING_RPC_ERRNO = -505,
+    PROTOCOL_FRAME_TOO_LARGE = -506,
+    PROTOCOL_BAD_FRAME = -507,
+    CLIENT_REPLY_MISMATCH = -508,
+    CLIENT_PIPELINE_FULL = -509,
     
     // Checksum related errors (-600 to -699)
     CHECKSUM_BUFFER_ALLOC_ERROR = -600,
@@ -0,0 +1,287 @@
+/***************************************************************************************************
+* @project: RPC System Calls
+****************************************************************************************************
+* @file logger.c
+* @brief Contains the asynchronous logger of the server.
+*
+* Records cycle between two lock-free queues (the job queue of the worker pool): a message takes a
+* free record, fills it and pushes it onto the pending queue, and the writer thread writes it out
+* and frees it again. The writer sleeps on a semaphore posted once per pending record. Messages
+* are written with write() and nothing on the flush path formats with stdio or allocates, so a
+* flush is safe from a signal handler or right after a fork.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "logger.h"
+#include "pool.h"
+
+static log_level_e log_level = LOG_LEVEL_INFO;
+static log_record_s* records = NULL;
+static job_queue_s free_records;        // records a message can take
+static job_queue_s pending_records;     // records waiting for the writer
+static sem_t pending;                   // posted once per pending record
+static pthread_t writer;
+static atomic_int running;              // messages are queued rather than written in place
+static atomic_int stopping;
+static _Atomic uint64_t dropped;        // messages lost while every record was taken
+
+/*==================================================================================================
+    Writing
+==================================================================================================*/
+
+/**
+ * @brief Writes a message out, warnings and errors to stderr and the rest to stdout
+ *
+ * @param level Level of the message
+ * @param text Message to write
+ * @param length Bytes in the message
+ */
+static void write_message(log_level_e level, const char* text, size_t length) {
+    int fd = (level >= LOG_LEVEL_WARNING) ? STDERR_FILENO : STDOUT_FILENO;
+    while (length > 0) {
+        ssize_t bytes_wrote = write(fd, text, length);
+        if (bytes_wrote == -1 && errno == EINTR)
+            continue;
+        if (bytes_wrote <= 0)
+            return;
+        text += bytes_wrote;
+        length -= bytes_wrote;
+    }
+}
+
+/**
+ * @brief Writes the notice of dropped messages
+ *
+ * The count is formatted by hand, as snprintf() is not async-signal-safe and a flush may run in a
+ * signal handler.
+ *
+ * @param lost Number of messages dropped
+ */
+static void write_dropped_notice(uint64_t lost) {
+    static const char prefix[] = "[Server : Warning] ";
+    static const char suffix[] = " log messages dropped\n";
+    char notice[sizeof(prefix) + 20 + sizeof(suffix)]; // 20 digits hold any uint64_t
+
+    // Digits come out least significant first
+    char digits[20];
+    size_t digit_count = 0;
+    do {
+        digits[digit_count++] = (char)('0' + (lost % 10));
+        lost /= 10;
+    } while (lost > 0);
+
+    size_t length = sizeof(prefix) - 1;
+    memcpy(notice, prefix, length);
+    while (digit_count > 0) {
+        notice[length++] = digits[--digit_count];
+    }
+    memcpy(notice + length, suffix, sizeof(suffix) - 1);
+    length += sizeof(suffix) - 1;
+
+    write_message(LOG_LEVEL_WARNING, notice, length);
+}
+
+/**
+ * @brief Writes a pending record out and frees it, reporting any messages dropped beforehand
+ *
+ * @param record Record to write
+ */
+static void write_record(log_record_s* record) {
+    uint64_t lost = atomic_exchange_explicit(&dropped, 0, memory_order_relaxed);
+    if (lost) {
+        write_dropped_notice(lost);
+    }
+
+    write_message(record->level, record->text, record->length);
+    queue_push(&free_records, record);
+}
+
+/**
+ * @brief Writes pending records until the logger stops
+ *
+ * @param argument Unused
+ * @return NULL
+ */
+static void* writer_main(void* argument) {
+    (void)argument;
+
+    while (1) {
+        while (sem_wait(&pending) == -1 && errno == EINTR);
+
+        // The logger posts once more when stopping, the rest is flushed by logger_stop()
+        log_record_s* record = queue_pop(&pending_records);
+        if (!record) {
+            if (atomic_load(&stopping)) {
+                return NULL;
+            }
+            continue;
+        }
+        write_record(record);
+    }
+}
+
+/*==================================================================================================
+    Logger
+==================================================================================================*/
+
+/**
+ * @brief Finds the level named on the command line
+ *
+ * @param name debug, info, warning or error
+ * @return The level, -1 if unknown
+ */
+int logger_level_of(const char* name) {
+    static const char* names[] = {"debug", "info", "warning", "error"};
+    for (int level = LOG_LEVEL_DEBUG; level <= LOG_LEVEL_ERROR; level++) {
+        if (strcmp(name, names[level]) == 0) {
+            return level;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Allocates the records of the logger and starts its writer
+ *
+ * @param level Lowest level logged
+ * @return 0 on success, -1 on error (messages are then written in place)
+ */
+int logger_start(log_level_e level) {
+    log_level = level;
+
+    records = malloc(LOG_RECORD_COUNT * sizeof(*records));
+    if (!records || queue_init(&free_records, LOG_RECORD_COUNT) == -1) {
+        free(records);
+        records = NULL;
+        return -1;
+    }
+    if (queue_init(&pending_records, LOG_RECORD_COUNT) == -1) {
+        queue_free(&free_records);
+        free(records);
+        records = NULL;
+        return -1;
+    }
+    for (size_t i = 0; i < LOG_RECORD_COUNT; i++) {
+        queue_push(&free_records, &records[i]);
+    }
+
+    sem_init(&pending, 0, 0);
+    atomic_init(&stopping, 0);
+    atomic_init(&dropped, 0);
+    if (pthread_create(&writer, NULL, writer_main, NULL) != 0) {
+        return -1;
+    }
+    atomic_store(&running, 1);
+    return 0;
+}
+
+/**
+ * @brief Starts a writer for a forked child, which inherits the records but not the writer
+ *
+ * @return 0 on success, -1 on error (messages are then written in place)
+ */
+int logger_restart(void) {
+    if (!atomic_load(&running)) {
+        return -1;
+    }
+
+    // The parent's writer still writes the messages pending at the fork
+    log_record_s* record;
+    while ((record = queue_pop(&pending_records))) {
+        queue_push(&free_records, record);
+    }
+    if (pthread_create(&writer, NULL, writer_main, NULL) != 0) {
+        atomic_store(&running, 0);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Stops the writer and writes out every pending record, later messages are written in
+ *        place
+ */
+void logger_stop(void) {
+    if (!atomic_load(&running)) {
+        return;
+    }
+    atomic_store(&running, 0);
+    atomic_store(&stopping, 1);
+    sem_post(&pending);
+    pthread_join(writer, NULL);
+    logger_flush();
+}
+
+/**
+ * @brief Writes out every pending record from the calling thread
+ *
+ * @note Only uses write() and the lock-free queues (no stdio or allocation), so it may be
+ *       called from a signal handler
+ */
+void logger_flush(void) {
+    if (!records) {
+        return;
+    }
+
+    log_record_s* record;
+    while ((record = queue_pop(&pending_records))) {
+        write_record(record);
+    }
+}
+
+/**
+ * @brief Logs a message, formatted as printf() would
+ *
+ * @param level Level of the message, nothing is formatted below the logger's level
+ * @param format Format of the message
+ */
+void log_message(log_level_e level, const char* format, ...) {
+    if (level < log_level) {
+        return;
+    }
+
+    // Take a free record, the message is dropped rather than waiting for one
+    log_record_s* record = NULL;
+    log_record_s unqueued;
+    if (atomic_load_explicit(&running, memory_order_relaxed)) {
+        record = queue_pop(&free_records);
+        if (!record) {
+            atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+            return;
+        }
+    } else {
+        record = &unqueued;
+    }
+
+    // A message cut short still ends its line
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(record->text, sizeof(record->text), format, arguments);
+    va_end(arguments);
+    if (length < 0) {
+        length = 0;
+    } else if ((size_t)length >= sizeof(record->text)) {
+        length = sizeof(record->text) - 1;
+        record->text[length - 1] = '\n';
+    }
+    record->level = level;
+    record->length = (size_t)length;
+
+    if (record == &unqueued) {
+        write_message(level, record->text, record->length);
+        return;
+    }
+    queue_push(&pending_records, record);
+    sem_post(&pending);
+}
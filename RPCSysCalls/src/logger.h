@@ -0,0 +1,60 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+/***************************************************************************************************
+* @project: RPC System Calls
+****************************************************************************************************
+* @file logger.h
+* @brief Contains the asynchronous, level-filtered logger of the server.
+*
+* A message below the logger's level returns before it is formatted. Any other message is
+* formatted into a preallocated record, which is handed to a writer thread through a lock-free
+* queue, so the thread logging never writes to a terminal or file itself. When every record is
+* taken the message is dropped and counted instead of waiting, and the writer reports how many
+* were lost.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdint.h>
+#include <stdlib.h>
+
+/*==================================================================================================
+    Macros
+==================================================================================================*/
+
+#define LOG_LEVEL_FLAG "-l"         // followed by the lowest level logged
+#define LOG_RECORD_COUNT 1024       // messages waiting at once (must be a power of two)
+#define LOG_MESSAGE_SIZE 256        // longest message, longer ones are cut
+
+/*==================================================================================================
+    Structures
+==================================================================================================*/
+
+typedef enum {
+    LOG_LEVEL_DEBUG,                // every request handled
+    LOG_LEVEL_INFO,                 // connections and server state (the default)
+    LOG_LEVEL_WARNING,              // written to stderr from here on
+    LOG_LEVEL_ERROR
+} log_level_e;
+
+typedef struct {
+    log_level_e level;
+    size_t length;
+    char text[LOG_MESSAGE_SIZE];
+} log_record_s;
+
+/*==================================================================================================
+    Function Declarations
+==================================================================================================*/
+
+int logger_level_of(const char* name);
+int logger_start(log_level_e level);
+int logger_restart(void);
+void logger_stop(void);
+void logger_flush(void);
+void log_message(log_level_e level, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+#endif // LOGGER_H
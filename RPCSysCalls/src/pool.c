@@ -0,0 +1,389 @@
+/***************************************************************************************************
+* @project: RPC System Calls
+****************************************************************************************************
+* @file pool.c
+* @brief Contains the lock-free job queue and the worker pool of the event loop server.
+*
+* The queue is a bounded array of cells, each holding the position it is ready for. A push claims
+* the next position with a compare and swap, stores the item and publishes the cell by advancing
+* its sequence, and a pop does the same from the other end, so any number of threads can use it
+* without a lock.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/eventfd.h>
+
+#include "pool.h"
+#include "util.h"
+
+/*==================================================================================================
+    Lock-Free Queue
+==================================================================================================*/
+
+/**
+ * @brief Allocates the cells of a queue
+ *
+ * @param queue Queue to initialize
+ * @param size Number of cells (must be a power of two)
+ * @return 0 on success, -1 on error
+ */
+int queue_init(job_queue_s* queue, size_t size) {
+    queue->cells = malloc(size * sizeof(*queue->cells));
+    if (!queue->cells) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < size; i++) {
+        atomic_init(&queue->cells[i].sequence, i);
+        queue->cells[i].item = NULL;
+    }
+    queue->mask = size - 1;
+    atomic_init(&queue->push_position, 0);
+    atomic_init(&queue->pop_position, 0);
+    return 0;
+}
+
+/**
+ * @brief Frees the cells of a queue
+ *
+ * @param queue Queue to free
+ */
+void queue_free(job_queue_s* queue) {
+    free(queue->cells);
+    queue->cells = NULL;
+}
+
+/**
+ * @brief Adds an item to the back of a queue
+ *
+ * @param queue Queue to push onto
+ * @param item Item to add
+ * @return 0 on success, -1 if the queue is full
+ */
+int queue_push(job_queue_s* queue, void* item) {
+    size_t position = atomic_load_explicit(&queue->push_position, memory_order_relaxed);
+
+    while (1) {
+        queue_cell_s* cell = &queue->cells[position & queue->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+        // The cell is free, claim its position
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->push_position, &position,
+                                                      position + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                cell->item = item;
+                atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+                return 0;
+            }
+
+        // The cell still holds an item from the last lap
+        } else if (difference < 0) {
+            return -1;
+
+        // Another thread claimed the position first
+        } else {
+            position = atomic_load_explicit(&queue->push_position, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Removes the item at the front of a queue
+ *
+ * @param queue Queue to pop from
+ * @return The item, NULL if the queue is empty
+ */
+void* queue_pop(job_queue_s* queue) {
+    size_t position = atomic_load_explicit(&queue->pop_position, memory_order_relaxed);
+
+    while (1) {
+        queue_cell_s* cell = &queue->cells[position & queue->mask];
+        size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+
+        // The cell holds an item, claim its position
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&queue->pop_position, &position,
+                                                      position + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                void* item = cell->item;
+                atomic_store_explicit(&cell->sequence, position + queue->mask + 1,
+                                      memory_order_release);
+                return item;
+            }
+
+        // The cell hasn't been filled yet
+        } else if (difference < 0) {
+            return NULL;
+
+        // Another thread claimed the position first
+        } else {
+            position = atomic_load_explicit(&queue->pop_position, memory_order_relaxed);
+        }
+    }
+}
+
+/*==================================================================================================
+    Worker Pool
+==================================================================================================*/
+
+/**
+ * @brief Counters kept for a job, those of its opcode (unknown opcodes share the counters of
+ *        opcode 0) unless it was spawned
+ *
+ * @param pool Pool holding the counters
+ * @param job Job to be counted
+ * @return Counters of the job
+ */
+static op_counters_s* counters_of(worker_pool_s* pool, const pool_job_s* job) {
+    if (job->spawned_run) {
+        return &pool->helper_counters;
+    }
+    return &pool->counters[(job->opcode < RP_CALL_COUNT) ? job->opcode : 0];
+}
+
+/**
+ * @brief Runs queued jobs until the pool stops
+ *
+ * @param argument Pool the worker belongs to
+ * @return NULL
+ */
+static void* worker_main(void* argument) {
+    worker_pool_s* pool = argument;
+
+    while (1) {
+        while (sem_wait(&pool->pending) == -1 && errno == EINTR);
+
+        // The pool posts once per worker when stopping
+        pool_job_s* job = queue_pop(&pool->jobs);
+        if (!job && atomic_load(&pool->stopping)) {
+            return NULL;
+        }
+
+        // A job is published just before its post, a pop can only miss it for an instant
+        while (!job) {
+            sched_yield();
+            job = queue_pop(&pool->jobs);
+        }
+
+        // A spawned job may be freed by its own run, so nothing of it is read afterwards
+        op_counters_s* counters = counters_of(pool, job);
+        void (*spawned_run)(void* context) = job->spawned_run;
+        uint64_t submit_time = job->submit_time;
+        atomic_fetch_sub_explicit(&counters->queued, 1, memory_order_relaxed);
+        uint64_t start_time = clock_now();
+        if (spawned_run) {
+            spawned_run(job->context);
+        } else {
+            pool->run(job->context);
+        }
+        uint64_t run_time = clock_now() - start_time;
+
+        atomic_fetch_add_explicit(&counters->completed, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&counters->wait_time, start_time - submit_time,
+                                  memory_order_relaxed);
+        atomic_fetch_add_explicit(&counters->run_time, run_time, memory_order_relaxed);
+        raise_max(&counters->max_run_time, run_time);
+        if (spawned_run) {
+            continue;
+        }
+
+        // Hand the job back, the finished queue has room for every job in flight
+        queue_push(&pool->finished, job);
+        uint64_t signal = 1;
+        while (write(pool->event_fd, &signal, sizeof(signal)) == -1 && errno == EINTR);
+    }
+}
+
+/**
+ * @brief Starts the workers of a pool
+ *
+ * @param pool Pool to initialize
+ * @param worker_count Number of worker threads
+ * @param run Function performing a job on a worker
+ * @return 0 on success, -1 on error
+ */
+int pool_init(worker_pool_s* pool, unsigned int worker_count, void (*run)(void* context)) {
+    memset(pool->counters, 0, sizeof(pool->counters));
+    memset(&pool->helper_counters, 0, sizeof(pool->helper_counters));
+    pool->run = run;
+    pool->worker_count = 0;
+    pool->in_flight = 0;
+    atomic_init(&pool->stopping, 0);
+
+    if (queue_init(&pool->jobs, JOB_QUEUE_SIZE) == -1) {
+        return -1;
+    }
+    if (queue_init(&pool->finished, JOB_QUEUE_SIZE) == -1) {
+        queue_free(&pool->jobs);
+        return -1;
+    }
+    pool->event_fd = eventfd(0, EFD_NONBLOCK);
+    pool->workers = malloc(worker_count * sizeof(*pool->workers));
+    if (pool->event_fd == -1 || !pool->workers || sem_init(&pool->pending, 0, 0) == -1) {
+        if (pool->event_fd != -1)
+            close(pool->event_fd);
+        free(pool->workers);
+        queue_free(&pool->jobs);
+        queue_free(&pool->finished);
+        return -1;
+    }
+
+    for (unsigned int i = 0; i < worker_count; i++) {
+        if (pthread_create(&pool->workers[i], NULL, worker_main, pool) != 0) {
+            pool_destroy(pool);
+            return -1;
+        }
+        pool->worker_count++;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Stops the workers of a pool once the queued jobs are done, and frees the pool
+ *
+ * @param pool Pool to destroy
+ */
+void pool_destroy(worker_pool_s* pool) {
+    atomic_store(&pool->stopping, 1);
+    for (unsigned int i = 0; i < pool->worker_count; i++) {
+        sem_post(&pool->pending);
+    }
+    for (unsigned int i = 0; i < pool->worker_count; i++) {
+        pthread_join(pool->workers[i], NULL);
+    }
+
+    sem_destroy(&pool->pending);
+    close(pool->event_fd);
+    free(pool->workers);
+    queue_free(&pool->jobs);
+    queue_free(&pool->finished);
+}
+
+/**
+ * @brief Pushes a job onto the queue of the workers and wakes one
+ *
+ * @param pool Pool to run the job
+ * @param job Job to run
+ * @return 0 on success, -1 if the queue is full
+ */
+static int enqueue_job(worker_pool_s* pool, pool_job_s* job) {
+    op_counters_s* counters = counters_of(pool, job);
+    uint64_t queued = atomic_fetch_add_explicit(&counters->queued, 1, memory_order_relaxed) + 1;
+    job->submit_time = clock_now();
+    if (queue_push(&pool->jobs, job) == -1) {
+        atomic_fetch_sub_explicit(&counters->queued, 1, memory_order_relaxed);
+        return -1;
+    }
+    raise_max(&counters->max_queued, queued);
+    sem_post(&pool->pending);
+    return 0;
+}
+
+/**
+ * @brief Queues a job for the workers
+ *
+ * @param pool Pool to run the job
+ * @param job Job to run, which must stay valid until returned by pool_finished()
+ * @return 0 on success, -1 if the queue is full (the caller should run the job itself)
+ */
+int pool_submit(worker_pool_s* pool, pool_job_s* job) {
+
+    // Every job in flight must fit in the finished queue
+    if (pool->in_flight == JOB_QUEUE_SIZE) {
+        return -1;
+    }
+
+    job->spawned_run = NULL;
+    if (enqueue_job(pool, job) == -1) {
+        return -1;
+    }
+    pool->in_flight++;
+    return 0;
+}
+
+/**
+ * @brief Queues a job from within a running job, any thread may spawn
+ *
+ * @param pool Pool to run the job
+ * @param job Job to run, which must stay valid until it runs (it isn't handed back)
+ * @param run Function performing the job, in place of the pool's
+ * @return 0 on success, -1 if the queue is full (the caller should do the work itself)
+ */
+int pool_spawn(worker_pool_s* pool, pool_job_s* job, void (*run)(void* context)) {
+    job->spawned_run = run;
+    return enqueue_job(pool, job);
+}
+
+/**
+ * @brief Clears the signal of the event fd, call once it is readable before taking the finished
+ *        jobs (a job finishing later signals again)
+ *
+ * @param pool Pool running the jobs
+ */
+void pool_acknowledge(worker_pool_s* pool) {
+    uint64_t signals;
+    while (read(pool->event_fd, &signals, sizeof(signals)) == -1 && errno == EINTR);
+}
+
+/**
+ * @brief Takes the next finished job
+ *
+ * @param pool Pool running the jobs
+ * @return The finished job, NULL if none are left
+ */
+pool_job_s* pool_finished(worker_pool_s* pool) {
+    pool_job_s* job = queue_pop(&pool->finished);
+    if (job) {
+        pool->in_flight--;
+    }
+    return job;
+}
+
+/**
+ * @brief Prints one line of counters, nothing if they never saw a job
+ *
+ * @param name Name the counters are printed under
+ * @param counters Counters to print
+ * @param stream Stream to print to
+ */
+static void report_counters(const char* name, op_counters_s* counters, FILE* stream) {
+    uint64_t completed = atomic_load(&counters->completed);
+    if (!completed && !atomic_load(&counters->max_queued)) {
+        return;
+    }
+
+    fprintf(stream, "    %-8s completed: %llu, queued: %llu (max %llu), "
+            "wait: %.1f us avg, run: %.1f us avg (max %.1f us)\n",
+            name,
+            (unsigned long long)completed,
+            (unsigned long long)atomic_load(&counters->queued),
+            (unsigned long long)atomic_load(&counters->max_queued),
+            (completed) ? atomic_load(&counters->wait_time) / 1000.0 / completed : 0.0,
+            (completed) ? atomic_load(&counters->run_time) / 1000.0 / completed : 0.0,
+            atomic_load(&counters->max_run_time) / 1000.0);
+}
+
+/**
+ * @brief Prints the counters of every opcode the pool has run, then those of the spawned jobs
+ *
+ * @param pool Pool holding the counters
+ * @param stream Stream to print to
+ */
+void pool_report(worker_pool_s* pool, FILE* stream) {
+    fprintf(stream, "[Server : Info] Worker pool (%u workers)\n", pool->worker_count);
+    for (int opcode = 0; opcode < RP_CALL_COUNT; opcode++) {
+        report_counters(strCallType(opcode), &pool->counters[opcode], stream);
+    }
+    report_counters("helpers", &pool->helper_counters, stream);
+}
@@ -0,0 +1,108 @@
+#ifndef POOL_H
+#define POOL_H
+
+/***************************************************************************************************
+* @project: RPC System Calls
+****************************************************************************************************
+* @file pool.h
+* @brief Contains the worker pool that runs blocking file operations off the event loop.
+*
+* Jobs are handed to the workers through a bounded lock-free queue (any thread may push or pop),
+* and finished jobs come back through a second queue. Each finish is signalled on an eventfd, so
+* the event loop waits for completions with the same epoll_wait() as its sockets.
+*
+* A running job can spawn further jobs to split its work across the workers. Spawned jobs aren't
+* handed back, the job spawning them waits for their work itself. They are counted apart from the
+* opcodes, so an opcode's completions are the calls it handled.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "protocol.h"
+
+/*==================================================================================================
+    Macros
+==================================================================================================*/
+
+#define DEFAULT_WORKER_COUNT 4      // workers started unless set with WORKERS_FLAG
+#define JOB_QUEUE_SIZE 1024         // jobs queued at once (must be a power of two)
+#define CACHE_LINE_SIZE 64
+
+/*==================================================================================================
+    Structures
+==================================================================================================*/
+
+/***************| Lock-Free Queue |***************/
+typedef struct {
+    _Atomic size_t sequence;    // position the cell is ready for
+    void* item;
+} queue_cell_s;
+
+typedef struct {
+    queue_cell_s* cells;
+    size_t mask;
+    _Alignas(CACHE_LINE_SIZE) _Atomic size_t push_position;
+    _Alignas(CACHE_LINE_SIZE) _Atomic size_t pop_position;
+} job_queue_s;
+
+/***************| Jobs |***************/
+typedef struct {
+    uint16_t opcode;            // call performed by the job, for the counters
+    uint64_t submit_time;       // nanoseconds when the job was queued
+    void* context;              // passed to the pool's run function
+    void (*spawned_run)(void* context); // run function of a spawned job, NULL if submitted
+} pool_job_s;
+
+/***************| Counters |***************/
+typedef struct {
+    _Atomic uint64_t queued;        // jobs waiting for a worker
+    _Atomic uint64_t max_queued;
+    _Atomic uint64_t completed;
+    _Atomic uint64_t wait_time;     // total nanoseconds spent queued
+    _Atomic uint64_t run_time;      // total nanoseconds spent running
+    _Atomic uint64_t max_run_time;
+} op_counters_s;
+
+/***************| Pool |***************/
+typedef struct {
+    void (*run)(void* context);     // performs a job on a worker
+    pthread_t* workers;
+    unsigned int worker_count;
+    job_queue_s jobs;               // waiting for a worker
+    job_queue_s finished;           // waiting for the event loop
+    sem_t pending;                  // posted once per queued job
+    int event_fd;                   // readable once jobs have finished
+    size_t in_flight;               // jobs submitted and not yet taken back (event loop only)
+    atomic_int stopping;
+    op_counters_s counters[RP_CALL_COUNT];
+    op_counters_s helper_counters;  // spawned jobs, so an opcode's completions count its calls
+} worker_pool_s;
+
+/*==================================================================================================
+    Function Declarations
+==================================================================================================*/
+
+/* Lock-Free Queue */
+int queue_init(job_queue_s* queue, size_t size);
+void queue_free(job_queue_s* queue);
+int queue_push(job_queue_s* queue, void* item);
+void* queue_pop(job_queue_s* queue);
+
+/* Worker Pool */
+int pool_init(worker_pool_s* pool, unsigned int worker_count, void (*run)(void* context));
+void pool_destroy(worker_pool_s* pool);
+int pool_submit(worker_pool_s* pool, pool_job_s* job);
+int pool_spawn(worker_pool_s* pool, pool_job_s* job, void (*run)(void* context));
+void pool_acknowledge(worker_pool_s* pool);
+pool_job_s* pool_finished(worker_pool_s* pool);
+void pool_report(worker_pool_s* pool, FILE* stream);
+
+#endif // POOL_H
@@ -5,12 +5,26 @@
 * @project: RPC System Calls
 ****************************************************************************************************
 * @file protocols.h
-* @brief Contains protocol code definitions.
+* @brief Contains protocol code definitions and the layout of request/response frames.
+*
+* Every call is sent as a single frame: a fixed header followed by the packed arguments of the
+* call (and any data it carries). The server answers with a frame holding the same opcode and
+* request id, followed by the result and errno of the call (and any data read). All integers are
+* sent in network byte order.
+*
+* A client may send several requests before reading any reply. The server can handle them at once,
+* so their replies arrive in the order the calls finish, and the request id pairs each reply with
+* its request.
+*
+* The *64_CALL variants take 64-bit offsets and counts and answer with a 64-bit result, so files
+* past 4GB can be addressed. The bulk data of STREAM64_CALL and RECEIVE64_CALL follows the frame
+* instead of being counted in its payload length, so a single call can move more than 4GB.
 *
 * @author Tyler Neal
 * @date 2/26/2025
 *******************************************************************************/
 
+#include <stdint.h>
 #include <stdlib.h>
 
 /*==================================================================================================
@@ -23,5 +37,178 @@
 #define WRITE_CALL 4
 #define LSEEK_CALL 5
 #define CHECKSUM_CALL 6
+#define PREAD_CALL 7
+#define PWRITE_CALL 8
+#define STREAM_CALL 9
+#define RECEIVE_CALL 10
+#define DIGEST_CALL 11
+#define DELTA_CALL 12
+#define LSEEK64_CALL 13
+#define PREAD64_CALL 14
+#define PWRITE64_CALL 15
+#define STREAM64_CALL 16
+#define RECEIVE64_CALL 17
+#define STATS_CALL 18
+#define RP_CALL_COUNT 19 // one past the largest opcode
+
+#define RP_HEADER_SIZE sizeof(rp_header_s)
+#define RP_MAX_PAYLOAD (64u * 1024 * 1024) // largest payload accepted in a frame
+#define DELTA_LITERAL UINT32_MAX // block of a delta operation carrying literal bytes
+
+/*==================================================================================================
+    Frame Layout
+==================================================================================================*/
+
+/***************| Header |***************/
+typedef struct __attribute__((packed)) {
+    uint16_t opcode;            // *_CALL of the request being made or answered
+    uint16_t reserved;
+    uint32_t request_id;        // chosen by the client, echoed by the server
+    uint32_t payload_length;    // bytes following the header
+} rp_header_s;
+
+/***************| Request Arguments |***************/
+typedef struct __attribute__((packed)) {
+    uint32_t flags;
+    uint32_t mode;              // only used with O_CREAT
+} rp_open_args_s;               // followed by the NUL terminated pathname
+
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+} rp_close_args_s;
+
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+    uint32_t count;
+} rp_read_args_s;               // the data read is returned after the reply
+
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+    uint32_t count;
+} rp_write_args_s;              // followed by the data to write (count bytes)
+
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+    int32_t offset;
+    uint32_t whence;
+} rp_lseek_args_s;
+
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+    uint32_t block_size;
+} rp_checksum_args_s;
+
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+    uint32_t count;
+    uint32_t offset;            // file position to read from
+} rp_pread_args_s;              // the data read is returned after the reply
+
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+    uint32_t count;
+    uint32_t offset;            // file position to write at
+} rp_pwrite_args_s;             // followed by the data to write (count bytes)
+
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+    uint32_t count;
+    uint32_t offset;            // file position to stream from
+} rp_stream_args_s;             // the bytes streamed (up to count, to the end of the file) are
+                                // sent after the reply, straight from the file
+
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+    uint32_t count;
+    uint32_t offset;            // file position to write at
+} rp_receive_args_s;            // followed by the data to write (count bytes), which is moved
+                                // straight into the file (exempt from RP_MAX_PAYLOAD)
+
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+    uint32_t chunk_size;        // bytes per chunk digest (a default size if 0, at least
+                                // DIGEST_MIN_CHUNK_SIZE otherwise)
+    uint32_t max_digests;       // most chunk digests returned (the file digest covers every chunk)
+} rp_digest_args_s;             // the number of chunks is returned, followed by the 64-bit digest
+                                // of the file and then those of its first chunks
+
+typedef struct __attribute__((packed)) {
+    uint32_t weak;              // rolling checksum of the block
+    uint64_t strong;            // XXH64 digest of the block
+} rp_block_signature_s;
+
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+    uint32_t block_size;
+    uint32_t block_count;
+    uint64_t offset;            // file position of the range to compare
+    uint32_t length;            // bytes in the range
+} rp_delta_args_s;              // followed by the signatures of the client's blocks, the number of
+                                // bytes of the file the delta covers is returned, followed by the
+                                // delta operations (an operation matching the client's block may
+                                // run past the end of the range)
+
+typedef struct __attribute__((packed)) {
+    uint32_t block;             // first of the client's blocks to copy, or DELTA_LITERAL
+    uint32_t count;             // number of blocks to copy, or literal bytes that follow
+} rp_delta_op_s;
+
+/***************| 64-bit Request Arguments |***************/
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+    int64_t offset;
+    uint32_t whence;
+} rp_lseek64_args_s;
+
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+    uint64_t count;
+    uint64_t offset;            // file position to read from
+} rp_pread64_args_s;            // the data read is returned after the reply
+
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+    uint64_t count;
+    uint64_t offset;            // file position to write at
+} rp_pwrite64_args_s;           // followed by the data to write (count bytes)
+
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+    uint64_t count;
+    uint64_t offset;            // file position to stream from
+} rp_stream64_args_s;           // the bytes streamed (the result) are sent after the reply frame
+
+typedef struct __attribute__((packed)) {
+    uint32_t file_fd;
+    uint64_t count;
+    uint64_t offset;            // file position to write at
+} rp_receive64_args_s;          // the data to write (count bytes) is sent after the frame
+
+/***************| Server Statistics |***************/
+typedef struct __attribute__((packed)) {
+    uint32_t opcode;            // call the statistics are kept for
+    uint64_t count;             // calls answered
+    uint64_t errors;            // calls answered with -1
+    uint64_t bytes_in;          // frame bytes received, and the data moved by RECEIVE64_CALL
+    uint64_t bytes_out;         // frame bytes sent, and the data moved by STREAM64_CALL
+    uint64_t p50;               // latency percentiles in nanoseconds, from the frame being read
+    uint64_t p90;               // to the reply being framed
+    uint64_t p99;
+    uint64_t max;
+} rp_call_stats_s;              // STATS_CALL takes no arguments, the number of call types answered
+                                // so far is returned, followed by their statistics
+
+/***************| Response |***************/
+typedef struct __attribute__((packed)) {
+    int32_t result;             // return value of the call
+    int32_t error;              // errno of the call when result is -1
+} rp_reply_s;                   // followed by the data read (or streamed) for READ_CALL,
+                                // PREAD_CALL and STREAM_CALL
+
+typedef struct __attribute__((packed)) {
+    int64_t result;             // return value of the call
+    int32_t error;              // errno of the call when result is -1
+} rp_reply64_s;                 // answers the *64_CALL variants, followed by the data read for
+                                // PREAD64_CALL
 
-#endif // PROTOCOLS_H
\ No newline at end of file
+#endif // PROTOCOLS_H
@@ -1,4 +1,3 @@
-
 /***************************************************************************************************
 * @project: RPC System Calls
 ****************************************************************************************************
@@ -9,15 +8,28 @@
 * the results back to them. The server performs the following operations:
 *   1. Sets up a socket listening on the specified port
 *   2. Accepts client connections
-*   3. Forks to handle each client in a separate process
-*   4. Processes remote procedure calls from the client
+*   3. Serves every client from a single epoll event loop (or forks to handle each client in a
+*      separate process with FORK_MODE_FLAG)
+*   4. Processes remote procedure calls from the client, one frame per call
 *   5. Executes system calls on behalf of the client
 *   6. Returns the results of the system call to the client
 *
+* In the event loop every socket is non-blocking, and each connection keeps the state of the frame
+* being read and the replies being sent, so a partial read or write simply waits for the next event.
+* Up to MAX_PIPELINE requests of a connection are handled at once (each with its own buffers), and
+* their replies are sent in the order they finish. A connection stops reading requests while a
+* reply can't be sent in full.
+*
+* Bulk transfers skip user space: a stream call sends its file range after the reply with
+* sendfile(), and the data of a receive call is spliced from the socket into the file through a
+* pipe as it arrives (the event loop moves it, since it is part of the connection's byte stream).
+*
 * @author Tyler Neal
 * @date 2/26/2025
 ***************************************************************************************************/
 
+#define _GNU_SOURCE // accept4(), pipe2(), splice()
+
 #include <errno.h>
 #include <fcntl.h>
 #include <signal.h>
@@ -28,15 +40,26 @@
 
 
 #include <arpa/inet.h>
+#include <endian.h>
 #include <netinet/in.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
 
 #include "error.h"
+#include "logger.h"
 #include "protocol.h"
 #include "server.h"
+#include "stats.h"
 #include "util.h"
 
 static int socket_fd;
+static worker_pool_s pool;      // runs file calls for the event loop
+static int pool_started = 0;
+static int interrupt_fds[2] = { -1, -1 }; // carries interrupts from the handler to the server
+static connection_s* closed_connections = NULL; // freed once the current events are handled
 
 /*==================================================================================================
     Main
@@ -46,64 +69,240 @@ static int socket_fd;
  * @brief Main entry point for the server application
  *
  * @param argc Number of command-line arguments
- * @param argv Command-line arguments (expects port number)
+ * @param argv Command-line arguments (expects port number, then optional flags)
  * @return 0 on successful execution, -1 on error
  */
 int main(int argc, char** argv) {
 
     // Verify argument count
-    if (argc != 2) {
-        fprintf(stderr, "Usage: <port>\n");
+    if (argc < 2) {
+        fprintf(stderr, USAGE);
         return -1;
     }
 
     // Retrieve arguments
     int port = atoi(argv[1]);
+    int fork_mode = 0;
+    int backlog = BACKLOG_SIZE;
+    int log_level = LOG_LEVEL_INFO;
+    unsigned int worker_count = DEFAULT_WORKER_COUNT;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], FORK_MODE_FLAG) == 0) {
+            fork_mode = 1;
+        } else if (strcmp(argv[i], BACKLOG_FLAG) == 0 && i + 1 < argc) {
+            backlog = atoi(argv[++i]);
+        } else if (strcmp(argv[i], WORKERS_FLAG) == 0 && i + 1 < argc) {
+            worker_count = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], LOG_LEVEL_FLAG) == 0 && i + 1 < argc &&
+                   (log_level = logger_level_of(argv[++i])) != -1) {
+            continue;
+        } else {
+            fprintf(stderr, USAGE);
+            return -1;
+        }
+    }
     struct sockaddr_in address;
 
-    // Create a handler for interrupts
-    if (signal(SIGINT, interrupt_handler) == SIG_ERR) {
-        perror("[Server : Error] Failed to register signal handler");
+    // Messages are written by the logger's thread (or in place if it can't start)
+    logger_start((log_level_e)log_level);
+
+    // Statistics are shared with the children of the fork mode
+    if (stats_init() == -1) {
+        log_message(LOG_LEVEL_WARNING, "[Server : Warning] Call statistics unavailable: %s\n",
+                    strerror(errno));
+    }
+
+    // Create a handler for interrupts (the server reports and exits once it reads the pipe)
+    if (pipe2(interrupt_fds, O_NONBLOCK | O_CLOEXEC) == -1 ||
+        signal(SIGINT, interrupt_handler) == SIG_ERR) {
+        log_message(LOG_LEVEL_ERROR, "[Server : Error] Failed to register signal handler: %s\n",
+                    strerror(errno));
+        return -1;
+    }
+
+    // A client closing early must fail the write, not kill the server
+    if (signal(SIGPIPE, SIG_IGN) == SIG_ERR) {
+        log_message(LOG_LEVEL_ERROR, "[Server : Error] Failed to ignore SIGPIPE: %s\n",
+                    strerror(errno));
         return -1;
     }
 
     // Setup the server socket
-    if (setupServer(&socket_fd, &address, port) == -1) {
-        perror("[Server : Error] Failed during setupServer()");
+    if (setupServer(&socket_fd, &address, port, backlog) == -1) {
+        log_message(LOG_LEVEL_ERROR, "[Server : Error] Failed during setupServer(): %s\n",
+                    strerror(errno));
+        return -1;
+    }
+
+    return (fork_mode) ? serve_forked(&address) : serve_events(worker_count);
+}
+
+/*==================================================================================================
+    Server Setup/Hanlding
+==================================================================================================*/
+
+/**
+ * @brief Signal handler for handling interrupt signals
+ *
+ * Only passes the signal on through the interrupt pipe, the server reports and exits once it
+ * reads it (see exit_interrupted()).
+ *
+ * @param sig_number Signal number that triggered the handler
+ */
+void interrupt_handler(int sig_number) {
+    int saved_errno = errno;
+    unsigned char signal_byte = (unsigned char)sig_number;
+    while (write(interrupt_fds[1], &signal_byte, sizeof(signal_byte)) == -1 && errno == EINTR);
+    errno = saved_errno;
+}
+
+/**
+ * @brief Signal handler for handling interrupt signals in the children of the fork mode
+ *
+ * The parent reports the statistics the children share with it, so a child only writes out its
+ * pending log messages.
+ *
+ * @param sig_number Signal number that triggered the handler
+ */
+void child_interrupt_handler(int sig_number) {
+    (void)sig_number;
+    logger_flush();
+    _exit(1);
+}
+
+/**
+ * @brief Reports the worker pool and call statistics, then exits, once an interrupt was read
+ */
+void exit_interrupted(void) {
+    unsigned char signal_byte = 0;
+    while (read(interrupt_fds[0], &signal_byte, sizeof(signal_byte)) == -1 && errno == EINTR);
+
+    logger_flush();
+    fprintf(stderr, "Recieved a SIGNAL INTERRUPT: %d, "
+            "exiting...\n", signal_byte);
+    if (pool_started) {
+        pool_report(&pool, stderr);
+    }
+    stats_report(stderr);
+    close(socket_fd);
+    exit(1);
+}
+
+/**
+ * @brief Sets up the server socket for listening
+ *
+ * @param socket_fd Pointer to store the created socket file descriptor
+ * @param address Pointer to store socket address information
+ * @param port Port number to listen on
+ * @param backlog Number of pending connections the socket queues
+ * @return 0 on success, -1 on error with errno set
+ */
+int setupServer(int* socket_fd, struct sockaddr_in* address, int port, int backlog) {
+
+    log_message(LOG_LEVEL_INFO, "[Server : Info] Starting RPC server on port %d\n", port);
+
+    // Get socket file descriptor
+    *socket_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (*socket_fd  < 0) {
+        return -1;
+    }
+
+    // Populate address struct
+    address->sin_family = AF_INET;
+    address->sin_addr.s_addr = INADDR_ANY;
+    address->sin_port = htons(port);
+
+    // Attempt to bind socket
+    if (bind(*socket_fd,
+       (struct sockaddr *)address,
+        sizeof(*address)) < 0)
+    {
+        log_message(LOG_LEVEL_ERROR, "[Server : Error] Socket bind failed: %s\n", strerror(errno));
+        close(*socket_fd);  // clean up socket
+        return -1;
+    }
+
+    // Attempt to listen to socket
+    if (listen(*socket_fd, backlog) < 0) {
+        log_message(LOG_LEVEL_ERROR, "[Server : Error] Socket listen failed: %s\n",
+                    strerror(errno));
+        close(*socket_fd);  // clean up socket
+        return -1;
+    }
+
+    log_message(LOG_LEVEL_INFO, "[Server : Info] "
+                "Server initialized and listening on port %d (backlog: %d)\n",
+                port, backlog);
+
+    return RP_SUCCESS;
+}
+
+/*==================================================================================================
+    Fork Mode
+==================================================================================================*/
+
+/**
+ * @brief Accepts connections forever, forking a child process to serve each client
+ *
+ * @param address Socket address information of the server
+ * @return int -1 on error (the parent otherwise runs until signal interrupt)
+ */
+int serve_forked(struct sockaddr_in* address) {
+
+    // Finished children are reaped automatically
+    if (signal(SIGCHLD, SIG_IGN) == SIG_ERR) {
+        log_message(LOG_LEVEL_ERROR, "[Server : Error] Failed to ignore SIGCHLD: %s\n",
+                    strerror(errno));
         return -1;
     }
 
     // Create container for accepts() address length field
-    int address_length = sizeof(address);
+    int address_length = sizeof(*address);
 
-    // Continuously accept connections
+    // Continuously accept connections, until interrupted
+    struct pollfd waiting[2] = {
+        { .fd = socket_fd, .events = POLLIN },
+        { .fd = interrupt_fds[0], .events = POLLIN },
+    };
     while (1) {
-        int connection_fd = accept(socket_fd, 
-                             (struct sockaddr*)&address, 
+        if (poll(waiting, 2, -1) == -1) {
+            if (errno == EINTR)
+                continue;
+            log_message(LOG_LEVEL_ERROR, "[Server : Error] Failed while waiting for connections: "
+                        "%s\n", strerror(errno));
+            break;
+        }
+        if (waiting[1].revents & POLLIN) {
+            exit_interrupted();
+        }
+
+        int connection_fd = accept(socket_fd,
+                             (struct sockaddr*)address,
                          (socklen_t*)&address_length);
         if (connection_fd == -1) {
-            perror("[Server : Error] Error while accepting connection");
+            log_message(LOG_LEVEL_ERROR, "[Server : Error] Error while accepting connection: %s\n",
+                        strerror(errno));
             continue;
         }
-        printf("[Server : Info] "
-               "New client connection accepted (fd: %d)\n", 
-               connection_fd);
+        log_message(LOG_LEVEL_INFO, "[Server : Info] New client connection accepted (fd: %d)\n",
+                    connection_fd);
 
         // Fork into child to handle request
         pid_t pid = fork();
 
         // Catch error
         if (pid == -1) {
-            perror("[Server : Error] Error while forking");
+            log_message(LOG_LEVEL_ERROR, "[Server : Error] Error while forking: %s\n",
+                        strerror(errno));
             close(connection_fd);
             break;
         }
 
         // Parent closes connection and goes back to accepting
         if (pid > 0) {
-            printf("[Server : Info] "
-                   "Forked child process (pid: %d) to handle client request\n", 
-                   pid);
+            log_message(LOG_LEVEL_INFO, "[Server : Info] "
+                        "Forked child process (pid: %d) to handle client request\n",
+                        pid);
             close(connection_fd);
             continue;
         }
@@ -111,66 +310,64 @@ int main(int argc, char** argv) {
 
         /* CHILD CODE FOLLOWS */
         close(socket_fd);
+        logger_restart();
+        signal(SIGINT, child_interrupt_handler);
+        close(interrupt_fds[0]);
+        close(interrupt_fds[1]);
 
         // Define call for error printing
         int status = RP_SUCCESS; // holds status of child
-        char* call_str;
+        char* call_str = "NONE";
+
+        // Buffers for the frames read from the client, and the one request handled at a time
+        connection_s connection;
+        if (init_connection(&connection, connection_fd) == -1) {
+            log_message(LOG_LEVEL_ERROR, "[Server Child : Error] "
+                        "Failed to allocate frame buffer: %s\n", strerror(errno));
+            close(connection_fd);
+            return -1;
+        }
+        request_s* request = get_request(&connection);
+        if (!request) {
+            log_message(LOG_LEVEL_ERROR, "[Server Child : Error] Failed to allocate request: %s\n",
+                        strerror(errno));
+            close(connection_fd);
+            return -1;
+        }
 
         // Handle requests from client
         while(1) {
-            
-            // Retreive call type
-            int call_type;
-            int* call_type_ptr = read_from_connection(connection_fd);
-            if (call_type_ptr) {
-                call_type = ntohl(*call_type_ptr);
-                call_str = strCallType(call_type);
-            } else {
+
+            // Retreive the next request frame
+            uint8_t* payload;
+            if (read_request_frame(&connection, &request->header, &payload) == -1) {
                 if (errno == CONNECTION_CLOSED) {
-                    fprintf(stderr, "[Server : Warning] "
-                            "Client closed connection\n");
+                    log_message(LOG_LEVEL_WARNING, "[Server : Warning] Client closed connection\n");
                 } else {
-                    fprintf(stderr, "[Server : Error] "
-                            "Failed to read call_type from client\n");
+                    log_message(LOG_LEVEL_ERROR, "[Server : Error] "
+                                "Failed to read call_type from client\n");
                     errno = SERVER_CALL_TYPE_READ_ERROR;
                     status = -1;
                 }
                 break;
             }
-
-            printf("[Server Child : Info] Processing request: %s\n", 
-                   call_str);
-
-            // Handle call
-            switch(call_type) {
-                
-                case OPEN_CALL:
-                    status = handle_open(connection_fd);
-                    break;
-
-                case CLOSE_CALL:
-                    status = handle_close(connection_fd);
-                    break;
-
-                case READ_CALL:
-                    status = handle_read(connection_fd);
-                    break;
-
-                case WRITE_CALL:
-                    status = handle_write(connection_fd);
-                    break;
-
-                case LSEEK_CALL:
-                    status = handle_lseek(connection_fd);
-                    break;
-
-                case CHECKSUM_CALL:
-                    status = handle_checksum(connection_fd);
-                    break;
-                
-                default:
-                    errno = SERVER_INVALID_CALL_TYPE;
-                    break;
+            request->payload = payload;
+            request->start_time = clock_now();
+            call_str = strCallType(request->header.opcode);
+
+            // Handle call (the socket blocks, so every reply is sent in full)
+            if (request->header.opcode == RECEIVE_CALL ||
+                request->header.opcode == RECEIVE64_CALL) {
+                status = start_receive(&connection, request);
+                if (status != -1) {
+                    status = receive_data(&connection);
+                }
+            } else {
+                status = dispatch_frame(request, &request->header, request->payload);
+            }
+            if (status != -1 && send_reply(request) == -1) {
+                errno = SERVER_ERROR_SENDING_RPC_RESULT;
+                status = -1;
             }
 
             // Terminate if error status or closed connection
@@ -178,266 +375,670 @@ int main(int argc, char** argv) {
                 break;
             }
         }
+        release_request(request);
+        free_connection(&connection);
 
         // Server child exit
-        close(socket_fd);
         close(connection_fd);
-        fprintf(stderr, "[Server Child : Info] "
-                "terminating with status code {%s: errno[%d]}\n", 
-                call_str, errno);
-        return status;
+        log_message(LOG_LEVEL_INFO, "[Server Child : Info] "
+                    "terminating with status code {%s: errno[%d]}\n",
+                    call_str, errno);
+        logger_stop();
+        exit((status == -1) ? 1 : 0);
     }
 
-    // Server parent exit
-    return 0; // (this is dead code as parent runs until signal interrupt)
+    return -1;
 }
 
 /*==================================================================================================
-    Server Setup/Hanlding
+    Event Loop Mode
 ==================================================================================================*/
 
 /**
- * @brief Signal handler for handling interrupt signals
- * 
- * @param sig_number Signal number that triggered the handler
- */
-void interrupt_handler(int sig_number) {
-    fprintf(stderr, "Recieved a SIGNAL INTERRUPT: %d, "
-            "exiting...\n", sig_number);
-    close(socket_fd);
-    exit(1);
-}
-
-/**
- * @brief Sets up the server socket for listening
- * 
- * @param socket_fd Pointer to store the created socket file descriptor
- * @param address Pointer to store socket address information
- * @param port Port number to listen on
- * @return 0 on success, -1 on error with errno set
+ * @brief Serves every client from a single epoll event loop
+ *
+ * @param worker_count Number of workers running file calls (0 runs them in the event loop)
+ * @return int -1 on error (otherwise runs until signal interrupt)
  */
-int setupServer(int* socket_fd, struct sockaddr_in* address, int port) {
-
-    printf("[Server : Info] Starting RPC server on port %d\n", port);
-
-    // Get socket file descriptor
-    *socket_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (*socket_fd  < 0) {
+int serve_events(unsigned int worker_count) {
+
+    // Accept connections without blocking
+    int flags = fcntl(socket_fd, F_GETFL, 0);
+    if (flags == -1 || fcntl(socket_fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        log_message(LOG_LEVEL_ERROR, "[Server : Error] "
+                    "Failed to make the socket non-blocking: %s\n",
+                    strerror(errno));
         return -1;
     }
 
-    // Populate address struct
-    address->sin_family = AF_INET;
-    address->sin_addr.s_addr = INADDR_ANY;
-    address->sin_port = htons(port);
+    int epoll_fd = epoll_create1(0);
+    if (epoll_fd == -1) {
+        log_message(LOG_LEVEL_ERROR, "[Server : Error] Failed to create epoll instance: %s\n",
+                    strerror(errno));
+        return -1;
+    }
 
-    // Attempt to bind socket
-    if (bind(*socket_fd, 
-       (struct sockaddr *)address, 
-        sizeof(*address)) < 0) 
-    {
-        perror("[Server : Error] Socket bind failed");
-        close(*socket_fd);  // clean up socket
+    // The listening socket is the only event without a connection
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, socket_fd, &event) == -1) {
+        log_message(LOG_LEVEL_ERROR, "[Server : Error] Failed to watch the server socket: %s\n",
+                    strerror(errno));
+        close(epoll_fd);
         return -1;
     }
 
-    // Attempt to listen to socket
-    if (listen(*socket_fd, BACKLOG_SIZE) < 0) {
-        perror("[Server : Error] Socket listen failed");
-        close(*socket_fd);  // clean up socket
+    // Finished jobs of the workers are signalled through the pool's event fd
+    if (worker_count > 0) {
+        if (pool_init(&pool, worker_count, run_job) == -1) {
+            log_message(LOG_LEVEL_ERROR, "[Server : Error] Failed to start worker pool: %s\n",
+                        strerror(errno));
+            close(epoll_fd);
+            return -1;
+        }
+        pool_started = 1;
+
+        event.events = EPOLLIN;
+        event.data.ptr = &pool;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pool.event_fd, &event) == -1) {
+            log_message(LOG_LEVEL_ERROR, "[Server : Error] Failed to watch the worker pool: %s\n",
+                        strerror(errno));
+            close(epoll_fd);
+            return -1;
+        }
+    }
+    // Interrupts are read from their pipe like any other event
+    event.events = EPOLLIN;
+    event.data.ptr = interrupt_fds;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, interrupt_fds[0], &event) == -1) {
+        log_message(LOG_LEVEL_ERROR, "[Server : Error] Failed to watch for interrupts: %s\n",
+                    strerror(errno));
+        close(epoll_fd);
         return -1;
     }
+    log_message(LOG_LEVEL_INFO, "[Server : Info] Serving clients from an event loop (%u workers)\n",
+                worker_count);
 
-    printf("[Server : Info] Server initialized and listening on port %d\n", port);
+    struct epoll_event events[MAX_EVENTS];
+    while (1) {
+        int event_count = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (event_count == -1) {
+            if (errno == EINTR)
+                continue;
+            log_message(LOG_LEVEL_ERROR, "[Server : Error] Failed while waiting for events: %s\n",
+                        strerror(errno));
+            break;
+        }
 
-    return RP_SUCCESS;
-}
+        for (int i = 0; i < event_count; i++) {
 
-/*==================================================================================================
-    RPC Handlers
-==================================================================================================*/
+            // New connections are waiting
+            if (!events[i].data.ptr) {
+                accept_connections(epoll_fd);
+                continue;
+            }
 
-/**
- * @brief Handles an open system call from the client
- * 
- * @param client_fd Client connection file descriptor
- * @return RP_SUCCESS on success, -1 on error with errno set
- */
-int handle_open(int client_fd) {
-    // Set errno for early exit
-    errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+            // Interrupted, report and exit
+            if (events[i].data.ptr == interrupt_fds) {
+                exit_interrupted();
+            }
 
-    // Get file descriptor
-    char* pathname = (char*)read_from_connection(client_fd);
-    if (!pathname) 
-        return -1;
-    
-    // Get flags
-    uint32_t flags;
-    if (read_data_of_type(&flags, UINT32, client_fd) == -1) {
-        free(pathname);
-        return -1;
-    }
+            // Workers finished jobs, pick their requests back up
+            if (events[i].data.ptr == &pool) {
+                pool_acknowledge(&pool);
+                pool_job_s* job;
+                while ((job = pool_finished(&pool))) {
+                    request_s* request = job->context;
+                    if (job_finished(epoll_fd, request) == -1) {
+                        close_connection(epoll_fd, request->connection);
+                    }
+                }
+                continue;
+            }
 
-    // Get mode if necessary
-    uint32_t mode;
-    if (flags & O_CREAT) {
-        if (read_data_of_type(&mode, UINT32, client_fd) == -1) {
-            free(pathname);
-            return -1;
+            // Progress the connection, closing it once finished (it may have closed earlier on)
+            connection_s* connection = events[i].data.ptr;
+            if (connection->closed) {
+                continue;
+            }
+            if ((events[i].events & EPOLLERR) ||
+                progress_connection(epoll_fd, connection) == -1) {
+                close_connection(epoll_fd, connection);
+            }
         }
+
+        // No event left refers to the connections closed meanwhile
+        free_closed_connections();
     }
 
-    // Perform call and return results
-    errno = 0;
-    int32_t result = (flags & O_CREAT) ?
-        (int32_t) open(pathname, (int)flags, (mode_t)mode) :
-        (int32_t) open(pathname, (int)flags);
-    if (return_result(client_fd, &result, INT32) == -1) 
-        return -1;
-    
-    free(pathname);
-    return RP_SUCCESS;
+    close(epoll_fd);
+    return -1;
 }
 
 /**
- * @brief Handles a close system call from the client
- * 
- * @param client_fd Client connection file descriptor
- * @return RP_SUCCESS on success, -1 on error with errno set
+ * @brief Accepts every pending connection and watches it for requests
+ *
+ * @param epoll_fd Epoll instance of the event loop
  */
-int handle_close(int client_fd) {
-    // Set errno for early exit
-    errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+void accept_connections(int epoll_fd) {
+    while (1) {
+        int connection_fd = accept4(socket_fd, NULL, NULL, SOCK_NONBLOCK);
+        if (connection_fd == -1) {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                log_message(LOG_LEVEL_ERROR, "[Server : Error] "
+                            "Error while accepting connection: %s\n",
+                            strerror(errno));
+            return;
+        }
 
-    // Get file descriptor
-    uint32_t file_fd;
-    if (read_data_of_type(&file_fd, UINT32, client_fd) == -1) 
-        return -1;
-    
-    // Perform call and return results
-    errno = 0;
-    int32_t result = (int32_t)close(file_fd);
-    if (return_result(client_fd, &result, INT32) == -1) 
-        return -1;
-    
-    return RP_SUCCESS;
+        // Each connection remembers its own frames and replies
+        connection_s* connection = malloc(sizeof(*connection));
+        if (!connection || init_connection(connection, connection_fd) == -1) {
+            log_message(LOG_LEVEL_ERROR, "[Server : Error] Failed to allocate connection: %s\n",
+                        strerror(errno));
+            free(connection);
+            close(connection_fd);
+            continue;
+        }
+
+        struct epoll_event event;
+        event.events = EPOLLIN | EPOLLONESHOT;
+        event.data.ptr = connection;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, connection_fd, &event) == -1) {
+            log_message(LOG_LEVEL_ERROR, "[Server : Error] Failed to watch connection: %s\n",
+                        strerror(errno));
+            free_connection(connection);
+            free(connection);
+            close(connection_fd);
+            continue;
+        }
+
+        log_message(LOG_LEVEL_INFO, "[Server : Info] New client connection accepted (fd: %d)\n",
+                    connection_fd);
+    }
 }
 
 /**
- * @brief Handles a read system call from the client
- * 
- * @param client_fd Client connection file descriptor
- * @return RP_SUCCESS on success, -1 on error with errno set
+ * @brief Progresses a connection: sends its finished replies, then handles every request frame it
+ *        has sent until its socket runs dry, a reply can't be sent in full or MAX_PIPELINE of its
+ *        requests are with the workers
+ *
+ * @param epoll_fd Epoll instance of the event loop
+ * @param connection Connection to progress
+ * @return int 0 to keep the connection open : -1 to close it
+ * @note Connections are watched with EPOLLONESHOT, so this re-arms the connection for the event it
+ *       waits for next (none while its pipeline is full)
  */
-int handle_read(int client_fd) {
-    // Set errno for early exit
-    errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+int progress_connection(int epoll_fd, connection_s* connection) {
+    while (1) {
 
-    // Get file descriptor
-    uint32_t file_fd;
-    if (read_data_of_type(&file_fd, UINT32, client_fd) == -1) 
-        return -1;
+        // Send the finished replies before reading anything else
+        int status = send_replies(connection);
+        if (status == -1) {
+            return -1;
+        }
+        if (status == 1) {
+            return watch_connection(epoll_fd, connection, EPOLLOUT);
+        }
 
-    // Get buffer
-    char* buffer = (char*)read_from_connection(client_fd);
-    if (!buffer) 
-        return -1;
+        // Finish receiving the data of a receive call, which stands before the next frame
+        if (connection->receiving) {
+            request_s* request = connection->receiving;
+            status = receive_data(connection);
+            if (status == 1) {
+                return watch_connection(epoll_fd, connection, EPOLLIN);
+            }
+            if (status == -1) {
+                log_message(LOG_LEVEL_ERROR, "[Server : Error] "
+                            "Failed receiving %s data {errno[%d]}\n",
+                            strCallType(request->header.opcode), errno);
+                release_request(request);
+                return -1;
+            }
+            queue_reply(request);
+            continue;
+        }
 
-    // Get count
-    uint32_t count;
-    if (read_data_of_type(&count, UINT32, client_fd) == -1) {
-        free(buffer);    
-        return -1;
-    }
+        // Wait for the workers to finish a request
+        if (connection->in_flight == MAX_PIPELINE) {
+            return 0;
+        }
 
-    // Perform call and return results
-    errno = 0;
-    int32_t data_read = (int32_t)read(file_fd, buffer, count);
-    if (return_result(client_fd, &data_read, INT32) == -1) 
-        return -1;
-    
-    // Send back data if data was actually read
-    if (data_read > 0) {
-        if (send_to_connection(client_fd, buffer, data_read) == -1) {
-            errno = SERVER_ERROR_SENDING_RPC_ERRNO;
+        // Handle the next request, frames already buffered need no event
+        rp_header_s header;
+        uint8_t* payload;
+        if (read_request_frame(connection, &header, &payload) == -1) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return watch_connection(epoll_fd, connection, EPOLLIN);
+            }
+            if (errno == CONNECTION_CLOSED) {
+                log_message(LOG_LEVEL_WARNING, "[Server : Warning] Client closed connection\n");
+            } else {
+                log_message(LOG_LEVEL_ERROR, "[Server : Error] "
+                            "Failed to read call_type from client\n");
+            }
+            return -1;
+        }
+
+        request_s* request = get_request(connection);
+        if (!request) {
+            log_message(LOG_LEVEL_ERROR, "[Server : Error] Failed to allocate request: %s\n",
+                        strerror(errno));
+            return -1;
+        }
+        request->header = header;
+        request->payload = payload;
+        request->start_time = clock_now();
+
+        // The data of a receive call is moved into the file as it arrives
+        if (header.opcode == RECEIVE_CALL || header.opcode == RECEIVE64_CALL) {
+            if (start_receive(connection, request) == -1) {
+                log_message(LOG_LEVEL_ERROR, "[Server : Error] "
+                            "Failed handling %s request {errno[%d]}\n",
+                            strCallType(header.opcode), errno);
+                release_request(request);
+                return -1;
+            }
+            continue;
+        }
+
+        // Blocking file calls go to the workers, and the next request is read straight away
+        if (pool_started && submit_request(connection, request) == 0) {
+            continue;
+        }
+
+        // Otherwise (or when the queue is full) handle the call in place
+        if (dispatch_frame(request, &request->header, request->payload) == -1) {
+            log_message(LOG_LEVEL_ERROR, "[Server : Error] "
+                        "Failed handling %s request {errno[%d]}\n",
+                        strCallType(header.opcode), errno);
+            release_request(request);
             return -1;
         }
+        queue_reply(request);
     }
-    
-    free(buffer);
-    return RP_SUCCESS;
 }
 
 /**
- * @brief Handles a write system call from the client
- * 
- * @param client_fd Client connection file descriptor
- * @return RP_SUCCESS on success, -1 on error with errno set
+ * @brief Hands a request to the worker pool
+ *
+ * @param connection Connection the request was read from
+ * @param request Request to hand off
+ * @return int 0 on success : -1 if the request must be handled in place
  */
-int handle_write(int client_fd) {
-    // Set errno for early exit
-    errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
-
-    // Get file descriptor
-    uint32_t file_fd;
-    if (read_data_of_type(&file_fd, UINT32, client_fd) == -1) 
-        return -1;
-    
-
-    // Get buffer
-    char* buffer = (char*)read_from_connection(client_fd);
-    if (!buffer) 
-        return -1;
-    
+int submit_request(connection_s* connection, request_s* request) {
 
-    // Get count
-    uint32_t count;
-    if (read_data_of_type(&count, UINT32, client_fd) == -1) {
-        free(buffer);    
-        return -1;
+    // The frame reader moves on to the next frame, so the job keeps its own arguments
+    size_t length = request->header.payload_length;
+    if (length > request->payload_capacity) {
+        uint8_t* copy = realloc(request->payload_copy, length);
+        if (!copy) {
+            return -1;
+        }
+        request->payload_copy = copy;
+        request->payload_capacity = length;
     }
+    memcpy(request->payload_copy, request->payload, length);
 
-    // Perform call and return results
-    errno = 0;
-    int32_t data_wrote = (int32_t)write(file_fd, buffer, count);
-    if (return_result(client_fd, &data_wrote, INT32) == -1) 
+    // A worker may take the job straight away, so it must only see the copy
+    request->payload = request->payload_copy;
+    request->job.opcode = request->header.opcode;
+    request->job.context = request;
+    if (pool_submit(&pool, &request->job) == -1) {
         return -1;
-    
-    
-    free(buffer);
-    return RP_SUCCESS;
+    }
+    connection->in_flight++;
+    return 0;
 }
 
 /**
- * @brief Handles a lseek system call from the client
- * 
- * @param client_fd Client connection file descriptor
+ * @brief Handles a request on a worker
+ *
+ * @param context Request to handle
+ */
+void run_job(void* context) {
+    request_s* request = context;
+    request->status = dispatch_frame(request, &request->header, request->payload);
+    request->error = errno;
+}
+
+/**
+ * @brief Queues the reply of a request a worker has handled, and progresses its connection
+ *
+ * @param epoll_fd Epoll instance of the event loop
+ * @param request Request the worker handled
+ * @return int 0 to keep the connection open : -1 to close it
+ */
+int job_finished(int epoll_fd, request_s* request) {
+    connection_s* connection = request->connection;
+    connection->in_flight--;
+
+    // The connection closed while the request was out, free it once nothing else is
+    if (connection->closed) {
+        release_request(request);
+        if (connection->in_flight == 0) {
+            connection->next_closed = closed_connections;
+            closed_connections = connection;
+        }
+        return 0;
+    }
+
+    if (request->status == -1) {
+        log_message(LOG_LEVEL_ERROR, "[Server : Error] Failed handling %s request {errno[%d]}\n",
+                    strCallType(request->header.opcode), request->error);
+        release_request(request);
+        return -1;
+    }
+
+    queue_reply(request);
+    return progress_connection(epoll_fd, connection);
+}
+
+/**
+ * @brief Re-arms a connection for the next event it waits for
+ *
+ * @param epoll_fd Epoll instance of the event loop
+ * @param connection Connection to watch
+ * @param events EPOLLIN while reading requests : EPOLLOUT while sending a reply
+ * @return int 0 on success : -1 on error
+ */
+int watch_connection(int epoll_fd, connection_s* connection, uint32_t events) {
+    struct epoll_event event;
+    event.events = events | EPOLLONESHOT;
+    event.data.ptr = connection;
+    return epoll_ctl(epoll_fd, EPOLL_CTL_MOD, connection->fd, &event);
+}
+
+/**
+ * @brief Stops watching a connection and closes its socket, the connection is freed after the
+ *        current events once no worker holds one of its requests
+ *
+ * @param epoll_fd Epoll instance of the event loop
+ * @param connection Connection to close
+ */
+void close_connection(int epoll_fd, connection_s* connection) {
+    if (connection->closed) {
+        return;
+    }
+
+    log_message(LOG_LEVEL_INFO, "[Server : Info] Closing client connection (fd: %d)\n",
+                connection->fd);
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, connection->fd, NULL);
+    close(connection->fd);
+    connection->closed = 1;
+
+    if (connection->in_flight == 0) {
+        connection->next_closed = closed_connections;
+        closed_connections = connection;
+    }
+}
+
+/**
+ * @brief Frees the closed connections no worker holds a request of, closing any files they left
+ *        open
+ */
+void free_closed_connections(void) {
+    while (closed_connections) {
+        connection_s* connection = closed_connections;
+        closed_connections = connection->next_closed;
+        free_connection(connection);
+        free(connection);
+    }
+}
+
+/*==================================================================================================
+    RPC Handlers
+==================================================================================================*/
+
+/**
+ * @brief Handles the request held in a frame
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
+ * @return RP_SUCCESS on success, -1 on error with errno set
+ */
+int dispatch_frame(request_s* request, const rp_header_s* header, const uint8_t* payload) {
+
+    log_message(LOG_LEVEL_DEBUG, "[Server : Debug] Processing request: %s\n",
+                strCallType(header->opcode));
+
+    // Handle call
+    switch(header->opcode) {
+
+        case OPEN_CALL:
+            return handle_open(request, header, payload);
+
+        case CLOSE_CALL:
+            return handle_close(request, header, payload);
+
+        case READ_CALL:
+            return handle_read(request, header, payload);
+
+        case WRITE_CALL:
+            return handle_write(request, header, payload);
+
+        case LSEEK_CALL:
+            return handle_lseek(request, header, payload);
+
+        case CHECKSUM_CALL:
+            return handle_checksum(request, header, payload);
+
+        case PREAD_CALL:
+            return handle_pread(request, header, payload);
+
+        case PWRITE_CALL:
+            return handle_pwrite(request, header, payload);
+
+        case STREAM_CALL:
+            return handle_stream(request, header, payload);
+
+        case DIGEST_CALL:
+            return handle_digest(request, header, payload);
+
+        case DELTA_CALL:
+            return handle_delta(request, header, payload);
+
+        case LSEEK64_CALL:
+            return handle_lseek64(request, header, payload);
+
+        case PREAD64_CALL:
+            return handle_pread64(request, header, payload);
+
+        case PWRITE64_CALL:
+            return handle_pwrite64(request, header, payload);
+
+        case STREAM64_CALL:
+            return handle_stream64(request, header, payload);
+
+        case STATS_CALL:
+            return handle_stats(request, header, payload);
+
+        default:
+            errno = SERVER_INVALID_CALL_TYPE;
+            return -1;
+    }
+}
+
+/**
+ * @brief Handles an open system call from the client
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
+ * @return RP_SUCCESS on success, -1 on error with errno set
+ */
+int handle_open(request_s* request, const rp_header_s* header, const uint8_t* payload) {
+
+    // Get flags, mode and pathname (which must be terminated)
+    rp_open_args_s args;
+    if (header->payload_length <= sizeof(args) || payload[header->payload_length - 1] != '\0') {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+    memcpy(&args, payload, sizeof(args));
+    uint32_t flags = ntohl(args.flags);
+    uint32_t mode = ntohl(args.mode);
+    const char* pathname = (const char*)payload + sizeof(args);
+
+    // Perform call and return results
+    errno = 0;
+    int32_t result = (flags & O_CREAT) ?
+        (int32_t) open(pathname, (int)flags, (mode_t)mode) :
+        (int32_t) open(pathname, (int)flags);
+
+    // Remember the file, so only this connection can use it
+    if (result != -1 && track_file(request->connection, result) == -1) {
+        close(result);
+        result = -1;
+        errno = ENOMEM;
+    }
+    if (return_result(request, header, result, NULL, 0) == -1)
+        return -1;
+
+    return RP_SUCCESS;
+}
+
+/**
+ * @brief Handles a close system call from the client
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
  * @return RP_SUCCESS on success, -1 on error with errno set
  */
-int handle_lseek(int client_fd) {
-    // Set errno for early exit
-    errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+int handle_close(request_s* request, const rp_header_s* header, const uint8_t* payload) {
 
     // Get file descriptor
-    uint32_t file_fd;
-    if (read_data_of_type(&file_fd, UINT32, client_fd) == -1)
+    rp_close_args_s args;
+    if (header->payload_length != sizeof(args)) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+    memcpy(&args, payload, sizeof(args));
+    uint32_t file_fd = ntohl(args.file_fd);
+
+    // Perform call and return results
+    errno = 0;
+    int32_t result = (int32_t)close_file(request->connection, file_fd);
+    if (return_result(request, header, result, NULL, 0) == -1)
+        return -1;
+
+    return RP_SUCCESS;
+}
+
+/**
+ * @brief Handles a read system call from the client
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
+ * @return RP_SUCCESS on success, -1 on error with errno set
+ */
+int handle_read(request_s* request, const rp_header_s* header, const uint8_t* payload) {
+
+    // Get file descriptor and count
+    rp_read_args_s args;
+    if (header->payload_length != sizeof(args)) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+    memcpy(&args, payload, sizeof(args));
+    uint32_t file_fd = ntohl(args.file_fd);
+    size_t count = ntohl(args.count);
+
+    // Read into the request's buffer, a short read is returned past the largest reply
+    if (count > RP_MAX_PAYLOAD - sizeof(rp_reply_s)) {
+        count = RP_MAX_PAYLOAD - sizeof(rp_reply_s);
+    }
+    if (reserve_read_buffer(request, count) == -1) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+
+    // Perform call and return results, along with the data actually read
+    errno = 0;
+    int32_t data_read = -1;
+    if (lock_file(request->connection, file_fd) == 0) {
+        data_read = (int32_t)read(file_fd, request->read_buffer, count);
+        unlock_file(request->connection);
+    }
+    if (return_result(request, header, data_read, request->read_buffer,
+                      (data_read > 0) ? (size_t)data_read : 0) == -1)
+        return -1;
+
+    return RP_SUCCESS;
+}
+
+/**
+ * @brief Handles a write system call from the client
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
+ * @return RP_SUCCESS on success, -1 on error with errno set
+ */
+int handle_write(request_s* request, const rp_header_s* header, const uint8_t* payload) {
+
+    // Get file descriptor and count, followed by the data
+    rp_write_args_s args;
+    if (header->payload_length < sizeof(args)) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+    memcpy(&args, payload, sizeof(args));
+    uint32_t file_fd = ntohl(args.file_fd);
+    uint32_t count = ntohl(args.count);
+    if (header->payload_length - sizeof(args) != count) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
         return -1;
-    
-    // Get offset
-    int32_t offset;
-    if (read_data_of_type(&offset, INT32, client_fd) == -1)
+    }
+
+    // Perform call straight from the frame and return results
+    errno = 0;
+    int32_t data_wrote = -1;
+    if (lock_file(request->connection, file_fd) == 0) {
+        data_wrote = (int32_t)write(file_fd, payload + sizeof(args), count);
+        unlock_file(request->connection);
+    }
+    if (return_result(request, header, data_wrote, NULL, 0) == -1)
         return -1;
 
-    // Get seek origin
-    uint32_t whence;
-    if (read_data_of_type(&whence, UINT32, client_fd) == -1)
+    return RP_SUCCESS;
+}
+
+/**
+ * @brief Handles a lseek system call from the client
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
+ * @return RP_SUCCESS on success, -1 on error with errno set
+ */
+int handle_lseek(request_s* request, const rp_header_s* header, const uint8_t* payload) {
+
+    // Get file descriptor, offset and seek origin
+    rp_lseek_args_s args;
+    if (header->payload_length != sizeof(args)) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
         return -1;
+    }
+    memcpy(&args, payload, sizeof(args));
+    uint32_t file_fd = ntohl(args.file_fd);
+    int32_t offset = (int32_t)ntohl((uint32_t)args.offset);
+    uint32_t whence = ntohl(args.whence);
 
     // Perform call and return results
     errno = 0;
-    int32_t result = (int32_t)lseek(file_fd, offset, whence);
-    if (return_result(client_fd, &result, INT32) == -1)
+    int32_t result = -1;
+    if (lock_file(request->connection, file_fd) == 0) {
+        result = (int32_t)lseek(file_fd, offset, whence);
+        unlock_file(request->connection);
+    }
+    if (return_result(request, header, result, NULL, 0) == -1)
         return -1;
 
     return RP_SUCCESS;
@@ -445,68 +1046,1457 @@ int handle_lseek(int client_fd) {
 
 /**
  * @brief Handles a checksum calculation request from the client
- * 
- * @param client_fd Client connection file descriptor
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
  * @return RP_SUCCESS on success, -1 on error with errno set
  */
-int handle_checksum(int client_fd) {
-    // Set errno for early exit
-    errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+int handle_checksum(request_s* request, const rp_header_s* header, const uint8_t* payload) {
 
-    // Get file descriptor
-    uint32_t file_fd;
-    if (read_data_of_type(&file_fd, UINT32, client_fd) == -1) {
+    // Get file descriptor and block size
+    rp_checksum_args_s args;
+    if (header->payload_length != sizeof(args)) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
         return -1;
     }
-    // Get block size
-    uint32_t block_size;
-    if (read_data_of_type(&block_size, UINT32, client_fd) == -1) {
+    memcpy(&args, payload, sizeof(args));
+    uint32_t file_fd = ntohl(args.file_fd);
+    uint32_t block_size = ntohl(args.block_size);
+
+    // Perform call and return results
+    errno = 0;
+    int16_t checksum = -1;
+    if (lock_file(request->connection, file_fd) == 0) {
+        checksum = genChecksum(file_fd, block_size);
+        unlock_file(request->connection);
+    }
+    if (return_result(request, header, checksum, NULL, 0) == -1) {
         return -1;
     }
 
-    // Perform call and return results
+    return RP_SUCCESS;
+}
+
+/**
+ * @brief Handles a pread system call from the client, which reads at an offset without moving the
+ *        file position, so calls in flight together can't disturb each other
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
+ * @return RP_SUCCESS on success, -1 on error with errno set
+ */
+int handle_pread(request_s* request, const rp_header_s* header, const uint8_t* payload) {
+
+    // Get file descriptor, count and offset
+    rp_pread_args_s args;
+    if (header->payload_length != sizeof(args)) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+    memcpy(&args, payload, sizeof(args));
+    uint32_t file_fd = ntohl(args.file_fd);
+    size_t count = ntohl(args.count);
+    off_t offset = (off_t)ntohl(args.offset);
+
+    // Read into the request's buffer, a short read is returned past the largest reply
+    if (count > RP_MAX_PAYLOAD - sizeof(rp_reply_s)) {
+        count = RP_MAX_PAYLOAD - sizeof(rp_reply_s);
+    }
+    if (reserve_read_buffer(request, count) == -1) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+
+    // Perform call and return results, along with the data actually read
     errno = 0;
-    int16_t checksum = genChecksum(file_fd, block_size);
-    if (return_result(client_fd, &checksum, INT16) == -1) {
+    int32_t data_read = -1;
+    if (lock_file(request->connection, file_fd) == 0) {
+        data_read = (int32_t)pread(file_fd, request->read_buffer, count, offset);
+        unlock_file(request->connection);
+    }
+    if (return_result(request, header, data_read, request->read_buffer,
+                      (data_read > 0) ? (size_t)data_read : 0) == -1)
+        return -1;
+
+    return RP_SUCCESS;
+}
+
+/**
+ * @brief Handles a pwrite system call from the client, which writes at an offset without moving
+ *        the file position
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
+ * @return RP_SUCCESS on success, -1 on error with errno set
+ */
+int handle_pwrite(request_s* request, const rp_header_s* header, const uint8_t* payload) {
+
+    // Get file descriptor, count and offset, followed by the data
+    rp_pwrite_args_s args;
+    if (header->payload_length < sizeof(args)) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+    memcpy(&args, payload, sizeof(args));
+    uint32_t file_fd = ntohl(args.file_fd);
+    uint32_t count = ntohl(args.count);
+    off_t offset = (off_t)ntohl(args.offset);
+    if (header->payload_length - sizeof(args) != count) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
         return -1;
     }
-    
+
+    // Perform call straight from the frame and return results
+    errno = 0;
+    int32_t data_wrote = -1;
+    if (lock_file(request->connection, file_fd) == 0) {
+        data_wrote = (int32_t)pwrite(file_fd, payload + sizeof(args), count, offset);
+        unlock_file(request->connection);
+    }
+    if (return_result(request, header, data_wrote, NULL, 0) == -1)
+        return -1;
+
     return RP_SUCCESS;
 }
 
-/*==================================================================================================
-    RPC Handler Helpers
-==================================================================================================*/
+/**
+ * @brief Handles a 64-bit lseek system call from the client, which can seek past 2GB
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
+ * @return RP_SUCCESS on success, -1 on error with errno set
+ */
+int handle_lseek64(request_s* request, const rp_header_s* header, const uint8_t* payload) {
+
+    // Get file descriptor, offset and seek origin
+    rp_lseek64_args_s args;
+    if (header->payload_length != sizeof(args)) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+    memcpy(&args, payload, sizeof(args));
+    uint32_t file_fd = ntohl(args.file_fd);
+    int64_t offset = (int64_t)be64toh((uint64_t)args.offset);
+    uint32_t whence = ntohl(args.whence);
+
+    // Perform call and return results
+    errno = 0;
+    int64_t result = -1;
+    if (lock_file(request->connection, file_fd) == 0) {
+        result = (int64_t)lseek(file_fd, (off_t)offset, whence);
+        unlock_file(request->connection);
+    }
+    if (return_result64(request, header, result, NULL, 0) == -1)
+        return -1;
+
+    return RP_SUCCESS;
+}
 
 /**
- * @brief Returns the result of a system call to the user, and sends an updated error number if
- *        necessary.
- * 
- * @param client_fd Client file descriptor to write result to
- * @param result_ptr Pointer to the numeric result of the system call to be sent back
- * @param type Variable type of the result being sent back
- * @param return_buffer Return buffer to be sent if RPC was a read, otherwise NULL
- * @return int 0 on success : -1 on error
+ * @brief Handles a 64-bit pread system call from the client, which reads at any offset
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
+ * @return RP_SUCCESS on success, -1 on error with errno set
  */
-int return_result(int client_fd, void* result_ptr, var_type_e type) {
+int handle_pread64(request_s* request, const rp_header_s* header, const uint8_t* payload) {
 
-    // Copy int value of result
-    int result;
-    memcpy(&result, result_ptr, sizeof(result));
+    // Get file descriptor, count and offset
+    rp_pread64_args_s args;
+    if (header->payload_length != sizeof(args)) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+    memcpy(&args, payload, sizeof(args));
+    uint32_t file_fd = ntohl(args.file_fd);
+    uint64_t count = be64toh(args.count);
+    uint64_t offset = be64toh(args.offset);
+    if (offset > INT64_MAX) {
+        errno = EINVAL;
+        return (return_result64(request, header, -1, NULL, 0) == -1) ? -1 : RP_SUCCESS;
+    }
 
-    // Send result of operation back to user
-    if (send_data_of_type(result_ptr, type, client_fd) < 0) {
-        errno = SERVER_ERROR_SENDING_RPC_RESULT;
+    // Read into the request's buffer, a short read is returned past the largest reply
+    if (count > RP_MAX_PAYLOAD - sizeof(rp_reply64_s)) {
+        count = RP_MAX_PAYLOAD - sizeof(rp_reply64_s);
+    }
+    if (reserve_read_buffer(request, (size_t)count) == -1) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
         return -1;
     }
 
-    // Send errno if neccessary
-    if (result == -1) {
-        if (send_data_of_type(&errno, INT32, client_fd) == -1) {
-            errno = SERVER_ERROR_SENDING_RPC_ERRNO;
-            return -1;
+    // Perform call and return results, along with the data actually read
+    errno = 0;
+    int64_t data_read = -1;
+    if (lock_file(request->connection, file_fd) == 0) {
+        data_read = (int64_t)pread(file_fd, request->read_buffer, (size_t)count, (off_t)offset);
+        unlock_file(request->connection);
+    }
+    if (return_result64(request, header, data_read, request->read_buffer,
+                        (data_read > 0) ? (size_t)data_read : 0) == -1)
+        return -1;
+
+    return RP_SUCCESS;
+}
+
+/**
+ * @brief Handles a 64-bit pwrite system call from the client, which writes at any offset
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
+ * @return RP_SUCCESS on success, -1 on error with errno set
+ */
+int handle_pwrite64(request_s* request, const rp_header_s* header, const uint8_t* payload) {
+
+    // Get file descriptor, count and offset, followed by the data
+    rp_pwrite64_args_s args;
+    if (header->payload_length < sizeof(args)) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+    memcpy(&args, payload, sizeof(args));
+    uint32_t file_fd = ntohl(args.file_fd);
+    uint64_t count = be64toh(args.count);
+    uint64_t offset = be64toh(args.offset);
+    if (header->payload_length - sizeof(args) != count) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+    if (offset > INT64_MAX) {
+        errno = EINVAL;
+        return (return_result64(request, header, -1, NULL, 0) == -1) ? -1 : RP_SUCCESS;
+    }
+
+    // Perform call straight from the frame and return results
+    errno = 0;
+    int64_t data_wrote = -1;
+    if (lock_file(request->connection, file_fd) == 0) {
+        data_wrote = (int64_t)pwrite(file_fd, payload + sizeof(args), (size_t)count,
+                                     (off_t)offset);
+        unlock_file(request->connection);
+    }
+    if (return_result64(request, header, data_wrote, NULL, 0) == -1)
+        return -1;
+
+    return RP_SUCCESS;
+}
+
+/**
+ * @brief Finds the bytes of a stream call in range, and keeps the file open until they are sent
+ *        (it may be closed first)
+ *
+ * @param request Request being handled
+ * @param file_fd File to stream from
+ * @param count Most bytes to stream
+ * @param offset File position to stream from
+ * @return Number of bytes to stream, -1 on error with errno set
+ */
+static int64_t prepare_stream(request_s* request, uint32_t file_fd, size_t count, off_t offset) {
+    errno = 0;
+    int64_t result = -1;
+    if (lock_file(request->connection, file_fd) == 0) {
+        struct stat status;
+        if (fstat(file_fd, &status) == 0 && (request->transfer_fd = dup(file_fd)) != -1) {
+            size_t in_range = (status.st_size > offset) ? (size_t)(status.st_size - offset) : 0;
+            result = (int64_t)((count < in_range) ? count : in_range);
         }
+        unlock_file(request->connection);
     }
 
-    return 0;
-}
\ No newline at end of file
+    // The event loop sends the range, so start reading it from disk in the meantime
+    if (result > 0) {
+        posix_fadvise(request->transfer_fd, offset, result, POSIX_FADV_WILLNEED);
+        request->transfer_offset = offset;
+        request->transfer_remaining = (size_t)result;
+    }
+    return result;
+}
+
+/**
+ * @brief Handles a stream request from the client, which sends a range of a file after the reply
+ *        straight from the file with sendfile() (the data never passes through a buffer)
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
+ * @return RP_SUCCESS on success, -1 on error with errno set
+ * @note The range is cut at the end of the file when the reply is framed, and the connection is
+ *       closed if the file shrinks before the range is sent (the reply can't be finished)
+ */
+int handle_stream(request_s* request, const rp_header_s* header, const uint8_t* payload) {
+
+    // Get file descriptor, count and offset
+    rp_stream_args_s args;
+    if (header->payload_length != sizeof(args)) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+    memcpy(&args, payload, sizeof(args));
+    uint32_t file_fd = ntohl(args.file_fd);
+    size_t count = ntohl(args.count);
+    off_t offset = (off_t)ntohl(args.offset);
+    if (count > INT32_MAX) {
+        count = INT32_MAX;
+    }
+
+    int32_t result = (int32_t)prepare_stream(request, file_fd, count, offset);
+    if (return_result(request, header, result, NULL, 0) == -1)
+        return -1;
+
+    return RP_SUCCESS;
+}
+
+/**
+ * @brief Handles a 64-bit stream request from the client, which streams a range of any size from
+ *        any offset (the range isn't counted in the reply frame)
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
+ * @return RP_SUCCESS on success, -1 on error with errno set
+ */
+int handle_stream64(request_s* request, const rp_header_s* header, const uint8_t* payload) {
+
+    // Get file descriptor, count and offset
+    rp_stream64_args_s args;
+    if (header->payload_length != sizeof(args)) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+    memcpy(&args, payload, sizeof(args));
+    uint32_t file_fd = ntohl(args.file_fd);
+    uint64_t count = be64toh(args.count);
+    uint64_t offset = be64toh(args.offset);
+    if (offset > INT64_MAX) {
+        errno = EINVAL;
+        return (return_result64(request, header, -1, NULL, 0) == -1) ? -1 : RP_SUCCESS;
+    }
+    if (count > SIZE_MAX) {
+        count = SIZE_MAX;
+    }
+
+    int64_t result = prepare_stream(request, file_fd, (size_t)count, (off_t)offset);
+    if (return_result64(request, header, result, NULL, 0) == -1)
+        return -1;
+
+    return RP_SUCCESS;
+}
+
+/**
+ * @brief Handles a digest request from the client, which hashes the file in chunks (on several
+ *        workers for large files) and returns the digest of the file and of its first chunks
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
+ * @return RP_SUCCESS on success, -1 on error with errno set
+ */
+int handle_digest(request_s* request, const rp_header_s* header, const uint8_t* payload) {
+
+    // Get file descriptor, chunk size and the most chunk digests to return
+    rp_digest_args_s args;
+    if (header->payload_length != sizeof(args)) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+    memcpy(&args, payload, sizeof(args));
+    uint32_t file_fd = ntohl(args.file_fd);
+    size_t chunk_size = ntohl(args.chunk_size);
+    size_t max_digests = ntohl(args.max_digests);
+    if (chunk_size == 0) {
+        chunk_size = DIGEST_CHUNK_SIZE;
+    }
+    if (max_digests > (RP_MAX_PAYLOAD - sizeof(rp_reply_s)) / sizeof(uint64_t) - 1) {
+        max_digests = (RP_MAX_PAYLOAD - sizeof(rp_reply_s)) / sizeof(uint64_t) - 1;
+    }
+
+    // Hash every chunk into the read buffer, after a slot for the file digest (small chunks are
+    // refused, as the buffer holds a digest for every chunk of the file)
+    errno = 0;
+    int32_t result = -1;
+    size_t chunk_count = 0;
+    uint64_t* digests = NULL;
+    if (chunk_size < DIGEST_MIN_CHUNK_SIZE) {
+        errno = EINVAL;
+    } else if (lock_file(request->connection, file_fd) == 0) {
+        struct stat status;
+        if (fstat(file_fd, &status) == 0) {
+            chunk_count = ((size_t)status.st_size + chunk_size - 1) / chunk_size;
+            if (chunk_count > INT32_MAX) {
+                errno = EFBIG;
+            } else if (reserve_read_buffer(request, (chunk_count + 1) * sizeof(uint64_t)) == -1) {
+                errno = ENOMEM;
+            } else {
+                digests = (uint64_t*)request->read_buffer;
+                if (digest_chunks(file_fd, status.st_size, chunk_size, chunk_count,
+                                  digests + 1) == 0) {
+                    result = (int32_t)chunk_count;
+                }
+            }
+        }
+        unlock_file(request->connection);
+    }
+
+    // Return the file digest and those of the first chunks
+    size_t digest_count = 0;
+    if (result != -1) {
+        digests[0] = combine_digests(digests + 1, chunk_count);
+        digest_count = 1 + ((chunk_count < max_digests) ? chunk_count : max_digests);
+        for (size_t i = 0; i < digest_count; i++) {
+            digests[i] = htobe64(digests[i]);
+        }
+    }
+    if (return_result(request, header, result, digests, digest_count * sizeof(uint64_t)) == -1)
+        return -1;
+
+    return RP_SUCCESS;
+}
+
+/**
+ * @brief Handles a delta request from the client, which finds the client's blocks (from their
+ *        signatures) at any offset of a range of the file, and returns the range as blocks for the
+ *        client to copy and the literal bytes between them
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request
+ * @return RP_SUCCESS on success, -1 on error with errno set
+ */
+int handle_delta(request_s* request, const rp_header_s* header, const uint8_t* payload) {
+
+    // Get file descriptor, blocks and range, followed by the signatures of the blocks
+    rp_delta_args_s args;
+    if (header->payload_length < sizeof(args)) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+    memcpy(&args, payload, sizeof(args));
+    uint32_t file_fd = ntohl(args.file_fd);
+    size_t block_size = ntohl(args.block_size);
+    size_t block_count = ntohl(args.block_count);
+    off_t offset = (off_t)be64toh(args.offset);
+    size_t length = ntohl(args.length);
+    if (header->payload_length - sizeof(args) != block_count * sizeof(rp_block_signature_s)) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+
+    // Perform call and return results, along with the delta
+    errno = 0;
+    int32_t result = -1;
+    size_t delta_size = 0;
+    if (block_size == 0 || length > INT32_MAX ||
+        delta_capacity(length, block_size) > RP_MAX_PAYLOAD - sizeof(rp_reply_s)) {
+        errno = EINVAL;
+    } else if (lock_file(request->connection, file_fd) == 0) {
+        result = compute_delta(request, file_fd, offset, length, block_size,
+                               (const rp_block_signature_s*)(payload + sizeof(args)),
+                               block_count, &delta_size);
+        unlock_file(request->connection);
+    }
+    if (return_result(request, header, result, request->read_buffer, delta_size) == -1)
+        return -1;
+
+    return RP_SUCCESS;
+}
+
+/**
+ * @brief Handles a statistics request from the client, which returns the counters and latency
+ *        percentiles of every call the server has answered (in every process of the fork mode)
+ *
+ * @param request Request being handled
+ * @param header Header of the request frame
+ * @param payload Arguments of the request (none)
+ * @return RP_SUCCESS on success, -1 on error with errno set
+ */
+int handle_stats(request_s* request, const rp_header_s* header, const uint8_t* payload) {
+    (void)payload;
+    if (header->payload_length != 0) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+    if (reserve_read_buffer(request, RP_CALL_COUNT * sizeof(rp_call_stats_s)) == -1) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+
+    // Add the slots up, and send the statistics in network byte order
+    rp_call_stats_s* stats = (rp_call_stats_s*)request->read_buffer;
+    size_t count = stats_snapshot(stats);
+    for (size_t i = 0; i < count; i++) {
+        stats[i].opcode = htonl(stats[i].opcode);
+        stats[i].count = htobe64(stats[i].count);
+        stats[i].errors = htobe64(stats[i].errors);
+        stats[i].bytes_in = htobe64(stats[i].bytes_in);
+        stats[i].bytes_out = htobe64(stats[i].bytes_out);
+        stats[i].p50 = htobe64(stats[i].p50);
+        stats[i].p90 = htobe64(stats[i].p90);
+        stats[i].p99 = htobe64(stats[i].p99);
+        stats[i].max = htobe64(stats[i].max);
+    }
+    errno = 0;
+    if (return_result(request, header, (int32_t)count, stats, count * sizeof(*stats)) == -1)
+        return -1;
+
+    return RP_SUCCESS;
+}
+
+/**
+ * @brief Starts a receive request from the client, whose data (following the arguments) is written
+ *        to the file at an offset by receive_data() as it arrives
+ *
+ * @param connection Connection the request was read from
+ * @param request Request holding the arguments read with read_request_frame()
+ * @return RP_SUCCESS on success, -1 on error with errno set
+ * @note A failing write is answered once the data is discarded, the frame is still read in full
+ */
+int start_receive(connection_s* connection, request_s* request) {
+
+    log_message(LOG_LEVEL_DEBUG, "[Server : Debug] Processing request: %s\n",
+                strCallType(request->header.opcode));
+
+    // Get file descriptor, count and offset, followed by the data
+    uint32_t file_fd;
+    uint64_t count;
+    uint64_t offset;
+    uint64_t max_count;
+    if (request->header.opcode == RECEIVE64_CALL) {
+        rp_receive64_args_s args;
+        memcpy(&args, request->payload, sizeof(args));
+        file_fd = ntohl(args.file_fd);
+        count = be64toh(args.count);
+        offset = be64toh(args.offset);
+        max_count = INT64_MAX;
+        if (request->header.payload_length != sizeof(args)) {
+            errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+            return -1;
+        }
+    } else {
+        rp_receive_args_s args;
+        memcpy(&args, request->payload, sizeof(args));
+        file_fd = ntohl(args.file_fd);
+        count = ntohl(args.count);
+        offset = ntohl(args.offset);
+        max_count = INT32_MAX;
+        if (request->header.payload_length - sizeof(args) != count) {
+            errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+            return -1;
+        }
+    }
+    if (count > SIZE_MAX) {
+        errno = SERVER_ERROR_RECIEVING_RPC_ARGS;
+        return -1;
+    }
+
+    // Keep the file open until the data is written (it may be closed first)
+    request->transfer_offset = (off_t)offset;
+    request->transfer_remaining = (size_t)count;
+    request->transfer_done = 0;
+    request->transfer_error = 0;
+    if (count > max_count || offset > INT64_MAX) {
+        request->transfer_error = EINVAL;
+    } else if (lock_file(connection, file_fd) == 0) {
+        request->transfer_fd = dup(file_fd);
+        if (request->transfer_fd == -1) {
+            request->transfer_error = errno;
+        }
+        unlock_file(connection);
+    } else {
+        request->transfer_error = errno;
+    }
+
+    connection->receiving = request;
+    return RP_SUCCESS;
+}
+
+/**
+ * @brief Moves as much of the data of the receive call being read into its file as the socket has,
+ *        and frames the reply once it is all in
+ *
+ * @param connection Connection reading the receive call
+ * @return int 0 once the reply is framed : 1 if data is left : -1 on error with errno set
+ * @note The caller owns the request again once 0 or -1 is returned
+ */
+int receive_data(connection_s* connection) {
+    request_s* request = connection->receiving;
+
+    // Data read along with the frame is written from the frame reader
+    uint8_t* data;
+    size_t length;
+    while (request->transfer_remaining > 0 &&
+           (length = take_buffered(&connection->reader, request->transfer_remaining, &data)) > 0) {
+        write_received(request, data, length);
+        request->transfer_remaining -= length;
+    }
+
+    // The rest goes from the socket into the file through a pipe, never entering user space
+    while (request->transfer_remaining > 0) {
+        if (connection->pipe_fds[0] == -1 && pipe2(connection->pipe_fds, O_NONBLOCK) == -1) {
+            connection->pipe_fds[0] = -1;
+            connection->receiving = NULL;
+            return -1;
+        }
+
+        size_t chunk = (request->transfer_remaining < TRANSFER_CHUNK_SIZE) ?
+                       request->transfer_remaining : TRANSFER_CHUNK_SIZE;
+        ssize_t moved = splice(connection->fd, NULL, connection->pipe_fds[1], NULL, chunk,
+                               SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (moved == -1) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return 1;
+            connection->receiving = NULL;
+            return -1;
+        }
+        if (moved == 0) {
+            errno = CONNECTION_CLOSED;
+            connection->receiving = NULL;
+            return -1;
+        }
+        request->transfer_remaining -= moved;
+
+        // Empty the pipe into the file, copying instead when the file can't be spliced into
+        while (moved > 0 && !request->transfer_error) {
+            ssize_t wrote = splice(connection->pipe_fds[0], NULL, request->transfer_fd,
+                                   &request->transfer_offset, moved, SPLICE_F_MOVE);
+            if (wrote == -1 && errno == EINTR)
+                continue;
+            if (wrote <= 0)
+                break;
+            moved -= wrote;
+            request->transfer_done += wrote;
+        }
+        if (moved > 0 && drain_pipe(connection, moved) == -1) {
+            connection->receiving = NULL;
+            return -1;
+        }
+    }
+
+    // Reply with the bytes written
+    connection->receiving = NULL;
+    if (request->transfer_fd != -1) {
+        close(request->transfer_fd);
+        request->transfer_fd = -1;
+    }
+    errno = request->transfer_error;
+    int64_t result = (request->transfer_error) ? -1 : (int64_t)request->transfer_done;
+    if (request->header.opcode == RECEIVE64_CALL)
+        return return_result64(request, &request->header, result, NULL, 0);
+    return return_result(request, &request->header, (int32_t)result, NULL, 0);
+}
+
+/*==================================================================================================
+    RPC Handler Helpers
+==================================================================================================*/
+
+/**
+ * @brief Frames the header and result of a reply, the data is sent from where it lies
+ *
+ * @param request Request to send the result of
+ * @param header Header of the request being answered
+ * @param reply Packed result and errno of the call
+ * @param reply_size Size of the packed result
+ * @param payload_length Bytes of the reply frame following its header
+ * @param data Data to be sent after the result, otherwise NULL
+ * @param data_size Size of the data in bytes
+ */
+static void frame_reply(request_s* request, const rp_header_s* header, const void* reply,
+                        size_t reply_size, size_t payload_length, const void* data,
+                        size_t data_size) {
+    rp_header_s reply_header;
+    reply_header.opcode = htons(header->opcode);
+    reply_header.reserved = 0;
+    reply_header.request_id = htonl(header->request_id);
+    reply_header.payload_length = htonl((uint32_t)payload_length);
+
+    memcpy(request->reply, &reply_header, sizeof(reply_header));
+    memcpy(request->reply + sizeof(reply_header), reply, reply_size);
+    request->reply_parts[0].iov_base = request->reply;
+    request->reply_parts[0].iov_len = sizeof(reply_header) + reply_size;
+    request->reply_parts[1].iov_base = (void*)data;
+    request->reply_parts[1].iov_len = data_size;
+    request->reply_part = 0;
+}
+
+/**
+ * @brief Returns the result of a system call to the user in a single reply frame, along with the
+ *        error number and any data read.
+ *
+ * @param request Request to send the result of
+ * @param header Header of the request being answered
+ * @param result Numeric result of the system call to be sent back
+ * @param data Data to be sent after the result (read calls), otherwise NULL
+ * @param data_size Size of the data in bytes
+ * @return int 0 on success : -1 on error
+ * @note The reply is only framed here, and is sent by send_reply() (followed by the file range of
+ *       a stream call, which must be set beforehand)
+ */
+int return_result(request_s* request, const rp_header_s* header, int32_t result,
+                  const void* data, size_t data_size) {
+    rp_reply_s reply;
+    reply.result = (int32_t)htonl((uint32_t)result);
+    reply.error = (int32_t)htonl((uint32_t)((result == -1) ? errno : 0));
+
+    size_t payload_length = sizeof(reply) + data_size + request->transfer_remaining;
+    frame_reply(request, header, &reply, sizeof(reply), payload_length, data, data_size);
+    stats_record(header->opcode, clock_now() - request->start_time,
+                 RP_HEADER_SIZE + header->payload_length, RP_HEADER_SIZE + payload_length,
+                 result == -1);
+    return 0;
+}
+
+/**
+ * @brief Returns the 64-bit result of a system call to the user in a single reply frame, along
+ *        with the error number and any data read.
+ *
+ * @param request Request to send the result of
+ * @param header Header of the request being answered
+ * @param result Numeric result of the system call to be sent back
+ * @param data Data to be sent after the result (read calls), otherwise NULL
+ * @param data_size Size of the data in bytes
+ * @return int 0 on success : -1 on error
+ * @note The file range of a stream call follows the frame instead of being counted in it
+ */
+int return_result64(request_s* request, const rp_header_s* header, int64_t result,
+                    const void* data, size_t data_size) {
+    rp_reply64_s reply;
+    reply.result = (int64_t)htobe64((uint64_t)result);
+    reply.error = (int32_t)htonl((uint32_t)((result == -1) ? errno : 0));
+
+    frame_reply(request, header, &reply, sizeof(reply), sizeof(reply) + data_size, data,
+                data_size);
+
+    // The data of the 64-bit stream and receive calls is outside their frames
+    size_t moved_in = (header->opcode == RECEIVE64_CALL) ? request->transfer_done : 0;
+    stats_record(header->opcode, clock_now() - request->start_time,
+                 RP_HEADER_SIZE + header->payload_length + moved_in,
+                 RP_HEADER_SIZE + sizeof(reply) + data_size + request->transfer_remaining,
+                 result == -1);
+    return 0;
+}
+
+/**
+ * @brief Sends as much of the reply of a request as the socket takes
+ *
+ * @param request Request holding the reply
+ * @return int 0 once the reply is sent : 1 if part of the reply is left : -1 on error
+ */
+int send_reply(request_s* request) {
+    int fd = request->connection->fd;
+
+    // Continue after partial writes until every part is sent or the socket is full
+    while (request->reply_part < REPLY_PARTS) {
+        struct iovec* next = &request->reply_parts[request->reply_part];
+        ssize_t bytes_wrote = writev(fd, next, REPLY_PARTS - request->reply_part);
+        if (bytes_wrote == -1) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return 1;
+            return -1;
+        }
+
+        while (request->reply_part < REPLY_PARTS && (size_t)bytes_wrote >= next->iov_len) {
+            bytes_wrote -= next->iov_len;
+            next++;
+            request->reply_part++;
+        }
+        if (request->reply_part < REPLY_PARTS) {
+            next->iov_base = (uint8_t*)next->iov_base + bytes_wrote;
+            next->iov_len -= bytes_wrote;
+        }
+    }
+
+    // Then the file range of a stream call, straight from the page cache
+    while (request->transfer_remaining > 0) {
+        ssize_t bytes_sent = sendfile(fd, request->transfer_fd, &request->transfer_offset,
+                                      request->transfer_remaining);
+        if (bytes_sent == -1) {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return 1;
+            return -1;
+        }
+
+        // The file shrank since the reply was framed
+        if (bytes_sent == 0) {
+            errno = SERVER_ERROR_SENDING_RPC_RESULT;
+            return -1;
+        }
+        request->transfer_remaining -= bytes_sent;
+    }
+    if (request->transfer_fd != -1) {
+        close(request->transfer_fd);
+        request->transfer_fd = -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Hashes the chunks of a file, spawning helpers on the worker pool for large files
+ *
+ * @param file_fd File descriptor of the file
+ * @param file_size Size of the file
+ * @param chunk_size Bytes per chunk
+ * @param chunk_count Number of chunks in the file
+ * @param digests Array to store the digest of each chunk in
+ * @return int 0 on success : -1 on error with errno set
+ * @note The caller keeps the file open until this returns, as no helper touches it afterwards
+ */
+int digest_chunks(int file_fd, off_t file_size, size_t chunk_size, size_t chunk_count,
+                  uint64_t* digests) {
+    digest_task_s* task = malloc(sizeof(*task));
+    if (!task) {
+        return -1;
+    }
+    task->file_fd = file_fd;
+    task->file_size = file_size;
+    task->chunk_size = chunk_size;
+    task->chunk_count = chunk_count;
+    task->digests = digests;
+    atomic_init(&task->next_chunk, 0);
+    atomic_init(&task->references, 1);
+    task->chunks_done = 0;
+    task->error = 0;
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->finished, NULL);
+
+    // Idle workers help out with large files (one is hashing here already)
+    if (pool_started && file_size >= PARALLEL_DIGEST_SIZE) {
+        size_t helper_count = pool.worker_count - 1;
+        if (helper_count > DIGEST_HELPERS)
+            helper_count = DIGEST_HELPERS;
+        if (helper_count > chunk_count - 1)
+            helper_count = chunk_count - 1;
+        for (size_t i = 0; i < helper_count; i++) {
+            task->helpers[i].opcode = DIGEST_CALL;
+            task->helpers[i].context = task;
+            atomic_fetch_add(&task->references, 1);
+            if (pool_spawn(&pool, &task->helpers[i], run_digest_helper) == -1) {
+                atomic_fetch_sub(&task->references, 1);
+                break;
+            }
+        }
+    }
+
+    // Hash chunks alongside the helpers, then wait for those they claimed
+    hash_chunks(task);
+    pthread_mutex_lock(&task->lock);
+    while (task->chunks_done < task->chunk_count) {
+        pthread_cond_wait(&task->finished, &task->lock);
+    }
+    int error = task->error;
+    pthread_mutex_unlock(&task->lock);
+    release_digest_task(task);
+
+    if (error) {
+        errno = error;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Claims and hashes chunks of a digest until none are left
+ *
+ * @param task Digest being computed
+ */
+void hash_chunks(digest_task_s* task) {
+    while (1) {
+        size_t chunk = atomic_fetch_add(&task->next_chunk, 1);
+        if (chunk >= task->chunk_count) {
+            return;
+        }
+
+        off_t offset = (off_t)(chunk * task->chunk_size);
+        size_t length = ((size_t)(task->file_size - offset) < task->chunk_size) ?
+                        (size_t)(task->file_size - offset) : task->chunk_size;
+        int status = digest_range(task->file_fd, offset, length, &task->digests[chunk]);
+
+        pthread_mutex_lock(&task->lock);
+        if (status == -1 && !task->error) {
+            task->error = errno;
+        }
+        if (++task->chunks_done == task->chunk_count) {
+            pthread_cond_signal(&task->finished);
+        }
+        pthread_mutex_unlock(&task->lock);
+    }
+}
+
+/**
+ * @brief Helps compute a digest on a worker
+ *
+ * @param context Digest being computed
+ */
+void run_digest_helper(void* context) {
+    digest_task_s* task = context;
+    hash_chunks(task);
+    release_digest_task(task);
+}
+
+/**
+ * @brief Drops a reference to a digest, freeing it once the handler and every helper are done (a
+ *        helper may only run after the digest is complete)
+ *
+ * @param task Digest to release
+ */
+void release_digest_task(digest_task_s* task) {
+    if (atomic_fetch_sub(&task->references, 1) == 1) {
+        pthread_mutex_destroy(&task->lock);
+        pthread_cond_destroy(&task->finished);
+        free(task);
+    }
+}
+
+/**
+ * @brief Finds the largest delta of a range, every literal run being followed by a copy
+ *
+ * @param length Bytes in the range
+ * @param block_size Bytes per block
+ * @return Bytes of delta operations and literals
+ */
+size_t delta_capacity(size_t length, size_t block_size) {
+    return length + (length / block_size + 2) * 2 * sizeof(rp_delta_op_s);
+}
+
+/**
+ * @brief Adds an operation to a delta
+ *
+ * @param delta End of the delta, moved past the operation
+ * @param block First block to copy, or DELTA_LITERAL
+ * @param count Number of blocks to copy, or literal bytes
+ * @return The operation added
+ */
+static rp_delta_op_s* add_operation(uint8_t** delta, uint32_t block, uint32_t count) {
+    rp_delta_op_s operation;
+    operation.block = htonl(block);
+    operation.count = htonl(count);
+    rp_delta_op_s* added = (rp_delta_op_s*)*delta;
+    memcpy(added, &operation, sizeof(operation));
+    *delta += sizeof(operation);
+    return added;
+}
+
+/**
+ * @brief Finds a block of the client matching a window of the file
+ *
+ * @param window First byte of the window (block_size bytes)
+ * @param block_size Bytes per block
+ * @param weak Rolling checksum of the window
+ * @param signatures Signatures of the client's blocks (in host byte order)
+ * @param block_count Number of blocks
+ * @param table Hash table of the blocks by rolling checksum (-1 for empty slots)
+ * @param mask Slots in the table minus one
+ * @param expected Block tried first (the one after the last copied), any value if none
+ * @return The matching block, -1 if none
+ */
+static int64_t find_block(const uint8_t* window, size_t block_size, uint32_t weak,
+                          const rp_block_signature_s* signatures, size_t block_count,
+                          const int64_t* table, size_t mask, size_t expected) {
+    int hashed = 0;
+    uint64_t strong = 0;
+
+    // Runs of blocks are most common, so try the block following the last one first
+    if (expected < block_count && signatures[expected].weak == weak) {
+        strong = hash_buffer(window, block_size);
+        hashed = 1;
+        if (signatures[expected].strong == strong) {
+            return (int64_t)expected;
+        }
+    }
+
+    // Only compute the digest once the rolling checksum matches
+    for (size_t slot = weak & mask; table[slot] != -1; slot = (slot + 1) & mask) {
+        const rp_block_signature_s* signature = &signatures[table[slot]];
+        if (signature->weak != weak) {
+            continue;
+        }
+        if (!hashed) {
+            strong = hash_buffer(window, block_size);
+            hashed = 1;
+        }
+        if (signature->strong == strong) {
+            return table[slot];
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Computes the delta of a range of a file against the client's blocks into the read buffer
+ *        of a request
+ *
+ * @param request Request holding the read buffer
+ * @param file_fd File descriptor of the file
+ * @param offset File position of the range
+ * @param length Bytes in the range
+ * @param block_size Bytes per block
+ * @param signatures Signatures of the client's blocks (in network byte order)
+ * @param block_count Number of blocks
+ * @param delta_size Pointer to store the size of the delta
+ * @return Bytes of the file the delta covers (0 past the end of the file), -1 on error with errno
+ *         set
+ */
+int32_t compute_delta(request_s* request, int file_fd, off_t offset, size_t length,
+                      size_t block_size, const rp_block_signature_s* signatures,
+                      size_t block_count, size_t* delta_size) {
+    *delta_size = 0;
+    struct stat status;
+    if (fstat(file_fd, &status) == -1) {
+        return -1;
+    }
+    if (offset >= status.st_size) {
+        return 0;
+    }
+
+    // A block starting in the range may end past it
+    if (length > (size_t)(status.st_size - offset)) {
+        length = (size_t)(status.st_size - offset);
+    }
+    size_t window_length = length + block_size - 1;
+    if (window_length > (size_t)(status.st_size - offset)) {
+        window_length = (size_t)(status.st_size - offset);
+    }
+
+    // The read buffer holds the delta, followed by the bytes of the range
+    size_t capacity = delta_capacity(length, block_size);
+    if (reserve_read_buffer(request, capacity + window_length) == -1) {
+        errno = ENOMEM;
+        return -1;
+    }
+    uint8_t* source = request->read_buffer + capacity;
+    for (size_t total = 0; total < window_length;) {
+        ssize_t bytes_read = pread(file_fd, source + total, window_length - total, offset + total);
+        if (bytes_read == -1 && errno == EINTR)
+            continue;
+        if (bytes_read <= 0) {
+            if (bytes_read == 0)
+                errno = EIO;
+            return -1;
+        }
+        total += bytes_read;
+    }
+
+    // Index the client's blocks by rolling checksum
+    size_t table_size = 1;
+    while (table_size < block_count * 2) {
+        table_size *= 2;
+    }
+    rp_block_signature_s* blocks = malloc(block_count * sizeof(*blocks) + 1);
+    int64_t* table = malloc(table_size * sizeof(*table));
+    if (!blocks || !table) {
+        free(blocks);
+        free(table);
+        errno = ENOMEM;
+        return -1;
+    }
+    memset(table, -1, table_size * sizeof(*table));
+    for (size_t i = 0; i < block_count; i++) {
+        blocks[i].weak = ntohl(signatures[i].weak);
+        blocks[i].strong = be64toh(signatures[i].strong);
+        size_t slot = blocks[i].weak & (table_size - 1);
+        while (table[slot] != -1) {
+            slot = (slot + 1) & (table_size - 1);
+        }
+        table[slot] = (int64_t)i;
+    }
+
+    // Slide a window over the range, copying the client's blocks where they match
+    uint8_t* delta = request->read_buffer;
+    rp_delta_op_s* last_copy = NULL;
+    size_t expected = SIZE_MAX;
+    size_t position = 0;
+    size_t literal_start = 0;
+    rolling_sum_s sum;
+    int summed = 0;
+    while (block_count > 0 && position < length && position + block_size <= window_length) {
+        if (!summed) {
+            rolling_init(&sum, source + position, block_size);
+            summed = 1;
+        }
+
+        int64_t block = find_block(source + position, block_size, rolling_digest(&sum), blocks,
+                                   block_count, table, table_size - 1, expected);
+        if (block == -1) {
+            if (position + block_size < window_length) {
+                rolling_roll(&sum, source[position], source[position + block_size]);
+            }
+            position++;
+            continue;
+        }
+
+        // Send the bytes since the last match, then extend the last copy or start another
+        if (position > literal_start) {
+            add_operation(&delta, DELTA_LITERAL, (uint32_t)(position - literal_start));
+            memcpy(delta, source + literal_start, position - literal_start);
+            delta += position - literal_start;
+            last_copy = NULL;
+        }
+        if (last_copy && (size_t)block == expected) {
+            last_copy->count = htonl(ntohl(last_copy->count) + 1);
+        } else {
+            last_copy = add_operation(&delta, (uint32_t)block, 1);
+        }
+        expected = (size_t)block + 1;
+        position += block_size;
+        literal_start = position;
+        summed = 0;
+    }
+    free(blocks);
+    free(table);
+
+    // The rest of the range is sent as is
+    size_t covered = (position > length) ? position : length;
+    if (covered > literal_start) {
+        add_operation(&delta, DELTA_LITERAL, (uint32_t)(covered - literal_start));
+        memcpy(delta, source + literal_start, covered - literal_start);
+        delta += covered - literal_start;
+    }
+
+    *delta_size = delta - request->read_buffer;
+    return (int32_t)covered;
+}
+
+/**
+ * @brief Writes data of a receive call to its file, unless a write has already failed
+ *
+ * @param request Receive call being read
+ * @param data Data to write
+ * @param length Number of bytes
+ * @note A failed write is recorded in transfer_error, and the rest of the data is discarded
+ */
+void write_received(request_s* request, const uint8_t* data, size_t length) {
+    while (length > 0 && !request->transfer_error) {
+        ssize_t wrote = pwrite(request->transfer_fd, data, length, request->transfer_offset);
+        if (wrote == -1 && errno == EINTR)
+            continue;
+        if (wrote <= 0) {
+            request->transfer_error = (wrote == 0) ? EIO : errno;
+            break;
+        }
+        data += wrote;
+        length -= wrote;
+        request->transfer_offset += wrote;
+        request->transfer_done += wrote;
+    }
+}
+
+/**
+ * @brief Reads data of a receive call out of the connection's pipe and writes it to the file with
+ *        write_received()
+ *
+ * @param connection Connection reading the receive call
+ * @param length Bytes in the pipe
+ * @return int 0 on success : -1 on error
+ */
+int drain_pipe(connection_s* connection, size_t length) {
+    uint8_t buffer[DISCARD_SIZE];
+    while (length > 0) {
+        ssize_t bytes_read = read(connection->pipe_fds[0], buffer,
+                                  (length < sizeof(buffer)) ? length : sizeof(buffer));
+        if (bytes_read == -1 && errno == EINTR)
+            continue;
+        if (bytes_read <= 0)
+            return -1;
+        write_received(connection->receiving, buffer, bytes_read);
+        length -= bytes_read;
+    }
+    return 0;
+}
+
+/**
+ * @brief Sends the queued replies of a connection, releasing each request once its reply is sent
+ *
+ * @param connection Connection holding the replies
+ * @return int 0 once every reply is sent : 1 if the socket is full : -1 on error
+ */
+int send_replies(connection_s* connection) {
+    while (connection->replies) {
+        request_s* request = connection->replies;
+        int status = send_reply(request);
+        if (status != 0) {
+            return status;
+        }
+
+        connection->replies = request->next;
+        release_request(request);
+    }
+
+    connection->last_reply = NULL;
+    return 0;
+}
+
+/*==================================================================================================
+    Connection State
+==================================================================================================*/
+
+/**
+ * @brief Sets up the state of an accepted client connection
+ *
+ * @param connection Connection to initialize
+ * @param fd File descriptor of the accepted connection
+ * @return int 0 on success : -1 on error
+ */
+int init_connection(connection_s* connection, int fd) {
+    connection->fd = fd;
+    connection->closed = 0;
+    connection->free_requests = NULL;
+    connection->replies = NULL;
+    connection->last_reply = NULL;
+    connection->in_flight = 0;
+    connection->next_closed = NULL;
+    connection->receiving = NULL;
+    connection->pipe_fds[0] = -1;
+    connection->pipe_fds[1] = -1;
+    connection->files = NULL;
+    connection->file_count = 0;
+    connection->file_capacity = 0;
+    if (pthread_rwlock_init(&connection->files_lock, NULL) != 0) {
+        return -1;
+    }
+    if (init_frame_reader(&connection->reader, FRAME_READER_SIZE) == -1) {
+        pthread_rwlock_destroy(&connection->files_lock);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Frees the buffers of a client connection, closing any files it left open
+ *
+ * @param connection Connection to free (no worker may hold one of its requests)
+ */
+void free_connection(connection_s* connection) {
+    for (size_t i = 0; i < connection->file_count; i++) {
+        close(connection->files[i]);
+    }
+    free(connection->files);
+    connection->files = NULL;
+    connection->file_count = 0;
+    connection->file_capacity = 0;
+    pthread_rwlock_destroy(&connection->files_lock);
+
+    if (connection->pipe_fds[0] != -1) {
+        close(connection->pipe_fds[0]);
+        close(connection->pipe_fds[1]);
+    }
+
+    // Unsent replies and unfinished receives are dropped along with the kept requests
+    if (connection->receiving) {
+        release_request(connection->receiving);
+        connection->receiving = NULL;
+    }
+    while (connection->replies) {
+        request_s* request = connection->replies;
+        connection->replies = request->next;
+        release_request(request);
+    }
+    while (connection->free_requests) {
+        request_s* request = connection->free_requests;
+        connection->free_requests = request->next;
+        free(request->payload_copy);
+        free(request->read_buffer);
+        free(request);
+    }
+
+    free_frame_reader(&connection->reader);
+}
+
+/**
+ * @brief Reads the next request frame of a connection, only reading the arguments of a receive
+ *        call (its data is left for receive_data())
+ *
+ * @param connection Connection to read from
+ * @param header Pointer to store the header in host byte order
+ * @param payload Pointer to store the location of the payload
+ * @return int 0 on success : -1 on error with errno set (CONNECTION_CLOSED on end of file)
+ */
+int read_request_frame(connection_s* connection, rp_header_s* header, uint8_t** payload) {
+    if (peek_frame_header(connection->fd, &connection->reader, header) == -1) {
+        return -1;
+    }
+    if (header->opcode == RECEIVE_CALL) {
+        return read_frame_head(connection->fd, &connection->reader, sizeof(rp_receive_args_s),
+                               payload);
+    }
+    if (header->opcode == RECEIVE64_CALL) {
+        return read_frame_head(connection->fd, &connection->reader, sizeof(rp_receive64_args_s),
+                               payload);
+    }
+    return read_frame(connection->fd, &connection->reader, header, payload);
+}
+
+/**
+ * @brief Takes a request of a connection to handle a frame in, reusing a finished one (and its
+ *        buffers) when there is one
+ *
+ * @param connection Connection the frame was read from
+ * @return The request, NULL on error
+ */
+request_s* get_request(connection_s* connection) {
+    request_s* request = connection->free_requests;
+    if (request) {
+        connection->free_requests = request->next;
+    } else {
+        request = calloc(1, sizeof(*request));
+        if (!request) {
+            return NULL;
+        }
+        request->connection = connection;
+    }
+
+    request->next = NULL;
+    request->reply_part = REPLY_PARTS;
+    request->transfer_fd = -1;
+    request->transfer_remaining = 0;
+    request->status = RP_SUCCESS;
+    return request;
+}
+
+/**
+ * @brief Returns a finished request to its connection for reuse
+ *
+ * @param request Request to release
+ */
+void release_request(request_s* request) {
+    connection_s* connection = request->connection;
+    if (request->transfer_fd != -1) {
+        close(request->transfer_fd);
+        request->transfer_fd = -1;
+    }
+    request->next = connection->free_requests;
+    connection->free_requests = request;
+}
+
+/**
+ * @brief Queues the reply of a handled request behind those of its connection
+ *
+ * @param request Request holding the reply
+ */
+void queue_reply(request_s* request) {
+    connection_s* connection = request->connection;
+    request->next = NULL;
+    if (connection->last_reply) {
+        connection->last_reply->next = request;
+    } else {
+        connection->replies = request;
+    }
+    connection->last_reply = request;
+}
+
+/**
+ * @brief Makes sure the read buffer of a request holds a number of bytes, the buffer is kept
+ *        and reused by every later read call
+ *
+ * @param request Request owning the buffer
+ * @param count Number of bytes needed
+ * @return int 0 on success : -1 on error
+ */
+int reserve_read_buffer(request_s* request, size_t count) {
+    if (count <= request->read_capacity) {
+        return 0;
+    }
+
+    uint8_t* buffer = realloc(request->read_buffer, count);
+    if (!buffer) {
+        return -1;
+    }
+    request->read_buffer = buffer;
+    request->read_capacity = count;
+    return 0;
+}
+
+/**
+ * @brief Records a file opened by a connection
+ *
+ * @param connection Connection that opened the file
+ * @param file_fd File descriptor of the file
+ * @return int 0 on success : -1 on error
+ */
+int track_file(connection_s* connection, int file_fd) {
+    int status = 0;
+    pthread_rwlock_wrlock(&connection->files_lock);
+
+    if (connection->file_count == connection->file_capacity) {
+        size_t capacity = (connection->file_capacity) ? connection->file_capacity * 2 : 8;
+        int* files = realloc(connection->files, capacity * sizeof(*files));
+        if (files) {
+            connection->files = files;
+            connection->file_capacity = capacity;
+        } else {
+            status = -1;
+        }
+    }
+    if (status == 0) {
+        connection->files[connection->file_count++] = file_fd;
+    }
+
+    pthread_rwlock_unlock(&connection->files_lock);
+    return status;
+}
+
+/**
+ * @brief Closes a file opened by a connection, once no call of the connection is using it
+ *
+ * @param connection Connection closing the file
+ * @param file_fd File descriptor of the file
+ * @return int 0 on success : -1 with errno set (EBADF if the connection didn't open the file)
+ */
+int close_file(connection_s* connection, int file_fd) {
+    int status = -1;
+    errno = EBADF;
+    pthread_rwlock_wrlock(&connection->files_lock);
+
+    for (size_t i = 0; i < connection->file_count; i++) {
+        if (connection->files[i] == file_fd) {
+            connection->files[i] = connection->files[--connection->file_count];
+            errno = 0;
+            status = close(file_fd);
+            break;
+        }
+    }
+
+    pthread_rwlock_unlock(&connection->files_lock);
+    return status;
+}
+
+/**
+ * @brief Checks a file was opened by a connection, since every connection of the event loop shares
+ *        the server's file descriptors, and keeps it from being closed until unlock_file()
+ *
+ * @param connection Connection using the file
+ * @param file_fd File descriptor of the file
+ * @return int 0 on success : -1 with errno set to EBADF if the connection didn't open the file
+ */
+int lock_file(connection_s* connection, int file_fd) {
+    pthread_rwlock_rdlock(&connection->files_lock);
+
+    for (size_t i = 0; i < connection->file_count; i++) {
+        if (connection->files[i] == file_fd) {
+            return 0;
+        }
+    }
+
+    pthread_rwlock_unlock(&connection->files_lock);
+    errno = EBADF;
+    return -1;
+}
+
+/**
+ * @brief Lets the files locked by lock_file() be closed again
+ *
+ * @param connection Connection using the file
+ */
+void unlock_file(connection_s* connection) {
+    pthread_rwlock_unlock(&connection->files_lock);
+}
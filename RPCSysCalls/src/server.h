@@ -11,13 +11,108 @@
 * @date 2/26/2025
 ***************************************************************************************************/
 
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#include <netinet/in.h>
+
+#include "logger.h"
+#include "pool.h"
 #include "util.h"
 
 /*==================================================================================================
     Macros
 ==================================================================================================*/
 
-#define BACKLOG_SIZE 5
+#define BACKLOG_SIZE 1024          // default listen backlog
+#define FORK_MODE_FLAG "-f"         // fork a process per client instead of the event loop
+#define BACKLOG_FLAG "-b"           // followed by the listen backlog
+#define WORKERS_FLAG "-w"           // followed by the number of workers (0 for none)
+#define USAGE "Usage: <port> [" FORK_MODE_FLAG "] [" BACKLOG_FLAG " <backlog>] " \
+              "[" WORKERS_FLAG " <workers>] " \
+              "[" LOG_LEVEL_FLAG " <debug | info | warning | error>]\n"
+#define MAX_EVENTS 64               // events handled per epoll_wait()
+#define REPLY_PARTS 2               // header and result, then any data read
+#define MAX_PIPELINE 64             // requests of one connection handled at once
+#define DISCARD_SIZE (64 * 1024)    // bytes of a failed receive discarded at a time
+#define DIGEST_HELPERS 16           // most workers helping hash one file
+#define PARALLEL_DIGEST_SIZE (8 * 1024 * 1024) // smallest file hashed by several workers
+
+/*==================================================================================================
+    Structures
+==================================================================================================*/
+
+typedef struct connection_s connection_s;
+
+/***************| Request |***************/
+typedef struct request_s {
+    connection_s* connection;
+    struct request_s* next;     // next free request, or next reply to send
+    rp_header_s header;
+    uint64_t start_time;        // nanoseconds when the frame was read, for the statistics
+    const uint8_t* payload;     // arguments, in the frame reader or payload_copy
+    uint8_t* payload_copy;      // arguments of a request handed to the workers
+    size_t payload_capacity;
+    uint8_t* read_buffer;       // file data of read calls, reused by every call
+    size_t read_capacity;
+
+    // Reply, any data read stays in read_buffer until it is sent
+    uint8_t reply[RP_HEADER_SIZE + sizeof(rp_reply64_s)]; // holds either reply
+    struct iovec reply_parts[REPLY_PARTS];
+    int reply_part;             // first part not fully sent
+
+    // File range moved between the socket and a file without a copy (stream and receive calls)
+    int transfer_fd;            // duplicate of the client's file, -1 if none
+    off_t transfer_offset;      // next file position
+    size_t transfer_remaining;  // bytes left to move
+    size_t transfer_done;       // bytes moved into the file (receive calls)
+    int transfer_error;         // errno of a failed receive, whose data is then discarded
+
+    // Handed to the worker pool
+    pool_job_s job;
+    int status;
+    int error;
+} request_s;
+
+/***************| Digest |***************/
+typedef struct {
+    int file_fd;
+    off_t file_size;
+    size_t chunk_size;
+    size_t chunk_count;
+    uint64_t* digests;          // one per chunk
+    _Atomic size_t next_chunk;  // next chunk to be claimed
+    _Atomic int references;     // held by the handler and every helper spawned
+    pthread_mutex_t lock;
+    pthread_cond_t finished;    // signalled once every chunk is hashed
+    size_t chunks_done;
+    int error;                  // errno of the first chunk that failed
+    pool_job_s helpers[DIGEST_HELPERS];
+} digest_task_s;
+
+/***************| Connection |***************/
+struct connection_s {
+    int fd;
+    int closed;                 // socket closed, freed once no worker holds a request
+    frame_reader_s reader;      // frames read from the client
+    request_s* free_requests;   // finished requests kept for reuse
+
+    // Finished requests, replied to in the order they finished
+    request_s* replies;
+    request_s* last_reply;
+    size_t in_flight;           // requests held by the workers
+    request_s* receiving;       // receive call whose data is being read, NULL if none
+    int pipe_fds[2];            // carries received data from the socket to files, -1 if unused
+    connection_s* next_closed;  // closed connections waiting to be freed
+
+    // Files opened by the client, closed along with the connection
+    pthread_rwlock_t files_lock; // held to read while used, to write while opened or closed
+    int* files;
+    size_t file_count;
+    size_t file_capacity;
+};
 
 /*==================================================================================================
     Function Declarations
@@ -25,17 +120,75 @@
 
 /* Server Setup / Signal Hanlding */
 void interrupt_handler(int sig_number);
-int setupServer(int* socket_fd, struct sockaddr_in* address, int port);
+void child_interrupt_handler(int sig_number);
+void exit_interrupted(void);
+int setupServer(int* socket_fd, struct sockaddr_in* address, int port, int backlog);
+
+/* Fork Mode */
+int serve_forked(struct sockaddr_in* address);
+
+/* Event Loop Mode */
+int serve_events(unsigned int worker_count);
+void accept_connections(int epoll_fd);
+int progress_connection(int epoll_fd, connection_s* connection);
+int submit_request(connection_s* connection, request_s* request);
+void run_job(void* context);
+int job_finished(int epoll_fd, request_s* request);
+int watch_connection(int epoll_fd, connection_s* connection, uint32_t events);
+void close_connection(int epoll_fd, connection_s* connection);
+void free_closed_connections(void);
 
 /* RPC Handlers */
-int handle_open(int client_fd);
-int handle_close(int client_fd);
-int handle_read(int client_fd);
-int handle_write(int client_fd);
-int handle_lseek(int client_fd);
-int handle_checksum(int client_fd);
+int dispatch_frame(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_open(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_close(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_read(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_write(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_lseek(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_checksum(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_pread(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_pwrite(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_stream(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_digest(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_delta(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_lseek64(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_pread64(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_pwrite64(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_stream64(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int handle_stats(request_s* request, const rp_header_s* header, const uint8_t* payload);
+int start_receive(connection_s* connection, request_s* request);
+int receive_data(connection_s* connection);
 
 /* RPC Handler Helpers */
-int return_result(int client_fd, void* result_ptr, var_type_e type);
+int return_result(request_s* request, const rp_header_s* header, int32_t result,
+                  const void* data, size_t data_size);
+int return_result64(request_s* request, const rp_header_s* header, int64_t result,
+                    const void* data, size_t data_size);
+int send_reply(request_s* request);
+int send_replies(connection_s* connection);
+void write_received(request_s* request, const uint8_t* data, size_t length);
+int drain_pipe(connection_s* connection, size_t length);
+int digest_chunks(int file_fd, off_t file_size, size_t chunk_size, size_t chunk_count,
+                  uint64_t* digests);
+void hash_chunks(digest_task_s* task);
+void run_digest_helper(void* context);
+void release_digest_task(digest_task_s* task);
+size_t delta_capacity(size_t length, size_t block_size);
+int32_t compute_delta(request_s* request, int file_fd, off_t offset, size_t length,
+                      size_t block_size, const rp_block_signature_s* signatures,
+                      size_t block_count, size_t* delta_size);
+
+/* Connection State */
+int init_connection(connection_s* connection, int fd);
+void free_connection(connection_s* connection);
+int read_request_frame(connection_s* connection, rp_header_s* header, uint8_t** payload);
+request_s* get_request(connection_s* connection);
+void release_request(request_s* request);
+void queue_reply(request_s* request);
+int reserve_read_buffer(request_s* request, size_t count);
+int track_file(connection_s* connection, int file_fd);
+int close_file(connection_s* connection, int file_fd);
+int lock_file(connection_s* connection, int file_fd);
+void unlock_file(connection_s* connection);
 
 #endif // SERVER_H
\ No newline at end of file
@@ -0,0 +1,211 @@
+/***************************************************************************************************
+* @project: RPC System Calls
+****************************************************************************************************
+* @file stats.c
+* @brief Contains the per-call statistics of the server, kept in shared memory slots.
+*
+* A latency below HISTOGRAM_SUB_BUCKETS nanoseconds has a bucket of its own. Above that, the
+* position of its highest bit picks a power of two and the HISTOGRAM_SUB_BITS bits below it pick
+* one of the buckets splitting it, so the bucket costs a single count of leading zeros.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <string.h>
+
+#include <sys/mman.h>
+
+#include "stats.h"
+#include "util.h"
+
+static stats_region_s* region = NULL;           // shared by every process of the server
+static _Thread_local stats_slot_s* own_slot = NULL; // slot the calling thread counts into
+
+/*==================================================================================================
+    Histogram Buckets
+==================================================================================================*/
+
+/**
+ * @brief Finds the bucket counting a latency
+ *
+ * @param latency Latency in nanoseconds
+ * @return Index of the bucket
+ */
+static size_t bucket_of(uint64_t latency) {
+    if (latency < HISTOGRAM_SUB_BUCKETS) {
+        return (size_t)latency;
+    }
+
+    int high_bit = 63 - __builtin_clzll(latency);
+    if (high_bit >= HISTOGRAM_MAX_BITS) {
+        return HISTOGRAM_BUCKETS - 1;
+    }
+    int shift = high_bit - HISTOGRAM_SUB_BITS;
+    return (size_t)(shift + 1) * HISTOGRAM_SUB_BUCKETS +
+           (size_t)((latency >> shift) - HISTOGRAM_SUB_BUCKETS);
+}
+
+/**
+ * @brief Finds the largest latency counted by a bucket
+ *
+ * @param bucket Index of the bucket
+ * @return Latency in nanoseconds
+ */
+static uint64_t bucket_limit(size_t bucket) {
+    if (bucket < HISTOGRAM_SUB_BUCKETS) {
+        return bucket;
+    }
+
+    int shift = (int)(bucket / HISTOGRAM_SUB_BUCKETS) - 1;
+    uint64_t lowest = (uint64_t)(HISTOGRAM_SUB_BUCKETS + bucket % HISTOGRAM_SUB_BUCKETS) << shift;
+    return lowest + ((uint64_t)1 << shift) - 1;
+}
+
+/**
+ * @brief Finds the latency a share of the calls of a histogram finished within
+ *
+ * @param histogram Calls per latency bucket
+ * @param count Calls in the histogram
+ * @param percent Share of the calls
+ * @return Latency in nanoseconds (the limit of its bucket)
+ */
+static uint64_t percentile(const uint64_t* histogram, uint64_t count, unsigned int percent) {
+    uint64_t wanted = (count * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+        seen += histogram[bucket];
+        if (seen >= wanted && seen > 0) {
+            return bucket_limit(bucket);
+        }
+    }
+    return 0;
+}
+
+/*==================================================================================================
+    Statistics
+==================================================================================================*/
+
+/**
+ * @brief Maps the region holding the statistics, which processes forked afterwards share
+ *
+ * @return 0 on success, -1 on error with errno set
+ */
+int stats_init(void) {
+    void* mapping = mmap(NULL, sizeof(stats_region_s), PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        return -1;
+    }
+
+    // The mapping starts zeroed, which is every counter's initial value
+    region = mapping;
+    return 0;
+}
+
+/**
+ * @brief Counts a call that has been answered
+ *
+ * @param opcode Call answered (unknown opcodes are counted as opcode 0)
+ * @param latency Nanoseconds from the frame being read to the reply being framed
+ * @param bytes_in Bytes received for the call
+ * @param bytes_out Bytes sent in reply
+ * @param failed Whether the call was answered with -1
+ * @note Does nothing before stats_init()
+ */
+void stats_record(uint16_t opcode, uint64_t latency, uint64_t bytes_in, uint64_t bytes_out,
+                  int failed) {
+    if (!region) {
+        return;
+    }
+
+    // A thread takes the next slot the first time it counts (the slots are shared past the last)
+    if (!own_slot) {
+        unsigned int slot = atomic_fetch_add_explicit(&region->next_slot, 1,
+                                                      memory_order_relaxed);
+        own_slot = &region->slots[slot % STATS_SLOT_COUNT];
+    }
+
+    call_stats_s* call = &own_slot->calls[(opcode < RP_CALL_COUNT) ? opcode : 0];
+    atomic_fetch_add_explicit(&call->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&call->bytes_in, bytes_in, memory_order_relaxed);
+    atomic_fetch_add_explicit(&call->bytes_out, bytes_out, memory_order_relaxed);
+    atomic_fetch_add_explicit(&call->latency[bucket_of(latency)], 1, memory_order_relaxed);
+    raise_max(&call->max_latency, latency);
+    if (failed) {
+        atomic_fetch_add_explicit(&call->errors, 1, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Adds up the slots into the statistics of every call answered so far
+ *
+ * @param stats Array of RP_CALL_COUNT statistics to fill (in host byte order)
+ * @return Number of calls filled in, ordered by opcode
+ * @note Calls counted while the slots are added up may be seen in part
+ */
+size_t stats_snapshot(rp_call_stats_s* stats) {
+    if (!region) {
+        return 0;
+    }
+
+    size_t filled = 0;
+    for (int opcode = 0; opcode < RP_CALL_COUNT; opcode++) {
+        rp_call_stats_s* call = &stats[filled];
+        memset(call, 0, sizeof(*call));
+        uint64_t histogram[HISTOGRAM_BUCKETS] = {0};
+        for (int i = 0; i < STATS_SLOT_COUNT; i++) {
+            call_stats_s* counted = &region->slots[i].calls[opcode];
+            call->count += atomic_load_explicit(&counted->count, memory_order_relaxed);
+            call->errors += atomic_load_explicit(&counted->errors, memory_order_relaxed);
+            call->bytes_in += atomic_load_explicit(&counted->bytes_in, memory_order_relaxed);
+            call->bytes_out += atomic_load_explicit(&counted->bytes_out, memory_order_relaxed);
+            uint64_t max_latency = atomic_load_explicit(&counted->max_latency,
+                                                        memory_order_relaxed);
+            if (max_latency > call->max) {
+                call->max = max_latency;
+            }
+            for (size_t bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+                histogram[bucket] += atomic_load_explicit(&counted->latency[bucket],
+                                                          memory_order_relaxed);
+            }
+        }
+        if (!call->count) {
+            continue;
+        }
+
+        // A percentile is the limit of its bucket, which never passes the slowest call
+        call->opcode = (uint32_t)opcode;
+        call->p50 = percentile(histogram, call->count, 50);
+        call->p90 = percentile(histogram, call->count, 90);
+        call->p99 = percentile(histogram, call->count, 99);
+        call->p50 = (call->p50 < call->max) ? call->p50 : call->max;
+        call->p90 = (call->p90 < call->max) ? call->p90 : call->max;
+        call->p99 = (call->p99 < call->max) ? call->p99 : call->max;
+        filled++;
+    }
+    return filled;
+}
+
+/**
+ * @brief Prints the statistics of every call answered so far
+ *
+ * @param stream Stream to print to
+ */
+void stats_report(FILE* stream) {
+    rp_call_stats_s stats[RP_CALL_COUNT];
+    size_t count = stats_snapshot(stats);
+
+    fprintf(stream, "[Server : Info] Call statistics\n");
+    for (size_t i = 0; i < count; i++) {
+        rp_call_stats_s* call = &stats[i];
+        fprintf(stream, "    %-9s calls: %llu (%llu failed), in: %llu B, out: %llu B, "
+                "p50: %.1f us, p90: %.1f us, p99: %.1f us, max: %.1f us\n",
+                strCallType((int)call->opcode),
+                (unsigned long long)call->count,
+                (unsigned long long)call->errors,
+                (unsigned long long)call->bytes_in,
+                (unsigned long long)call->bytes_out,
+                call->p50 / 1000.0, call->p90 / 1000.0, call->p99 / 1000.0, call->max / 1000.0);
+    }
+}
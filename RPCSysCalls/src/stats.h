@@ -0,0 +1,76 @@
+#ifndef STATS_H
+#define STATS_H
+
+/***************************************************************************************************
+* @project: RPC System Calls
+****************************************************************************************************
+* @file stats.h
+* @brief Contains the per-call statistics of the server: counters, bytes moved and latency
+*        histograms.
+*
+* Statistics live in a shared memory mapping made before the server forks, so the children of the
+* fork mode server count into the same region as the event loop and its workers. The region is
+* split into slots, and each thread (or process) counts into a slot of its own with relaxed atomic
+* adds, so counting never takes a lock and rarely shares a cache line. Readers add the slots up.
+*
+* Latencies are kept in log-linear histograms (as HDR histograms do): each power of two is split
+* into HISTOGRAM_SUB_BUCKETS buckets, so a percentile is reported to within 1/8 of its value
+* whatever its magnitude.
+*
+* @author Tyler Neal
+* @date 2/26/2025
+***************************************************************************************************/
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pool.h"
+#include "protocol.h"
+
+/*==================================================================================================
+    Macros
+==================================================================================================*/
+
+#define STATS_SLOT_COUNT 16         // threads (or processes) counting without sharing a slot
+#define HISTOGRAM_SUB_BITS 3
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BITS) // buckets per power of two
+#define HISTOGRAM_MAX_BITS 40       // latencies past 2^40 ns (about 18 minutes) share the last
+#define HISTOGRAM_BUCKETS ((HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_BUCKETS)
+
+/*==================================================================================================
+    Structures
+==================================================================================================*/
+
+/***************| Counters |***************/
+typedef struct {
+    _Atomic uint64_t count;
+    _Atomic uint64_t errors;
+    _Atomic uint64_t bytes_in;
+    _Atomic uint64_t bytes_out;
+    _Atomic uint64_t max_latency;
+    _Atomic uint64_t latency[HISTOGRAM_BUCKETS]; // calls per latency bucket
+} call_stats_s;
+
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE) call_stats_s calls[RP_CALL_COUNT];
+} stats_slot_s;
+
+/***************| Shared Region |***************/
+typedef struct {
+    atomic_uint next_slot;      // slot handed to the next thread that counts
+    stats_slot_s slots[STATS_SLOT_COUNT];
+} stats_region_s;
+
+/*==================================================================================================
+    Function Declarations
+==================================================================================================*/
+
+int stats_init(void);
+void stats_record(uint16_t opcode, uint64_t latency, uint64_t bytes_in, uint64_t bytes_out,
+                  int failed);
+size_t stats_snapshot(rp_call_stats_s* stats);
+void stats_report(FILE* stream);
+
+#endif // STATS_H
@@ -9,25 +9,270 @@
 * the following operations:
 *   1. Sets up a socket connection with the server
 *   2. Opens a remote file for reading
-*   3. Requests a checksum of the remote file
+*   3. Requests a digest of the remote file
 *   4. Creates a local file for copying the remotefile into
-*   5. Copies the remotefile to local directory
-*   6. Closes the remote file
-*   7. Computes a checksum for the local file copy
-*   8. Compares the remote checksum to the local to verify file integrity
-*   9. Prints whether the checksums match
+*   5. Copies the remotefile to local directory, streamed straight into the local file (or with
+*      several reads kept in flight with PIPELINE_FLAG, or only transferring the bytes the local
+*      file lacks with SYNC_FLAG)
+*   6. Computes a digest for the local file copy
+*   7. Compares the remote digest to the local to verify file integrity, listing the chunks that
+*      differ if not
+*   8. Closes the remote file
+*   9. Prints whether the digests match
 *
 * @author Tyler Neal
 * @date 2/26/2025
 ***************************************************************************************************/
 
+#include <errno.h>
 #include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/stat.h>
 
 #include "client.h"
 #include "util.h"
 
+/*==================================================================================================
+    Copying
+==================================================================================================*/
+
+/**
+ * @brief Copies a remote file by streaming it straight into the local file
+ *
+ * @param server_fd Server connection file descriptor
+ * @param remote_fd Remote file to copy
+ * @param local_file Local file to copy into
+ * @return Number of bytes copied, -1 on error
+ */
+static ssize_t copy_streamed(int server_fd, int remote_fd, int local_file) {
+
+    // A single call streams the whole file, however large
+    int64_t bytes_streamed = rp_stream64_to_fd(server_fd, remote_fd, local_file, 0, SIZE_MAX);
+    if (bytes_streamed == -1) {
+        perror("[User : Error] - failed to stream remote file");
+        return -1;
+    }
+    printf("*** Streamed %lld bytes ***\n", (long long)bytes_streamed);
+
+    return (ssize_t)bytes_streamed;
+}
+
+/**
+ * @brief Copies a remote file with several reads kept in flight, writing each chunk at its offset
+ *        as its reply arrives
+ *
+ * @param server_fd Server connection file descriptor
+ * @param remote_fd Remote file to copy
+ * @param local_file Local file to copy into
+ * @return Number of bytes copied, -1 on error
+ */
+static ssize_t copy_pipelined(int server_fd, int remote_fd, int local_file) {
+
+    // Allocate a buffer per read kept in flight
+    char* buffer = (char*)malloc(USER_PIPELINE_DEPTH * USER_BUFFER_SIZE);
+    rp_async_s async;
+    if (!buffer || rp_async_init(&async, server_fd, USER_PIPELINE_DEPTH) == -1) {
+        perror("[User : Error] - failed to allocate buffer");
+        return -1;
+    }
+    rp_call_s calls[USER_PIPELINE_DEPTH];
+    off_t offsets[USER_PIPELINE_DEPTH];
+
+    ssize_t bytes_wrote, total_bytes_copied = 0;
+    off_t next_offset = 0;
+    int end_of_file = 0;
+    for (int i = 0; i < USER_PIPELINE_DEPTH; i++) {
+        offsets[i] = next_offset;
+        next_offset += USER_BUFFER_SIZE;
+        if (rp_submit_pread(&async, &calls[i], remote_fd, buffer + i * USER_BUFFER_SIZE,
+                            USER_BUFFER_SIZE, offsets[i]) == -1) {
+            perror("[User : Error] - failed to read from remote file");
+            return -1;
+        }
+    }
+    while (async.in_flight > 0) {
+        rp_call_s* call = rp_reap(&async);
+        if (!call) {
+            perror("[User : Error] - failed to read from remote file");
+            return -1;
+        }
+        if (call->result == -1) {
+            errno = call->error;
+            perror("[User : Error] - failed to read from remote file");
+            return -1;
+        }
+        printf("*** Read in %d bytes ***\n", call->result);
+
+        int index = (int)(call - calls);
+        if ((bytes_wrote = pwrite(local_file, call->data, call->result, offsets[index])) == -1) {
+            perror("[User : Error] - failed to write to local file");
+            free(buffer);
+            return -1;
+        }
+        total_bytes_copied += bytes_wrote;
+        printf("*** Wrote %zu bytes ***\n", bytes_wrote);
+
+        // A short read marks the end of the file, otherwise read the next chunk
+        if (call->result < USER_BUFFER_SIZE) {
+            end_of_file = 1;
+        }
+        if (!end_of_file) {
+            offsets[index] = next_offset;
+            next_offset += USER_BUFFER_SIZE;
+            if (rp_submit_pread(&async, call, remote_fd, call->data, USER_BUFFER_SIZE,
+                                offsets[index]) == -1) {
+                perror("[User : Error] - failed to read from remote file");
+                return -1;
+            }
+        }
+    }
+    rp_async_free(&async);
+    free(buffer);
+
+    return total_bytes_copied;
+}
+
+/**
+ * @brief Syncs the local file with the remote file, only transferring the bytes it lacks
+ *
+ * @param server_fd Server connection file descriptor
+ * @param remote_fd Remote file to copy
+ * @param local_file Local file to sync, replaced by the synced file (the descriptor then refers to
+ *                   the new file)
+ * @param local_file_path Path of the local file
+ * @return Number of bytes in the synced file, -1 on error
+ */
+static ssize_t copy_synced(int server_fd, int remote_fd, int local_file,
+                           const char* local_file_path) {
+
+    // The synced file is built beside the local file, which it is rebuilt from
+    char* sync_path = malloc(strlen(local_file_path) + sizeof(USER_SYNC_SUFFIX));
+    if (!sync_path) {
+        perror("[User : Error] - failed to allocate path");
+        return -1;
+    }
+    sprintf(sync_path, "%s" USER_SYNC_SUFFIX, local_file_path);
+    int sync_file = open(sync_path, O_CREAT | O_RDWR | O_TRUNC, 0744);
+    if (sync_file < 0) {
+        perror("[User : Error] - failed to open sync file");
+        free(sync_path);
+        return -1;
+    }
+
+    size_t literal_bytes;
+    ssize_t total_bytes_synced = rp_sync(server_fd, remote_fd, local_file, sync_file,
+                                         &literal_bytes);
+    if (total_bytes_synced == -1) {
+        perror("[User : Error] - failed to sync remote file");
+        close(sync_file);
+        unlink(sync_path);
+        free(sync_path);
+        return -1;
+    }
+    printf("*** Transferred %zu of %zd bytes ***\n", literal_bytes, total_bytes_synced);
+
+    // Then replaces it
+    if (rename(sync_path, local_file_path) == -1 || dup2(sync_file, local_file) == -1) {
+        perror("[User : Error] - failed to replace local file");
+        close(sync_file);
+        free(sync_path);
+        return -1;
+    }
+    close(sync_file);
+    free(sync_path);
+
+    return total_bytes_synced;
+}
+
+/*==================================================================================================
+    Verification
+==================================================================================================*/
+
+/**
+ * @brief Compares the chunk digests of the remote file and its copy, printing the ranges that
+ *        differ
+ *
+ * @param server_fd Server connection file descriptor
+ * @param remote_fd Remote file that was copied
+ * @param remote_chunks Number of chunks in the remote file
+ * @param local_file Local copy
+ * @return 0 on success, -1 on error
+ */
+static int report_differences(int server_fd, int remote_fd, int32_t remote_chunks,
+                              int local_file) {
+    struct stat status;
+    if (fstat(local_file, &status) == -1) {
+        perror("[User : Error] - failed to stat local file");
+        return -1;
+    }
+    size_t local_chunks = ((size_t)status.st_size + USER_DIGEST_CHUNK_SIZE - 1) /
+                          USER_DIGEST_CHUNK_SIZE;
+
+    uint64_t* remote_digests = malloc((remote_chunks + 1) * sizeof(uint64_t));
+    uint64_t* local_digests = malloc((local_chunks + 1) * sizeof(uint64_t));
+    if (!remote_digests || !local_digests) {
+        perror("[User : Error] - failed to allocate digests");
+        free(remote_digests);
+        free(local_digests);
+        return -1;
+    }
+    if (rp_digest(server_fd, remote_fd, USER_DIGEST_CHUNK_SIZE, remote_digests,
+                  remote_chunks + 1) == -1 ||
+        digest_file(local_file, USER_DIGEST_CHUNK_SIZE, local_digests, local_chunks + 1) == -1) {
+        perror("[User : Error] - failed to get chunk digests");
+        free(remote_digests);
+        free(local_digests);
+        return -1;
+    }
+
+    // Chunks past the end of either file differ as well
+    size_t chunk_count = ((size_t)remote_chunks > local_chunks) ? (size_t)remote_chunks :
+                                                                  local_chunks;
+    for (size_t i = 0; i < chunk_count; i++) {
+        if (i >= (size_t)remote_chunks || i >= local_chunks ||
+            remote_digests[i + 1] != local_digests[i + 1]) {
+            printf("[User : Info] Chunk %zu differs (bytes %zu to %zu)\n", i,
+                   i * USER_DIGEST_CHUNK_SIZE, (i + 1) * USER_DIGEST_CHUNK_SIZE);
+        }
+    }
+
+    free(remote_digests);
+    free(local_digests);
+    return 0;
+}
+
+/**
+ * @brief Prints the statistics of every call the server has answered
+ *
+ * @param server_fd Server connection file descriptor
+ * @return 0 on success, -1 on error
+ */
+static int print_stats(int server_fd) {
+    rp_call_stats_s stats[RP_CALL_COUNT];
+    int32_t count = rp_stats(server_fd, stats, RP_CALL_COUNT);
+    if (count == -1) {
+        perror("[User : Error] - failed to get server statistics");
+        return -1;
+    }
+
+    printf("[User : Info] Server call statistics:\n");
+    for (int32_t i = 0; i < count; i++) {
+        printf("    %-9s calls: %llu (%llu failed), in: %llu B, out: %llu B, "
+               "p50: %.1f us, p99: %.1f us, max: %.1f us\n",
+               strCallType((int)stats[i].opcode),
+               (unsigned long long)stats[i].count,
+               (unsigned long long)stats[i].errors,
+               (unsigned long long)stats[i].bytes_in,
+               (unsigned long long)stats[i].bytes_out,
+               stats[i].p50 / 1000.0, stats[i].p99 / 1000.0, stats[i].max / 1000.0);
+    }
+    return 0;
+}
+
 /*==================================================================================================
     Main
 ==================================================================================================*/
@@ -41,14 +286,33 @@
                arg[2] port - port number to connect to host on
                arg[3] remote_file_path - path to the remote text file
                arg[4] local_file_path - path to local file to create
+               arg[5] optional PIPELINE_FLAG - copy with pipelined reads, or SYNC_FLAG - sync
+                      the local file with delta transfers
+               arg[5 or 6] optional STATS_FLAG - print the server's call statistics
  * @return 0 on successful execution, -1 on error
  */
 int main(int argc, char** argv) {
 
-    // Verify argument count
-    if (argc != 5) {
+    // Verify arguments
+    int pipelined = 0;
+    int synced = 0;
+    int show_stats = 0;
+    int valid = (argc >= 5 && argc <= 7);
+    for (int i = 5; i < argc && valid; i++) {
+        if (strcmp(argv[i], PIPELINE_FLAG) == 0 && !synced) {
+            pipelined = 1;
+        } else if (strcmp(argv[i], SYNC_FLAG) == 0 && !pipelined) {
+            synced = 1;
+        } else if (strcmp(argv[i], STATS_FLAG) == 0) {
+            show_stats = 1;
+        } else {
+            valid = 0;
+        }
+    }
+    if (!valid) {
         fprintf(stderr, "Usage: <hostname> <port> "
-                                       "<remote_file_path> <local_file_path>\n");
+                                       "<remote_file_path> <local_file_path> "
+                                       "[" PIPELINE_FLAG " | " SYNC_FLAG "] [" STATS_FLAG "]\n");
         return -1;
     }
 
@@ -76,14 +340,16 @@ int main(int argc, char** argv) {
     }
     printf("[User : Info] Remote file opened successfully (fd: %d)\n", remote_fd);
 
-    // Request checksum of remote file
-    printf("[User : Info] Computing remote file checksum...\n");
-    short remote_checksum = rp_checksum(server_fd, remote_fd, CHECKSUM_BLOCK_SIZE);
-    if (remote_checksum == -1) {
-        perror("[User : Error] - failed to get checksum for remote file");
+    // Request digest of remote file (the chunk digests are only fetched if the copy differs)
+    printf("[User : Info] Computing remote file digest...\n");
+    uint64_t remote_digest;
+    int32_t remote_chunks = rp_digest(server_fd, remote_fd, USER_DIGEST_CHUNK_SIZE,
+                                      &remote_digest, 1);
+    if (remote_chunks == -1) {
+        perror("[User : Error] - failed to get digest for remote file");
         return -1;
     }
-    printf("[User : Info] Remote checksum: %hd\n", remote_checksum);
+    printf("[User : Info] Remote digest: %016llx\n", (unsigned long long)remote_digest);
 
     // Open local file
     printf("[User : Info] Creating local file: %s\n", local_file_path);
@@ -93,32 +359,29 @@ int main(int argc, char** argv) {
         return -1;
     }
 
-    // Allocate buffer for reading from server/writing to local file
-    char* buffer = (char*)malloc(USER_BUFFER_SIZE);
-    if (!buffer) {
-        perror("[User : Error] - failed to allocate buffer");
+    // Copy the remote file, streamed straight into the local file unless asked otherwise
+    printf("[User : Info] Copying data from remote to local file...\n");
+    ssize_t total_bytes_copied =
+        (pipelined) ? copy_pipelined(server_fd, remote_fd, local_file) :
+        (synced) ? copy_synced(server_fd, remote_fd, local_file, local_file_path) :
+                   copy_streamed(server_fd, remote_fd, local_file);
+    if (total_bytes_copied == -1) {
         return -1;
     }
-    
-    // Write the contents of the remote file to local file
-    printf("[User : Info] Copying data from remote to local file...\n");
-    ssize_t bytes_read, bytes_wrote, total_bytes_copied = 0;
-    while ((bytes_read = rp_read(server_fd, remote_fd, buffer, USER_BUFFER_SIZE)) > 0) {
-        printf("*** Read in %zu bytes ***\n", bytes_read);
-        if ((bytes_wrote = write(local_file, buffer, bytes_read)) == -1) {
-            perror("[User : Error] - failed to write to local file");
-            free(buffer);
-            return -1;
-        }
-        total_bytes_copied += bytes_wrote;
-        printf("*** Wrote %zu bytes ***\n", bytes_wrote);
-    } 
     printf("[User : Info] Copy complete (%zd bytes transferred)\n", total_bytes_copied);
-    free(buffer);
 
-    // Catch read error
-    if (bytes_read == -1) {
-        perror("[User : Error] - failed to read from remote file");
+    // Compute digest of copied file to verify integrity
+    printf("[User : Info] Computing local file digest...\n");
+    uint64_t local_digest;
+    if (digest_file(local_file, USER_DIGEST_CHUNK_SIZE, &local_digest, 1) == -1) {
+        perror("[User : Error] - failed to generate digest for local file");
+        return -1;
+    }
+    printf("[User : Info] Local digest: %016llx\n", (unsigned long long)local_digest);
+
+    // List the chunks that differ, which are all that would need copying again
+    int matched = (remote_digest == local_digest);
+    if (!matched && report_differences(server_fd, remote_fd, remote_chunks, local_file) == -1) {
         return -1;
     }
 
@@ -129,21 +392,19 @@ int main(int argc, char** argv) {
         return -1;
     }
 
-    // Compute checksum of copied file to verify integrity
-    printf("[User : Info] Computing local file checksum...\n");
-    short local_checksum = genChecksum(local_file, CHECKSUM_BLOCK_SIZE);
-    if (local_checksum == -1) {
-        perror("[User : Error] - failed to generate checksum for local file");
+    // Print how the server's calls performed
+    if (show_stats && print_stats(server_fd) == -1) {
         return -1;
     }
-    printf("[User : Info] Local checksum: %hd\n", local_checksum);
 
     // Print status of copy
-    if (remote_checksum == local_checksum) {
-        printf("[User : Info] SUCCESS: File copied successfully (Checksums match: %hd)\n", local_checksum);
+    if (matched) {
+        printf("[User : Info] SUCCESS: File copied successfully (Digests match: %016llx)\n",
+               (unsigned long long)local_digest);
     } else {
-        printf("[User : Error] ERROR: File copy validation failed (Remote: %hd, Local: %hd)\n", 
-               remote_checksum, local_checksum);
+        printf("[User : Error] ERROR: File copy validation failed (Remote: %016llx, "
+               "Local: %016llx)\n", (unsigned long long)remote_digest,
+               (unsigned long long)local_digest);
         return -1;
     }
 
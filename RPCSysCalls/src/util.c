@@ -6,6 +6,12 @@
 * @brief Contains utility function definitions used in both the client and the
 *        server.
 *
+* File digests are XXH64 hashes (a fast non-cryptographic 64-bit hash) of fixed size chunks,
+* and the digest of the whole file is the hash of its chunk digests, so the chunks can be hashed
+* in any order and in parallel. Chunks are hashed straight from a mapping of the file, or read
+* DIGEST_BUFFER_SIZE bytes at a time when it can't be mapped. Delta syncs pair the digest of each
+* block with a rolling checksum, which finds the blocks at any offset.
+*
 * @author Tyler Neal
 * @date 2/26/2025
 ***************************************************************************************************/
@@ -14,10 +20,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <arpa/inet.h>
+#include <endian.h>
 #include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 
 #include "error.h"
 #include "protocol.h"
@@ -28,160 +39,308 @@
 ==================================================================================================*/
 
 /**
- * @brief Reads data from a file descriptor. First the size of the data is
- * read in as a size_t, and then a buffer is allocated to read in the actual
- * data contents
- * 
- * @param fd File descriptor to read from
- * @return void* Pointer to the data read, NULL on error with errno set
- * @note Caller is responsible for freeing the returned buffer
+ * @brief Writes a list of buffers in full, continuing after partial writes
+ *
+ * @param fd File descriptor to write to
+ * @param next Buffers to write (advanced as they are written)
+ * @param count Number of buffers
+ * @return 0 on success, -1 on error with errno set
  */
-void* read_from_connection(int fd) {
-    size_t data_size;
-    ssize_t bytes_read;
+static int write_vectors(int fd, struct iovec* next, int count) {
+    while (count > 0) {
+        ssize_t bytes_wrote = writev(fd, next, count);
+        if (bytes_wrote == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
 
-    // Read in the size of data
-    bytes_read = read(fd, &data_size, sizeof(data_size));
-    if (bytes_read == -1) {
-        return NULL;
-    }
-    if (bytes_read == 0) {
-        errno = CONNECTION_CLOSED;
-        return NULL;
+        while (count > 0 && (size_t)bytes_wrote >= next->iov_len) {
+            bytes_wrote -= next->iov_len;
+            next++;
+            count--;
+        }
+        if (count > 0) {
+            next->iov_base = (uint8_t*)next->iov_base + bytes_wrote;
+            next->iov_len -= bytes_wrote;
+        }
     }
 
-    // Convert size to host byte order
-    data_size = ntohl(data_size);
+    return 0;
+}
 
-    // Allocate buffer for data
-    void* buffer = malloc(data_size);
-    if (!buffer) {
-        return NULL;
+/**
+ * @brief Sends a whole frame (header, arguments and data) with a single writev
+ *
+ * @param fd File descriptor to write to
+ * @param opcode Call type of the frame
+ * @param request_id Request id of the frame
+ * @param args Packed arguments (or reply) following the header, NULL if none
+ * @param args_size Size of the arguments in bytes
+ * @param data Data following the arguments, NULL if none
+ * @param data_size Size of the data in bytes
+ * @return 0 on success, -1 on error with errno set
+ */
+int send_frame(int fd, uint16_t opcode, uint32_t request_id, const void* args, size_t args_size,
+               const void* data, size_t data_size) {
+    if (args_size + data_size > RP_MAX_PAYLOAD) {
+        errno = PROTOCOL_FRAME_TOO_LARGE;
+        return -1;
     }
 
-    // Read in the data of specified size
-    bytes_read = read(fd, buffer, data_size);
-    if (bytes_read == -1) {
-        return NULL;
-    }
-    if (bytes_read == 0) {
-        errno = CONNECTION_CLOSED;
-        return NULL;
-    }
+    rp_header_s header;
+    header.opcode = htons(opcode);
+    header.reserved = 0;
+    header.request_id = htonl(request_id);
+    header.payload_length = htonl((uint32_t)(args_size + data_size));
 
-    return buffer;
+    struct iovec iov[3] = {
+        { &header, sizeof(header) },
+        { (void*)args, args_size },
+        { (void*)data, data_size },
+    };
+    return write_vectors(fd, iov, 3);
 }
 
 /**
- * @brief Sends data over a file descriptor with size prefix
- * 
+ * @brief Sends the header and arguments of a frame whose data the caller sends itself
+ *
  * @param fd File descriptor to write to
- * @param data Pointer to the data to be sent
- * @param data_size Size of the data in bytes
+ * @param opcode Call type of the frame
+ * @param request_id Request id of the frame
+ * @param args Packed arguments following the header
+ * @param args_size Size of the arguments in bytes
+ * @param data_size Size of the data the caller sends after the arguments
  * @return 0 on success, -1 on error with errno set
  */
-int send_to_connection(int fd, void* data, size_t data_size) {
-    size_t data_size_net = htonl(data_size);
-
-    // Write data size to client
-    if (write(fd, &data_size_net, sizeof(data_size_net)) == -1) {
+int send_frame_head(int fd, uint16_t opcode, uint32_t request_id, const void* args,
+                    size_t args_size, size_t data_size) {
+    if (args_size + data_size > UINT32_MAX) {
+        errno = PROTOCOL_FRAME_TOO_LARGE;
         return -1;
     }
 
-    // Write data to client
-    if (write(fd, data, data_size) == -1) {
-        return -1;
-    }
+    rp_header_s header;
+    header.opcode = htons(opcode);
+    header.reserved = 0;
+    header.request_id = htonl(request_id);
+    header.payload_length = htonl((uint32_t)(args_size + data_size));
 
-    return 0;
+    struct iovec iov[2] = {
+        { &header, sizeof(header) },
+        { (void*)args, args_size },
+    };
+    return write_vectors(fd, iov, 2);
 }
 
 /**
- * @brief Reads a parameter of specified type from specified connection
- * 
- * @param var Pointer to store the read parameter
- * @param type Type of the parameter (INT32, UINT32, INT16)
- * @param client_fd Client connection file descriptor
+ * @brief Allocates the buffer of a frame reader
+ *
+ * @param reader Frame reader to initialize
+ * @param capacity Initial size of the buffer (grown for larger frames)
  * @return 0 on success, -1 on error with errno set
  */
-int read_data_of_type(void* var, var_type_e type, int client_fd) {
-    switch (type) {
-        case INT32: {
-            int32_t* int_ptr = (int32_t*)read_from_connection(client_fd);
-            if (!int_ptr) // break if value want read
-                return -1;
-            *(int32_t*)var = ntohl(*int_ptr);
-            free(int_ptr);
-            break;
-        }
-        case UINT32: {
-            uint32_t* uint_ptr = (uint32_t*)read_from_connection(client_fd);
-            if (!uint_ptr) // break if value want read
+int init_frame_reader(frame_reader_s* reader, size_t capacity) {
+    reader->buffer = malloc(capacity);
+    reader->capacity = capacity;
+    reader->start = 0;
+    reader->end = 0;
+    return (reader->buffer) ? 0 : -1;
+}
+
+/**
+ * @brief Frees the buffer of a frame reader
+ *
+ * @param reader Frame reader to free
+ */
+void free_frame_reader(frame_reader_s* reader) {
+    free(reader->buffer);
+    reader->buffer = NULL;
+    reader->capacity = 0;
+}
+
+/**
+ * @brief Makes sure a number of bytes are buffered from the start of the next frame
+ *
+ * @param fd File descriptor to read from
+ * @param reader Frame reader holding the buffered bytes
+ * @param length Number of bytes needed
+ * @return 0 on success, -1 on error with errno set (CONNECTION_CLOSED on end of file)
+ */
+static int fill_frame_reader(int fd, frame_reader_s* reader, size_t length) {
+
+    // Move the partial frame to the front, growing the buffer if it can't fit
+    if (reader->start + length > reader->capacity) {
+        size_t buffered = reader->end - reader->start;
+        memmove(reader->buffer, reader->buffer + reader->start, buffered);
+        reader->start = 0;
+        reader->end = buffered;
+
+        if (length > reader->capacity) {
+            uint8_t* buffer = realloc(reader->buffer, length);
+            if (!buffer) {
                 return -1;
-            *(uint32_t*)var = ntohl(*uint_ptr);
-            free(uint_ptr);
-            break;
+            }
+            reader->buffer = buffer;
+            reader->capacity = length;
         }
-        case INT16: {
-            int16_t* short_ptr = (int16_t*)read_from_connection(client_fd);
-            if (!short_ptr) // break if value want read
-                return -1;
-            *(int16_t*)var = ntohs(*short_ptr);
-            free(short_ptr);
-            break;
+    }
+
+    // Read as much as fits, usually the entire frame and more
+    while (reader->end - reader->start < length) {
+        ssize_t bytes_read = read(fd, reader->buffer + reader->end, reader->capacity - reader->end);
+        if (bytes_read == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
         }
-        default:
-            errno = ERR_INVALID_VAR_TYPE;
+        if (bytes_read == 0) {
+            errno = CONNECTION_CLOSED;
             return -1;
+        }
+        reader->end += bytes_read;
     }
+
     return 0;
 }
 
 /**
- * @brief Sends a result of specified type to specified fd
- * 
- * @param result Pointer to the result to send
- * @param type Type of the result (INT32, UINT32, INT16)
- * @param client_fd Client connection file descriptor
- * @return 0 on success, -1 on error with errno set
+ * @brief Reads the header of the next frame from a file descriptor without consuming it
+ *
+ * @param fd File descriptor to read from
+ * @param reader Frame reader holding bytes already read from fd
+ * @param header Pointer to store the header in host byte order
+ * @return 0 on success, -1 on error with errno set (CONNECTION_CLOSED on end of file)
  */
-int send_data_of_type(void* result, var_type_e type, int client_fd) {
-    // We cast signed integers to unsigned because bit integrity remains same
-    switch (type) {
-        case INT32: {
-            uint32_t copy;
-            memcpy(&copy, result, sizeof(copy));
-            uint32_t net_val = htonl(copy);
-            if (send_to_connection(client_fd, &net_val, sizeof(net_val)) < 0) {
-                errno = ERR_SEND_DATA_OF_TYPE;
-                return -1;
-            }
-            break;
-        }
-        case UINT32: {
-            uint32_t copy;
-            memcpy(&copy, result, sizeof(copy));
-            uint32_t net_val = htonl(copy); // Use 64-bit conversion
-            if (send_to_connection(client_fd, &net_val, sizeof(net_val)) < 0) {
-                errno = ERR_SEND_DATA_OF_TYPE;
-                return -1;
-            }
-            break;
-        }
-        case INT16: {
-            uint16_t copy;
-            memcpy(&copy, result, sizeof(copy));
-            uint16_t net_val = htons(copy); // Use 16-bit conversion
-            if (send_to_connection(client_fd, &net_val, sizeof(net_val)) < 0) {
-                errno = ERR_SEND_DATA_OF_TYPE;
-                return -1;
-            }
-            break;
+int peek_frame_header(int fd, frame_reader_s* reader, rp_header_s* header) {
+
+    // Start over at the front once every buffered frame is consumed
+    if (reader->start == reader->end) {
+        reader->start = 0;
+        reader->end = 0;
+    }
+
+    // Retrieve the header
+    if (fill_frame_reader(fd, reader, RP_HEADER_SIZE) == -1) {
+        return -1;
+    }
+    rp_header_s net_header;
+    memcpy(&net_header, reader->buffer + reader->start, sizeof(net_header));
+    header->opcode = ntohs(net_header.opcode);
+    header->reserved = ntohs(net_header.reserved);
+    header->request_id = ntohl(net_header.request_id);
+    header->payload_length = ntohl(net_header.payload_length);
+
+    return 0;
+}
+
+/**
+ * @brief Reads the next frame from a file descriptor
+ *
+ * @param fd File descriptor to read from
+ * @param reader Frame reader holding bytes already read from fd
+ * @param header Pointer to store the header in host byte order
+ * @param payload Pointer to store the location of the payload
+ * @return 0 on success, -1 on error with errno set (CONNECTION_CLOSED on end of file)
+ * @note The payload stays valid until the next call with the same reader
+ */
+int read_frame(int fd, frame_reader_s* reader, rp_header_s* header, uint8_t** payload) {
+
+    // Retrieve the header
+    if (peek_frame_header(fd, reader, header) == -1) {
+        return -1;
+    }
+    if (header->payload_length > RP_MAX_PAYLOAD) {
+        errno = PROTOCOL_FRAME_TOO_LARGE;
+        return -1;
+    }
+
+    // Retrieve the payload
+    if (fill_frame_reader(fd, reader, RP_HEADER_SIZE + header->payload_length) == -1) {
+        return -1;
+    }
+    *payload = reader->buffer + reader->start + RP_HEADER_SIZE;
+    reader->start += RP_HEADER_SIZE + header->payload_length;
+
+    return 0;
+}
+
+/**
+ * @brief Reads the header and the start of the payload of the next frame, leaving the rest of the
+ *        payload to be taken by the caller (with take_buffered() and then from fd itself)
+ *
+ * @param fd File descriptor to read from
+ * @param reader Frame reader holding bytes already read from fd
+ * @param head_length Bytes of the payload to read
+ * @param head Pointer to store the location of the start of the payload
+ * @return 0 on success, -1 on error with errno set (CONNECTION_CLOSED on end of file)
+ * @note The header must have been read with peek_frame_header(), the start of the payload stays
+ *       valid until the next call with the same reader
+ */
+int read_frame_head(int fd, frame_reader_s* reader, size_t head_length, uint8_t** head) {
+    rp_header_s header;
+    if (peek_frame_header(fd, reader, &header) == -1) {
+        return -1;
+    }
+    if (header.payload_length < head_length) {
+        errno = PROTOCOL_BAD_FRAME;
+        return -1;
+    }
+
+    if (fill_frame_reader(fd, reader, RP_HEADER_SIZE + head_length) == -1) {
+        return -1;
+    }
+    *head = reader->buffer + reader->start + RP_HEADER_SIZE;
+    reader->start += RP_HEADER_SIZE + head_length;
+
+    return 0;
+}
+
+/**
+ * @brief Takes bytes already read past the last frame consumed
+ *
+ * @param reader Frame reader holding the bytes
+ * @param length Most bytes to take
+ * @param data Pointer to store the location of the bytes
+ * @return Number of bytes taken (0 if none are buffered)
+ * @note The bytes stay valid until the next call with the same reader
+ */
+size_t take_buffered(frame_reader_s* reader, size_t length, uint8_t** data) {
+    size_t buffered = reader->end - reader->start;
+    if (length > buffered) {
+        length = buffered;
+    }
+
+    *data = reader->buffer + reader->start;
+    reader->start += length;
+    return length;
+}
+
+/**
+ * @brief Reads an exact number of bytes from a file descriptor
+ *
+ * @param fd File descriptor to read from
+ * @param buffer Buffer to store the bytes
+ * @param length Number of bytes to read
+ * @return 0 on success, -1 on error with errno set (CONNECTION_CLOSED on end of file)
+ */
+int read_exact(int fd, void* buffer, size_t length) {
+    size_t total = 0;
+
+    while (total < length) {
+        ssize_t bytes_read = read(fd, (uint8_t*)buffer + total, length - total);
+        if (bytes_read == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1;
         }
-        default:
-            errno = ERR_INVALID_VAR_TYPE;
+        if (bytes_read == 0) {
+            errno = CONNECTION_CLOSED;
             return -1;
+        }
+        total += bytes_read;
     }
+
     return 0;
 }
 
@@ -206,6 +365,30 @@ char* strCallType(int call_type) {
             return "LSEEK";
         case CHECKSUM_CALL:
             return "CHECKSUM";
+        case PREAD_CALL:
+            return "PREAD";
+        case PWRITE_CALL:
+            return "PWRITE";
+        case STREAM_CALL:
+            return "STREAM";
+        case RECEIVE_CALL:
+            return "RECEIVE";
+        case DIGEST_CALL:
+            return "DIGEST";
+        case DELTA_CALL:
+            return "DELTA";
+        case LSEEK64_CALL:
+            return "LSEEK64";
+        case PREAD64_CALL:
+            return "PREAD64";
+        case PWRITE64_CALL:
+            return "PWRITE64";
+        case STREAM64_CALL:
+            return "STREAM64";
+        case RECEIVE64_CALL:
+            return "RECEIVE64";
+        case STATS_CALL:
+            return "STATS";
         default:
             return "INVALID";
     }
@@ -253,4 +436,338 @@ short genChecksum(int fd, int block_size) {
         return -1;
 
     return checksum;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Reads the monotonic clock
+ *
+ * @return Nanoseconds since an arbitrary point
+ */
+uint64_t clock_now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (uint64_t)time.tv_sec * 1000000000u + (uint64_t)time.tv_nsec;
+}
+
+/**
+ * @brief Raises a maximum counter to a value
+ *
+ * @param counter Counter holding the maximum
+ * @param value Value seen
+ */
+void raise_max(_Atomic uint64_t* counter, uint64_t value) {
+    uint64_t current = atomic_load_explicit(counter, memory_order_relaxed);
+    while (value > current &&
+           !atomic_compare_exchange_weak_explicit(counter, &current, value,
+                                                  memory_order_relaxed, memory_order_relaxed));
+}
+
+/*==================================================================================================
+    Digests
+==================================================================================================*/
+
+#define HASH_PRIME_1 11400714785074694791ull
+#define HASH_PRIME_2 14029467366897019727ull
+#define HASH_PRIME_3 1609587929392839161ull
+#define HASH_PRIME_4 9650029242287828579ull
+#define HASH_PRIME_5 2870177450012600261ull
+
+static uint64_t rotate_left(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static uint64_t load64(const uint8_t* bytes) {
+    uint64_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return le64toh(value);
+}
+
+static uint32_t load32(const uint8_t* bytes) {
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return le32toh(value);
+}
+
+static uint64_t hash_round(uint64_t accumulator, uint64_t input) {
+    accumulator += input * HASH_PRIME_2;
+    accumulator = rotate_left(accumulator, 31);
+    return accumulator * HASH_PRIME_1;
+}
+
+static uint64_t hash_merge(uint64_t hash, uint64_t accumulator) {
+    hash ^= hash_round(0, accumulator);
+    return hash * HASH_PRIME_1 + HASH_PRIME_4;
+}
+
+/**
+ * @brief Starts a hash
+ *
+ * @param state State to initialize
+ * @param seed Seed of the hash
+ */
+void hash_init(hash_state_s* state, uint64_t seed) {
+    state->accumulators[0] = seed + HASH_PRIME_1 + HASH_PRIME_2;
+    state->accumulators[1] = seed + HASH_PRIME_2;
+    state->accumulators[2] = seed;
+    state->accumulators[3] = seed - HASH_PRIME_1;
+    state->total_length = 0;
+    state->pending_length = 0;
+}
+
+/**
+ * @brief Adds bytes to a hash
+ *
+ * @param state State of the hash
+ * @param data Bytes to add
+ * @param length Number of bytes
+ */
+void hash_update(hash_state_s* state, const void* data, size_t length) {
+    const uint8_t* next = data;
+    const uint8_t* end = next + length;
+    state->total_length += length;
+
+    // Fill up the stripe left over from the last update
+    if (state->pending_length + length < HASH_STRIPE_SIZE) {
+        memcpy(state->pending + state->pending_length, next, length);
+        state->pending_length += length;
+        return;
+    }
+    if (state->pending_length > 0) {
+        size_t fill = HASH_STRIPE_SIZE - state->pending_length;
+        memcpy(state->pending + state->pending_length, next, fill);
+        for (int i = 0; i < 4; i++) {
+            state->accumulators[i] = hash_round(state->accumulators[i],
+                                                load64(state->pending + i * 8));
+        }
+        next += fill;
+        state->pending_length = 0;
+    }
+
+    // Then whole stripes straight from the data
+    uint64_t accumulators[4];
+    memcpy(accumulators, state->accumulators, sizeof(accumulators));
+    while (end - next >= HASH_STRIPE_SIZE) {
+        accumulators[0] = hash_round(accumulators[0], load64(next));
+        accumulators[1] = hash_round(accumulators[1], load64(next + 8));
+        accumulators[2] = hash_round(accumulators[2], load64(next + 16));
+        accumulators[3] = hash_round(accumulators[3], load64(next + 24));
+        next += HASH_STRIPE_SIZE;
+    }
+    memcpy(state->accumulators, accumulators, sizeof(accumulators));
+
+    memcpy(state->pending, next, end - next);
+    state->pending_length = end - next;
+}
+
+/**
+ * @brief Finishes a hash
+ *
+ * @param state State of the hash
+ * @return The hash of every byte added
+ */
+uint64_t hash_final(const hash_state_s* state) {
+    const uint64_t* accumulators = state->accumulators;
+    uint64_t hash;
+    if (state->total_length >= HASH_STRIPE_SIZE) {
+        hash = rotate_left(accumulators[0], 1) + rotate_left(accumulators[1], 7) +
+               rotate_left(accumulators[2], 12) + rotate_left(accumulators[3], 18);
+        for (int i = 0; i < 4; i++) {
+            hash = hash_merge(hash, accumulators[i]);
+        }
+    } else {
+        hash = accumulators[2] + HASH_PRIME_5;
+    }
+    hash += state->total_length;
+
+    // Mix in the bytes short of a stripe
+    const uint8_t* next = state->pending;
+    size_t length = state->pending_length;
+    for (; length >= 8; next += 8, length -= 8) {
+        hash ^= hash_round(0, load64(next));
+        hash = rotate_left(hash, 27) * HASH_PRIME_1 + HASH_PRIME_4;
+    }
+    if (length >= 4) {
+        hash ^= (uint64_t)load32(next) * HASH_PRIME_1;
+        hash = rotate_left(hash, 23) * HASH_PRIME_2 + HASH_PRIME_3;
+        next += 4;
+        length -= 4;
+    }
+    for (; length > 0; next++, length--) {
+        hash ^= *next * HASH_PRIME_5;
+        hash = rotate_left(hash, 11) * HASH_PRIME_1;
+    }
+
+    // Avalanche
+    hash ^= hash >> 33;
+    hash *= HASH_PRIME_2;
+    hash ^= hash >> 29;
+    hash *= HASH_PRIME_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+/**
+ * @brief Hashes a buffer in one go
+ *
+ * @param data Bytes to hash
+ * @param length Number of bytes
+ * @return The hash of the bytes
+ */
+uint64_t hash_buffer(const void* data, size_t length) {
+    hash_state_s state;
+    hash_init(&state, 0);
+    hash_update(&state, data, length);
+    return hash_final(&state);
+}
+
+/**
+ * @brief Computes the rolling checksum of a window of bytes
+ *
+ * @param sum Rolling checksum to initialize
+ * @param data First byte of the window
+ * @param length Bytes in the window
+ */
+void rolling_init(rolling_sum_s* sum, const uint8_t* data, size_t length) {
+    sum->a = 0;
+    sum->b = 0;
+    sum->length = length;
+    for (size_t i = 0; i < length; i++) {
+        sum->a += data[i];
+        sum->b += (uint32_t)(length - i) * data[i];
+    }
+}
+
+/**
+ * @brief Slides the window of a rolling checksum forward by one byte
+ *
+ * @param sum Rolling checksum of the window
+ * @param out Byte leaving the front of the window
+ * @param in Byte entering the back of the window
+ */
+void rolling_roll(rolling_sum_s* sum, uint8_t out, uint8_t in) {
+    sum->a += in - out;
+    sum->b += sum->a - (uint32_t)sum->length * out;
+}
+
+/**
+ * @brief Reads a rolling checksum
+ *
+ * @param sum Rolling checksum of the window
+ * @return Both sums packed in 32 bits
+ */
+uint32_t rolling_digest(const rolling_sum_s* sum) {
+    return (sum->a & 0xffff) | (sum->b << 16);
+}
+
+/**
+ * @brief Hashes a range of a file, mapping it when possible and otherwise reading it in large
+ *        buffers
+ *
+ * @param fd File descriptor of the file
+ * @param offset File position of the range
+ * @param length Bytes in the range (which must lie within the file)
+ * @param digest Pointer to store the digest of the range
+ * @return 0 on success, -1 on error with errno set
+ * @note The file position is left untouched
+ */
+int digest_range(int fd, off_t offset, size_t length, uint64_t* digest) {
+    hash_state_s state;
+    hash_init(&state, 0);
+
+    // Map from the page holding the start of the range
+    off_t page_offset = offset % sysconf(_SC_PAGESIZE);
+    if (length > 0) {
+        uint8_t* mapping = mmap(NULL, length + page_offset, PROT_READ, MAP_PRIVATE, fd,
+                                offset - page_offset);
+        if (mapping != MAP_FAILED) {
+            madvise(mapping, length + page_offset, MADV_SEQUENTIAL);
+            hash_update(&state, mapping + page_offset, length);
+            munmap(mapping, length + page_offset);
+            *digest = hash_final(&state);
+            return 0;
+        }
+    }
+
+    // Files that can't be mapped are read instead
+    uint8_t* buffer = (length > 0) ? malloc(DIGEST_BUFFER_SIZE) : NULL;
+    if (length > 0 && !buffer) {
+        return -1;
+    }
+    while (length > 0) {
+        ssize_t bytes_read = pread(fd, buffer, (length < DIGEST_BUFFER_SIZE) ?
+                                   length : DIGEST_BUFFER_SIZE, offset);
+        if (bytes_read == -1 && errno == EINTR)
+            continue;
+        if (bytes_read <= 0) {
+            if (bytes_read == 0)
+                errno = EIO;
+            free(buffer);
+            return -1;
+        }
+        hash_update(&state, buffer, bytes_read);
+        offset += bytes_read;
+        length -= bytes_read;
+    }
+    free(buffer);
+
+    *digest = hash_final(&state);
+    return 0;
+}
+
+/**
+ * @brief Combines the digests of every chunk of a file into the digest of the file
+ *
+ * @param digests Digests of the chunks, in order
+ * @param count Number of chunks
+ * @return Digest of the file
+ */
+uint64_t combine_digests(const uint64_t* digests, size_t count) {
+    hash_state_s state;
+    hash_init(&state, 0);
+    for (size_t i = 0; i < count; i++) {
+        uint64_t digest = htobe64(digests[i]);
+        hash_update(&state, &digest, sizeof(digest));
+    }
+    return hash_final(&state);
+}
+
+/**
+ * @brief Computes the digest of a file and of each of its chunks
+ *
+ * @param fd File descriptor of the file
+ * @param chunk_size Bytes per chunk (DIGEST_CHUNK_SIZE if 0)
+ * @param digests Array to store the file digest in, followed by the first capacity - 1 chunk
+ *                digests
+ * @param capacity Entries in digests (at least 1)
+ * @return Number of chunks in the file, -1 on error with errno set
+ */
+ssize_t digest_file(int fd, size_t chunk_size, uint64_t* digests, size_t capacity) {
+    struct stat status;
+    if (fstat(fd, &status) == -1) {
+        return -1;
+    }
+    if (chunk_size == 0) {
+        chunk_size = DIGEST_CHUNK_SIZE;
+    }
+
+    // Each chunk digest is added to the file digest as it is computed
+    hash_state_s state;
+    hash_init(&state, 0);
+    size_t chunk_count = 0;
+    for (off_t offset = 0; offset < status.st_size; offset += chunk_size, chunk_count++) {
+        size_t length = ((size_t)(status.st_size - offset) < chunk_size) ?
+                        (size_t)(status.st_size - offset) : chunk_size;
+        uint64_t digest;
+        if (digest_range(fd, offset, length, &digest) == -1) {
+            return -1;
+        }
+        if (chunk_count + 1 < capacity) {
+            digests[chunk_count + 1] = digest;
+        }
+        digest = htobe64(digest);
+        hash_update(&state, &digest, sizeof(digest));
+    }
+
+    digests[0] = hash_final(&state);
+    return (ssize_t)chunk_count;
+}
@@ -11,36 +11,93 @@
 * @date 2/26/2025
 ***************************************************************************************************/
 
+#include <stdatomic.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <sys/types.h>
+
+#include "protocol.h"
 
 /*==================================================================================================
     Macros
 ==================================================================================================*/
 
 #define CHECKSUM_BLOCK_SIZE 2 // buffer size for checksums
+#define FRAME_READER_SIZE (64 * 1024) // initial buffer size for reading frames
+#define TRANSFER_CHUNK_SIZE (64 * 1024) // bytes moved through a pipe at a time (a pipe's capacity)
+#define DIGEST_CHUNK_SIZE (1024 * 1024) // default bytes per chunk digest
+#define DIGEST_MIN_CHUNK_SIZE (4 * 1024) // smallest chunk the server hashes (bounds its digests)
+#define DIGEST_BUFFER_SIZE (1024 * 1024) // bytes read at a time from files that can't be mapped
+#define HASH_STRIPE_SIZE 32 // bytes the hash takes at a time
 
 /*==================================================================================================
-    Enumerations
+    Structures
 ==================================================================================================*/
 
-typedef enum {
-    INT32,
-    UINT32,
-    INT16,
-} var_type_e;
+/*
+ * Bytes are read from the connection in large chunks, and frames are parsed straight out of the
+ * buffer, so a frame costs a single read() however many fields it holds.
+ */
+typedef struct {
+    uint8_t* buffer;
+    size_t capacity;
+    size_t start;           // first byte of the next frame
+    size_t end;             // end of the bytes read so far
+} frame_reader_s;
+
+/*
+ * State of an XXH64 hash, so a chunk can be hashed a buffer at a time.
+ */
+typedef struct {
+    uint64_t accumulators[4];
+    uint64_t total_length;
+    uint8_t pending[HASH_STRIPE_SIZE]; // bytes short of a stripe
+    size_t pending_length;
+} hash_state_s;
+
+/*
+ * Checksum of a window of bytes that slides a byte at a time in constant time (the weak sum of
+ * rsync), so every offset of a file can be checked against a set of blocks.
+ */
+typedef struct {
+    uint32_t a;             // sum of the bytes
+    uint32_t b;             // sum of the bytes weighted by their distance from the end
+    size_t length;
+} rolling_sum_s;
 
 /*==================================================================================================
     Function Declarations
 ==================================================================================================*/
 
-/* File Descriptor Reading/Writing */
-void* read_from_connection(int fd);
-int send_to_connection(int fd, void* data, size_t data_size);
-int read_data_of_type(void* var, var_type_e type, int client_fd);
-int send_data_of_type(void* result, var_type_e type, int client_fd);
+/* Frame Reading/Writing */
+int send_frame(int fd, uint16_t opcode, uint32_t request_id, const void* args, size_t args_size,
+               const void* data, size_t data_size);
+int send_frame_head(int fd, uint16_t opcode, uint32_t request_id, const void* args,
+                    size_t args_size, size_t data_size);
+int init_frame_reader(frame_reader_s* reader, size_t capacity);
+void free_frame_reader(frame_reader_s* reader);
+int peek_frame_header(int fd, frame_reader_s* reader, rp_header_s* header);
+int read_frame(int fd, frame_reader_s* reader, rp_header_s* header, uint8_t** payload);
+int read_frame_head(int fd, frame_reader_s* reader, size_t head_length, uint8_t** head);
+size_t take_buffered(frame_reader_s* reader, size_t length, uint8_t** data);
+int read_exact(int fd, void* buffer, size_t length);
 
 /* Additional Helpers */
 char* strCallType(int call_type);
 short genChecksum(int fd, int block_size);
+uint64_t clock_now(void);
+void raise_max(_Atomic uint64_t* counter, uint64_t value);
+
+/* Digests */
+void hash_init(hash_state_s* state, uint64_t seed);
+void hash_update(hash_state_s* state, const void* data, size_t length);
+uint64_t hash_final(const hash_state_s* state);
+uint64_t hash_buffer(const void* data, size_t length);
+void rolling_init(rolling_sum_s* sum, const uint8_t* data, size_t length);
+void rolling_roll(rolling_sum_s* sum, uint8_t out, uint8_t in);
+uint32_t rolling_digest(const rolling_sum_s* sum);
+int digest_range(int fd, off_t offset, size_t length, uint64_t* digest);
+uint64_t combine_digests(const uint64_t* digests, size_t count);
+ssize_t digest_file(int fd, size_t chunk_size, uint64_t* digests, size_t capacity);
 
 #endif // UTIL_H
\ No newline at end of file